@@ -0,0 +1,151 @@
+// Measure the throughput of alias queries through the lotus pointer analysis
+// interface. For each function, the pointers that are loaded from or stored to
+// are queried against each other, first with one alias() call per pair, and
+// then with the batched aliasMatrix() and aliasesOf(). The results of the
+// three must agree.
+
+#include "Alias/PointerAnalysisInterface.h"
+
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IRReader/IRReader.h>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/SourceMgr.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <chrono>
+#include <set>
+#include <vector>
+
+using namespace llvm;
+
+static cl::opt<std::string> InputFilename(cl::Positional,
+                                          cl::desc("<IR file>"), cl::Required);
+static cl::opt<unsigned>
+    MaxPointers("max-pointers",
+                cl::desc("The maximum number of pointers queried per function"),
+                cl::init(1000));
+static cl::opt<unsigned> Repeat("repeat",
+                                cl::desc("The number of times to query"),
+                                cl::init(1));
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double elapsedSeconds(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void report(const char *name, size_t numQueries, double seconds) {
+  errs() << "  " << name << ": " << numQueries << " queries in "
+         << format("%.3f", seconds) << " s, "
+         << format("%.2f", numQueries / seconds / 1e6) << " M queries/s\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  cl::ParseCommandLineOptions(argc, argv, "Alias query benchmark\n");
+
+  LLVMContext context;
+  SMDiagnostic err;
+  std::unique_ptr<Module> module = parseIRFile(InputFilename, err, context);
+  if (!module) {
+    err.print(argv[0], errs());
+    return 1;
+  }
+
+  auto start = Clock::now();
+  lotus::AndersenPointerAnalysisResult andersen(*module);
+  // The overloads of alias() on values are declared in the base class
+  lotus::PointerAnalysisResult &pa = andersen;
+  errs() << "Andersen's analysis takes " << format("%.3f", elapsedSeconds(start))
+         << " s\n";
+
+  // The pointers accessed in each function
+  std::vector<std::vector<const Value *>> groups;
+  for (auto const &f : *module) {
+    std::set<const Value *> seen;
+    std::vector<const Value *> pointers;
+    for (auto const &inst : instructions(f)) {
+      const Value *ptr = nullptr;
+      if (auto *load = dyn_cast<LoadInst>(&inst))
+        ptr = load->getPointerOperand();
+      else if (auto *store = dyn_cast<StoreInst>(&inst))
+        ptr = store->getPointerOperand();
+      if (ptr != nullptr && pointers.size() < MaxPointers &&
+          seen.insert(ptr).second)
+        pointers.push_back(ptr);
+    }
+    if (pointers.size() > 1)
+      groups.push_back(std::move(pointers));
+  }
+
+  size_t numQueries = 0;
+  for (auto const &pointers : groups)
+    numQueries += pointers.size() * pointers.size();
+  numQueries *= Repeat;
+  errs() << "Querying " << groups.size() << " functions\n";
+
+  // One query per pair, which is the path of the existing clients
+  std::vector<std::vector<AliasResult>> expected(groups.size());
+  start = Clock::now();
+  for (unsigned r = 0; r < Repeat; ++r) {
+    for (size_t g = 0; g < groups.size(); ++g) {
+      auto const &pointers = groups[g];
+      auto &results = expected[g];
+      results.clear();
+      for (const Value *p1 : pointers)
+        for (const Value *p2 : pointers)
+          results.push_back(pa.alias(p1, p2));
+    }
+  }
+  report("alias", numQueries, elapsedSeconds(start));
+
+  unsigned numMismatches = 0;
+  start = Clock::now();
+  for (unsigned r = 0; r < Repeat; ++r) {
+    for (size_t g = 0; g < groups.size(); ++g) {
+      if (pa.aliasMatrix(groups[g]) != expected[g])
+        ++numMismatches;
+    }
+  }
+  report("aliasMatrix", numQueries, elapsedSeconds(start));
+
+  start = Clock::now();
+  for (unsigned r = 0; r < Repeat; ++r) {
+    for (size_t g = 0; g < groups.size(); ++g) {
+      auto const &pointers = groups[g];
+      for (size_t i = 0; i < pointers.size(); ++i) {
+        auto results = pa.aliasesOf(pointers[i], pointers);
+        if (!std::equal(results.begin(), results.end(),
+                        expected[g].begin() + i * pointers.size()))
+          ++numMismatches;
+      }
+    }
+  }
+  report("aliasesOf", numQueries, elapsedSeconds(start));
+
+  unsigned numNoAlias = 0, numMayAlias = 0, numMustAlias = 0;
+  for (auto const &results : expected) {
+    for (AliasResult result : results) {
+      if (result == AliasResult::NoAlias)
+        ++numNoAlias;
+      else if (result == AliasResult::MustAlias)
+        ++numMustAlias;
+      else
+        ++numMayAlias;
+    }
+  }
+  errs() << "NoAlias: " << numNoAlias << ", MayAlias: " << numMayAlias
+         << ", MustAlias: " << numMustAlias << "\n";
+
+  if (numMismatches != 0) {
+    errs() << numMismatches << " batched queries disagree with alias()\n";
+    return 1;
+  }
+  return 0;
+}
@@ -8,6 +8,8 @@
 #include <llvm/Support/SourceMgr.h>
 #include <llvm/Support/raw_ostream.h>
 
+#include <chrono>
+
 using namespace llvm;
 
 static cl::opt<std::string> InputFilename(cl::Positional,
@@ -30,8 +32,14 @@ int main(int argc, char **argv) {
 
   errs() << "Running Andersen's analysis on " << InputFilename << "\n";
   
-  // Run Andersen analysis
+  // Run Andersen analysis, whose solver uses the workers given by -nworkers
+  auto start = std::chrono::steady_clock::now();
   Andersen anders(*M);
+  auto end = std::chrono::steady_clock::now();
+  errs() << "Andersen's analysis takes "
+         << std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+                .count()
+         << " ms\n";
 
   // Collect all allocation sites
   std::vector<const Value *> allocSites;
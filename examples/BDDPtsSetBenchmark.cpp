@@ -1,8 +1,10 @@
 #include "Alias/Andersen/PtsSet.h"
 #include "Alias/Andersen/BDDPtsSet.h"
+#include "Alias/Andersen/SharedPtsSet.h"
 #include <chrono>
 #include <iostream>
 #include <random>
+#include <type_traits>
 #include <vector>
 
 // Benchmark various operations on points-to sets
@@ -87,6 +89,22 @@ void benchmarkPtsSet(const std::string &name, int numNodes, int numOperations) {
   }
   std::cout << "  Average set size: " << (totalSize / numOperations) << " elements" << std::endl;
 
+  // All BDD sets live in the shared manager
+  if (std::is_same<PtsSetType, BDDAndersPtsSet>::value) {
+    BDDPtsSetManager &manager = BDDPtsSetManager::get();
+    std::cout << "  BDD manager: " << manager.getNumNodes() << " nodes, "
+              << manager.getMemoryUsage() / 1024 << " KB" << std::endl;
+  }
+
+  // All shared sets live in the pool
+  if (std::is_same<PtsSetType, SharedAndersPtsSet>::value) {
+    SharedPtsSetPool &pool = SharedPtsSetPool::get();
+    std::cout << "  Shared pool: " << pool.getNumSets() << " sets, "
+              << pool.getMemoryUsage() / 1024 << " KB, "
+              << pool.getNumUnionCacheHits() << "/" << pool.getNumUnions()
+              << " unions cached" << std::endl;
+  }
+
   std::cout << std::endl;
 }
 
@@ -110,7 +128,11 @@ int main(int argc, char *argv[]) {
   benchmarkPtsSet<AndersPtsSet>("SparseBitVector", numNodes, numOps);
 
   // Benchmark BDD-based implementation
+  BDDPtsSetManager::get().reserve(numNodes);
   benchmarkPtsSet<BDDAndersPtsSet>("BDD", numNodes, numOps);
 
+  // Benchmark hash-consed implementation
+  benchmarkPtsSet<SharedAndersPtsSet>("Shared", numNodes, numOps);
+
   return 0;
 } 
\ No newline at end of file
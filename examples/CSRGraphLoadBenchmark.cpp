@@ -0,0 +1,102 @@
+#include "CSIndex/Graph.h"
+#include "CSIndex/GraphFile.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+// Compares the load time of the text and the binary formats of a CSIndex graph.
+// Usage: CSRGraphLoadBenchmark [text_graph_file | -gen num_vertices]
+// Without a file, a random graph of 1M vertices with call and return edges is used.
+
+template <typename Fn> static long long timeMs(Fn &&F) {
+  auto Start = std::chrono::high_resolution_clock::now();
+  F();
+  auto End = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::milliseconds>(End - Start).count();
+}
+
+// about four edges per vertex, one in 32 of them a labelled call (positive) or return (negative) edge
+static void generateTextGraph(const std::string &Path, int NumVertices) {
+  std::mt19937 Rand(42);
+  std::uniform_int_distribution<int> Pick(0, NumVertices - 1);
+  std::ofstream Out(Path);
+  Out << "graph_for_greach\n" << NumVertices << "\n";
+  for (int V = 0; V < NumVertices; ++V) {
+    Out << V << ": ";
+    for (int E = 0; E < 4; ++E) {
+      unsigned R = Rand();
+      Out << Pick(Rand);
+      if (R % 32 == 0)
+        Out << "." << (R % 64 == 0 ? -(int)(R % 1000 + 1) : (int)(R % 1000 + 1));
+      Out << " ";
+    }
+    Out << "#" << V / 64 << "\n";
+  }
+}
+
+static bool sameGraph(Graph &A, Graph &B) {
+  if (A.num_vertices() != B.num_vertices())
+    return false;
+  for (int V = 0; V < A.num_vertices(); ++V) {
+    if (A[V].func_id != B[V].func_id || A.out_edges(V) != B.out_edges(V) || A.in_edges(V) != B.in_edges(V))
+      return false;
+    for (int T : A.out_edges(V))
+      if (A.label(V, T) != B.label(V, T))
+        return false;
+  }
+  return true;
+}
+
+int main(int argc, char **argv) {
+  std::string TextPath;
+  int NumVertices = 1000000;
+  if (argc == 3 && strcmp(argv[1], "-gen") == 0)
+    NumVertices = atoi(argv[2]);
+  else if (argc == 2)
+    TextPath = argv[1];
+  bool Generated = TextPath.empty();
+  if (Generated) {
+    TextPath = "CSRGraphLoadBenchmark.txt";
+    generateTextGraph(TextPath, NumVertices);
+  }
+  std::string BinaryPath = TextPath + ".bin";
+
+  Graph Text;
+  long long TextMs = timeMs([&] {
+    std::ifstream In(TextPath);
+    Text.readGraph(In);
+  });
+
+  std::string Error;
+  long long WriteMs = timeMs([&] {
+    if (!GraphFile::write(Text, BinaryPath, Error)) {
+      std::cerr << Error << "\n";
+      exit(1);
+    }
+  });
+
+  GraphFile File;
+  long long MapMs = timeMs([&] {
+    if (!File.open(BinaryPath)) {
+      std::cerr << File.error() << "\n";
+      exit(1);
+    }
+  });
+  Graph Binary;
+  long long BuildMs = timeMs([&] { Binary.readGraph(File); });
+
+  std::cout << Text.num_vertices() << " vertices, " << File.num_edges() << " edges\n";
+  std::cout << "  text load              " << TextMs << " ms\n";
+  std::cout << "  binary map             " << MapMs << " ms (written in " << WriteMs << " ms)\n";
+  std::cout << "  binary map and build   " << MapMs + BuildMs << " ms\n";
+  std::cout << "  same graph: " << (sameGraph(Text, Binary) ? "yes" : "NO") << "\n";
+
+  File.close();
+  std::remove(BinaryPath.c_str());
+  if (Generated)
+    std::remove(TextPath.c_str());
+  return 0;
+}
@@ -0,0 +1,135 @@
+#include "Alias/DyckAA/DyckVFG.h"
+#include "Alias/DyckAA/DyckValueFlowAnalysis.h"
+
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IRReader/IRReader.h>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/SourceMgr.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <chrono>
+#include <functional>
+#include <malloc.h>
+#include <set>
+#include <vector>
+
+using namespace llvm;
+
+static cl::opt<std::string> InputFilename(cl::Positional, cl::desc("<input bitcode file>"), cl::init("-"),
+                                          cl::value_desc("filename"));
+
+static cl::opt<unsigned> NumRounds("rounds", cl::desc("Number of traversal rounds"), cl::init(10));
+
+// The adjacency DyckVFGNode used to have: a red-black tree per node and direction
+using EdgeSetTy = std::set<std::pair<DyckVFGNode *, int>>;
+
+template <typename Fn> static long long timeMs(Fn &&F) {
+  auto Start = std::chrono::high_resolution_clock::now();
+  F();
+  auto End = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::milliseconds>(End - Start).count();
+}
+
+static size_t heapInUse() { return mallinfo2().uordblks; }
+
+// A forward and a backward DFS from every unvisited node, the way NullFlowAnalysis walks the graph
+template <typename OutFn, typename InFn>
+static unsigned long traverse(DyckVFG *VFG, OutFn &&Targets, InFn &&Sources) {
+  unsigned long Visits = 0;
+  std::vector<bool> Visited(VFG->numNodes());
+  std::vector<DyckVFGNode *> Stack;
+  for (int Direction = 0; Direction < 2; ++Direction) {
+    Visited.assign(VFG->numNodes(), false);
+    for (unsigned K = 0; K < VFG->numNodes(); ++K) {
+      if (Visited[K])
+        continue;
+      Stack.push_back(VFG->getVFGNode(K));
+      while (!Stack.empty()) {
+        auto *Top = Stack.back();
+        Stack.pop_back();
+        if (Visited[Top->getIndex()])
+          continue;
+        Visited[Top->getIndex()] = true;
+        ++Visits;
+        auto Push = [&](DyckVFGNode *N) {
+          if (!Visited[N->getIndex()])
+            Stack.push_back(N);
+        };
+        if (Direction == 0)
+          Targets(Top, Push);
+        else
+          Sources(Top, Push);
+      }
+    }
+  }
+  return Visits;
+}
+
+int main(int argc, char **argv) {
+  cl::ParseCommandLineOptions(argc, argv, "DyckVFG layout benchmark\n");
+
+  LLVMContext Context;
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseIRFile(InputFilename, Err, Context);
+  if (!M) {
+    Err.print(argv[0], errs());
+    return 1;
+  }
+
+  legacy::PassManager Passes;
+  auto *VFA = new DyckValueFlowAnalysis();
+  Passes.add(VFA);
+  Passes.run(*M);
+  auto *VFG = VFA->getDyckVFGraph();
+
+  outs() << "DyckVFG: " << VFG->numNodes() << " nodes, " << VFG->numEdges() << " edges\n";
+
+  // rebuild the tree-based adjacency to compare with
+  size_t HeapBefore = heapInUse();
+  std::vector<EdgeSetTy> Targets(VFG->numNodes()), Sources(VFG->numNodes());
+  for (unsigned K = 0; K < VFG->numNodes(); ++K) {
+    auto *N = VFG->getVFGNode(K);
+    for (auto &T : *N) {
+      Targets[K].emplace(T.first, T.second);
+      Sources[T.first->getIndex()].emplace(N, T.second);
+    }
+  }
+  size_t TreeBytes = heapInUse() - HeapBefore + 2 * VFG->numNodes() * sizeof(EdgeSetTy);
+  size_t CSRBytes = VFG->getEdgeMemoryUsage();
+
+  unsigned long TreeVisits = 0, CSRVisits = 0;
+  auto TreeTime = timeMs([&]() {
+    for (unsigned R = 0; R < NumRounds; ++R)
+      TreeVisits += traverse(
+          VFG,
+          [&](DyckVFGNode *N, const std::function<void(DyckVFGNode *)> &Push) {
+            for (auto &T : Targets[N->getIndex()])
+              Push(T.first);
+          },
+          [&](DyckVFGNode *N, const std::function<void(DyckVFGNode *)> &Push) {
+            for (auto &S : Sources[N->getIndex()])
+              Push(S.first);
+          });
+  });
+  auto CSRTime = timeMs([&]() {
+    for (unsigned R = 0; R < NumRounds; ++R)
+      CSRVisits += traverse(
+          VFG,
+          [&](DyckVFGNode *N, const std::function<void(DyckVFGNode *)> &Push) {
+            for (auto &T : *N)
+              Push(T.first);
+          },
+          [&](DyckVFGNode *N, const std::function<void(DyckVFGNode *)> &Push) {
+            for (auto It = N->in_begin(), E = N->in_end(); It != E; ++It)
+              Push(It->first);
+          });
+  });
+
+  outs() << "std::set edges: " << TreeBytes / 1024 << " KB, " << NumRounds << " traversals in " << TreeTime
+         << " ms (" << TreeVisits << " visits)\n";
+  outs() << "CSR edges:      " << CSRBytes / 1024 << " KB, " << NumRounds << " traversals in " << CSRTime
+         << " ms (" << CSRVisits << " visits)\n";
+  return 0;
+}
@@ -0,0 +1,127 @@
+#include "Alias/DyckAA/DyckGraph.h"
+#include "Alias/DyckAA/DyckWorkList.h"
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+// The worklist qirunAlgorithm used to have: a multimap with linear-time helpers
+class MultiMapWorkList {
+private:
+  std::multimap<unsigned, void *> List;
+
+public:
+  bool push(unsigned Vertex, void *Label) {
+    if (contains(Vertex, Label))
+      return false;
+    List.insert(std::make_pair(Vertex, Label));
+    return true;
+  }
+
+  bool contains(unsigned Vertex, void *Label) {
+    auto Range = List.equal_range(Vertex);
+    for (auto It = Range.first; It != Range.second; ++It)
+      if (It->second == Label)
+        return true;
+    return false;
+  }
+
+  bool remove(unsigned Vertex, void *Label) {
+    auto Range = List.equal_range(Vertex);
+    for (auto It = Range.first; It != Range.second; ++It) {
+      if (It->second == Label) {
+        List.erase(It);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool empty() const { return List.empty(); }
+};
+
+template <typename Fn> static long long timeMs(Fn &&F) {
+  auto Start = std::chrono::high_resolution_clock::now();
+  F();
+  auto End = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::milliseconds>(End - Start).count();
+}
+
+// A few dense vertices, each with many labels, queried the way the unification loop does:
+// a membership test before every push and a removal after every merge of a neighbour.
+template <typename WorkListType>
+void benchmarkWorkList(const std::string &Name, unsigned NumVertices, unsigned NumLabels) {
+  WorkListType WL;
+  unsigned Pushed = 0, Removed = 0;
+  auto Time = timeMs([&]() {
+    for (unsigned V = 0; V < NumVertices; ++V)
+      for (unsigned L = 0; L < NumLabels; ++L)
+        Pushed += WL.push(V, (void *)(uintptr_t)(L + 1));
+    // pushing again is a no-op
+    for (unsigned V = 0; V < NumVertices; ++V)
+      for (unsigned L = 0; L < NumLabels; ++L)
+        Pushed += WL.push(V, (void *)(uintptr_t)(L + 1));
+    for (unsigned V = 0; V < NumVertices; ++V)
+      for (unsigned L = NumLabels; L > 0; --L)
+        Removed += WL.remove(V, (void *)(uintptr_t)L);
+  });
+  std::cout << "  " << Name << ": " << Time << " ms (pushed " << Pushed << ", removed " << Removed << ")"
+            << std::endl;
+}
+
+// Hubs with many labels, each label pointing to a chain of vertices that
+// unify transitively, i.e., merges cascade through the labelled edges.
+void benchmarkUnification(unsigned NumHubs, unsigned NumLabels, unsigned Depth) {
+  DyckGraph G;
+  std::vector<DyckGraphEdgeLabel *> Labels;
+  for (unsigned L = 0; L < NumLabels; ++L)
+    Labels.push_back(G.getOrInsertIndexEdgeLabel(L));
+
+  for (unsigned H = 0; H < NumHubs; ++H) {
+    auto *Hub = G.retrieveDyckVertex(nullptr).first;
+    for (auto *Label : Labels) {
+      auto *X = G.retrieveDyckVertex(nullptr).first;
+      auto *Y = G.retrieveDyckVertex(nullptr).first;
+      Hub->addTarget(X, Label);
+      Hub->addTarget(Y, Label);
+      for (unsigned D = 0; D < Depth; ++D) {
+        auto *NX = G.retrieveDyckVertex(nullptr).first;
+        auto *NY = G.retrieveDyckVertex(nullptr).first;
+        X->addTarget(NX, G.getDereferenceEdgeLabel());
+        Y->addTarget(NY, G.getDereferenceEdgeLabel());
+        X = NX;
+        Y = NY;
+      }
+    }
+  }
+
+  unsigned NumVertices = G.numVertices();
+  auto Time = timeMs([&]() { G.qirunAlgorithm(); });
+  std::cout << "  " << NumHubs << " hubs x " << NumLabels << " labels x depth " << Depth << ": " << NumVertices
+            << " vertices -> " << G.numEquivalentClasses() << " classes in " << Time << " ms" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  unsigned NumVertices = 8;
+  unsigned MaxLabels = 8192;
+  if (argc > 1)
+    NumVertices = std::stoi(argv[1]);
+  if (argc > 2)
+    MaxLabels = std::stoi(argv[2]);
+
+  std::cout << "Running dyck worklist benchmarks" << std::endl;
+  std::cout << "================================" << std::endl;
+
+  for (unsigned NumLabels = 1024; NumLabels <= MaxLabels; NumLabels *= 2) {
+    std::cout << NumVertices << " vertices x " << NumLabels << " labels" << std::endl;
+    benchmarkWorkList<MultiMapWorkList>("multimap", NumVertices, NumLabels);
+    benchmarkWorkList<DyckWorkList>("DyckWorkList", NumVertices, NumLabels);
+  }
+
+  std::cout << std::endl << "Running qirunAlgorithm on synthetic dense graphs" << std::endl;
+  for (unsigned NumLabels = 1024; NumLabels <= MaxLabels; NumLabels *= 2)
+    benchmarkUnification(NumVertices, NumLabels, 4);
+
+  return 0;
+}
@@ -0,0 +1,252 @@
+// Check that the incremental mode of Andersen's analysis agrees with solving
+// from scratch. The harness applies a series of random edits to the function
+// bodies of a module. After each edit, the incremental analysis re-collects the
+// edited function, and its points-to sets are compared with those of a new
+// analysis of the edited module.
+//
+// The edits are:
+//   - removing a store of a pointer,
+//   - putting a removed store back (at the end of its block, which does not
+//     matter to a flow-insensitive analysis),
+//   - redirecting the pointer stored by a store, or passed to a call, to a
+//     global variable, through a new bitcast instruction or a constant.
+
+#include "Alias/Andersen/Andersen.h"
+
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IRReader/IRReader.h>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/SourceMgr.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+using namespace llvm;
+
+static cl::opt<std::string> InputFilename(cl::Positional,
+                                          cl::desc("<IR file>"), cl::Required);
+static cl::opt<unsigned> NumEdits("edits", cl::desc("The number of edits"),
+                                  cl::init(20));
+static cl::opt<unsigned> Seed("seed", cl::desc("The seed of the edits"),
+                              cl::init(1));
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+long long elapsedMs(Clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() -
+                                                               start)
+      .count();
+}
+
+class ModuleEditor {
+private:
+  Module &module;
+  std::mt19937 rng;
+  std::vector<GlobalVariable *> globals;
+  // The stores that have been removed, and the blocks they come from
+  std::vector<std::pair<StoreInst *, BasicBlock *>> removedStores;
+
+  template <typename T> T pick(const std::vector<T> &items) {
+    return items[std::uniform_int_distribution<size_t>(0, items.size() - 1)(
+        rng)];
+  }
+
+  // A pointer that is not a constant, so that replacing it does not change
+  // the set of address-taken functions
+  static bool isReplaceable(const Value *v) {
+    return v->getType()->isPointerTy() &&
+           (isa<Instruction>(v) || isa<Argument>(v));
+  }
+
+  Function *removeStore() {
+    std::vector<StoreInst *> stores;
+    for (auto &f : module)
+      for (auto &inst : instructions(f))
+        if (auto *store = dyn_cast<StoreInst>(&inst))
+          if (store->getValueOperand()->getType()->isPointerTy())
+            stores.push_back(store);
+    if (stores.empty())
+      return nullptr;
+
+    StoreInst *store = pick(stores);
+    Function *f = store->getFunction();
+    removedStores.emplace_back(store, store->getParent());
+    store->removeFromParent();
+    return f;
+  }
+
+  Function *restoreStore() {
+    if (removedStores.empty())
+      return nullptr;
+
+    size_t i = std::uniform_int_distribution<size_t>(
+        0, removedStores.size() - 1)(rng);
+    auto removed = removedStores[i];
+    removedStores.erase(removedStores.begin() + i);
+    removed.first->insertBefore(removed.second->getTerminator());
+    return removed.second->getParent();
+  }
+
+  Function *redirectPointer() {
+    // (instruction, operand number)
+    std::vector<std::pair<Instruction *, unsigned>> uses;
+    for (auto &f : module) {
+      for (auto &inst : instructions(f)) {
+        if (auto *store = dyn_cast<StoreInst>(&inst)) {
+          if (isReplaceable(store->getValueOperand()))
+            uses.emplace_back(store, 0);
+        } else if (auto *call = dyn_cast<CallInst>(&inst)) {
+          Function *callee = call->getCalledFunction();
+          if (callee == nullptr || callee->isIntrinsic())
+            continue;
+          for (unsigned i = 0; i < call->arg_size(); ++i)
+            if (isReplaceable(call->getArgOperand(i)))
+              uses.emplace_back(call, i);
+        }
+      }
+    }
+    if (uses.empty() || globals.empty())
+      return nullptr;
+
+    auto use = pick(uses);
+    Instruction *inst = use.first;
+    Type *type = inst->getOperand(use.second)->getType();
+    GlobalVariable *global = pick(globals);
+    if (global->getType()->getAddressSpace() !=
+        type->getPointerAddressSpace())
+      return nullptr;
+
+    Value *newValue;
+    if (rng() % 2)
+      newValue = new BitCastInst(global, type, "redirect", inst);
+    else
+      newValue = ConstantExpr::getBitCast(global, type);
+    inst->setOperand(use.second, newValue);
+    return inst->getFunction();
+  }
+
+public:
+  ModuleEditor(Module &m, unsigned seed) : module(m), rng(seed) {
+    for (auto &global : module.globals())
+      globals.push_back(&global);
+  }
+
+  ~ModuleEditor() {
+    for (auto const &removed : removedStores)
+      removed.first->deleteValue();
+  }
+
+  // Apply a random edit, and return the edited function. Return nullptr if
+  // the edit is not applicable
+  Function *edit(const char *&kind) {
+    switch (rng() % 3) {
+    case 0:
+      kind = "remove store";
+      return removeStore();
+    case 1:
+      kind = "restore store";
+      return restoreStore();
+    default:
+      kind = "redirect pointer";
+      return redirectPointer();
+    }
+  }
+};
+
+// Compare the points-to sets of all the pointers in the module. Return the
+// number of pointers whose points-to sets differ
+unsigned compareResults(const Module &module, const Andersen &incremental,
+                        const Andersen &scratch) {
+  std::vector<const Value *> pointers;
+  for (auto const &global : module.globals())
+    pointers.push_back(&global);
+  for (auto const &f : module) {
+    if (f.hasAddressTaken())
+      pointers.push_back(&f);
+    for (auto const &arg : f.args())
+      if (arg.getType()->isPointerTy())
+        pointers.push_back(&arg);
+    for (auto const &inst : instructions(f))
+      if (inst.getType()->isPointerTy())
+        pointers.push_back(&inst);
+  }
+
+  unsigned numDiffs = 0;
+  std::vector<const Value *> incrementalPts, scratchPts;
+  for (const Value *ptr : pointers) {
+    bool incrementalKnown = incremental.getPointsToSet(ptr, incrementalPts);
+    bool scratchKnown = scratch.getPointsToSet(ptr, scratchPts);
+    std::sort(incrementalPts.begin(), incrementalPts.end());
+    std::sort(scratchPts.begin(), scratchPts.end());
+    if (incrementalKnown == scratchKnown &&
+        (!incrementalKnown || incrementalPts == scratchPts))
+      continue;
+
+    if (numDiffs++ < 10) {
+      errs() << "  Mismatch on " << *ptr << ": " << incrementalPts.size()
+             << " incremental vs " << scratchPts.size() << " from scratch\n";
+    }
+  }
+  return numDiffs;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  cl::ParseCommandLineOptions(
+      argc, argv, "Check incremental Andersen's analysis against re-solving\n");
+
+  LLVMContext context;
+  SMDiagnostic err;
+  std::unique_ptr<Module> module = parseIRFile(InputFilename, err, context);
+  if (!module) {
+    err.print(argv[0], errs());
+    return 1;
+  }
+
+  auto start = Clock::now();
+  Andersen incremental(*module, true);
+  errs() << "Initial analysis takes " << elapsedMs(start) << " ms\n";
+
+  ModuleEditor editor(*module, Seed);
+  unsigned numFailures = 0, numApplied = 0;
+  long long incrementalMs = 0, scratchMs = 0;
+  for (unsigned i = 0; i < NumEdits; ++i) {
+    const char *kind = nullptr;
+    Function *f = editor.edit(kind);
+    if (f == nullptr)
+      continue;
+    ++numApplied;
+
+    start = Clock::now();
+    incremental.updateFunctions({f});
+    long long updateMs = elapsedMs(start);
+    incrementalMs += updateMs;
+
+    start = Clock::now();
+    Andersen scratch(*module);
+    long long solveMs = elapsedMs(start);
+    scratchMs += solveMs;
+
+    unsigned numDiffs = compareResults(*module, incremental, scratch);
+    errs() << "Edit " << i << " (" << kind << " in " << f->getName()
+           << "): update " << updateMs << " ms, from scratch " << solveMs
+           << " ms, " << (numDiffs == 0 ? "agree" : "DISAGREE") << "\n";
+    if (numDiffs != 0)
+      ++numFailures;
+  }
+
+  errs() << numApplied << " edits applied, " << numFailures
+         << " disagreements. Incremental updates take " << incrementalMs
+         << " ms in total, and solving from scratch " << scratchMs << " ms\n";
+  return numFailures == 0 ? 0 : 1;
+}
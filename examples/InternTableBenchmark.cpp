@@ -0,0 +1,251 @@
+// Benchmark util::ConcurrentInternTable, which interns the points-to sets and
+// the contexts of the semi-sparse pointer analysis, against the
+// std::unordered_set that interned them before.
+//
+// The workloads mimic the two users of the table:
+//   - sets: sorted vectors of object pointers, where most interned sets are
+//     one insertion away from an existing set, as in PtsSet::insert(),
+//   - contexts: (call site, caller context) pairs of k-limited call strings,
+//     as in Context::pushContext().
+// Each workload is run single-threaded with both tables, then with several
+// threads sharing one ConcurrentInternTable. The tables must agree on the
+// number of unique values, and all threads must get the same copy of a value.
+
+#include "Support/ADT/ConcurrentInternTable.h"
+#include "Support/ADT/Hashing.h"
+#include "Support/ADT/VectorSet.h"
+
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+using namespace llvm;
+
+static cl::opt<unsigned> NumOps("ops",
+                                cl::desc("The number of values interned"),
+                                cl::init(1000000));
+static cl::opt<unsigned> NumThreads("threads",
+                                    cl::desc("The number of threads"),
+                                    cl::init(4));
+static cl::opt<unsigned> Seed("seed", cl::desc("The seed of the workloads"),
+                              cl::init(1));
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double elapsedSeconds(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// The memory objects that the sets point to, and the call sites of contexts
+const unsigned NumObjects = 4096, NumCallSites = 20000;
+int objects[NumObjects];
+char callSites[NumCallSites];
+
+typedef util::VectorSet<const int *> SetType;
+typedef util::ContainerHasher<SetType> SetHasher;
+
+std::vector<SetType> makeSetWorkload(unsigned numOps, std::mt19937 &rng) {
+  std::uniform_int_distribution<unsigned> objectDist(0, NumObjects - 1);
+  std::vector<SetType> workload;
+  workload.reserve(numOps);
+  // Grow sets one element at a time from sets seen before
+  workload.push_back(SetType{&objects[objectDist(rng)]});
+  for (unsigned i = 1; i < numOps; ++i) {
+    size_t base = std::uniform_int_distribution<size_t>(
+        i > 1000 ? i - 1000 : 0, i - 1)(rng);
+    SetType set = workload[base];
+    if (set.size() > 64 || rng() % 8 == 0)
+      set = SetType{&objects[objectDist(rng)]};
+    else
+      set.insert(&objects[objectDist(rng) % (set.size() * 16 + 16)]);
+    workload.push_back(std::move(set));
+  }
+  return workload;
+}
+
+struct Ctx {
+  const void *callSite;
+  const Ctx *pred;
+
+  bool operator==(const Ctx &other) const {
+    return callSite == other.callSite && pred == other.pred;
+  }
+};
+
+struct CtxHasher {
+  size_t operator()(const Ctx &c) const {
+    return util::hashPair(c.callSite, c.pred);
+  }
+};
+
+// A context is given as the call site pushed and the index of the operation
+// that made its caller context, or ~0u for the global context
+typedef std::pair<unsigned, unsigned> CtxOp;
+
+std::vector<CtxOp> makeContextWorkload(unsigned numOps, std::mt19937 &rng) {
+  const unsigned limit = 3;
+  std::vector<CtxOp> workload;
+  std::vector<unsigned> depth;
+  workload.reserve(numOps);
+  for (unsigned i = 0; i < numOps; ++i) {
+    unsigned callSite =
+        std::uniform_int_distribution<unsigned>(0, NumCallSites - 1)(rng);
+    unsigned pred = ~0u;
+    if (i > 0 && rng() % 4 != 0) {
+      pred = std::uniform_int_distribution<unsigned>(i > 5000 ? i - 5000 : 0,
+                                                     i - 1)(rng);
+      if (depth[pred] >= limit)
+        pred = workload[pred].second;
+    }
+    workload.emplace_back(callSite, pred);
+    depth.push_back(pred == ~0u ? 1 : depth[pred] + 1);
+  }
+  return workload;
+}
+
+// Intern the contexts of the workload with f(const Ctx&), which returns the
+// unique copy of a context
+template <typename Function>
+std::vector<const Ctx *> internContexts(const std::vector<CtxOp> &workload,
+                                        Function &&f) {
+  std::vector<const Ctx *> result(workload.size());
+  for (size_t i = 0; i < workload.size(); ++i) {
+    const Ctx *pred =
+        workload[i].second == ~0u ? nullptr : result[workload[i].second];
+    result[i] = f(Ctx{&callSites[workload[i].first], pred});
+  }
+  return result;
+}
+
+void report(const char *name, size_t numValues, double seconds) {
+  errs() << "  " << name << ": " << format("%.3f", seconds) << " s, "
+         << format("%.2f", NumOps / seconds / 1e6) << " M ops/s, "
+         << numValues << " unique\n";
+}
+
+// Run f(threadId) on NumThreads threads, and return the elapsed time
+template <typename Function> double runThreads(Function &&f) {
+  auto start = Clock::now();
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < NumThreads; ++t)
+    threads.emplace_back(f, t);
+  for (auto &thread : threads)
+    thread.join();
+  return elapsedSeconds(start);
+}
+
+unsigned benchmarkSets(const std::vector<SetType> &workload) {
+  unsigned numErrors = 0;
+  errs() << "Sets\n";
+
+  // The interning of PtsSet::uniquifySet() before the concurrent table
+  std::unordered_set<SetType, SetHasher> baseline;
+  auto start = Clock::now();
+  for (auto const &value : workload) {
+    SetType set = value;
+    auto itr = baseline.find(set);
+    if (itr == baseline.end()) {
+      set.shrink_to_fit();
+      itr = baseline.insert(itr, std::move(set));
+    }
+  }
+  report("unordered_set", baseline.size(), elapsedSeconds(start));
+
+  util::ConcurrentInternTable<SetType, SetHasher> table;
+  start = Clock::now();
+  for (auto const &value : workload) {
+    SetType set = value;
+    table.intern(std::move(set), [](SetType &newSet) { newSet.shrink_to_fit(); });
+  }
+  report("ConcurrentInternTable", table.size(), elapsedSeconds(start));
+  if (table.size() != baseline.size())
+    ++numErrors;
+
+  // Every thread interns the whole workload, from a different starting point
+  util::ConcurrentInternTable<SetType, SetHasher> sharedTable;
+  std::vector<std::vector<const SetType *>> results(NumThreads);
+  double seconds = runThreads([&](unsigned t) {
+    size_t n = workload.size(), offset = n / NumThreads * t;
+    auto &result = results[t];
+    result.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+      size_t idx = (offset + i) % n;
+      SetType set = workload[idx];
+      result[idx] = sharedTable.intern(std::move(set));
+    }
+  });
+  errs() << "  " << NumThreads << " threads: " << format("%.3f", seconds)
+         << " s, "
+         << format("%.2f", double(NumOps) * NumThreads / seconds / 1e6)
+         << " M ops/s, " << sharedTable.size() << " unique\n";
+  if (sharedTable.size() != baseline.size())
+    ++numErrors;
+  for (auto const &result : results)
+    if (result != results[0])
+      ++numErrors;
+  return numErrors;
+}
+
+unsigned benchmarkContexts(const std::vector<CtxOp> &workload) {
+  unsigned numErrors = 0;
+  errs() << "Contexts\n";
+
+  // The interning of Context::pushContext() before the concurrent table
+  std::unordered_set<Ctx, CtxHasher> baseline;
+  auto start = Clock::now();
+  internContexts(workload, [&](const Ctx &ctx) {
+    return &*baseline.insert(ctx).first;
+  });
+  report("unordered_set", baseline.size(), elapsedSeconds(start));
+
+  util::ConcurrentInternTable<Ctx, CtxHasher> table;
+  start = Clock::now();
+  internContexts(workload, [&](const Ctx &ctx) { return table.intern(ctx); });
+  report("ConcurrentInternTable", table.size(), elapsedSeconds(start));
+  if (table.size() != baseline.size())
+    ++numErrors;
+
+  util::ConcurrentInternTable<Ctx, CtxHasher> sharedTable;
+  std::vector<std::vector<const Ctx *>> results(NumThreads);
+  double seconds = runThreads([&](unsigned t) {
+    results[t] = internContexts(
+        workload, [&](const Ctx &ctx) { return sharedTable.intern(ctx); });
+  });
+  errs() << "  " << NumThreads << " threads: " << format("%.3f", seconds)
+         << " s, "
+         << format("%.2f", double(NumOps) * NumThreads / seconds / 1e6)
+         << " M ops/s, " << sharedTable.size() << " unique\n";
+  if (sharedTable.size() != baseline.size())
+    ++numErrors;
+  for (auto const &result : results)
+    if (result != results[0])
+      ++numErrors;
+  return numErrors;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  cl::ParseCommandLineOptions(argc, argv, "Interning table benchmark\n");
+  if (NumThreads == 0)
+    NumThreads = 1;
+
+  std::mt19937 rng(Seed);
+  unsigned numErrors = benchmarkSets(makeSetWorkload(NumOps, rng));
+  numErrors += benchmarkContexts(makeContextWorkload(NumOps, rng));
+
+  if (numErrors != 0) {
+    errs() << numErrors << " inconsistencies between the tables\n";
+    return 1;
+  }
+  return 0;
+}
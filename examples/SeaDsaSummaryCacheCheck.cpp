@@ -0,0 +1,361 @@
+// Check the summary cache of SeaDsa (-sea-dsa-summary-cache).
+//
+// The keys of the cache must change whenever a graph computed from the IR
+// would change. The check builds a caller of an external function and edits
+// the callee in the ways that change the local graph of the caller: giving
+// it a body, and adding the noalias and returned attributes that the
+// analysis of external calls reads. The caller also loads a function
+// pointer through a cast of a global, whose graph depends on the function
+// the global is initialized to. Renaming a local value must keep the key.
+//
+// Given a module, the check then runs SeaDsa on it without the cache, with
+// an empty cache, with the filled cache, and again after editing one
+// function, and compares the graphs loaded from the cache with the graphs
+// computed from scratch. It reports the time of each run and the hits and
+// misses of the cache, which show how much of the analysis is reused.
+
+#include "Alias/seadsa/AllocWrapInfo.hh"
+#include "Alias/seadsa/DsaAnalysis.hh"
+#include "Alias/seadsa/DsaLibFuncInfo.hh"
+#include "Alias/seadsa/InitializePasses.hh"
+#include "Alias/seadsa/SummaryCache.hh"
+#include "Alias/seadsa/support/Debug.h"
+#include "Alias/seadsa/support/RemovePtrToInt.hh"
+
+#include <llvm/Analysis/TargetLibraryInfo.h>
+#include <llvm/AsmParser/Parser.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IRReader/IRReader.h>
+#include <llvm/InitializePasses.h>
+#include <llvm/Pass.h>
+#include <llvm/PassRegistry.h>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Signals.h>
+#include <llvm/Support/SourceMgr.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <map>
+
+using namespace llvm;
+
+static cl::opt<std::string> InputFilename(cl::Positional,
+                                          cl::desc("<IR file>"),
+                                          cl::init(""));
+static cl::opt<std::string>
+    EditedFunction("edit", cl::desc("The function to edit, the one in the "
+                                     "middle of the module by default"),
+                   cl::init(""));
+
+// Register passes manually since INITIALIZE_PASS macros are commented out
+static RegisterPass<seadsa::DsaAnalysis>
+    X("seadsa-dsa", "SeaHorn Dsa analysis: entry point for all clients");
+static RegisterPass<seadsa::RemovePtrToInt>
+    Y("seadsa-remove-ptrtoint",
+      "Convert ptrtoint/inttoptr pairs to bitcasts when possible");
+static RegisterPass<seadsa::AllocWrapInfo>
+    Z("seadsa-alloc-wrap", "Identifies allocation wrappers");
+static RegisterPass<seadsa::DsaLibFuncInfo>
+    W("seadsa-lib-functions-info",
+      "Identifies library functions for special handling");
+
+namespace {
+
+const char *KeyModule = R"(
+declare i8* @callee(i8*)
+declare void @f1()
+declare void @f2()
+
+@g = global void ()* @f1
+
+define i8* @caller(i8* %p) {
+  %r = call i8* @callee(i8* %p)
+  %fp = load i8*, i8** bitcast (void ()** @g to i8**)
+  ret i8* %r
+}
+)";
+
+// The key of the local graph of the caller. A new cache is used each
+// time, since a cache remembers the hashes of the functions.
+seadsa::SummaryCache::Key localKey(Module &module) {
+  TargetLibraryInfoWrapperPass tli;
+  seadsa::AllocWrapInfo allocInfo(&tli);
+  seadsa::SummaryCache cache(module, allocInfo, "local");
+  return cache.getLocalKey(*module.getFunction("caller"));
+}
+
+// Returns the number of failures
+unsigned checkKeys() {
+  LLVMContext context;
+  SMDiagnostic err;
+  std::unique_ptr<Module> module = parseAssemblyString(KeyModule, err, context);
+  if (!module) {
+    err.print("SeaDsaSummaryCacheCheck", errs());
+    return 1;
+  }
+  Function *callee = module->getFunction("callee");
+  unsigned numFailures = 0;
+  auto expect = [&](const char *edit, bool changes,
+                    const seadsa::SummaryCache::Key &before) {
+    bool changed = localKey(*module) != before;
+    errs() << "  " << edit << ": key " << (changed ? "changes" : "is kept")
+           << (changed == changes ? "" : ", WRONG") << "\n";
+    numFailures += changed != changes;
+  };
+
+  auto key = localKey(*module);
+  module->getFunction("caller")->getEntryBlock().front().setName("renamed");
+  expect("renaming a local value", false, key);
+
+  key = localKey(*module);
+  callee->addRetAttr(Attribute::NoAlias);
+  expect("noalias on the return of the callee", true, key);
+
+  key = localKey(*module);
+  callee->addParamAttr(0, Attribute::Returned);
+  expect("returned on an argument of the callee", true, key);
+
+  key = localKey(*module);
+  IRBuilder<> builder(BasicBlock::Create(context, "entry", callee));
+  builder.CreateRet(callee->getArg(0));
+  expect("a body for the callee", true, key);
+
+  key = localKey(*module);
+  callee->deleteBody();
+  expect("the callee back to a declaration", true, key);
+
+  key = localKey(*module);
+  module->getGlobalVariable("g")->setInitializer(module->getFunction("f2"));
+  expect("another function as the initializer of a global", true, key);
+  return numFailures;
+}
+
+typedef std::chrono::steady_clock Clock;
+
+long long elapsedMs(Clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() -
+                                                               start)
+      .count();
+}
+
+// Prints the graphs of the defined functions in a form that depends on
+// neither the addresses nor the creation order of the nodes: the nodes are
+// numbered in the order of a search from the cells of the values, sorted by
+// the names of the values.
+class GraphPrinter {
+private:
+  DenseMap<const Value *, std::string> names;
+
+  std::string name(const Value *v) {
+    auto it = names.find(v);
+    if (it != names.end()) return it->second;
+    std::string s;
+    raw_string_ostream os(s);
+    v->printAsOperand(os, /*PrintType=*/true);
+    return names[v] = os.str();
+  }
+
+  std::string print(const seadsa::Graph &g,
+                    std::vector<std::pair<std::string, const seadsa::Cell *>>
+                        roots) {
+    std::sort(roots.begin(), roots.end(),
+              [](const auto &a, const auto &b) { return a.first < b.first; });
+    DenseMap<const seadsa::Node *, unsigned> ids;
+    std::deque<const seadsa::Node *> queue;
+    auto cell = [&](const seadsa::Cell &c) {
+      if (c.isNull()) return std::string("null");
+      auto res = ids.insert({c.getNode(), ids.size()});
+      if (res.second) queue.push_back(c.getNode());
+      return "(" + std::to_string(res.first->second) + "," +
+             std::to_string(c.getRawOffset()) + ")";
+    };
+
+    std::string s;
+    raw_string_ostream os(s);
+    for (auto &root : roots) {
+      const seadsa::Cell &c = *root.second;
+      os << root.first << " -> " << cell(c) << (c.isRead() ? " r" : "")
+         << (c.isModified() ? " m" : "") << "\n";
+    }
+    for (unsigned i = 0; !queue.empty(); ++i) {
+      const seadsa::Node *n = queue.front();
+      queue.pop_front();
+      os << "node " << i << " [" << n->getNodeType().toStr()
+         << "] size=" << n->size();
+
+      std::map<unsigned, std::vector<std::string>> types;
+      for (auto &kv : n->types())
+        for (const Type *t : kv.second) {
+          std::string ts;
+          raw_string_ostream tos(ts);
+          t->print(tos);
+          types[kv.first].push_back(tos.str());
+        }
+      for (auto &kv : types) {
+        std::sort(kv.second.begin(), kv.second.end());
+        os << " " << kv.first << ":";
+        for (auto &t : kv.second)
+          os << t << "|";
+      }
+
+      std::vector<std::string> sites;
+      for (const Value *v : n->getAllocSites())
+        sites.push_back(name(v));
+      std::sort(sites.begin(), sites.end());
+      os << " sites=";
+      for (auto &site : sites)
+        os << site << ";";
+
+      for (auto &kv : n->links()) {
+        os << " " << kv.first << "->" << cell(*kv.second);
+      }
+      os << "\n";
+    }
+    return os.str();
+  }
+
+public:
+  explicit GraphPrinter(Module &module) {
+    for (Function &f : module) {
+      for (Argument &arg : f.args())
+        names[&arg] = f.getName().str() + "#a" + std::to_string(arg.getArgNo());
+      unsigned i = 0;
+      for (Instruction &inst : instructions(f))
+        names[&inst] = f.getName().str() + "#i" + std::to_string(i++);
+    }
+  }
+
+  std::map<std::string, std::string> print(Module &module,
+                                           seadsa::GlobalAnalysis &ga) {
+    std::map<std::string, std::string> res;
+    for (Function &f : module) {
+      if (f.isDeclaration() || !ga.hasGraph(f)) continue;
+      const seadsa::Graph &g = ga.getGraph(f);
+      std::vector<std::pair<std::string, const seadsa::Cell *>> roots;
+      for (auto &kv : g.scalars())
+        roots.emplace_back("s " + name(kv.first), kv.second.get());
+      for (auto &kv : g.formals())
+        roots.emplace_back("f " + name(kv.first), kv.second.get());
+      for (auto &kv : g.returns())
+        roots.emplace_back("r " + kv.first->getName().str(), kv.second.get());
+      res[f.getName().str()] = print(g, std::move(roots));
+    }
+    return res;
+  }
+};
+
+// Runs SeaDsa with the cache in cacheDir, none if empty, and returns the
+// printed graphs
+std::map<std::string, std::string> runSeaDsa(Module &module,
+                                             const std::string &cacheDir,
+                                             const char *label) {
+  auto *cacheOpt = static_cast<cl::opt<std::string> *>(
+      cl::getRegisteredOptions()["sea-dsa-summary-cache"]);
+  cacheOpt->setValue(cacheDir);
+
+  legacy::PassManager pm;
+  pm.add(new seadsa::AllocWrapInfo());
+  pm.add(new seadsa::DsaLibFuncInfo());
+  auto *dsa = new seadsa::DsaAnalysis();
+  pm.add(dsa);
+  // -- the cache reports its hits and misses itself, when it is used
+  errs() << "  " << label << ":" << (cacheDir.empty() ? "\n" : " ");
+  auto start = Clock::now();
+  pm.run(module);
+  long long ms = elapsedMs(start);
+  errs() << "    " << ms << " ms\n";
+  return GraphPrinter(module).print(module, dsa->getDsaAnalysis());
+}
+
+// Returns the number of functions whose graphs differ
+unsigned compareGraphs(const std::map<std::string, std::string> &cached,
+                       const std::map<std::string, std::string> &scratch) {
+  unsigned numDiffs = 0;
+  for (auto &kv : scratch) {
+    auto it = cached.find(kv.first);
+    if (it != cached.end() && it->second == kv.second) continue;
+    if (numDiffs++ < 10)
+      errs() << "    Mismatch on the graph of " << kv.first << "\n";
+  }
+  numDiffs += cached.size() != scratch.size();
+  errs() << "    " << scratch.size() << " graphs compared, " << numDiffs
+         << " differ\n";
+  return numDiffs;
+}
+
+// Returns the number of failures
+unsigned checkCache(Module &module) {
+  SmallString<128> cacheDir;
+  if (sys::fs::createUniqueDirectory("seadsa-summary-cache", cacheDir)) {
+    errs() << "Cannot create a cache directory\n";
+    return 1;
+  }
+  seadsa::SeaDsaEnableLog("dsa-summary-cache");
+
+  // -- the first run fills the cache, and also rewrites the module to remove
+  // -- ptrtoint, so that the graphs are compared on the same module
+  unsigned numFailures = 0;
+  runSeaDsa(module, cacheDir.str().str(), "empty cache");
+  auto scratch = runSeaDsa(module, "", "without cache");
+  auto cached = runSeaDsa(module, cacheDir.str().str(), "filled cache");
+  numFailures += compareGraphs(cached, scratch);
+
+  // -- an alloca at the entry of the edited function changes its graph and
+  // -- the key of every graph computed from it
+  std::vector<Function *> defined;
+  for (Function &f : module)
+    if (!f.isDeclaration()) defined.push_back(&f);
+  Function *edited = EditedFunction.empty()
+                         ? (defined.empty() ? nullptr
+                                            : defined[defined.size() / 2])
+                         : module.getFunction(EditedFunction);
+  if (!edited || edited->isDeclaration()) {
+    errs() << "No function to edit\n";
+    return numFailures + 1;
+  }
+  IRBuilder<> builder(&*edited->getEntryBlock().getFirstInsertionPt());
+  builder.CreateAlloca(builder.getInt8Ty(), nullptr, "edit");
+  errs() << "  Editing " << edited->getName() << "\n";
+  scratch = runSeaDsa(module, "", "without cache");
+  cached = runSeaDsa(module, cacheDir.str().str(), "filled cache");
+  numFailures += compareGraphs(cached, scratch);
+
+  sys::fs::remove_directories(cacheDir);
+  return numFailures;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  sys::PrintStackTraceOnErrorSignal(argv[0]);
+  cl::ParseCommandLineOptions(argc, argv,
+                              "Check the summary cache of SeaDsa\n");
+
+  errs() << "Cache keys:\n";
+  unsigned numFailures = checkKeys();
+
+  if (!InputFilename.empty()) {
+    LLVMContext context;
+    SMDiagnostic err;
+    std::unique_ptr<Module> module = parseIRFile(InputFilename, err, context);
+    if (!module) {
+      err.print(argv[0], errs());
+      return 1;
+    }
+    PassRegistry &registry = *PassRegistry::getPassRegistry();
+    initializeCore(registry);
+    initializeAnalysis(registry);
+    seadsa::initializeAnalysisPasses(registry);
+    errs() << "Cached graphs of " << InputFilename << ":\n";
+    numFailures += checkCache(*module);
+  }
+  errs() << (numFailures ? "FAILED\n" : "OK\n");
+  return numFailures ? 1 : 0;
+}
@@ -0,0 +1,128 @@
+// Compare the memory of the stores kept by the semi-sparse engine when they
+// are hash maps, as PtsMap is, and when they are persistent maps, as Store is.
+//
+// The benchmark models the memo of a long function: each program point gets a
+// copy of the store of its predecessor with a few objects updated, and a back
+// edge from time to time merges the store of an earlier point. The peak memory
+// is measured for one representation per run, so run it once with and once
+// without -persistent.
+
+#include "Support/ADT/PersistentPtrMap.h"
+
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+using namespace llvm;
+
+static cl::opt<bool> Persistent("persistent",
+                                cl::desc("Use persistent maps as stores"));
+static cl::opt<unsigned> NumPoints("points",
+                                   cl::desc("The number of program points"),
+                                   cl::init(20000));
+static cl::opt<unsigned> NumObjects("objects",
+                                    cl::desc("The number of memory objects"),
+                                    cl::init(2000));
+static cl::opt<unsigned> Seed("seed", cl::desc("The seed of the updates"),
+                              cl::init(1));
+
+namespace {
+
+// The memory objects, and the points-to sets they map to, which are interned
+// in the engine so a set is as cheap to store as a pointer
+std::vector<int> objects, ptsSets;
+
+// The store operations the benchmark needs, over both representations
+struct HashStore {
+  std::unordered_map<const int *, const int *> map;
+
+  void strongUpdate(const int *obj, const int *set) { map[obj] = set; }
+  void weakUpdate(const int *obj, const int *set) {
+    auto &old = map[obj];
+    old = std::max(old, set);
+  }
+  void mergeWith(const HashStore &other) {
+    for (auto const &mapping : other.map)
+      weakUpdate(mapping.first, mapping.second);
+  }
+  size_t size() const { return map.size(); }
+};
+
+struct PersistentStore {
+  util::PersistentPtrMap<const int *, const int *> map;
+
+  static const int *join(const int *lhs, const int *rhs) {
+    return std::max(lhs, rhs);
+  }
+  void strongUpdate(const int *obj, const int *set) { map.set(obj, set); }
+  void weakUpdate(const int *obj, const int *set) {
+    map.update(obj, set, join);
+  }
+  void mergeWith(const PersistentStore &other) { map.merge(other.map, join); }
+  size_t size() const { return map.size(); }
+};
+
+template <typename StoreType> void run() {
+  std::mt19937 rng(Seed);
+  std::uniform_int_distribution<unsigned> objectDist(0, NumObjects - 1);
+  std::uniform_int_distribution<unsigned> setDist(0, ptsSets.size() - 1);
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<StoreType> memo;
+  memo.reserve(NumPoints);
+
+  // The initial store, with the globals
+  memo.emplace_back();
+  for (unsigned i = 0; i < NumObjects; ++i)
+    memo.back().strongUpdate(&objects[i], &ptsSets[setDist(rng)]);
+
+  size_t totalEntries = 0;
+  for (unsigned i = 1; i < NumPoints; ++i) {
+    StoreType store = memo.back();
+    unsigned numUpdates = 1 + rng() % 3;
+    for (unsigned j = 0; j < numUpdates; ++j) {
+      if (rng() % 2)
+        store.strongUpdate(&objects[objectDist(rng)], &ptsSets[setDist(rng)]);
+      else
+        store.weakUpdate(&objects[objectDist(rng)], &ptsSets[setDist(rng)]);
+    }
+    if (rng() % 16 == 0)
+      store.mergeWith(memo[std::uniform_int_distribution<unsigned>(
+          i > 100 ? i - 100 : 0, i - 1)(rng)]);
+    totalEntries += store.size();
+    memo.push_back(std::move(store));
+  }
+
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  errs() << (Persistent ? "Persistent" : "Hash") << " stores: " << NumPoints
+         << " points, " << totalEntries << " mappings in total, "
+         << format("%.3f", seconds) << " s, peak RSS "
+         << usage.ru_maxrss / 1024 << " MB\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  cl::ParseCommandLineOptions(argc, argv, "Store memory benchmark\n");
+  if (NumObjects == 0 || NumPoints == 0)
+    return 1;
+
+  objects.resize(NumObjects);
+  ptsSets.resize(NumObjects);
+  if (Persistent)
+    run<PersistentStore>();
+  else
+    run<HashStore>();
+  return 0;
+}
@@ -46,9 +46,12 @@
 #define TCFS_ANDERSEN_H
 
 #include "Alias/Andersen/Constraint.h"
+#include "Alias/Andersen/ConstraintGraph.h"
 #include "Alias/Andersen/NodeFactory.h"
+#include "Alias/Andersen/PtsGraph.h"
 #include "Alias/Andersen/TemplatePtsSet.h"
 
+#include <llvm/ADT/ArrayRef.h>
 #include <llvm/ADT/DenseMap.h>
 #include <llvm/IR/InstrTypes.h>  // For CallBase
 #include <llvm/IR/DataLayout.h>
@@ -65,14 +68,51 @@ private:
   // identified by the program.
   std::vector<AndersConstraint> constraints;
 
-  // This is the points-to graph generated by the analysis
-  // Using the DefaultPtsSet from TemplatePtsSet.h
-  std::map<NodeIndex, DefaultPtsSet, std::less<NodeIndex>, std::allocator<std::pair<const NodeIndex, DefaultPtsSet>>> ptsGraph;
+  // In incremental mode, the constraints and the constraint graph are kept
+  // after solving, so that the solution can be updated after some functions
+  // change
+  bool incremental;
+  // The constraints collected from each function. Those of the globals are
+  // mapped from nullptr
+  llvm::DenseMap<const llvm::Function *, std::vector<AndersConstraint>>
+      funcConstraints;
+  // The number of times each current constraint is collected
+  std::map<AndersConstraint, unsigned> constraintCounts;
+  // The constraint graph, which is empty after solving unless incremental
+  ConstraintGraph constraintGraph;
+
+  // The points-to set implementation selected by -andersen-pts-set
+  PtsSetImpl ptsSetImpl;
+
+  // This is the points-to graph generated by the analysis. Only the graph of
+  // the selected points-to set implementation is populated
+  AndersPtsGraph<DefaultPtsSet> ptsGraph;
+  AndersPtsGraph<TemplatePtsSet<PtsSetImpl::BDD>> bddPtsGraph;
+  AndersPtsGraph<TemplatePtsSet<PtsSetImpl::SHARED>> sharedPtsGraph;
+
+  // Call f with the populated points-to graph and return what it returns
+  template <typename Fn> decltype(auto) visitPtsGraph(Fn &&f) const {
+    if (ptsSetImpl == PtsSetImpl::BDD)
+      return f(bddPtsGraph);
+    if (ptsSetImpl == PtsSetImpl::SHARED)
+      return f(sharedPtsGraph);
+    return f(ptsGraph);
+  }
 
   // Three main phases
   void collectConstraints(const llvm::Module &);
   void optimizeConstraints();
   void solveConstraints();
+  template <typename PtsSetType>
+  void solveConstraints(AndersPtsGraph<PtsSetType> &ptsGraph);
+
+  // Helper functions for incremental solving
+  void collectConstraintsForFunction(const llvm::Function &);
+  bool countConstraint(const AndersConstraint &, bool add);
+  template <typename PtsSetType>
+  void updateSolution(AndersPtsGraph<PtsSetType> &ptsGraph,
+                      const std::vector<AndersConstraint> &added,
+                      const std::vector<AndersConstraint> &removed);
 
   // Helper functions for constraint collection
   void collectConstraintsForGlobals(const llvm::Module &);
@@ -97,9 +137,24 @@ private:
 public:
   static char ID;
 
-  Andersen(const llvm::Module &);
+  // In incremental mode, the offline optimizations (HVN, HU and HCD) and LCD
+  // are disabled, because the nodes they merge cannot be split after the
+  // constraints change
+  Andersen(const llvm::Module &, bool incremental = false);
   bool runOnModule(const llvm::Module &M);
 
+  // Incremental interfaces, which require the incremental mode:
+  // - Re-collect the constraints of the functions whose bodies have changed,
+  // and update the solution. Adding or removing globals, functions, or
+  // address-taken functions requires a new analysis.
+  void updateFunctions(llvm::ArrayRef<const llvm::Function *> funcs);
+  // - Add and remove some constraints, and update the solution. Only the
+  // nodes that the removed constraints may affect are re-solved.
+  void updateConstraints(const std::vector<AndersConstraint> &added,
+                         const std::vector<AndersConstraint> &removed);
+  // - Discard the solution and solve the current constraints from scratch.
+  void solveFromScratch();
+
   // Given a llvm pointer v,
   // - Return false if the analysis doesn't know where v points to. In other
   // words, the client must conservatively assume v can points to everything.
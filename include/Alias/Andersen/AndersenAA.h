@@ -3,21 +3,34 @@
 
 #include "Alias/Andersen/Andersen.h"
 
+#include <llvm/ADT/ArrayRef.h>
 #include <llvm/Analysis/AliasAnalysis.h>
 #include <llvm/Pass.h>
 
+#include <vector>
+
 class AndersenAAResult : public llvm::AAResultBase<AndersenAAResult> {
 private:
   friend llvm::AAResultBase<AndersenAAResult>;
 
   Andersen anders;
-  llvm::AliasResult andersenAlias(const llvm::Value *, const llvm::Value *);
 
 public:
   AndersenAAResult(const llvm::Module &);
 
   llvm::AliasResult alias(const llvm::MemoryLocation &,
                           const llvm::MemoryLocation &);
+
+  // Batched queries, which look up the points-to set of each pointer only
+  // once. The results are those of alias() on the locations before or after
+  // the pointers.
+  // - result[i * values.size() + j] is the result of values[i] and values[j]
+  std::vector<llvm::AliasResult>
+  aliasMatrix(llvm::ArrayRef<const llvm::Value *> values);
+  // - result[i] is the result of v and candidates[i]
+  std::vector<llvm::AliasResult>
+  aliasesOf(const llvm::Value *v,
+            llvm::ArrayRef<const llvm::Value *> candidates);
   bool pointsToConstantMemory(const llvm::MemoryLocation &, bool);
 };
 
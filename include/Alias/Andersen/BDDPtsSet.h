@@ -1,68 +1,150 @@
-/*
+#ifndef ANDERSEN_BDDPTSSET_H
+#define ANDERSEN_BDDPTSSET_H
 
-FIXME: This is a temporary implementation of the "BDD points-to set", which actually uses a SparseBitVector.
-It should be replaced with a proper BDD implementation.
-*/
+#include "Solvers/BDD.h"
 
+#include <llvm/ADT/SmallVector.h>
 
-#ifndef ANDERSEN_BDDPTSSET_H
-#define ANDERSEN_BDDPTSSET_H
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+// The CUDD manager shared by all BDD points-to sets.
+//
+// An element of a points-to set is a node index, which is encoded as an
+// assignment to a domain of boolean variables with the most significant bit at
+// the top of the BDD. Sets that share most of their elements (e.g. the fields
+// of the same objects, or the vtables of a class hierarchy) share most of their
+// BDD nodes, and identical sets are the same node.
+//
+// CUDD is not thread-safe, so are the sets.
+class BDDPtsSetManager {
+private:
+  Solvers::BDD bdd;
+  DdManager *manager;
+  DdNode *zero;
+
+  // domainVars[i] encodes the (numBits - 1 - i)-th bit of an element
+  std::vector<DdNode *> domainVars;
+
+  // The number of non-empty sets. The encoding of the elements changes when
+  // the domain is enlarged, which is only allowed if no such set is alive
+  unsigned numLiveSets;
+
+  BDDPtsSetManager();
+
+  friend class BDDAndersPtsSet;
+
+public:
+  static BDDPtsSetManager &get();
+
+  DdManager *getManager() const { return manager; }
+  unsigned getNumBits() const { return domainVars.size(); }
+
+  // Enlarge the domain so that it can encode [0, numElements)
+  void reserve(unsigned numElements);
 
-#include <llvm/ADT/SparseBitVector.h>
+  // The bytes used by the unique table and the caches of CUDD
+  size_t getMemoryUsage() const;
+  // The number of live BDD nodes
+  unsigned getNumNodes() const;
+};
 
-// A points-to set representation that uses SparseBitVector for now
-// but would be replaced with BDD for better performance
+// A points-to set represented by a BDD over the domain variables of
+// BDDPtsSetManager. Union, intersection and subset tests are BDD operations,
+// equality is a pointer comparison, and a copy is a reference.
 class BDDAndersPtsSet {
 private:
-  // Use a bitvector for now to make things build
-  llvm::SparseBitVector<> bitvec;
+  DdNode *node;
+
+  // Replace the BDD of this set with n, which is referenced by the caller
+  void reset(DdNode *n);
 
 public:
-  using iterator = llvm::SparseBitVector<>::iterator;
+  // Enumerate the elements of a set in ascending order by walking the paths
+  // of its BDD to the constant one. A don't-care variable is expanded to both
+  // of its values
+  class iterator {
+  private:
+    DdManager *manager;
+    DdNode *zero;
+    DdNode *root;
+    unsigned numBits;
+    // path[l] is the cofactor of the root at level l w.r.t. the bits of value
+    // above l. It is empty at the end
+    llvm::SmallVector<DdNode *, 33> path;
+    unsigned value;
+
+    // Complete the path from level l, taking the else-branch when possible
+    void descend(unsigned l);
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = unsigned;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const unsigned *;
+    using reference = const unsigned &;
+
+    iterator() : manager(nullptr), zero(nullptr), root(nullptr), numBits(0), value(0) {}
+    explicit iterator(DdNode *r);
+    iterator(const iterator &other);
+    iterator &operator=(const iterator &other);
+    ~iterator();
+
+    const unsigned &operator*() const { return value; }
+    iterator &operator++();
+    iterator operator++(int) {
+      iterator ret = *this;
+      ++*this;
+      return ret;
+    }
+
+    bool operator==(const iterator &other) const {
+      if (path.empty() || other.path.empty())
+        return path.empty() && other.path.empty();
+      return root == other.root && value == other.value;
+    }
+    bool operator!=(const iterator &other) const { return !(*this == other); }
+  };
+
+  BDDAndersPtsSet();
+  BDDAndersPtsSet(const BDDAndersPtsSet &other);
+  BDDAndersPtsSet(BDDAndersPtsSet &&other);
+  BDDAndersPtsSet &operator=(const BDDAndersPtsSet &other);
+  BDDAndersPtsSet &operator=(BDDAndersPtsSet &&other);
+  ~BDDAndersPtsSet();
 
   // Return true if *this has idx as an element
-  bool has(unsigned idx) { return bitvec.test(idx); }
-  bool has(unsigned idx) const {
-    // Since llvm::SparseBitVector::test() does not have a const quantifier, we
-    // have to use this ugly workaround to implement has()
-    llvm::SparseBitVector<> idVec;
-    idVec.set(idx);
-    return bitvec.contains(idVec);
-  }
+  bool has(unsigned idx) const;
 
   // Return true if the ptsset changes
-  bool insert(unsigned idx) { return bitvec.test_and_set(idx); }
+  bool insert(unsigned idx);
 
   // Return true if *this is a superset of other
-  bool contains(const BDDAndersPtsSet &other) const {
-    return bitvec.contains(other.bitvec);
-  }
+  bool contains(const BDDAndersPtsSet &other) const;
 
   // intersectWith: return true if *this and other share points-to elements
-  bool intersectWith(const BDDAndersPtsSet &other) const {
-    return bitvec.intersects(other.bitvec);
-  }
+  bool intersectWith(const BDDAndersPtsSet &other) const;
+
+  // Return true if *this and other share points-to elements other than
+  // ignored
+  bool intersectWith(const BDDAndersPtsSet &other, unsigned ignored) const;
 
   // Return true if the ptsset changes
-  bool unionWith(const BDDAndersPtsSet &other) { return bitvec |= other.bitvec; }
+  bool unionWith(const BDDAndersPtsSet &other);
 
-  void clear() { bitvec.clear(); }
+  void clear();
 
-  unsigned getSize() const {
-    return bitvec.count(); // NOT a constant time operation!
-  }
-  bool
-  isEmpty() const // Always prefer using this function to perform empty test
-  {
-    return bitvec.empty();
-  }
+  unsigned getSize() const; // Counts the minterms of the BDD
+  bool isEmpty() const;
 
+  // BDDs are canonical, so this is a constant time operation
   bool operator==(const BDDAndersPtsSet &other) const {
-    return bitvec == other.bitvec;
+    return node == other.node;
   }
 
-  iterator begin() const { return bitvec.begin(); }
-  iterator end() const { return bitvec.end(); }
+  iterator begin() const { return iterator(node); }
+  iterator end() const { return iterator(); }
 };
 
-#endif // ANDERSEN_BDDPTSSET_H 
\ No newline at end of file
+#endif // ANDERSEN_BDDPTSSET_H
@@ -0,0 +1,194 @@
+#ifndef ANDERSEN_CONSTRAINTGRAPH_H
+#define ANDERSEN_CONSTRAINTGRAPH_H
+
+#include "Alias/Andersen/GraphTraits.h"
+#include "Alias/Andersen/NodeFactory.h"
+
+#include <llvm/ADT/iterator_range.h>
+
+#include <map>
+#include <set>
+
+// This class represent the constraint graph. The solver keeps it after solving
+// in incremental mode, so that the solution can be updated later
+class ConstraintGraphNode {
+private:
+  NodeIndex idx;
+
+  // We use set rather than SmallSet because we need the capability of iteration
+  typedef std::set<NodeIndex> NodeSet;
+  NodeSet copyEdges, loadEdges, storeEdges;
+
+  bool insertCopyEdge(NodeIndex dst) { return copyEdges.insert(dst).second; }
+  bool removeCopyEdge(NodeIndex dst) { return copyEdges.erase(dst); }
+  bool insertLoadEdge(NodeIndex dst) { return loadEdges.insert(dst).second; }
+  bool removeLoadEdge(NodeIndex dst) { return loadEdges.erase(dst); }
+  bool insertStoreEdge(NodeIndex dst) { return storeEdges.insert(dst).second; }
+  bool removeStoreEdge(NodeIndex dst) { return storeEdges.erase(dst); }
+  bool isEmpty() const {
+    return copyEdges.empty() && loadEdges.empty() && storeEdges.empty();
+  }
+
+  void mergeEdges(const ConstraintGraphNode &other) {
+    copyEdges.insert(other.copyEdges.begin(), other.copyEdges.end());
+    loadEdges.insert(other.loadEdges.begin(), other.loadEdges.end());
+    storeEdges.insert(other.storeEdges.begin(), other.storeEdges.end());
+  }
+
+  ConstraintGraphNode(NodeIndex i) : idx(i) {}
+
+public:
+  typedef NodeSet::iterator iterator;
+  typedef NodeSet::const_iterator const_iterator;
+
+  NodeIndex getNodeIndex() const { return idx; }
+
+  bool replaceCopyEdge(NodeIndex oldIdx, NodeIndex newIdx) {
+    return removeCopyEdge(oldIdx) && insertCopyEdge(newIdx);
+  }
+  bool replaceLoadEdge(NodeIndex oldIdx, NodeIndex newIdx) {
+    return removeLoadEdge(oldIdx) && insertLoadEdge(newIdx);
+  }
+  bool replaceStoreEdge(NodeIndex oldIdx, NodeIndex newIdx) {
+    return removeStoreEdge(oldIdx) && insertStoreEdge(newIdx);
+  }
+
+  iterator begin() { return copyEdges.begin(); }
+  iterator end() { return copyEdges.end(); }
+  const_iterator begin() const { return copyEdges.begin(); }
+  const_iterator end() const { return copyEdges.end(); }
+
+  const_iterator load_begin() const { return loadEdges.begin(); }
+  const_iterator load_end() const { return loadEdges.end(); }
+  llvm::iterator_range<const_iterator> loads() const {
+    return llvm::iterator_range<const_iterator>(load_begin(), load_end());
+  }
+
+  const_iterator store_begin() const { return storeEdges.begin(); }
+  const_iterator store_end() const { return storeEdges.end(); }
+  llvm::iterator_range<const_iterator> stores() const {
+    return llvm::iterator_range<const_iterator>(store_begin(), store_end());
+  }
+
+  friend class ConstraintGraph;
+};
+
+class ConstraintGraph {
+private:
+  typedef std::map<NodeIndex, ConstraintGraphNode> NodeMapTy;
+  NodeMapTy graph;
+
+public:
+  typedef NodeMapTy::iterator iterator;
+  typedef NodeMapTy::const_iterator const_iterator;
+
+  ConstraintGraph() {}
+
+  bool insertCopyEdge(NodeIndex src, NodeIndex dst) {
+    auto itr = graph.find(src);
+    if (itr == graph.end()) {
+      ConstraintGraphNode srcNode(src);
+      srcNode.insertCopyEdge(dst);
+      graph.insert(std::make_pair(src, std::move(srcNode)));
+      return true;
+    } else
+      return (itr->second).insertCopyEdge(dst);
+  }
+
+  bool insertLoadEdge(NodeIndex src, NodeIndex dst) {
+    auto itr = graph.find(src);
+    if (itr == graph.end()) {
+      ConstraintGraphNode srcNode(src);
+      srcNode.insertLoadEdge(dst);
+      graph.insert(std::make_pair(src, std::move(srcNode)));
+      return true;
+    } else
+      return (itr->second).insertLoadEdge(dst);
+  }
+
+  bool insertStoreEdge(NodeIndex src, NodeIndex dst) {
+    auto itr = graph.find(src);
+    if (itr == graph.end()) {
+      ConstraintGraphNode srcNode(src);
+      srcNode.insertStoreEdge(dst);
+      graph.insert(std::make_pair(src, std::move(srcNode)));
+      return true;
+    } else
+      return (itr->second).insertStoreEdge(dst);
+  }
+
+  void mergeNodes(NodeIndex dst, NodeIndex src) {
+    auto itr = graph.find(src);
+    if (itr == graph.end())
+      return;
+
+    const ConstraintGraphNode &srcNode = itr->second;
+    itr = graph.find(dst);
+    if (itr == graph.end()) {
+      ConstraintGraphNode dstNode(dst);
+      graph.insert(std::make_pair(dst, srcNode));
+    } else
+      (itr->second).mergeEdges(srcNode);
+  }
+
+  bool removeCopyEdge(NodeIndex src, NodeIndex dst) {
+    auto itr = graph.find(src);
+    return itr != graph.end() && (itr->second).removeCopyEdge(dst);
+  }
+
+  bool removeLoadEdge(NodeIndex src, NodeIndex dst) {
+    auto itr = graph.find(src);
+    return itr != graph.end() && (itr->second).removeLoadEdge(dst);
+  }
+
+  bool removeStoreEdge(NodeIndex src, NodeIndex dst) {
+    auto itr = graph.find(src);
+    return itr != graph.end() && (itr->second).removeStoreEdge(dst);
+  }
+
+  void deleteNode(NodeIndex idx) { graph.erase(idx); }
+
+  ConstraintGraphNode *getNodeWithIndex(NodeIndex idx) {
+    auto itr = graph.find(idx);
+    if (itr == graph.end())
+      return nullptr;
+    else
+      return &(itr->second);
+  }
+
+  ConstraintGraphNode *getOrInsertNode(NodeIndex idx) {
+    auto itr = graph.find(idx);
+    if (itr == graph.end()) {
+      ConstraintGraphNode newNode(idx);
+      itr = graph.insert(std::make_pair(idx, newNode)).first;
+    }
+    return &(itr->second);
+  }
+
+  iterator begin() { return graph.begin(); }
+  iterator end() { return graph.end(); }
+  const_iterator begin() const { return graph.begin(); }
+  const_iterator end() const { return graph.end(); }
+};
+
+// Specialize the AnderGraphTraits for ConstraintGraph
+template <> class AndersGraphTraits<ConstraintGraph> {
+public:
+  typedef ConstraintGraphNode NodeType;
+  typedef MapValueIterator<ConstraintGraph::const_iterator> NodeIterator;
+  typedef ConstraintGraphNode::iterator ChildIterator;
+
+  static inline ChildIterator child_begin(const NodeType *n) {
+    return n->begin();
+  }
+  static inline ChildIterator child_end(const NodeType *n) { return n->end(); }
+
+  static inline NodeIterator node_begin(const ConstraintGraph *g) {
+    return NodeIterator(g->begin());
+  }
+  static inline NodeIterator node_end(const ConstraintGraph *g) {
+    return NodeIterator(g->end());
+  }
+};
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef ANDERSEN_PTSGRAPH_H
+#define ANDERSEN_PTSGRAPH_H
+
+#include "Alias/Andersen/NodeFactory.h"
+
+#include <cassert>
+#include <vector>
+
+// The points-to graph, i.e. the points-to set of each node. The sets are kept
+// in a vector indexed by NodeIndex, so looking up a node is an array access.
+// A node has no points-to set until operator[] creates one. The graph only
+// grows with grow(), which is never called while solving, so a reference to a
+// set stays valid until the set is erased or the graph grows
+template <typename PtsSetType> class AndersPtsGraph {
+private:
+  std::vector<PtsSetType> sets;
+  // Whether a node has a points-to set. We use bytes rather than bits so that
+  // the sets of different nodes can be created by different threads
+  std::vector<char> present;
+
+public:
+  // Remove all the sets and make room for the nodes [0, numNodes)
+  void reset(unsigned numNodes) {
+    sets.clear();
+    sets.resize(numNodes);
+    present.assign(numNodes, 0);
+  }
+
+  // Make room for the nodes [0, numNodes), keeping the existing sets
+  void grow(unsigned numNodes) {
+    if (numNodes <= sets.size())
+      return;
+    sets.resize(numNodes);
+    present.resize(numNodes, 0);
+  }
+
+  // The number of nodes the graph has room for
+  unsigned size() const { return sets.size(); }
+
+  bool count(NodeIndex n) const { return n < present.size() && present[n]; }
+
+  // Return nullptr if n does not have a points-to set
+  PtsSetType *find(NodeIndex n) { return count(n) ? &sets[n] : nullptr; }
+  const PtsSetType *find(NodeIndex n) const {
+    return count(n) ? &sets[n] : nullptr;
+  }
+
+  // Return the points-to set of n, which is created if it does not exist
+  PtsSetType &operator[](NodeIndex n) {
+    assert(n < sets.size() && "The points-to graph is not large enough!");
+    present[n] = 1;
+    return sets[n];
+  }
+
+  void erase(NodeIndex n) {
+    if (!count(n))
+      return;
+    present[n] = 0;
+    sets[n] = PtsSetType();
+  }
+};
+
+#endif
@@ -9,28 +9,26 @@
 class AndersPtsSet {
 private:
   llvm::SparseBitVector<> bitvec;
+  // The number of elements, which is updated whenever bitvec changes
+  unsigned size = 0;
 
 public:
   using iterator = llvm::SparseBitVector<>::iterator;
 
   // Return true if *this has idx as an element
-  // This function should be marked const, but we cannot do it because
-  // SparseBitVector::test() is not marked const. WHY???
-  bool has(unsigned idx) { return bitvec.test(idx); }
-  bool has(unsigned idx) const {
-    // Since llvm::SparseBitVector::test() does not have a const quantifier, we
-    // have to use this ugly workaround to implement has()
-    llvm::SparseBitVector<> idVec;
-    idVec.set(idx);
-    return bitvec.contains(idVec);
-  }
+  bool has(unsigned idx) const { return bitvec.test(idx); }
 
   // Return true if the ptsset changes
-  bool insert(unsigned idx) { return bitvec.test_and_set(idx); }
+  bool insert(unsigned idx) {
+    if (!bitvec.test_and_set(idx))
+      return false;
+    ++size;
+    return true;
+  }
 
   // Return true if *this is a superset of other
   bool contains(const AndersPtsSet &other) const {
-    return bitvec.contains(other.bitvec);
+    return size >= other.size && bitvec.contains(other.bitvec);
   }
 
   // intersectWith: return true if *this and other share points-to elements
@@ -38,22 +36,54 @@ public:
     return bitvec.intersects(other.bitvec);
   }
 
-  // Return true if the ptsset changes
-  bool unionWith(const AndersPtsSet &other) { return bitvec |= other.bitvec; }
+  // Return true if *this and other share points-to elements other than
+  // ignored. Neither this nor the one above allocates memory
+  bool intersectWith(const AndersPtsSet &other, unsigned ignored) const {
+    if (!bitvec.intersects(other.bitvec))
+      return false;
+    if (!bitvec.test(ignored) || !other.bitvec.test(ignored))
+      return true;
+
+    // Both sets have ignored, so look for another common element
+    for (auto itr = begin(), ite = end(), otherItr = other.begin(),
+              otherIte = other.end();
+         itr != ite && otherItr != otherIte;) {
+      if (*itr < *otherItr) {
+        ++itr;
+      } else if (*otherItr < *itr) {
+        ++otherItr;
+      } else {
+        if (*itr != ignored)
+          return true;
+        ++itr;
+        ++otherItr;
+      }
+    }
+    return false;
+  }
 
-  void clear() { bitvec.clear(); }
+  // Return true if the ptsset changes
+  bool unionWith(const AndersPtsSet &other) {
+    if (!(bitvec |= other.bitvec))
+      return false;
+    size = bitvec.count();
+    return true;
+  }
 
-  unsigned getSize() const {
-    return bitvec.count(); // NOT a constant time operation!
+  void clear() {
+    bitvec.clear();
+    size = 0;
   }
+
+  unsigned getSize() const { return size; }
   bool
   isEmpty() const // Always prefer using this function to perform empty test
   {
-    return bitvec.empty();
+    return size == 0;
   }
 
   bool operator==(const AndersPtsSet &other) const {
-    return bitvec == other.bitvec;
+    return size == other.size && bitvec == other.bitvec;
   }
 
   iterator begin() const { return bitvec.begin(); }
@@ -0,0 +1,186 @@
+#ifndef ANDERSEN_SHAREDPTSSET_H
+#define ANDERSEN_SHAREDPTSSET_H
+
+#include <llvm/ADT/DenseMap.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <unordered_map>
+#include <vector>
+
+// The pool of the canonical sets referred to by SharedAndersPtsSet.
+//
+// A canonical set is immutable and stored once as a sorted vector of 64-bit
+// blocks. Sets are hash-consed, so two nodes with the same points-to set share
+// one copy, and they are reference-counted, so a set is freed when no node
+// refers to it any more. The results of unions are memoized by the ids of the
+// operands, which makes repeated propagation along the same copy edges cheap.
+//
+// The pool is not thread-safe, so are the sets.
+class SharedPtsSetPool {
+public:
+  struct Block {
+    unsigned index;
+    uint64_t bits;
+
+    bool operator==(const Block &other) const {
+      return index == other.index && bits == other.bits;
+    }
+  };
+
+private:
+  struct Entry {
+    std::vector<Block> blocks;
+    unsigned size = 0;
+    unsigned refs = 0;
+    size_t hash = 0;
+  };
+
+  // Entries are indexed by set ids. The empty set is always the 0-th one. A
+  // deque keeps the entries in place when new sets are added
+  std::deque<Entry> entries;
+  // The ids of the sets that can be reused
+  std::vector<unsigned> freeIds;
+  // The ids of the dead sets that may still appear in the union cache. They
+  // are reused after the cache is flushed
+  std::vector<unsigned> deadIds;
+  // From the hash of a set to its id
+  std::unordered_multimap<size_t, unsigned> table;
+  // From the ids of two sets (the smaller first) to the id of their union
+  llvm::DenseMap<std::pair<unsigned, unsigned>, unsigned> unionCache;
+
+  // Statistics
+  unsigned long numUnions = 0, numUnionCacheHits = 0;
+
+  SharedPtsSetPool();
+
+  // Return the id of the canonical set of blocks, with a reference added
+  unsigned intern(std::vector<Block> &&blocks);
+
+  void retain(unsigned id) {
+    if (id != 0)
+      ++entries[id].refs;
+  }
+  void release(unsigned id);
+
+  // Return the id of the union of the sets a and b, with a reference added
+  unsigned getUnion(unsigned a, unsigned b);
+
+  // Forget the cached unions so that the ids of dead sets can be reused
+  void flushUnionCache();
+
+  const Entry &getEntry(unsigned id) const { return entries[id]; }
+
+  friend class SharedAndersPtsSet;
+
+public:
+  static SharedPtsSetPool &get();
+
+  // The number of distinct sets alive
+  unsigned getNumSets() const { return table.size(); }
+  // The bytes used by the blocks of the sets alive
+  size_t getMemoryUsage() const;
+  unsigned long getNumUnions() const { return numUnions; }
+  unsigned long getNumUnionCacheHits() const { return numUnionCacheHits; }
+};
+
+// A points-to set that refers to a canonical set in SharedPtsSetPool. Copying
+// a set copies an id, equality is an id comparison, and the size is cached in
+// the canonical set.
+class SharedAndersPtsSet {
+private:
+  unsigned id = 0;
+
+public:
+  // The iterator holds a reference to the canonical set it walks through, so
+  // it stays valid even if the set it comes from changes
+  class iterator {
+  private:
+    unsigned id = 0;
+    const SharedPtsSetPool::Block *block = nullptr, *blockEnd = nullptr;
+    uint64_t remaining = 0;
+    unsigned value = 0;
+
+    // Move to the lowest element in remaining, or the next block
+    void settle();
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = unsigned;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const unsigned *;
+    using reference = const unsigned &;
+
+    iterator() {}
+    explicit iterator(unsigned id);
+    iterator(const iterator &other);
+    iterator &operator=(const iterator &other);
+    ~iterator();
+
+    const unsigned &operator*() const { return value; }
+    iterator &operator++() {
+      remaining &= remaining - 1;
+      settle();
+      return *this;
+    }
+    iterator operator++(int) {
+      iterator ret = *this;
+      ++*this;
+      return ret;
+    }
+
+    bool operator==(const iterator &other) const {
+      return block == other.block && remaining == other.remaining;
+    }
+    bool operator!=(const iterator &other) const { return !(*this == other); }
+  };
+
+  SharedAndersPtsSet() {}
+  SharedAndersPtsSet(const SharedAndersPtsSet &other) : id(other.id) {
+    SharedPtsSetPool::get().retain(id);
+  }
+  SharedAndersPtsSet(SharedAndersPtsSet &&other) : id(other.id) {
+    other.id = 0;
+  }
+  SharedAndersPtsSet &operator=(const SharedAndersPtsSet &other);
+  SharedAndersPtsSet &operator=(SharedAndersPtsSet &&other);
+  ~SharedAndersPtsSet() { SharedPtsSetPool::get().release(id); }
+
+  // Return true if *this has idx as an element
+  bool has(unsigned idx) const;
+
+  // Return true if the ptsset changes
+  bool insert(unsigned idx);
+
+  // Return true if *this is a superset of other
+  bool contains(const SharedAndersPtsSet &other) const;
+
+  // intersectWith: return true if *this and other share points-to elements
+  bool intersectWith(const SharedAndersPtsSet &other) const;
+
+  // Return true if *this and other share points-to elements other than
+  // ignored. Neither this nor the one above allocates memory
+  bool intersectWith(const SharedAndersPtsSet &other, unsigned ignored) const;
+
+  // Return true if the ptsset changes
+  bool unionWith(const SharedAndersPtsSet &other);
+
+  void clear() { *this = SharedAndersPtsSet(); }
+
+  unsigned getSize() const {
+    return SharedPtsSetPool::get().getEntry(id).size;
+  }
+  bool isEmpty() const { return id == 0; }
+
+  // Canonical sets are unique, so this is a constant time operation
+  bool operator==(const SharedAndersPtsSet &other) const {
+    return id == other.id;
+  }
+
+  iterator begin() const { return iterator(id); }
+  iterator end() const { return iterator(); }
+};
+
+#endif // ANDERSEN_SHAREDPTSSET_H
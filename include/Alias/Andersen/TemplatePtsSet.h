@@ -3,15 +3,18 @@
 
 #include "Alias/Andersen/PtsSet.h"
 #include "Alias/Andersen/BDDPtsSet.h"
+#include "Alias/Andersen/SharedPtsSet.h"
 
 // An enumeration for the available points-to set implementations
 enum class PtsSetImpl {
   SPARSE_BITVECTOR,
-  BDD
+  BDD,
+  SHARED
 };
 
 // Template class for points-to sets
-// The implementation type is selected at compile time
+// The solver is instantiated for each implementation, and the one to use is
+// selected at runtime with -andersen-pts-set
 template <PtsSetImpl Impl = PtsSetImpl::SPARSE_BITVECTOR>
 class TemplatePtsSet {
 };
@@ -30,9 +33,14 @@ public:
   using BDDAndersPtsSet::BDDAndersPtsSet;
 };
 
-// This typedef controls which implementation is used by default
-// To switch to BDD implementation, change this to:
-// using DefaultPtsSet = TemplatePtsSet<PtsSetImpl::BDD>;
+// Specialization for hash-consed implementation
+template <>
+class TemplatePtsSet<PtsSetImpl::SHARED> : public SharedAndersPtsSet {
+public:
+  using SharedAndersPtsSet::SharedAndersPtsSet;
+};
+
+// The implementation used unless another one is selected
 using DefaultPtsSet = TemplatePtsSet<PtsSetImpl::SPARSE_BITVECTOR>;
 
 #endif // ANDERSEN_TEMPLATE_PTSSET_H 
\ No newline at end of file
@@ -29,6 +29,7 @@
 #include <llvm/Support/Debug.h>
 #include <llvm/IR/InlineAsm.h>
 #include <map>
+#include <memory>
 #include <set>
 #include <unordered_map>
 
@@ -56,6 +57,26 @@ private:
     std::set<FunctionTypeNode *> TyRoots;
     /// @}
 
+    /// An update of the call graph found when collecting the constraints of a function
+    struct CallGraphUpdate {
+        enum UpdateKind { UK_Ret, UK_VAArg, UK_CommonCall, UK_PointerCall } Kind;
+        Function *Caller;
+        Value *Val; ///< the returned value, the va_arg, or the call instruction
+        Value *CalledValue;
+        std::vector<Value *> Args;
+    };
+
+    /// A function-local analyzer collects the constraints of one function into its own graph,
+    /// which borrows the labels of the global graph. Its updates to the shared states, i.e., the
+    /// call graph and the function groups, are buffered and replayed by the global analyzer
+    /// in the order of functions, so that the result does not depend on the scheduling.
+    /// @{
+    Function *LocalFunc = nullptr;
+    std::unique_ptr<DyckGraph> LocalGraph;
+    std::vector<CallGraphUpdate> PendingUpdates;
+    std::vector<std::pair<FunctionType *, FunctionType *>> PendingCombinations;
+    /// @}
+
 public:
     AAAnalyzer(Module *, DyckGraph *, DyckCallGraph *);
 
@@ -65,10 +86,20 @@ public:
 
     void interProcedureAnalysis();
 
+    /// the options that change the result of the analysis, e.g., to tell apart cached results
+    static std::string getOptionString();
+
 private:
+    /// create a function-local analyzer
+    AAAnalyzer(AAAnalyzer *Global, Function *F);
+
     void printNoAliasedPointerCalls();
 
-    void handleInst(Instruction *Inst, DyckCallGraphNode *Parent);
+    void collectFunctionConstraints(Function *F);
+
+    void mergeLocalAnalyzer(AAAnalyzer *Local);
+
+    void handleInst(Instruction *Inst, Function *Parent);
 
     void handleInstrinsic(Instruction *Inst);
 
@@ -79,9 +110,9 @@ private:
 
     void handleExtractInsertElmtInst(Value *Vec, Value *Elmt);
 
-    void handleInvokeCallInst(Instruction *Ret, Value *CV, std::vector<Value *> *Args, DyckCallGraphNode *Parent);
+    void handleInvokeCallInst(Instruction *Ret, Value *CV, std::vector<Value *> *Args, Function *Parent);
 
-    void handleLibInvokeCallInst(Value *Ret, Function *F, const std::vector<Value *> *Args, DyckCallGraphNode *Parent);
+    void handleLibInvokeCallInst(Value *Ret, Function *F, const std::vector<Value *> *Args);
 
     bool handlePointerFunctionCalls(DyckCallGraphNode *Caller, int Counter);
 
@@ -100,6 +131,11 @@ private:
 
     void combineFunctionGroups(FunctionType *, FunctionType *);
 
+private:
+    /// Update the call graph node of the caller, buffered in a function-local analyzer
+    void updateCallGraph(CallGraphUpdate::UpdateKind Kind, Function *Caller, Value *Val,
+                         Value *CalledValue = nullptr, std::vector<Value *> *Args = nullptr);
+
 private:
     /// return the structure's field vertex
     DyckGraphNode *addField(DyckGraphNode *Val, long FieldIndex, DyckGraphNode *Field);
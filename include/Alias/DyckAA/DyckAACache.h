@@ -0,0 +1,106 @@
+/*
+ *  Canary features a fast unification-based alias analysis for C programs
+ *  Copyright (C) 2021 Qingkai Shi <qingkaishi@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ALIAS_DYCKAA_DYCKAACACHE_H
+#define ALIAS_DYCKAA_DYCKAACACHE_H
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+class DyckCallGraph;
+
+class DyckGraph;
+
+class DyckGraphNode;
+
+struct ModRef;
+
+/// An on-disk cache of the results of DyckAA, i.e., the equivalent classes and edges of the
+/// dyck graph, the call graph with resolved indirect calls, and the mod/ref summaries.
+///
+/// A cache file is named by the MD5 of the module bitcode and the options of the analysis, and
+/// it is loaded via a memory-mapped buffer. Values are identified by their positions in a
+/// deterministic walk of the module (globals, then arguments, blocks and instructions of each
+/// function, then constants in the order they are used), so a cache can be used by any run,
+/// in any LLVMContext, that loads the same bitcode.
+///
+/// The file is a header followed by tagged sections. The mod/ref section is appended when
+/// DyckModRefAnalysis runs for the first time on a module.
+class DyckAACache {
+private:
+    std::string Path;
+
+    /// the digest of the module and the options
+    std::string Key;
+
+    /// values indexed by their stable ids, the reverse map is only built to write a cache
+    /// @{
+    std::vector<Value *> Values;
+    DenseMap<Value *, unsigned> ValueIds;
+    /// @}
+
+    /// the mapped cache file, null if there is no valid cache
+    std::unique_ptr<MemoryBuffer> Buffer;
+
+    /// the bytes of the sections written or loaded so far
+    std::string Sections;
+
+public:
+    /// Open the cache of \p M, null if caching is disabled, i.e., -dyckaa-cache-dir is not set.
+    static std::unique_ptr<DyckAACache> open(Module &M);
+
+    /// Restore the dyck graph and the call graph, which must be empty, from the cache.
+    /// Return false if the cache does not exist or is invalid, then the graphs are not changed.
+    bool loadAliasResult(DyckGraph *DG, DyckCallGraph *DCG);
+
+    /// Write the solved dyck graph and the call graph to the cache.
+    void storeAliasResult(DyckGraph *DG, DyckCallGraph *DCG);
+
+    /// Restore the mod/ref summaries, return false if they are not in the cache.
+    bool loadModRef(DyckGraph *DG, std::map<Function *, ModRef> &Func2MR);
+
+    /// Append the mod/ref summaries to the cache.
+    void storeModRef(DyckGraph *DG, const std::map<Function *, ModRef> &Func2MR);
+
+private:
+    DyckAACache(Module &M, std::string Path, std::string Key);
+
+    /// find the section of \p Tag in the loaded file, false if it does not exist
+    bool findSection(unsigned Tag, StringRef &Payload) const;
+
+    /// number the values of \p M in the deterministic order
+    void numberValues(Module &M);
+
+    /// build the map from values to their stable ids
+    void buildValueIds();
+
+    /// the stable id of \p V, ~0U if \p V is null
+    unsigned getValueId(Value *V) const;
+
+    /// write the header and the sections to a temporary file, and then rename it to the cache file
+    void flush();
+};
+
+#endif // ALIAS_DYCKAA_DYCKAACACHE_H
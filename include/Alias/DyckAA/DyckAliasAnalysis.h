@@ -20,6 +20,8 @@
 #define ALIAS_DYCKAA_DYCKALIASANALYSIS_H
 
 #include <llvm/Pass.h>
+#include <llvm/ADT/BitVector.h>
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/ADT/SmallPtrSet.h>
 #include <llvm/ADT/SmallVector.h>
 #include <llvm/Support/ErrorHandling.h>
@@ -28,6 +30,8 @@
 #include <llvm/Support/CommandLine.h>
 #include <llvm/Support/Debug.h>
 #include <llvm/IR/InlineAsm.h>
+#include <memory>
+#include "Alias/DyckAA/DyckAACache.h"
 #include "Alias/DyckAA/DyckCallGraph.h"
 #include "Alias/DyckAA/DyckGraphEdgeLabel.h"
 #include "Alias/DyckAA/DyckGraph.h"
@@ -39,9 +43,25 @@ private:
     DyckGraph *DyckPTG;
     DyckCallGraph *DyckCG;
 
+    /// the on-disk cache of the result, null if caching is disabled
+    std::unique_ptr<DyckAACache> Cache;
+
+    /// A frozen view of the result, built when the analysis finishes. Alias classes are numbered
+    /// in the order of the representatives of the dyck graph. Queries only read the view, so they
+    /// never change the analysis and can be issued from multiple threads.
+    /// @{
+    DenseMap<const Value *, unsigned> ClassIds;
+    std::vector<const std::set<Value *> *> ClassAliasSets;
+    std::vector<unsigned> ClassPointsTo;
+    BitVector ClassMayNull;
+    /// @}
+
 public:
     static char ID;
 
+    /// the class id of values that are not analyzed
+    static const unsigned UnknownClass = ~0U;
+
     DyckAliasAnalysis();
 
     ~DyckAliasAnalysis() override;
@@ -50,7 +70,7 @@ public:
 
     void getAnalysisUsage(AnalysisUsage &AU) const override;
 
-    /// get alias set of a pointer \p Ptr
+    /// get alias set of a pointer \p Ptr, nullptr if \p Ptr is not analyzed
     const std::set<Value *> *getAliasSet(Value *Ptr) const;
 
     /// return true if \p V1 is an alias of \p V2
@@ -59,13 +79,31 @@ public:
     /// return true if \p V is an alias of nullptr
     bool mayNull(Value *V) const;
 
+    /// get the id of the alias class of \p V, UnknownClass if \p V is not analyzed
+    unsigned getAliasClass(const Value *V) const;
+
+    /// get the id of the alias class that \p V points to, UnknownClass if there is no such class
+    unsigned pointsToClass(const Value *V) const;
+
+    /// get the number of alias classes
+    unsigned numAliasClasses() const { return ClassAliasSets.size(); }
+
+    /// return a matrix M, where M[I][J] is set iff Values[I] may alias Values[J]
+    std::vector<BitVector> aliasMatrix(ArrayRef<Value *> Values) const;
+
     /// get the call graph based on dyck-aa
     DyckCallGraph *getDyckCallGraph() const;
 
     /// get the dyck-cfl graph
     DyckGraph *getDyckGraph() const;
 
+    /// get the on-disk cache of the result, null if caching is disabled
+    DyckAACache *getCache() const { return Cache.get(); }
+
 private:
+    /// build the frozen view of the result
+    void freeze();
+
     /// Three kinds of information will be printed.
     /// 1. Alias Sets will be printed to the console
     /// 2. The relation of Alias Sets will be output into "alias_rel.dot"
@@ -65,7 +65,8 @@ protected:
     int CallId;
 
 public:
-    Call(CallKind K, Instruction *Inst, Value *CalledValue, std::vector<Value *> *Args);
+    /// a call is given a new unique id unless a positive \p Id is provided, e.g., when it is restored from a cache
+    Call(CallKind K, Instruction *Inst, Value *CalledValue, std::vector<Value *> *Args, int Id = 0);
 
     CallKind getKind() const { return Kind; }
 
@@ -84,7 +85,7 @@ public:
 
 class CommonCall : public Call {
 public:
-    CommonCall(Instruction *Inst, Function *Func, std::vector<Value *> *Args);
+    CommonCall(Instruction *Inst, Function *Func, std::vector<Value *> *Args, int Id = 0);
 
     Function *getCalledFunction() const { return dyn_cast_or_null<Function>(CalledValue); }
 
@@ -99,7 +100,7 @@ private:
     std::set<Function *> MayAliasedCallees;
 
 public:
-    PointerCall(Instruction *Inst, Value *CalledValue, std::vector<Value *> *Args);
+    PointerCall(Instruction *Inst, Value *CalledValue, std::vector<Value *> *Args, int Id = 0);
 
     std::set<Function *>::const_iterator begin() const { return MayAliasedCallees.begin(); }
 
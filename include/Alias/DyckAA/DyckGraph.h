@@ -19,18 +19,36 @@
 #ifndef DYCKAA_DYCKHALFGRAPH_H
 #define DYCKAA_DYCKHALFGRAPH_H
 
-#include <stack>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
 
 #include "Alias/DyckAA/DyckGraphNode.h"
 
 class DyckGraphEdgeLabel;
 
+class DyckWorkList;
+
 /// This class models a dyck-cfl language as a graph, which does not contain the barred edges.
 /// See details in http://dl.acm.org/citation.cfm?id=2491956.2462159&coll=DL&dl=ACM&CFID=379446910&CFTOKEN=65130716 .
+/// Vertices are allocated in a node arena and unified with a union-find forest (union by rank,
+/// path halving), so that a unification costs O(alpha(n)) plus the number of moved edge labels.
 class DyckGraph {
 private:
-    std::set<DyckGraphNode *> Vertices;
+    /// the node arena, a deque never moves its elements
+    std::deque<DyckGraphNode> Nodes;
+
+    /// the number of representatives, i.e., equivalent classes
+    unsigned NumReps = 0;
+
+    /// representatives, rebuilt on demand after the graph changes
+    /// @{
+    std::vector<DyckGraphNode *> Reps;
+    bool RepsValid = true;
+    /// @}
 
     std::unordered_map<void *, DyckGraphNode *> ValVertexMap;
 
@@ -41,24 +59,34 @@ private:
     std::map<long, DyckGraphEdgeLabel *> IndexEdgeLabelMap;
     /// @}
 
+    /// the graph owning the edge labels if they are borrowed, the maps above then only cache them
+    DyckGraph *LabelOwner = nullptr;
+
+    /// guards the label maps of an owner against its borrowers
+    std::mutex LabelMutex;
+
 public:
     DyckGraph();
 
+    /// Create a graph that borrows the edge labels of \p Owner, so that its vertices and
+    /// edges can be merged into \p Owner later. The borrowers of a graph may run concurrently.
+    explicit DyckGraph(DyckGraph *Owner);
+
     ~DyckGraph();
 
-    /// The number of vertices in the graph.
+    /// The number of vertices (representatives) in the graph.
     unsigned int numVertices();
 
     /// The number of equivalent sets.
     /// Please use it after you call void qirunAlgorithm().
     unsigned int numEquivalentClasses();
 
-    /// Get the set of vertices in the graph.
-    std::set<DyckGraphNode *> &getVertices();
+    /// Get the set of vertices (representatives) in the graph.
+    const std::vector<DyckGraphNode *> &getVertices();
 
     /// You are not recommended to use the function when the graph is big,
     /// because it is time-consuming.
-    void printAsDot(const char *FileName) const;
+    void printAsDot(const char *FileName);
 
     /// Combine x's rep and y's rep.
     DyckGraphNode *combine(DyckGraphNode *NodeX, DyckGraphNode *NodeY);
@@ -84,6 +112,16 @@ public:
     /// If the function does nothing, return true, otherwise return false.
     bool qirunAlgorithm();
 
+    /// Copy the vertices, equivalent classes and edges of \p Local, which borrows the labels of this graph,
+    /// into this graph. A vertex of \p Local that wraps a value is mapped by \p Wrap, an anonymous
+    /// one is given a new vertex, vertices are visited in the order they were created in \p Local.
+    void merge(DyckGraph *Local, const std::function<DyckGraphNode *(void *)> &Wrap);
+
+    /// Append a solved equivalent class of \p Vals, whose first vertex is the representative and
+    /// is anonymous if \p Vals is empty. It is used to restore a graph from a cache, so the values
+    /// must not have vertices yet, and the edges are added to the representatives afterwards.
+    DyckGraphNode *addEquivalentClass(const std::vector<void *> &Vals);
+
     /// validation
     void validation(const char *, int);
 
@@ -94,10 +132,14 @@ public:
     DyckGraphEdgeLabel *getDereferenceEdgeLabel() const { return DerefEdgeLabel; }
 
 private:
-    void removeFromWorkList(std::multimap<DyckGraphNode *, void *> &, DyckGraphNode *, void *);
-
-    bool containsInWorkList(std::multimap<DyckGraphNode *, void *> &, DyckGraphNode *, void *);
+    /// Unify two representatives, the out edges of the one that is not the new
+    /// representative are moved to the new one. If \p WorkList is not null, the
+    /// pending labels of the absorbed one are removed from it, and labels that
+    /// have more than one targets after the move are added to it.
+    DyckGraphNode *unify(DyckGraphNode *RepX, DyckGraphNode *RepY, DyckWorkList *WorkList);
+
+    /// compress every path in the union-find forest, after which lookups never write
+    void flatten();
 };
 
 #endif // DYCKAA_DYCKHALFGRAPH_H
-
@@ -19,109 +19,114 @@
 #ifndef DYCKAA_DYCKGRAPHNODE_H
 #define DYCKAA_DYCKGRAPHNODE_H
 
-#include <map>
+#include <memory>
 #include <set>
+#include <utility>
+#include <vector>
 
 class DyckGraph;
 
+/// A vertex of the dyck graph. Vertices live in the node arena of a DyckGraph and are never freed
+/// before the graph. Unifying two vertices does not delete either of them: they are linked in a
+/// union-find forest and the root of each tree represents the equivalence class. Every public
+/// function below can be called on any member of a class and works on its representative.
 class DyckGraphNode {
     friend class DyckGraph;
+
+public:
+    /// per-label adjacency: a vector of labels sorted by address, each with a compact vector of targets.
+    /// targets may be stale (non-representative) vertices, use getRepresentative() to resolve them.
+    typedef std::vector<DyckGraphNode *> EdgeListTy;
+    typedef std::vector<std::pair<void *, EdgeListTy>> LabelEdgesTy;
+
 private:
-    static int GlobalNodeIndex;
+    /// only DyckGraph can create the tag, i.e., only the arena can construct a vertex
+    struct ArenaTag {};
+
     int NodeIndex;
     const char *NodeName;
     bool ContainsNull = false;
 
-    std::set<void *> InLables;
-    std::set<void *> OutLables;
+    /// the value this vertex is created for, null for the anonymous ones
+    void *Value;
 
-    std::map<void *, std::set<DyckGraphNode *>> InNodes;
-    std::map<void *, std::set<DyckGraphNode *>> OutNodes;
+    /// union-find forest
+    /// @{
+    DyckGraphNode *Parent;
+    unsigned Rank = 0;
+    /// @}
 
-    /// only store non-null value
-    std::set<void *> EquivClass;
+    /// members of a class are chained from the representative to LastMember,
+    /// so that unifying two classes is a constant-time splice
+    /// @{
+    DyckGraphNode *NextMember = nullptr;
+    DyckGraphNode *LastMember;
+    /// @}
 
-    /// The constructor is not visible. The first argument is the pointer of the value that you want to encapsulate.
-    /// The second argument is the name of the vertex, which will be used in void DyckGraph::printAsDot() function.
-    /// please use DyckGraph::retrieveDyckVertex for initialization.
-    explicit DyckGraphNode(void *V, const char *Name = nullptr);
+    /// out edges, only meaningful for a representative
+    LabelEdgesTy OutNodes;
+
+    /// only store non-null value, materialized on demand from the member chain
+    /// @{
+    std::unique_ptr<std::set<void *>> EquivClass;
+    bool EquivClassValid = false;
+    /// @}
 
 public:
+    /// The first argument is the pointer of the value that you want to encapsulate.
+    /// The second argument is the name of the vertex, which will be used in void DyckGraph::printAsDot() function.
+    /// The tag is private, please use DyckGraph::retrieveDyckVertex for initialization.
+    DyckGraphNode(ArenaTag, int Index, void *V, const char *Name);
+
+    DyckGraphNode(const DyckGraphNode &) = delete;
+
+    DyckGraphNode &operator=(const DyckGraphNode &) = delete;
+
     ~DyckGraphNode();
 
     /// Get its index
-    /// The index of the first vertex you create is 0, the second one is 1, ...
+    /// The index of the first vertex you create in a graph is 0, the second one is 1, ...
     int getIndex() const;
 
     /// Get its name
     const char *getName();
 
-    /// Get the source vertices corresponding the label
-    std::set<DyckGraphNode *> *getInVertices(void *Label);
+    /// Get the representative of the equivalence class this vertex belongs to.
+    DyckGraphNode *getRepresentative();
 
-    /// Get the target vertices corresponding the label
-    std::set<DyckGraphNode *> *getOutVertices(void *Label);
+    /// Return true if the vertex is the representative of its equivalence class.
+    bool isRepresentative() const { return Parent == this; }
 
-    /// Get a single source vertex corresponding the label
-    /// if there are multiple such vertices or zero, return null
-    DyckGraphNode *getInVertex(void *Label);
-
-    /// Get a single target vertex corresponding the label
-    /// if there are multiple such vertices or zero, return null
+    /// Get a target vertex (resolved to its representative) corresponding the label.
+    /// Return null if there is no such target. After DyckGraph::qirunAlgorithm(), there is at most one.
     DyckGraphNode *getOutVertex(void *Label);
 
-    /// Get the number of vertices that are the targets of this vertex, and have the edge label: label.
+    /// Get the number of (possibly unified) targets of this vertex that have the edge label: label.
     unsigned int outNumVertices(void *Label);
 
-    /// Get the number of vertices that are the sources of this vertex, and have the edge label: label.
-    unsigned int inNumVertices(void *Label);
-
-    /// Total degree of the vertex
-    unsigned int degree();
-
-    /// Get all the labels in the edges that point to the vertex's targets.
-    std::set<void *> &getOutLabels();
-
-    /// Get all the labels in the edges that point to the vertex.
-    std::set<void *> &getInLabels();
-
-    /// Get all the vertex's targets.
-    /// The return value is a map which maps labels to a set of vertices.
-    std::map<void *, std::set<DyckGraphNode *>> &getOutVertices();
+    /// Get all the targets of the vertex grouped by labels.
+    const LabelEdgesTy &getOutVertices();
 
-    /// Get all the vertex's sources.
-    /// The return value is a map which maps labels to a set of vertices.
-    std::map<void *, std::set<DyckGraphNode *>> &getInVertices();
+    /// Get all the targets of the vertex, resolved to their representatives.
+    void getOutVertices(std::set<DyckGraphNode *> &Targets);
 
-    /// Add a target with a label. Meanwhile, this vertex will be a source of ver.
+    /// Add a target with a label.
     void addTarget(DyckGraphNode *Node, void *Label);
 
-    /// Remove a target. Meanwhile, this vertex will be removed from ver's sources
-    void removeTarget(DyckGraphNode *Node, void *Label);
-
-    /// Return true if the vertex contains a target ver, and the edge label is "label"
-    bool containsTarget(DyckGraphNode *Tar, void *Label);
-
-    /// For qirun's algorithm DyckGraph::qirunAlgorithm().
-    /// The representatives of all the vertices in the equivalent set of this vertex
-    /// will be set to be Rep.
-    void mvEquivalentSetTo(DyckGraphNode *RootRep);
-
     /// Get the equivalent set of non-null value.
     /// Use it after you call DyckGraph::qirunAlgorithm().
     std::set<void *> *getEquivalentSet();
 
     /// the equivalent set contains null pointer
-    void setContainsNull() { ContainsNull = true; }
+    void setContainsNull() { getRepresentative()->ContainsNull = true; }
 
     /// return true if the equivalent set contains null pointer
-    bool containsNull() const { return ContainsNull; }
+    bool containsNull() { return getRepresentative()->ContainsNull; }
 
 private:
-    void addSource(DyckGraphNode *, void *Label);
+    EdgeListTy *getOutList(void *Label);
 
-    void removeSource(DyckGraphNode *, void *Label);
+    EdgeListTy &getOrInsertOutList(void *Label);
 };
 
 #endif // DYCKAA_DYCKGRAPHNODE_H
-
@@ -24,6 +24,7 @@
 #include <map>
 #include <set>
 #include <unordered_map>
+#include <vector>
 #include "Support/CFG.h"
 #include "Support/ADT/MapIterators.h"
 
@@ -36,43 +37,88 @@ class DyckModRefAnalysis;
 class Call;
 
 class DyckVFGNode {
+public:
+    /// labeled edge, 0 - epsilon, pos - call, neg - return
+    using EdgeTy = std::pair<DyckVFGNode *, int>;
+
+    using EdgeIterator = const EdgeTy *;
+
 private:
     /// the value this node represents
     Value *V;
 
-    /// labeled edge, 0 - epsilon, pos - call, neg - return
+    /// the index of this node in the graph
+    unsigned Index;
+
+    /// out edges added before the graph is finalized
+    std::vector<EdgeTy> PendingTargets;
+
+    /// the spans of this node in the compressed sparse rows of the graph
     /// @{
-    using EdgeSetTy = std::set<std::pair<DyckVFGNode *, int>>;
-    EdgeSetTy Targets;
-    EdgeSetTy Sources;
+    EdgeIterator TargetBegin = nullptr;
+    EdgeIterator TargetEnd = nullptr;
+    EdgeIterator SourceBegin = nullptr;
+    EdgeIterator SourceEnd = nullptr;
     /// @}
 
+    friend class DyckVFG;
+
 public:
-    explicit DyckVFGNode(Value *V) : V(V) {}
+    DyckVFGNode(Value *V, unsigned Index) : V(V), Index(Index) {}
 
+    /// add an edge, which becomes visible after the graph is finalized
     void addTarget(DyckVFGNode *N, int L = 0) {
         assert(N);
-        this->Targets.emplace(N, L);
-        N->Sources.emplace(this, L);
+        PendingTargets.emplace_back(N, L);
     }
 
     Value *getValue() const { return V; }
 
+    unsigned getIndex() const { return Index; }
+
     Function *getFunction() const;
 
-    EdgeSetTy::const_iterator begin() const { return Targets.begin(); }
+    EdgeIterator begin() const { return TargetBegin; }
+
+    EdgeIterator end() const { return TargetEnd; }
+
+    EdgeIterator in_begin() const { return SourceBegin; }
 
-    EdgeSetTy::const_iterator end() const { return Targets.end(); }
+    EdgeIterator in_end() const { return SourceEnd; }
 
-    EdgeSetTy::const_iterator in_begin() const { return Sources.begin(); }
+    unsigned numTargets() const { return TargetEnd - TargetBegin; }
 
-    EdgeSetTy::const_iterator in_end() const { return Sources.end(); }
+    unsigned numSources() const { return SourceEnd - SourceBegin; }
 };
 
+/// The value flow graph is built with per-node edge buffers and then finalized into a
+/// compressed sparse row (CSR) layout, i.e., an offset array and an edge array for
+/// each direction, so that the edges of a node are a contiguous span.
 class DyckVFG {
 private:
     std::unordered_map<Value *, DyckVFGNode *> ValueNodeMap;
 
+    /// nodes in the order they are created
+    std::vector<DyckVFGNode *> Nodes;
+
+    /// the out (in) edges of the K-th node are TargetEdges (SourceEdges) [Offsets[K], Offsets[K + 1])
+    /// @{
+    std::vector<unsigned> TargetOffsets;
+    std::vector<DyckVFGNode::EdgeTy> TargetEdges;
+    std::vector<unsigned> SourceOffsets;
+    std::vector<DyckVFGNode::EdgeTy> SourceEdges;
+    /// @}
+
+    /// an inter-procedural edge found by a worker, To is null if only the node of From is required.
+    /// the nodes are null if they do not exist when the edge is found
+    struct CallEdge {
+        Value *From;
+        Value *To;
+        DyckVFGNode *FromNode;
+        DyckVFGNode *ToNode;
+        int Label;
+    };
+
 public:
     DyckVFG(DyckAliasAnalysis *DAA, DyckModRefAnalysis *DMRA, Module *M);
 
@@ -84,17 +130,31 @@ public:
 
     value_iterator<std::unordered_map<Value *, DyckVFGNode *>::iterator> node_end() { return {ValueNodeMap.end()}; }
 
+    unsigned numNodes() const { return Nodes.size(); }
+
+    unsigned numEdges() const { return TargetEdges.size(); }
+
+    /// get the node whose index is \p Index
+    DyckVFGNode *getVFGNode(unsigned Index) const { return Nodes[Index]; }
+
+    /// the bytes used by the CSR arrays
+    size_t getEdgeMemoryUsage() const;
+
     /// Dump the Value Flow Graph to a DOT file for visualization
     void dumpToDot(const std::string &FileName) const;
 
 private:
     DyckVFGNode *getOrCreateVFGNode(Value *);
 
-    void connect(DyckModRefAnalysis *, Call *, Function *, CFG *);
+    void connect(DyckModRefAnalysis *, Call *, Function *, CFG *, std::vector<CallEdge> &) const;
 
-    void buildLocalVFG(DyckAliasAnalysis *DAA, CFG *DMRA, Function *F) const;
+    void buildLocalVFG(DyckAliasAnalysis *DAA, CFG *DMRA, Function *F,
+                       std::vector<std::pair<DyckVFGNode *, DyckVFGNode *>> &Edges) const;
 
     void buildLocalVFG(Function &);
+
+    /// freeze the edges into the CSR arrays
+    void finalize();
 };
 
 #endif //ALIAS_DyckAA_DYCKVFG_H
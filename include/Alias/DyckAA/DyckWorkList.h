@@ -0,0 +1,80 @@
+/*
+ *  Canary features a fast unification-based alias analysis for C programs
+ *  Copyright (C) 2021 Qingkai Shi <qingkaishi@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef DYCKAA_DYCKWORKLIST_H
+#define DYCKAA_DYCKWORKLIST_H
+
+#include <llvm/ADT/BitVector.h>
+#include <llvm/ADT/DenseMap.h>
+#include <utility>
+#include <vector>
+
+/// The worklist of DyckGraph::qirunAlgorithm(), i.e., a set of (vertex, label) pairs whose targets
+/// are to be unified. Vertices are identified by their dense indices (DyckGraphNode::getIndex()).
+///
+/// Pending pairs are kept in a dense array that is consumed as a stack. Each vertex has a slot
+/// counting its pending pairs, and a bitmap over the slots answers most membership tests
+/// without touching the index. The index maps a pair to its position in the array, so
+/// push, contains, remove and pop all take constant (expected) time, and a pair is never
+/// queued twice.
+class DyckWorkList {
+public:
+    typedef std::pair<unsigned, void *> ItemTy;
+
+private:
+    /// pending pairs
+    std::vector<ItemTy> Items;
+
+    /// pair -> position in Items
+    llvm::DenseMap<ItemTy, unsigned> Positions;
+
+    /// per-vertex slots: the number of pending pairs of a vertex
+    std::vector<unsigned> Slots;
+
+    /// Membership[N] iff Slots[N] > 0
+    llvm::BitVector Membership;
+
+public:
+    explicit DyckWorkList(unsigned NumVertices = 0) : Slots(NumVertices, 0), Membership(NumVertices) {}
+
+    /// add (vertex, label), return false if it is already in the list
+    bool push(unsigned Vertex, void *Label);
+
+    /// return true if (vertex, label) is in the list
+    bool contains(unsigned Vertex, void *Label) const;
+
+    /// return true if the vertex has any pending label
+    bool contains(unsigned Vertex) const { return Vertex < Membership.size() && Membership.test(Vertex); }
+
+    /// remove (vertex, label), return false if it is not in the list
+    bool remove(unsigned Vertex, void *Label);
+
+    /// remove and return the most recently added pair
+    ItemTy pop();
+
+    bool empty() const { return Items.empty(); }
+
+    unsigned size() const { return Items.size(); }
+
+private:
+    void grow(unsigned Vertex);
+
+    void release(unsigned Vertex);
+};
+
+#endif // DYCKAA_DYCKWORKLIST_H
@@ -21,6 +21,9 @@
 
 #include <llvm/IR/Module.h>
 #include <llvm/Support/CommandLine.h>
+#include <map>
+#include <set>
+#include <vector>
 
 #include "Alias/DyckAA/DyckCallGraph.h"
 #include "Alias/DyckAA/DyckGraph.h"
@@ -28,6 +31,10 @@
 
 using namespace llvm;
 
+/// Mod/ref summaries over the dyck call graph. A function's summary contains the dyck nodes reachable
+/// from its parameters that it or its callees may modify/reference. Summaries are computed bottom-up
+/// over the SCCs of the call graph, a caller composes the summaries of its callees instead of visiting
+/// them again, and the SCCs at the same level (i.e., the same height in the SCC DAG) run in parallel.
 class MRAnalyzer {
 private:
     Module *M;
@@ -35,19 +42,33 @@ private:
     DyckCallGraph *DCG;
     std::map<Function *, ModRef> Func2MR;
 
+    /// the nodes reachable from a set of parameters (sorted) excluding the parameters themselves,
+    /// which is shared by the functions whose parameters are the same aliases, e.g., along a call chain
+    std::map<std::vector<DyckGraphNode *>, std::set<DyckGraphNode *>> ParReachableNodes;
+
+    /// the nodes reachable from the parameters of each function
+    std::map<Function *, const std::set<DyckGraphNode *> *> FuncParReachableNodes;
+
 public:
     MRAnalyzer(Module *, DyckGraph *, DyckCallGraph *);
 
     ~MRAnalyzer();
 
+    /// compute the mod/ref set of each function from its own instructions
     void intraProcedureAnalysis();
 
+    /// compose the mod/ref sets of callees into their callers, bottom-up
     void interProcedureAnalysis();
 
     void swap(std::map<Function *, ModRef> &Result) { Result.swap(Func2MR); }
 
 private:
-    void runOnFunction(DyckCallGraphNode *);
+    void runOnFunction(Function *);
+
+    void runOnSCC(const std::vector<DyckCallGraphNode *> &);
+
+    /// get the SCCs of the call graph grouped by their levels, the callees of an SCC are in lower levels
+    void getSCCLevels(std::vector<std::vector<std::vector<DyckCallGraphNode *>>> &Levels);
 };
 
 #endif //DYCKAA_MRANALYZER_H
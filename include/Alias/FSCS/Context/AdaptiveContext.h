@@ -3,6 +3,7 @@
 #include "Alias/FSCS/Context/Context.h"
 #include "Alias/FSCS/Context/ProgramPoint.h"
 
+#include <shared_mutex>
 #include <unordered_set>
 
 namespace context
@@ -21,6 +22,8 @@ class AdaptiveContext
 {
 private:
 	static std::unordered_set<ProgramPoint> trackedCallsites;  ///< Set of call sites being tracked
+	/// Contexts may be pushed from several threads, so lookups take a shared lock and trackCallSite() an exclusive one
+	static std::shared_timed_mutex trackedMutex;
 public:
 	/**
 	 * @brief Marks a call site to be tracked for context sensitivity
@@ -1,11 +1,10 @@
 #pragma once
 
+#include "Support/ADT/ConcurrentInternTable.h"
 #include "Support/ADT/Hashing.h"
 
 #include <llvm/IR/Instruction.h>
 
-#include <unordered_set>
-
 namespace context
 {
 
@@ -27,7 +26,7 @@ private:
 	const Context* predContext;         ///< The predecessor (caller) context
 	size_t sz;                          ///< The depth of this context in the call stack
 
-	static std::unordered_set<Context> ctxSet;  ///< Global set for context uniquing/interning
+	static util::ConcurrentInternTable<Context> ctxSet;  ///< Global thread-safe table for context uniquing/interning
 
 	/**
 	 * @brief Constructor for the global (empty) context
@@ -112,6 +111,14 @@ public:
 	 * @return A vector of pointers to all contexts
 	 */
 	static std::vector<const Context*> getAllContexts();
+
+	/**
+	 * @brief Frees all contexts at once
+	 *
+	 * Every context pointer obtained before becomes dangling, so this is only
+	 * meant for when an analysis and its clients are done
+	 */
+	static void releaseAll();
 	
 	/**
 	 * @brief Friend declaration to allow the hash specialization to access private members
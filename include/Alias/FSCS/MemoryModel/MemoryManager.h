@@ -4,6 +4,7 @@
 #include "Alias/FSCS/MemoryModel/MemoryBlock.h"
 #include "Alias/FSCS/MemoryModel/MemoryObject.h"
 
+#include <mutex>
 #include <set>
 #include <unordered_map>
 
@@ -22,6 +23,9 @@ private:
 	// Use the slow std::set here because we want the ordering
 	mutable std::set<MemoryObject> objSet;
 
+	// Guards allocMap and objSet, which may grow from several threads
+	mutable std::mutex mutex;
+
 	// uBlock is the memory block representing the location that may points to anywhere. It is of the type byte array
 	static const MemoryBlock uBlock;
 	// nBlock is the memory block representing the location that must be null pointer. Its size is set to zero
@@ -2,6 +2,7 @@
 
 #include "Alias/FSCS/MemoryModel/Pointer.h"
 
+#include <mutex>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -33,6 +34,9 @@ private:
 	using PointerVector = std::vector<const Pointer*>;
 	std::unordered_map<const llvm::Value*, PointerVector> valuePtrMap;
 
+	// Guards ptrSet and valuePtrMap, which may grow from several threads. canonicalizeValue() may create constants in the LLVMContext, so it runs under the lock too
+	mutable std::mutex mutex;
+
 	const Pointer* buildPointer(const context::Context* ctx, const llvm::Value* val);
 public:
 	PointerManager();
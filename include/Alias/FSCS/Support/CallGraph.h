@@ -3,7 +3,9 @@
 #include "Support/ADT/VectorSet.h"
 #include "Support/Iterator/IteratorRange.h"
 
+#include <mutex>
 #include <unordered_map>
+#include <vector>
 
 namespace tpa
 {
@@ -23,6 +25,9 @@ private:
 	CalleeMap calleeMap;
 	CallerMap callerMap;
 
+	// Guards the edge insertions, so that transfer functions running on several threads can add edges. The iterator ranges returned by getCallees() and getCallers() are not guarded; use the snapshots while edges may be added
+	mutable std::mutex mutex;
+
 	template <typename MapType, typename KeyType, typename ValueType>
 	static bool insertMap(MapType& m, const KeyType& k, const ValueType& v)
 	{
@@ -35,9 +40,24 @@ private:
 	}
 public:
 	CallGraph() = default;
+	CallGraph(const CallGraph& other)
+	{
+		std::lock_guard<std::mutex> lock(other.mutex);
+		calleeMap = other.calleeMap;
+		callerMap = other.callerMap;
+	}
+	CallGraph(CallGraph&& other)
+	{
+		std::lock_guard<std::mutex> lock(other.mutex);
+		calleeMap = std::move(other.calleeMap);
+		callerMap = std::move(other.callerMap);
+	}
+	CallGraph& operator=(const CallGraph&) = delete;
+	CallGraph& operator=(CallGraph&&) = delete;
 
 	bool insertEdge(const CallerType& caller, const CalleeType& callee)
 	{
+		std::lock_guard<std::mutex> lock(mutex);
 		auto ret0 = insertMap(calleeMap, caller, callee);
 		auto ret1 = insertMap(callerMap, callee, caller);
 		return ret0 || ret1;
@@ -60,6 +80,26 @@ public:
 	else
 		return util::iteratorRange(itr->second.begin(), itr->second.end());
 	}
+
+	std::vector<CalleeType> getCalleesSnapshot(const CallerType& caller) const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto itr = calleeMap.find(caller);
+		if (itr == calleeMap.end())
+			return std::vector<CalleeType>();
+		else
+			return std::vector<CalleeType>(itr->second.begin(), itr->second.end());
+	}
+
+	std::vector<CallerType> getCallersSnapshot(const CalleeType& callee) const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto itr = callerMap.find(callee);
+		if (itr == callerMap.end())
+			return std::vector<CallerType>();
+		else
+			return std::vector<CallerType>(itr->second.begin(), itr->second.end());
+	}
 };
 
 }
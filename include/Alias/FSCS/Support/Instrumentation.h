@@ -0,0 +1,141 @@
+#pragma once
+
+#include <llvm/Support/raw_ostream.h>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace tpa
+{
+
+// The events of the semi-sparse engine that can be observed
+enum class EngineEvent: unsigned
+{
+	// A top-level successor was enqueued
+	TopLevelPropagation,
+	// A store was propagated to a memory-level successor. The value is 1 if the memo changed and the successor was enqueued, 0 otherwise
+	MemLevelPropagation,
+	// A store was pruned at a call. The value is the number of objects reachable from the callee
+	StorePruning,
+	// A context was pushed at a call. The value is the depth of the new context
+	ContextCreation,
+	// A call did not push a context because of the k-limit. The value is the depth of the context
+	ContextLimitHit,
+	// The precision loss tracker ran. The value is the number of program points that lose precision
+	PrecisionLoss,
+
+	NumEvents
+};
+
+// Counters and hooks for the engine events. The engine reports an event with TPA_RECORD_EVENT(Kind, value), which is compiled only if TPA_INSTRUMENTATION is defined (see the ENABLE_TPA_INSTRUMENTATION CMake option), and otherwise expands to nothing, arguments included. When compiled in, the events are still ignored until setEnabled(true) is called, which -tpa-instrument does before the semi-sparse analysis runs.
+//
+// For each kind of event, the number of events and the sum of their values are aggregated, and writeReport() prints them as JSON.
+class Instrumentation
+{
+public:
+	using Hook = std::function<void(EngineEvent, uint64_t)>;
+private:
+	static constexpr unsigned NumEvents = static_cast<unsigned>(EngineEvent::NumEvents);
+
+	struct State
+	{
+		std::atomic<bool> enabled { false };
+		std::atomic<uint64_t> counts[NumEvents];
+		std::atomic<uint64_t> totals[NumEvents];
+		std::vector<Hook> hooks;
+
+		State()
+		{
+			for (unsigned i = 0; i < NumEvents; ++i)
+			{
+				counts[i] = 0;
+				totals[i] = 0;
+			}
+		}
+	};
+
+	static State& getState()
+	{
+		static State state;
+		return state;
+	}
+public:
+	static const char* getEventName(EngineEvent event)
+	{
+		switch (event)
+		{
+			case EngineEvent::TopLevelPropagation:
+				return "TopLevelPropagation";
+			case EngineEvent::MemLevelPropagation:
+				return "MemLevelPropagation";
+			case EngineEvent::StorePruning:
+				return "StorePruning";
+			case EngineEvent::ContextCreation:
+				return "ContextCreation";
+			case EngineEvent::ContextLimitHit:
+				return "ContextLimitHit";
+			case EngineEvent::PrecisionLoss:
+				return "PrecisionLoss";
+			case EngineEvent::NumEvents:
+				break;
+		}
+		return "Unknown";
+	}
+
+	static void setEnabled(bool e) { getState().enabled.store(e, std::memory_order_relaxed); }
+	static bool isEnabled() { return getState().enabled.load(std::memory_order_relaxed); }
+
+	// Hooks are called on every recorded event, possibly from several threads at once. Add them before the analysis runs
+	static void addHook(Hook hook) { getState().hooks.push_back(std::move(hook)); }
+	static void clearHooks() { getState().hooks.clear(); }
+
+	static void record(EngineEvent event, uint64_t value)
+	{
+		auto& state = getState();
+		if (!state.enabled.load(std::memory_order_relaxed))
+			return;
+
+		auto idx = static_cast<unsigned>(event);
+		state.counts[idx].fetch_add(1, std::memory_order_relaxed);
+		state.totals[idx].fetch_add(value, std::memory_order_relaxed);
+		for (auto const& hook: state.hooks)
+			hook(event, value);
+	}
+
+	static uint64_t getCount(EngineEvent event) { return getState().counts[static_cast<unsigned>(event)].load(std::memory_order_relaxed); }
+	static uint64_t getTotal(EngineEvent event) { return getState().totals[static_cast<unsigned>(event)].load(std::memory_order_relaxed); }
+
+	static void reset()
+	{
+		auto& state = getState();
+		for (unsigned i = 0; i < NumEvents; ++i)
+		{
+			state.counts[i] = 0;
+			state.totals[i] = 0;
+		}
+	}
+
+	// Print {"events": {"<name>": {"count": n, "total": t}, ...}}
+	static void writeReport(llvm::raw_ostream& os)
+	{
+		os << "{\"events\": {";
+		for (unsigned i = 0; i < NumEvents; ++i)
+		{
+			auto event = static_cast<EngineEvent>(i);
+			if (i != 0)
+				os << ", ";
+			os << "\"" << getEventName(event) << "\": {\"count\": " << getCount(event) << ", \"total\": " << getTotal(event) << "}";
+		}
+		os << "}}\n";
+	}
+};
+
+}
+
+#ifdef TPA_INSTRUMENTATION
+#define TPA_RECORD_EVENT(kind, value) ::tpa::Instrumentation::record(::tpa::EngineEvent::kind, (value))
+#else
+#define TPA_RECORD_EVENT(kind, value) ((void)0)
+#endif
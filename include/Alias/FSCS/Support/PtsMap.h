@@ -2,6 +2,8 @@
 
 #include "Alias/FSCS/Support/PtsSet.h"
 
+#include <mutex>
+#include <shared_mutex>
 #include <type_traits>
 #include <unordered_map>
 
@@ -16,12 +18,74 @@ private:
 
 	using MapType = std::unordered_map<T, PtsSet>;
 	MapType mapping;
+
+	// The environment may be updated from several threads. Iteration is not guarded, and is meant for when the analysis is done
+	mutable std::shared_timed_mutex mutex;
+	using ReadLock = std::shared_lock<std::shared_timed_mutex>;
+	using WriteLock = std::unique_lock<std::shared_timed_mutex>;
+
+	bool weakUpdateUnlocked(T key, PtsSet pSet)
+	{
+		auto itr = mapping.find(key);
+		if (itr == mapping.end())
+		{
+			mapping.insert(std::make_pair(key, pSet));
+			return true;
+		}
+		else
+		{
+			auto& set = itr->second;
+			auto newSet = set.merge(pSet);
+			if (newSet == set)
+				return false;
+			else
+			{
+				set = newSet;
+				return true;
+			}
+		}
+	}
 public:
 	using const_iterator = typename MapType::const_iterator;
 
+	PtsMap() = default;
+	PtsMap(const PtsMap& other)
+	{
+		ReadLock lock(other.mutex);
+		mapping = other.mapping;
+	}
+	PtsMap(PtsMap&& other)
+	{
+		WriteLock lock(other.mutex);
+		mapping = std::move(other.mapping);
+	}
+	PtsMap& operator=(const PtsMap& other)
+	{
+		if (this != &other)
+		{
+			WriteLock lock(mutex, std::defer_lock);
+			ReadLock otherLock(other.mutex, std::defer_lock);
+			std::lock(lock, otherLock);
+			mapping = other.mapping;
+		}
+		return *this;
+	}
+	PtsMap& operator=(PtsMap&& other)
+	{
+		if (this != &other)
+		{
+			WriteLock lock(mutex, std::defer_lock);
+			WriteLock otherLock(other.mutex, std::defer_lock);
+			std::lock(lock, otherLock);
+			mapping = std::move(other.mapping);
+		}
+		return *this;
+	}
+
 	PtsSet lookup(T key) const
 	{
 		assert(key != nullptr);
+		ReadLock lock(mutex);
 		auto itr = mapping.find(key);
 		if (itr == mapping.end())
 			return PtsSet::getEmptySet();
@@ -37,6 +101,7 @@ public:
 	{
 		assert(key != nullptr && obj != nullptr);
 
+		WriteLock lock(mutex);
 		auto itr = mapping.find(key);
 		if (itr == mapping.end())
 			itr = mapping.insert(std::make_pair(key, PtsSet::getEmptySet())).first;
@@ -56,30 +121,15 @@ public:
 	{
 		assert(key != nullptr);
 
-		auto itr = mapping.find(key);
-		if (itr == mapping.end())
-		{
-			mapping.insert(std::make_pair(key, pSet));
-			return true;
-		}
-		else
-		{
-			auto& set = itr->second;
-			auto newSet = set.merge(pSet);
-			if (newSet == set)
-				return false;
-			else
-			{
-				set = newSet;
-				return true;
-			}
-		}
+		WriteLock lock(mutex);
+		return weakUpdateUnlocked(key, pSet);
 	}
 
 	bool strongUpdate(T key, PtsSet pSet)
 	{
 		assert(key != nullptr);
 
+		WriteLock lock(mutex);
 		auto itr = mapping.find(key);
 		if (itr == mapping.end())
 		{
@@ -101,14 +151,28 @@ public:
 
 	bool mergeWith(const PtsMap<T>& rhs)
 	{
+		if (this == &rhs)
+			return false;
+
+		WriteLock lock(mutex, std::defer_lock);
+		ReadLock rhsLock(rhs.mutex, std::defer_lock);
+		std::lock(lock, rhsLock);
 		bool ret = false;
-		for (auto const& mapping: rhs)
-			ret |= weakUpdate(mapping.first, mapping.second);
+		for (auto const& mapping: rhs.mapping)
+			ret |= weakUpdateUnlocked(mapping.first, mapping.second);
 		return ret;
 	}
 
-	size_t size() const { return mapping.size(); }
-	bool empty() const { return mapping.empty(); }
+	size_t size() const
+	{
+		ReadLock lock(mutex);
+		return mapping.size();
+	}
+	bool empty() const
+	{
+		ReadLock lock(mutex);
+		return mapping.empty();
+	}
 	const_iterator begin() const { return mapping.begin(); }
 	const_iterator end() const { return mapping.end(); }
 };
@@ -1,10 +1,9 @@
 #pragma once
 
+#include "Support/ADT/ConcurrentInternTable.h"
 #include "Support/ADT/Hashing.h"
 #include "Support/ADT/VectorSet.h"
 
-#include <unordered_set>
-
 namespace tpa
 {
 
@@ -16,7 +15,8 @@ private:
 	using SetType = util::VectorSet<const MemoryObject*>;
 	const SetType* pSet;
 
-	using PtsSetSet = std::unordered_set<SetType, util::ContainerHasher<SetType>>;
+	// Sets are interned in a thread-safe table, so that they can be created by several threads at once
+	using PtsSetSet = util::ConcurrentInternTable<SetType, util::ContainerHasher<SetType>>;
 	static PtsSetSet existingSet;
 	static const SetType* emptySet;
 
@@ -63,6 +63,9 @@ public:
 	static std::vector<const MemoryObject*> intersects(const PtsSet& s0, const PtsSet& s1);
 	static PtsSet mergeAll(const std::vector<PtsSet>&);
 
+	// Free all the sets at once. Every existing PtsSet becomes invalid, so this is only meant for when an analysis and its clients are done
+	static void releaseAll();
+
 	friend std::hash<PtsSet>;
 };
 
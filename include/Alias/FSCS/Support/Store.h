@@ -1,8 +1,76 @@
-#include "Alias/FSCS/Support/PtsMap.h"
+#pragma once
+
+#include "Alias/FSCS/Support/PtsSet.h"
+#include "Support/ADT/PersistentPtrMap.h"
+
+#include <cassert>
 
 namespace tpa
 {
 
-using Store = PtsMap<const MemoryObject*>;
+class MemoryObject;
+
+// The points-to sets of the memory objects at a program point. The engine keeps a store per program point, and most of them differ from their predecessors in a few objects. A store is therefore persistent: copying it is O(1), and an update only copies the path to the updated object, so the stores share the rest of their structure. It has the same interface as PtsMap
+// Only examples/StoreBenchmark measures the memory saved, on a synthetic memo. The FSCS library is not built, so the peak memory of SemiSparsePropagator itself has not been measured
+class Store
+{
+private:
+	using MapType = util::PersistentPtrMap<const MemoryObject*, PtsSet>;
+	MapType mapping;
+
+	static PtsSet mergeSets(PtsSet lhs, const PtsSet& rhs)
+	{
+		return lhs.merge(rhs);
+	}
+public:
+	using const_iterator = MapType::const_iterator;
+
+	PtsSet lookup(const MemoryObject* key) const
+	{
+		assert(key != nullptr);
+		auto set = mapping.lookup(key);
+		if (set == nullptr)
+			return PtsSet::getEmptySet();
+		else
+			return *set;
+	}
+	bool contains(const MemoryObject* key) const
+	{
+		return !lookup(key).empty();
+	}
+
+	bool insert(const MemoryObject* key, const MemoryObject* obj)
+	{
+		assert(key != nullptr && obj != nullptr);
+		return mapping.set(key, lookup(key).insert(obj));
+	}
+
+	bool weakUpdate(const MemoryObject* key, PtsSet pSet)
+	{
+		assert(key != nullptr);
+		return mapping.update(key, pSet, mergeSets);
+	}
+
+	bool strongUpdate(const MemoryObject* key, PtsSet pSet)
+	{
+		assert(key != nullptr);
+		return mapping.set(key, pSet);
+	}
+
+	// The parts shared by the two stores are skipped
+	bool mergeWith(const Store& rhs)
+	{
+		return mapping.merge(rhs.mapping, mergeSets);
+	}
+
+	size_t size() const { return mapping.size(); }
+	bool empty() const { return mapping.empty(); }
+	const_iterator begin() const { return mapping.begin(); }
+	const_iterator end() const { return mapping.end(); }
+
+	// Stores sharing their structure compare without looking at it
+	bool operator==(const Store& rhs) const { return mapping == rhs.mapping; }
+	bool operator!=(const Store& rhs) const { return !(*this == rhs); }
+};
 
-}
\ No newline at end of file
+}
@@ -1,6 +1,7 @@
 #ifndef LOTUS_POINTER_ANALYSIS_INTERFACE_H
 #define LOTUS_POINTER_ANALYSIS_INTERFACE_H
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Value.h"
@@ -34,6 +35,17 @@ public:
                  llvm::MemoryLocation::getBeforeOrAfter(V2));
   }
 
+  /// Query every pair of Values. The result of Values[I] and Values[J] is at
+  /// index I * Values.size() + J. An analysis may override this to answer the
+  /// queries faster than one alias() call per pair
+  virtual std::vector<llvm::AliasResult>
+  aliasMatrix(llvm::ArrayRef<const llvm::Value *> Values);
+
+  /// Query V against each of the Candidates, in order
+  virtual std::vector<llvm::AliasResult>
+  aliasesOf(const llvm::Value *V,
+            llvm::ArrayRef<const llvm::Value *> Candidates);
+
   /// Get the points-to set for a pointer
   virtual std::vector<const llvm::Value*> getPointsToSet(const llvm::Value *Ptr) = 0;
 
@@ -56,6 +68,11 @@ public:
 
   llvm::AliasResult alias(const llvm::MemoryLocation &LocA,
                          const llvm::MemoryLocation &LocB) override;
+  std::vector<llvm::AliasResult>
+  aliasMatrix(llvm::ArrayRef<const llvm::Value *> Values) override;
+  std::vector<llvm::AliasResult>
+  aliasesOf(const llvm::Value *V,
+            llvm::ArrayRef<const llvm::Value *> Candidates) override;
   std::vector<const llvm::Value*> getPointsToSet(const llvm::Value *Ptr) override;
   bool pointsTo(const llvm::Value *Ptr, const llvm::Value *Target) override;
   bool pointsToConstantMemory(const llvm::MemoryLocation &Loc, bool OrLocal = false) override;
@@ -9,6 +9,7 @@ namespace seadsa {
 
 class Graph;
 class DsaCallSite;
+class SummaryCache;
 
 class DsaAllocSite {
 public:
@@ -72,6 +73,7 @@ public:
 
 private:
   friend seadsa::Graph;
+  friend seadsa::SummaryCache;
 
   /// private constructor exposed only to seadsa::Graph
   DsaAllocSite(const seadsa::Graph &g, const llvm::Value &v)
@@ -9,8 +9,10 @@
 #include "Alias/seadsa/CallSite.hh"
 #include "Alias/seadsa/Graph.hh"
 #include "Alias/seadsa/Mapper.hh"
+#include "Alias/seadsa/SummaryCache.hh"
 
 namespace llvm {
+class CallGraphNode;
 class DataLayout;
 class TargetLibraryInfo;
 class TargetLibraryInfoWrapperPass;
@@ -20,6 +22,7 @@ class CallGraph;
 namespace seadsa {
 class AllocWrapInfo;
 class DsaLibFuncInfo;
+class LocalAnalysis;
 
 class BottomUpAnalysis {
 
@@ -37,6 +40,29 @@ private:
   llvm::CallGraph &m_cg;
   bool m_flowSensitiveOpt;
 
+  using SCC = std::vector<llvm::CallGraphNode *>;
+  using SummaryKeys =
+      llvm::DenseMap<const llvm::Function *, SummaryCache::Key>;
+
+  // Return the graph shared between all functions of the scc
+  GraphRef getSCCGraph(const SCC &scc, GraphMap &graphs);
+  // Compute the local graph of the scc into fGraph
+  void runLocalOnSCC(const SCC &scc, Graph &fGraph, LocalAnalysis &la);
+  // Return the key of the graph of the scc in the summary cache, given
+  // the keys of the sccs of its callees, and record it in keys
+  SummaryCache::Key getSummaryKey(const SCC &scc, SummaryCache &cache,
+                                  SummaryKeys &keys);
+  // Clone the graphs of the callees into fGraph, the graph of the
+  // scc. The graphs of the callees outside the scc must be final.
+  void resolveCallsOnSCC(const SCC &scc, Graph *fGraph, GraphMap &graphs);
+  // Same as above for all sccs, in bottom-up order, on numThreads
+  // threads. The graphs are stored in the cache, if any, when done.
+  void resolveCallsInParallel(const std::vector<SCC> &sccs,
+                              const std::vector<GraphRef> &sccGraphs,
+                              const std::vector<SummaryCache::Key> &sccKeys,
+                              SummaryCache *cache, GraphMap &graphs,
+                              unsigned numThreads);
+
 public:
   static void cloneAndResolveArguments(const DsaCallSite &CS, Graph &calleeG,
                                        Graph &callerG,
@@ -53,6 +53,7 @@ public:
   bool isPointer() const { return m_ty && m_ty->isPointerTy(); }
   bool isUnknown() const { return !isOmniType() && !m_ty; }
   bool isOmniType() const { return m_is_omni; }
+  bool isNotImplemented() const { return m_NOT_IMPLEMENTED; }
 
   llvm::Type *getLLVMType() const { return m_ty; }
 
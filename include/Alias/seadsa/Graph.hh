@@ -12,11 +12,12 @@
 #include "llvm/IR/Value.h"
 
 #include "llvm/ADT/DenseMap.h"
-#include "llvm/ADT/ImmutableSet.h"
 
 #include "Alias/seadsa/AllocSite.hh"
 #include "Alias/seadsa/FieldType.hh"
+#include "Alias/seadsa/TypeSet.hh"
 
+#include <atomic>
 #include <functional>
 
 namespace llvm {
@@ -50,10 +51,11 @@ struct DsaAllocatorDeleter {
 
 class Graph {
   friend class Node;
+  friend class SummaryCache;
 
 public:
-  using Set = llvm::ImmutableSet<llvm::Type *>;
-  using SetFactory = typename Set::Factory;
+  using Set = TypeSet;
+  using SetFactory = TypeSetFactory;
 
 protected:
   const llvm::DataLayout &m_dl;
@@ -413,6 +415,7 @@ class Node {
 
   friend class FunctionalMapper;
   friend class SimulationMapper;
+  friend class SummaryCache;
 
 public:
   struct NodeType {
@@ -565,7 +568,10 @@ private:
 
   /// XXX This is ugly. Ids should probably be unique per-graph, not
   /// XXX unique overall. Check with @jnavas before changing this though...
-  static uint64_t m_id_factory;
+  /// Atomic since graphs can be built on several threads (see
+  /// BottomUpAnalysis). The ids of the nodes of one graph still follow
+  /// their creation order.
+  static std::atomic<uint64_t> m_id_factory;
 
   uint64_t m_id; // global id for the node
 
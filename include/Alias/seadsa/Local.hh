@@ -7,6 +7,7 @@
 #include "llvm/Pass.h"
 
 #include "Alias/seadsa/Graph.hh"
+#include "Alias/seadsa/SummaryCache.hh"
 
 namespace llvm {
 class DataLayout;
@@ -40,6 +41,7 @@ class Local : public llvm::ModulePass {
 
   const llvm::DataLayout *m_dl;
   const AllocWrapInfo *m_allocInfo;
+  std::unique_ptr<SummaryCache> m_cache;
 
 public:
   static char ID;
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace llvm {
+class Constant;
+class Function;
+class GlobalValue;
+class Instruction;
+class MemoryBuffer;
+class Module;
+struct SlotMapping;
+class Type;
+class Value;
+} // namespace llvm
+
+namespace seadsa {
+class AllocWrapInfo;
+class Graph;
+
+/**
+ * \brief A cache of the graphs of SeaDsa on disk, reused across runs
+ *
+ * The cache is enabled with -sea-dsa-summary-cache=<dir>. A graph is
+ * stored under a key that hashes everything it is computed from: the
+ * options of the analysis, the target, the functions it summarizes
+ * and, for a bottom-up graph, the keys of the graphs of the callees.
+ * Editing a function therefore invalidates its graph and the graphs
+ * of its callers, and nothing else.
+ *
+ * The functions are hashed structurally: renaming local values or
+ * changing debug information keeps the key. For this reason, a
+ * stored graph refers to arguments and instructions by their position
+ * in their function, and to globals by name.
+ *
+ * The graphs are kept in one file of <dir> per module and per client
+ * of the cache, in a compact binary encoding, and the file is read
+ * at once when the cache is created. save() replaces it with the
+ * graphs loaded or stored since, so that it holds the graphs of the
+ * last run only.
+ *
+ * Computing the keys and loading graphs must be done on one thread,
+ * since loading creates types and constants in the LLVM context.
+ * Storing graphs is thread-safe.
+ **/
+class SummaryCache {
+public:
+  /// An empty key means the graph cannot be cached
+  using Key = std::string;
+
+  /// Return true if a cache directory is given
+  static bool isEnabled();
+
+  /// client names the user of the cache, such as "bu"
+  SummaryCache(llvm::Module &M, const AllocWrapInfo &allocInfo,
+               llvm::StringRef client);
+  ~SummaryCache();
+
+  /// Return the key of the local graph of F
+  Key getLocalKey(const llvm::Function &F);
+
+  /// Return the key of the bottom-up graph shared by fns, the functions
+  /// of an scc, given the keys of the graphs of their callees
+  Key getBottomUpKey(llvm::ArrayRef<const llvm::Function *> fns,
+                     llvm::ArrayRef<Key> calleeKeys, bool flowSensitiveOpt);
+
+  /// Load the graph stored under key into g, which must be empty.
+  /// Return false, leaving g empty, if there is no such graph or it
+  /// cannot be read.
+  bool load(const Key &key, Graph &g);
+
+  /// Store g under key. Return false if g refers to a value that
+  /// cannot be named across runs, in which case it is not stored.
+  bool store(const Key &key, const Graph &g);
+
+  /// Write the graphs loaded or stored so far to the cache directory.
+  /// Return false on errors, leaving the directory as it was.
+  bool save();
+
+  unsigned numHits() const { return m_hits; }
+  unsigned numMisses() const { return m_misses; }
+  unsigned numStores() const { return m_stores; }
+
+private:
+  llvm::Module &m_module;
+  /// hash of the options and of the module-wide parts of the key
+  std::string m_config;
+  /// the file of the graphs, and its contents when the cache was
+  /// created, indexed by key
+  std::string m_file;
+  std::unique_ptr<llvm::MemoryBuffer> m_buffer;
+  llvm::StringMap<llvm::StringRef> m_found;
+  /// the graphs to save
+  llvm::StringMap<std::string> m_kept;
+  std::mutex m_keptMutex;
+
+  /// structural hashes of functions
+  llvm::DenseMap<const llvm::Function *, std::string> m_fnHashes;
+  /// structural hashes of struct and function types and of globals,
+  /// shared by the hashes of the functions
+  llvm::DenseMap<const llvm::Type *, std::string> m_typeHashes;
+  llvm::DenseMap<const llvm::GlobalValue *, std::string> m_globalHashes;
+  /// position of every instruction in its function, and back. A
+  /// function is numbered when a graph first refers to it.
+  llvm::DenseMap<const llvm::Instruction *, unsigned> m_instIndex;
+  llvm::DenseMap<const llvm::Function *,
+                 std::vector<const llvm::Instruction *>>
+      m_insts;
+  std::mutex m_instsMutex;
+  /// named types of the module, and constants parsed while loading
+  std::unique_ptr<llvm::SlotMapping> m_slots;
+  llvm::StringMap<llvm::Constant *> m_constants;
+
+  std::atomic<unsigned> m_hits{0};
+  std::atomic<unsigned> m_misses{0};
+  std::atomic<unsigned> m_stores{0};
+
+  const std::string &getFunctionHash(const llvm::Function &F);
+  llvm::SlotMapping &getSlots();
+  const llvm::Instruction *getInstruction(const llvm::Function &F,
+                                          size_t idx);
+  bool getInstructionIndex(const llvm::Instruction &I, unsigned &out);
+
+  /// Encode and decode graphs
+  class Encoder;
+  class Decoder;
+  bool write(const Graph &g, std::string &out);
+  bool read(llvm::StringRef in, Graph &g);
+};
+
+} // namespace seadsa
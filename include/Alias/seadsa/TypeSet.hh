@@ -0,0 +1,95 @@
+#pragma once
+
+#include "llvm/ADT/Hashing.h"
+
+#include "Support/ADT/ConcurrentInternTable.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace llvm {
+class Type;
+} // namespace llvm
+
+namespace seadsa {
+
+/// An immutable set of types, used for the types accessed at each
+/// offset of a node.
+///
+/// The sets are hash-consed by a TypeSetFactory: a set is a pointer to
+/// its sorted elements, so it is copied and compared in constant
+/// time. Unlike llvm::ImmutableSet, a set has no reference count and
+/// the factory can be shared by graphs built on different threads.
+class TypeSet {
+  friend class TypeSetFactory;
+
+public:
+  using value_type = llvm::Type *;
+  using Elements = std::vector<llvm::Type *>;
+  using iterator = Elements::const_iterator;
+
+private:
+  const Elements *m_elems;
+
+  static const Elements &emptyElements() {
+    static const Elements empty;
+    return empty;
+  }
+
+  explicit TypeSet(const Elements *elems) : m_elems(elems) {}
+
+public:
+  TypeSet() : m_elems(&emptyElements()) {}
+
+  /// Types are ordered by address, as in llvm::ImmutableSet
+  iterator begin() const { return m_elems->begin(); }
+  iterator end() const { return m_elems->end(); }
+
+  bool isEmpty() const { return m_elems->empty(); }
+  bool isSingleton() const { return m_elems->size() == 1; }
+  unsigned size() const { return m_elems->size(); }
+
+  bool contains(const llvm::Type *t) const {
+    return std::binary_search(begin(), end(), const_cast<llvm::Type *>(t));
+  }
+
+  bool operator==(const TypeSet &o) const { return m_elems == o.m_elems; }
+  bool operator!=(const TypeSet &o) const { return m_elems != o.m_elems; }
+};
+
+/// Creates the sets of types. Thread-safe.
+///
+/// The sets live as long as the factory, which must therefore outlive
+/// the graphs using it.
+class TypeSetFactory {
+  struct ElementsHash {
+    size_t operator()(const TypeSet::Elements &elems) const {
+      return llvm::hash_combine_range(elems.begin(), elems.end());
+    }
+  };
+
+  util::ConcurrentInternTable<TypeSet::Elements, ElementsHash> m_table;
+
+public:
+  TypeSetFactory() = default;
+  TypeSetFactory(const TypeSetFactory &) = delete;
+  TypeSetFactory &operator=(const TypeSetFactory &) = delete;
+
+  TypeSet getEmptySet() const { return TypeSet(); }
+
+  /// return the union of old and a set containing t
+  TypeSet add(TypeSet old, const llvm::Type *t) {
+    llvm::Type *ty = const_cast<llvm::Type *>(t);
+    auto it = std::lower_bound(old.begin(), old.end(), ty);
+    if (it != old.end() && *it == ty) return old;
+
+    TypeSet::Elements elems;
+    elems.reserve(old.size() + 1);
+    elems.insert(elems.end(), old.begin(), it);
+    elems.push_back(ty);
+    elems.insert(elems.end(), it, old.end());
+    return TypeSet(m_table.intern(std::move(elems)));
+  }
+};
+
+} // namespace seadsa
@@ -17,6 +17,7 @@
 #include <unordered_map>
 
 #include "BitVector.h"
+#include "GraphFile.h"
 
 using namespace std;
 
@@ -110,12 +111,16 @@ public:
 
     explicit Graph(istream &);
 
+    explicit Graph(const GraphFile &);
+
     Graph(GRA &, VertexList &);
 
     ~Graph();
 
     void readGraph(istream &);
 
+    void readGraph(const GraphFile &);
+
     void writeGraph(ostream &);
 
     void printGraph();
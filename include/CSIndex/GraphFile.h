@@ -0,0 +1,90 @@
+#ifndef _GRAPH_FILE_H
+#define _GRAPH_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class Graph;
+
+/// The binary graph format, the counterpart of the graph_for_greach text format.
+/// All integers are little-endian, and each section starts at an 8-byte aligned
+/// position recorded in the header:
+///   offsets   uint64[n + 1], the out edges of v are targets[offsets[v] .. offsets[v + 1])
+///   targets   int32[m]
+///   labels    int32[m], the call-site label of each edge, 0 for none (GF_LABELS)
+///   func ids  int32[n], the function of each vertex (GF_FUNC_IDS)
+struct GraphFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t num_vertices;
+    uint64_t num_edges;
+    uint64_t offsets_pos;
+    uint64_t targets_pos;
+    uint64_t labels_pos;
+    uint64_t func_ids_pos;
+    uint64_t file_size;
+    uint32_t checksum;    // FNV-1a of the header bytes before it
+    uint32_t reserved;
+};
+
+enum GraphFileFlags : uint32_t {
+    GF_LABELS = 1,
+    GF_FUNC_IDS = 2
+};
+
+/// A read-only view of a binary graph file. The file is mapped, not read, so
+/// opening it costs one pass over the offsets and the targets for validation,
+/// and the arrays point into the mapping.
+class GraphFile {
+public:
+    GraphFile() = default;
+
+    ~GraphFile();
+
+    GraphFile(const GraphFile &) = delete;
+
+    GraphFile &operator=(const GraphFile &) = delete;
+
+    // false, with the reason in error(), if path is not a valid graph file
+    bool open(const std::string &path);
+
+    void close();
+
+    // whether path starts with the magic of the binary format
+    static bool isGraphFile(const std::string &path);
+
+    // writes g, with its edge labels and function ids, in the binary format
+    static bool write(Graph &g, const std::string &path, std::string &error);
+
+    const std::string &error() const { return err; }
+
+    int num_vertices() const { return (int) header->num_vertices; }
+
+    size_t num_edges() const { return header->num_edges; }
+
+    const uint64_t *offsets() const { return (const uint64_t *) (base + header->offsets_pos); }
+
+    const int32_t *targets() const { return (const int32_t *) (base + header->targets_pos); }
+
+    // nullptr if the file has no labels
+    const int32_t *labels() const {
+        return (header->flags & GF_LABELS) ? (const int32_t *) (base + header->labels_pos) : nullptr;
+    }
+
+    // nullptr if the file has no function ids
+    const int32_t *func_ids() const {
+        return (header->flags & GF_FUNC_IDS) ? (const int32_t *) (base + header->func_ids_pos) : nullptr;
+    }
+
+private:
+    bool fail(const std::string &msg);
+
+    const char *base = nullptr;
+    size_t size = 0;
+    const GraphFileHeader *header = nullptr;
+    std::string err;
+};
+
+#endif
@@ -14,10 +14,10 @@ namespace pdg
     void getAnalysisUsage(llvm::AnalysisUsage &AU) const override;
     llvm::StringRef getPassName() const override { return "Control Dependency Graph"; }
     bool runOnFunction(llvm::Function &F) override;
-    void addControlDepFromNodeToBB(Node &n, llvm::BasicBlock &bb, EdgeType edge_type);
-    void addControlDepFromEntryNodeToInsts(llvm::Function &F);
-    void addControlDepFromDominatedBlockToDominator(llvm::Function &F);
-  private:
-    llvm::PostDominatorTree *_PDT;
+    // only touch the nodes of F, so functions can be handled in parallel
+    static void addControlDependencies(llvm::Function &F, llvm::PostDominatorTree &PDT);
+    static void addControlDepFromNodeToBB(Node &n, llvm::BasicBlock &bb, EdgeType edge_type);
+    static void addControlDepFromEntryNodeToInsts(llvm::Function &F);
+    static void addControlDepFromDominatedBlockToDominator(llvm::Function &F, llvm::PostDominatorTree &PDT);
   };
 } // namespace pdg
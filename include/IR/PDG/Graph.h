@@ -52,6 +52,16 @@ namespace pdg
     bool _is_build = false;
   };
 
+  // The nodes of a function, built apart from the program graph so that the
+  // fragments of different functions can be built in parallel. They are then
+  // added to the graph in module order, so the graph does not depend on the
+  // number of threads.
+  struct FunctionFragment
+  {
+    FunctionWrapper *func_w = nullptr;
+    std::vector<std::pair<llvm::Value *, Node *>> inst_nodes;
+  };
+
   class ProgramGraph : public GenericGraph
   {
   public:
@@ -77,9 +87,13 @@ namespace pdg
     void build(llvm::Module &M) override;
     bool hasFuncWrapper(llvm::Function &F) { return _func_wrapper_map.find(&F) != _func_wrapper_map.end(); }
     bool hasCallWrapper(llvm::CallInst &ci) { return _call_wrapper_map.find(&ci) != _call_wrapper_map.end(); }
-    FunctionWrapper *getFuncWrapper(llvm::Function &F) { return _func_wrapper_map[&F]; }
+    FunctionWrapper *getFuncWrapper(llvm::Function &F);
     CallWrapper *getCallWrapper(llvm::CallInst &ci) { return _call_wrapper_map[&ci]; }
+    FunctionFragment buildFunctionFragment(llvm::Function &F);
+    void mergeFunctionFragment(FunctionFragment &fragment);
     void bindDITypeToNodes(llvm::Module &M);
+    void bindDITypeToAddrVars(FunctionWrapper &fw);
+    void bindDITypeToInsts(llvm::Function &F);
     llvm::DIType *computeNodeDIType(Node &n);
     void addTreeNodesToGraph(Tree &tree);
     void addFormalTreeNodesToGraph(FunctionWrapper &func_w);
@@ -5,4 +5,5 @@ namespace pdg
   extern bool DOTONLYDDG;
   extern bool DOTONLYCDG;
   extern bool DEBUG;
+  extern unsigned NUMTHREADS;
 }
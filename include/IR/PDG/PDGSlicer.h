@@ -0,0 +1,60 @@
+#pragma once
+#include "IR/PDG/PDGSnapshot.h"
+
+#include <memory>
+#include <set>
+#include <vector>
+
+namespace pdg
+{
+  enum class SliceKind
+  {
+    BACKWARD,
+    FORWARD,
+    // backward, along the edges that produce the value only: no control
+    // dependences and no flows of the base pointer of a load or store
+    THIN
+  };
+
+  // Slices a PDG snapshot. The walks match the parameter, call and return
+  // edges of a call site with each other: a path that enters a callee through
+  // one call site only returns through the same call site. The call strings are
+  // cut to the last context_depth call sites, and a return with an empty call
+  // string goes to every caller, so deep paths lose precision, not soundness.
+  //
+  // The slicer only reads the snapshot, so slices can be taken in parallel.
+  class PDGSlicer
+  {
+  public:
+    using NodeID = PDGSnapshot::NodeID;
+    // the ids of the nodes in a slice, sorted
+    using Slice = std::vector<NodeID>;
+
+    PDGSlicer(ProgramGraph &g, PDGSnapshot &snapshot, unsigned context_depth = 3);
+    Slice slice(const std::vector<Node *> &criteria, SliceKind kind) const;
+    // the nodes on the paths from sources to sinks
+    Slice chop(const std::vector<Node *> &sources, const std::vector<Node *> &sinks) const;
+    // one slice per criteria set, taken on -pdg-threads threads
+    std::vector<Slice> sliceEach(const std::vector<std::vector<Node *>> &criteria, SliceKind kind) const;
+    std::set<llvm::Instruction *> getInstructions(const Slice &slice) const;
+    // a copy of M keeping the instructions in insts and the terminators; the
+    // uses of the removed instructions are replaced with undef
+    static std::unique_ptr<llvm::Module> buildSlicedModule(llvm::Module &M, const std::set<llvm::Instruction *> &insts);
+
+  private:
+    Slice walk(const std::vector<Node *> &starts, bool backward, bool thin) const;
+    void classifyEdge(NodeID src, NodeID dst, EdgeType kind, unsigned &site, char &into_callee, char &thin) const;
+
+    PDGSnapshot &_snapshot;
+    unsigned _context_depth;
+    // the call site node of the call nodes and actual tree nodes, and the caller
+    std::vector<NodeID> _call_site;
+    std::vector<llvm::Function *> _caller;
+    // per out-edge and per in-edge: the call site an interprocedural edge
+    // belongs to, whether it points from the caller into the callee, and
+    // whether thin slices take it
+    std::vector<unsigned> _out_site, _in_site;
+    std::vector<char> _out_into_callee, _in_into_callee;
+    std::vector<char> _out_thin, _in_thin;
+  };
+} // namespace pdg
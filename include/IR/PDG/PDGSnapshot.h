@@ -0,0 +1,103 @@
+#pragma once
+#include "IR/PDG/Graph.h"
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class Graph;
+class Grail;
+
+namespace pdg
+{
+  // An immutable copy of a PDG in compressed sparse row form. Every node gets a
+  // dense id, and the in- and out-edges of a node are contiguous ranges of the
+  // edge arrays, each edge carrying its EdgeType. Reachability queries take a
+  // mask of the edge kinds a path may use.
+  //
+  // canReach walks the CSR with an epoch-stamped visited array and prunes the
+  // nodes of functions from which the function of the sink cannot be reached
+  // in the function-level graph. buildReachIndex additionally builds a Grail
+  // index on the SCC-condensed graph of one edge mask, which then answers the
+  // queries with that mask without a graph walk.
+  //
+  // The queries reuse scratch state, so a snapshot must not be queried from
+  // several threads at once.
+  class PDGSnapshot
+  {
+  public:
+    using NodeID = unsigned;
+    using EdgeKindMask = uint32_t;
+    static constexpr NodeID InvalidID = ~0u;
+    static constexpr EdgeKindMask AllEdgeKinds = ~0u;
+    static EdgeKindMask kindBit(EdgeType edge_type) { return 1u << static_cast<unsigned>(edge_type); }
+    static EdgeKindMask excludeKinds(const std::set<EdgeType> &exclude_edge_types);
+
+    explicit PDGSnapshot(GenericGraph &g);
+    ~PDGSnapshot();
+    PDGSnapshot(const PDGSnapshot &) = delete;
+    PDGSnapshot &operator=(const PDGSnapshot &) = delete;
+
+    unsigned numNodes() const { return _nodes.size(); }
+    unsigned numEdges() const { return _out_dst.size(); }
+    NodeID getID(Node &n) const;
+    Node *getNode(NodeID id) const { return _nodes[id]; }
+    // the function unit of a node; unit 0 holds the nodes outside any function
+    unsigned getUnit(NodeID id) const { return _node_unit[id]; }
+    unsigned numUnits() const { return _unit_funcs.size(); }
+    llvm::Function *getUnitFunc(unsigned unit) const { return _unit_funcs[unit]; }
+
+    // out-edges of n are [outBegin(n), outEnd(n)), in-edges [inBegin(n), inEnd(n))
+    unsigned outBegin(NodeID id) const { return _out_offsets[id]; }
+    unsigned outEnd(NodeID id) const { return _out_offsets[id + 1]; }
+    NodeID outDst(unsigned e) const { return _out_dst[e]; }
+    EdgeType outKind(unsigned e) const { return static_cast<EdgeType>(_out_kind[e]); }
+    unsigned inBegin(NodeID id) const { return _in_offsets[id]; }
+    unsigned inEnd(NodeID id) const { return _in_offsets[id + 1]; }
+    NodeID inSrc(unsigned e) const { return _in_src[e]; }
+    EdgeType inKind(unsigned e) const { return static_cast<EdgeType>(_in_kind[e]); }
+
+    bool canReach(Node &src, Node &dst, EdgeKindMask mask = AllEdgeKinds);
+    bool canReach(NodeID src, NodeID dst, EdgeKindMask mask = AllEdgeKinds);
+    // build a Grail index answering the queries whose mask is exactly mask
+    void buildReachIndex(EdgeKindMask mask = AllEdgeKinds, int grail_dim = 2);
+    bool hasReachIndex() const { return _grail != nullptr; }
+
+  private:
+    bool searchReach(NodeID src, NodeID dst, EdgeKindMask mask);
+    void computeUnitsReaching(unsigned dst_unit, EdgeKindMask mask);
+    void releaseReachIndex();
+
+    std::vector<Node *> _nodes;
+    std::unordered_map<Node *, NodeID> _node_ids;
+    std::vector<unsigned> _out_offsets;
+    std::vector<NodeID> _out_dst;
+    std::vector<uint8_t> _out_kind;
+    std::vector<unsigned> _in_offsets;
+    std::vector<NodeID> _in_src;
+    std::vector<uint8_t> _in_kind;
+
+    // function-level graph, kept as in-edges with the union of the edge kinds
+    // between two units, for the backward pruning walk
+    std::vector<unsigned> _node_unit;
+    std::vector<llvm::Function *> _unit_funcs;
+    std::vector<unsigned> _unit_in_offsets;
+    std::vector<unsigned> _unit_in_src;
+    std::vector<EdgeKindMask> _unit_in_kinds;
+    // the units reaching the unit of the last sink, cached per (unit, mask)
+    std::vector<char> _unit_reaches_dst;
+    unsigned _pruned_dst_unit = ~0u;
+    EdgeKindMask _pruned_mask = 0;
+
+    std::vector<unsigned> _visit_epoch;
+    unsigned _epoch = 0;
+    std::vector<NodeID> _stack;
+
+    // Grail index over the SCC-condensed graph of _index_mask
+    std::unique_ptr<Graph> _dag;
+    std::unique_ptr<Grail> _grail;
+    std::vector<int> _scc_of_node;
+    EdgeKindMask _index_mask = 0;
+  };
+} // namespace pdg
@@ -2,6 +2,8 @@
 
 #include "IR/PDG/LLVMEssentials.h"
 #include "IR/PDG/Tree.h"
+#include <functional>
+#include <mutex>
 #include <vector>
 #include <set>
 #include <unordered_set>
@@ -36,5 +38,12 @@ namespace pdg
     std::string getNodeTypeStr(GraphNodeType node_type);
     std::string getEdgeTypeStr(EdgeType edge_type);
     std::string& rtrim(std::string& s, const char* t = "\t\n\r\f\v");
+    // run task(0), ..., task(num_tasks - 1) on -pdg-threads threads
+    void runInParallel(unsigned num_tasks, const std::function<void(unsigned)> &task);
+    // compute the layouts of the structs accessed by geps, which the data
+    // layout otherwise caches lazily, and not thread-safely
+    void cacheStructLayouts(llvm::Module &M);
+    // held by tasks run in parallel while they print to errs()
+    std::mutex &getErrsMutex();
   } // namespace pdgutils
 } // namespace pdg
@@ -17,13 +17,15 @@ namespace pdg
       void getAnalysisUsage(llvm::AnalysisUsage &AU) const override;
       ProgramGraph *getPDG() { return _PDG; }
       llvm::StringRef getPassName() const override { return "Program Dependency Graph"; }
-      FunctionWrapper *getFuncWrapper(llvm::Function &F) { return _PDG->getFuncWrapperMap()[&F]; }
+      FunctionWrapper *getFuncWrapper(llvm::Function &F) { return _PDG->getFuncWrapper(F); }
       CallWrapper *getCallWrapper(llvm::CallInst &call_inst) { return _PDG->getCallWrapperMap()[&call_inst]; }
       void connectGlobalWithUses();
       void connectInTrees(Tree *src_tree, Tree *dst_tree, EdgeType edge_type);
       void connectOutTrees(Tree *src_tree, Tree *dst_tree, EdgeType edge_type);
       void connectCallerAndCallee(CallWrapper &cw, FunctionWrapper &fw);
       void connectIntraprocDependencies(llvm::Function &F);
+      bool connectLocalIntraprocDependencies(llvm::Function &F);
+      void connectRetTreesWithAddrVars(llvm::Function &F);
       void connectInterprocDependencies(llvm::Function &F);
       void connectClassNodeWithClassMethods(llvm::Function &F);
       void connectFormalInTreeWithAddrVars(Tree &formal_in_tree);
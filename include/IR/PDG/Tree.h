@@ -65,8 +65,8 @@ namespace pdg
     void setBaseVal(llvm::Value &v) { _base_val = &v; }
 
   private:
-    llvm::Value* _base_val;
-    TreeNode *_root_node;
-    int _size;
+    llvm::Value* _base_val = nullptr;
+    TreeNode *_root_node = nullptr;
+    int _size = 0;
   };
 } // namespace pdg
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace util
+{
+
+// A hash-consing table that can be used from several threads at once. intern() returns the unique copy of a value, whose address is stable until the table is cleared.
+//
+// The table is split into shards by hash, and each shard has its own lock, so threads interning different values seldom wait for each other. A value is hashed once: each shard indexes its values with an open-addressing table that keeps their hashes, so growing the index does not hash them again.
+template <typename T, typename Hasher = std::hash<T>, typename KeyEqual = std::equal_to<T>, unsigned NumShards = 64>
+class ConcurrentInternTable
+{
+private:
+	static_assert(NumShards > 1 && (NumShards & (NumShards - 1)) == 0, "The number of shards must be a power of two");
+
+	// A slot of the open-addressing index of a shard. An empty slot has a null value
+	struct Slot
+	{
+		size_t hash;
+		const T* value;
+	};
+
+	struct Shard
+	{
+		std::mutex mutex;
+		// A deque does not move its elements when it grows
+		std::deque<T> values;
+		// Linear probing over a power-of-two number of slots, at most half full
+		std::vector<Slot> slots;
+	};
+
+	Shard shards[NumShards];
+	Hasher hasher;
+	KeyEqual equal;
+
+	static constexpr unsigned shardBits()
+	{
+		unsigned bits = 0;
+		for (unsigned n = NumShards; n > 1; n >>= 1)
+			++bits;
+		return bits;
+	}
+
+	Shard& getShard(size_t hash)
+	{
+		// The low bits of the hash pick a slot within the shard, so use the high ones here
+		uint64_t mixed = static_cast<uint64_t>(hash) * 0x9e3779b97f4a7c15ULL;
+		return shards[mixed >> (64 - shardBits())];
+	}
+
+	static void insertSlot(std::vector<Slot>& slots, size_t hash, const T* value)
+	{
+		size_t mask = slots.size() - 1;
+		size_t i = hash & mask;
+		while (slots[i].value != nullptr)
+			i = (i + 1) & mask;
+		slots[i] = { hash, value };
+	}
+
+	// Double the slots of a shard, without hashing the values again
+	static void grow(Shard& shard)
+	{
+		std::vector<Slot> newSlots(shard.slots.empty() ? 16 : shard.slots.size() * 2, Slot{ 0, nullptr });
+		for (auto const& slot: shard.slots)
+			if (slot.value != nullptr)
+				insertSlot(newSlots, slot.hash, slot.value);
+		shard.slots.swap(newSlots);
+	}
+
+	template <typename Value, typename Prepare>
+	const T* internImpl(Value&& value, Prepare&& prepare)
+	{
+		size_t hash = hasher(value);
+		Shard& shard = getShard(hash);
+
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		if (!shard.slots.empty())
+		{
+			size_t mask = shard.slots.size() - 1;
+			for (size_t i = hash & mask; shard.slots[i].value != nullptr; i = (i + 1) & mask)
+			{
+				const Slot& slot = shard.slots[i];
+				if (slot.hash == hash && equal(*slot.value, value))
+					return slot.value;
+			}
+		}
+
+		if ((shard.values.size() + 1) * 2 > shard.slots.size())
+			grow(shard);
+		shard.values.push_back(std::forward<Value>(value));
+		T& stored = shard.values.back();
+		prepare(stored);
+		insertSlot(shard.slots, hash, &stored);
+		return &stored;
+	}
+
+	struct NoPrepare
+	{
+		void operator()(T&) const {}
+	};
+public:
+	ConcurrentInternTable() = default;
+	ConcurrentInternTable(const ConcurrentInternTable&) = delete;
+	ConcurrentInternTable& operator=(const ConcurrentInternTable&) = delete;
+
+	// Return the unique copy of value, which is added to the table if it is not there
+	const T* intern(const T& value)
+	{
+		return internImpl(value, NoPrepare());
+	}
+	const T* intern(T&& value)
+	{
+		return internImpl(std::move(value), NoPrepare());
+	}
+
+	// Same as above, except that prepare(T&) is applied to the value when it is added. It must not change the hash of the value
+	template <typename Prepare>
+	const T* intern(T&& value, Prepare&& prepare)
+	{
+		return internImpl(std::move(value), std::forward<Prepare>(prepare));
+	}
+
+	// The number of unique values. Not exact if other threads are interning
+	size_t size()
+	{
+		size_t ret = 0;
+		for (auto& shard: shards)
+		{
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			ret += shard.values.size();
+		}
+		return ret;
+	}
+
+	// Call f(const T&) on every value in the table
+	template <typename Function>
+	void forEach(Function&& f)
+	{
+		for (auto& shard: shards)
+		{
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			for (auto const& value: shard.values)
+				f(value);
+		}
+	}
+
+	// Release all the values at once. Every pointer returned by intern() becomes dangling, so this is only meant for when all the users of the table are done
+	void clear()
+	{
+		for (auto& shard: shards)
+		{
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			std::deque<T>().swap(shard.values);
+			std::vector<Slot>().swap(shard.slots);
+		}
+	}
+};
+
+}
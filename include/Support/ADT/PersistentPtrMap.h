@@ -0,0 +1,494 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace util
+{
+
+// A persistent map from pointers to small values. Copying a map is O(1), and an update copies only the O(log n) nodes on the path to the updated key, so the copies share the rest of their structure.
+//
+// The map is a compressed hash-array mapped trie (CHAMP). Each node has 32 slots, each of which is empty, an entry, or a child node holding the keys that share the slot. Keys are hashed with a bijection, so two keys never have the same hash and the trie needs no collision nodes. Since a slot has a child iff at least two keys fall into it, the shape of the trie only depends on its keys. Two equal maps thus have the same shape, and maps sharing a node share all of its keys and values, which lets equality and merging skip the shared parts.
+//
+// Nodes are reference-counted with atomic counters, so maps can be read and copied from several threads as long as each map object is only updated by one of them.
+template <typename K, typename V>
+class PersistentPtrMap
+{
+private:
+	static_assert(std::is_pointer<K>::value, "PersistentPtrMap only accepts pointers as keys");
+	static_assert(std::is_trivially_destructible<V>::value, "PersistentPtrMap only accepts trivially destructible values");
+
+	static constexpr unsigned BitsPerLevel = 5;
+	// The hash has 64 bits, which takes 13 levels
+	static constexpr unsigned MaxDepth = (64 + BitsPerLevel - 1) / BitsPerLevel;
+public:
+	using value_type = std::pair<K, V>;
+private:
+	struct alignas(alignof(value_type) > alignof(void*) ? alignof(value_type) : alignof(void*)) Node
+	{
+		std::atomic<unsigned> refs;
+		// The slots holding an entry, and those holding a child
+		uint32_t dataMap, nodeMap;
+		// The number of entries in the subtrie
+		unsigned count;
+
+		// The entries, in slot order, are followed by the children, in slot order
+		value_type* entries() { return reinterpret_cast<value_type*>(this + 1); }
+		const value_type* entries() const { return reinterpret_cast<const value_type*>(this + 1); }
+		Node** children() { return reinterpret_cast<Node**>(entries() + numEntries()); }
+		Node* const* children() const { return reinterpret_cast<Node* const*>(entries() + numEntries()); }
+
+		unsigned numEntries() const { return popcount(dataMap); }
+		unsigned numChildren() const { return popcount(nodeMap); }
+	};
+
+	Node* root;
+
+	static unsigned popcount(uint32_t bits) { return __builtin_popcount(bits); }
+	// The position, among the bits of map, of bit
+	static unsigned indexOf(uint32_t map, uint32_t bit) { return popcount(map & (bit - 1)); }
+
+	// A bijective mix of the pointer, so that the low bits, which are the first consumed, are not all zeros due to alignment
+	static uint64_t hashOf(K key)
+	{
+		uint64_t h = reinterpret_cast<uintptr_t>(key);
+		h = (h ^ (h >> 33)) * 0xff51afd7ed558ccdULL;
+		h = (h ^ (h >> 33)) * 0xc4ceb9fe1a85ec53ULL;
+		return h ^ (h >> 33);
+	}
+	static uint32_t slotBit(uint64_t hash, unsigned level)
+	{
+		return 1u << ((hash >> (level * BitsPerLevel)) & 31);
+	}
+
+	static Node* allocate(uint32_t dataMap, uint32_t nodeMap, unsigned count)
+	{
+		size_t bytes = sizeof(Node) + popcount(dataMap) * sizeof(value_type) + popcount(nodeMap) * sizeof(Node*);
+		Node* node = new (::operator new(bytes)) Node;
+		node->refs.store(1, std::memory_order_relaxed);
+		node->dataMap = dataMap;
+		node->nodeMap = nodeMap;
+		node->count = count;
+		return node;
+	}
+
+	static void retain(Node* node)
+	{
+		if (node != nullptr)
+			node->refs.fetch_add(1, std::memory_order_relaxed);
+	}
+	static void release(Node* node)
+	{
+		if (node == nullptr || node->refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+			return;
+		for (unsigned i = 0, e = node->numChildren(); i < e; ++i)
+			release(node->children()[i]);
+		node->~Node();
+		::operator delete(node);
+	}
+
+	// Return a copy of node that holds references to its children
+	static Node* clone(const Node* node)
+	{
+		Node* copy = allocate(node->dataMap, node->nodeMap, node->count);
+		for (unsigned i = 0, e = node->numEntries(); i < e; ++i)
+			new (copy->entries() + i) value_type(node->entries()[i]);
+		for (unsigned i = 0, e = node->numChildren(); i < e; ++i)
+		{
+			copy->children()[i] = node->children()[i];
+			retain(copy->children()[i]);
+		}
+		return copy;
+	}
+
+	// Build a node from its entries and children, whose references it takes over
+	static Node* build(uint32_t dataMap, uint32_t nodeMap, unsigned count, const value_type* entries, Node* const* children)
+	{
+		Node* node = allocate(dataMap, nodeMap, count);
+		for (unsigned i = 0, e = node->numEntries(); i < e; ++i)
+			new (node->entries() + i) value_type(entries[i]);
+		for (unsigned i = 0, e = node->numChildren(); i < e; ++i)
+			node->children()[i] = children[i];
+		return node;
+	}
+
+	// Return the node at the given level that holds the two entries of different keys
+	static Node* makePair(unsigned level, const value_type& e0, uint64_t h0, const value_type& e1, uint64_t h1)
+	{
+		uint32_t b0 = slotBit(h0, level), b1 = slotBit(h1, level);
+		if (b0 == b1)
+		{
+			Node* child = makePair(level + 1, e0, h0, e1, h1);
+			return build(0, b0, 2, nullptr, &child);
+		}
+		if (b0 < b1)
+		{
+			value_type entries[] = { e0, e1 };
+			return build(b0 | b1, 0, 2, entries, nullptr);
+		}
+		value_type entries[] = { e1, e0 };
+		return build(b0 | b1, 0, 2, entries, nullptr);
+	}
+
+	// Return the node after setting key to join(old value, value), or to value if the key is absent. The result is a new reference, which is node itself if nothing changes
+	template <typename Join>
+	static Node* insertImpl(Node* node, unsigned level, uint64_t hash, const value_type& entry, Join& join)
+	{
+		uint32_t bit = slotBit(hash, level);
+		if (node->dataMap & bit)
+		{
+			unsigned idx = indexOf(node->dataMap, bit);
+			const value_type& old = node->entries()[idx];
+			if (old.first == entry.first)
+			{
+				V newValue = join(old.second, entry.second);
+				if (newValue == old.second)
+				{
+					retain(node);
+					return node;
+				}
+				Node* copy = clone(node);
+				copy->entries()[idx].second = newValue;
+				return copy;
+			}
+
+			// Move the old entry and the new one into a child
+			Node* child = makePair(level + 1, old, hashOf(old.first), entry, hash);
+			Node* copy = allocate(node->dataMap & ~bit, node->nodeMap | bit, node->count + 1);
+			for (unsigned i = 0, j = 0, e = node->numEntries(); i < e; ++i)
+				if (i != idx)
+					new (copy->entries() + j++) value_type(node->entries()[i]);
+			unsigned childIdx = indexOf(copy->nodeMap, bit);
+			for (unsigned i = 0, j = 0, e = copy->numChildren(); i < e; ++i)
+			{
+				if (i == childIdx)
+					copy->children()[i] = child;
+				else
+				{
+					copy->children()[i] = node->children()[j++];
+					retain(copy->children()[i]);
+				}
+			}
+			return copy;
+		}
+
+		if (node->nodeMap & bit)
+		{
+			unsigned idx = indexOf(node->nodeMap, bit);
+			Node* child = node->children()[idx];
+			Node* newChild = insertImpl(child, level + 1, hash, entry, join);
+			if (newChild == child)
+			{
+				release(newChild);
+				retain(node);
+				return node;
+			}
+			Node* copy = clone(node);
+			release(copy->children()[idx]);
+			copy->children()[idx] = newChild;
+			copy->count = node->count - child->count + newChild->count;
+			return copy;
+		}
+
+		// Put the entry into an empty slot
+		Node* copy = allocate(node->dataMap | bit, node->nodeMap, node->count + 1);
+		unsigned idx = indexOf(copy->dataMap, bit);
+		for (unsigned i = 0, j = 0, e = copy->numEntries(); i < e; ++i)
+			new (copy->entries() + i) value_type(i == idx ? entry : node->entries()[j++]);
+		for (unsigned i = 0, e = copy->numChildren(); i < e; ++i)
+		{
+			copy->children()[i] = node->children()[i];
+			retain(copy->children()[i]);
+		}
+		return copy;
+	}
+
+	// Return the union of the two nodes at the given level, where join combines the values of a key in both. The result is a new reference, which is lhs itself if it has everything in rhs
+	template <typename Join>
+	static Node* mergeImpl(Node* lhs, Node* rhs, unsigned level, Join& join)
+	{
+		if (lhs == rhs)
+		{
+			retain(lhs);
+			return lhs;
+		}
+
+		// The entries are constructed in place, since a value may have no default constructor
+		typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type entryBuffer[32];
+		value_type* entries = reinterpret_cast<value_type*>(entryBuffer);
+		Node* children[32];
+		unsigned numEntries = 0, numChildren = 0, count = 0;
+		uint32_t dataMap = 0, nodeMap = 0;
+		bool changed = false;
+
+		uint32_t slots = lhs->dataMap | lhs->nodeMap | rhs->dataMap | rhs->nodeMap;
+		while (slots != 0)
+		{
+			uint32_t bit = slots & (~slots + 1);
+			slots &= slots - 1;
+
+			const value_type* lEntry = (lhs->dataMap & bit) ? &lhs->entries()[indexOf(lhs->dataMap, bit)] : nullptr;
+			const value_type* rEntry = (rhs->dataMap & bit) ? &rhs->entries()[indexOf(rhs->dataMap, bit)] : nullptr;
+			Node* lChild = (lhs->nodeMap & bit) ? lhs->children()[indexOf(lhs->nodeMap, bit)] : nullptr;
+			Node* rChild = (rhs->nodeMap & bit) ? rhs->children()[indexOf(rhs->nodeMap, bit)] : nullptr;
+
+			if (lEntry != nullptr && rEntry != nullptr && lEntry->first == rEntry->first)
+			{
+				V newValue = join(lEntry->second, rEntry->second);
+				changed |= !(newValue == lEntry->second);
+				new (entries + numEntries++) value_type(lEntry->first, newValue);
+				dataMap |= bit;
+				++count;
+				continue;
+			}
+
+			Node* child;
+			if (lEntry != nullptr && rEntry != nullptr)
+				child = makePair(level + 1, *lEntry, hashOf(lEntry->first), *rEntry, hashOf(rEntry->first));
+			else if (lEntry != nullptr && rChild != nullptr)
+				child = insertImpl(rChild, level + 1, hashOf(lEntry->first), *lEntry, join);
+			else if (lChild != nullptr && rEntry != nullptr)
+				child = insertImpl(lChild, level + 1, hashOf(rEntry->first), *rEntry, join);
+			else if (lChild != nullptr && rChild != nullptr)
+				child = mergeImpl(lChild, rChild, level + 1, join);
+			else if (lEntry != nullptr || rEntry != nullptr)
+			{
+				// The slot is only used by one side
+				changed |= (rEntry != nullptr);
+				new (entries + numEntries++) value_type(lEntry != nullptr ? *lEntry : *rEntry);
+				dataMap |= bit;
+				++count;
+				continue;
+			}
+			else
+			{
+				child = lChild != nullptr ? lChild : rChild;
+				retain(child);
+			}
+
+			changed |= (child != lChild);
+			children[numChildren++] = child;
+			nodeMap |= bit;
+			count += child->count;
+		}
+
+		if (!changed)
+		{
+			for (unsigned i = 0; i < numChildren; ++i)
+				release(children[i]);
+			retain(lhs);
+			return lhs;
+		}
+		return build(dataMap, nodeMap, count, entries, children);
+	}
+
+	static bool equalImpl(const Node* lhs, const Node* rhs)
+	{
+		if (lhs == rhs)
+			return true;
+		if (lhs->dataMap != rhs->dataMap || lhs->nodeMap != rhs->nodeMap || lhs->count != rhs->count)
+			return false;
+		for (unsigned i = 0, e = lhs->numEntries(); i < e; ++i)
+			if (lhs->entries()[i].first != rhs->entries()[i].first || !(lhs->entries()[i].second == rhs->entries()[i].second))
+				return false;
+		for (unsigned i = 0, e = lhs->numChildren(); i < e; ++i)
+			if (!equalImpl(lhs->children()[i], rhs->children()[i]))
+				return false;
+		return true;
+	}
+
+	template <typename Join>
+	bool insertWith(K key, const V& value, Join join)
+	{
+		value_type entry(key, value);
+		if (root == nullptr)
+		{
+			root = build(slotBit(hashOf(key), 0), 0, 1, &entry, nullptr);
+			return true;
+		}
+
+		Node* newRoot = insertImpl(root, 0, hashOf(key), entry, join);
+		if (newRoot == root)
+		{
+			release(newRoot);
+			return false;
+		}
+		release(root);
+		root = newRoot;
+		return true;
+	}
+public:
+	// Iterates over the entries in an unspecified order. An iterator stays valid as long as the map it comes from is neither changed nor destroyed
+	class const_iterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = typename PersistentPtrMap::value_type;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const value_type*;
+		using reference = const value_type&;
+	private:
+		struct Frame
+		{
+			const Node* node;
+			// The next entry or child to visit
+			unsigned pos;
+		};
+		Frame stack[MaxDepth + 1];
+		unsigned depth = 0;
+		const value_type* current = nullptr;
+
+		// Move to the entry at the position of the top frame, or to the next one
+		void settle()
+		{
+			while (depth != 0)
+			{
+				Frame& top = stack[depth - 1];
+				unsigned numEntries = top.node->numEntries();
+				if (top.pos < numEntries)
+				{
+					current = &top.node->entries()[top.pos];
+					return;
+				}
+				if (top.pos < numEntries + top.node->numChildren())
+				{
+					const Node* child = top.node->children()[top.pos - numEntries];
+					++top.pos;
+					stack[depth++] = { child, 0 };
+				}
+				else
+					--depth;
+			}
+			current = nullptr;
+		}
+	public:
+		const_iterator() = default;
+		explicit const_iterator(const Node* root)
+		{
+			if (root != nullptr)
+			{
+				stack[depth++] = { root, 0 };
+				settle();
+			}
+		}
+
+		reference operator*() const { return *current; }
+		pointer operator->() const { return current; }
+
+		const_iterator& operator++()
+		{
+			++stack[depth - 1].pos;
+			settle();
+			return *this;
+		}
+		const_iterator operator++(int)
+		{
+			auto ret = *this;
+			++*this;
+			return ret;
+		}
+
+		bool operator==(const const_iterator& other) const { return current == other.current; }
+		bool operator!=(const const_iterator& other) const { return !(*this == other); }
+	};
+
+	PersistentPtrMap(): root(nullptr) {}
+	PersistentPtrMap(const PersistentPtrMap& other): root(other.root) { retain(root); }
+	PersistentPtrMap(PersistentPtrMap&& other) noexcept: root(other.root) { other.root = nullptr; }
+	PersistentPtrMap& operator=(const PersistentPtrMap& other)
+	{
+		retain(other.root);
+		release(root);
+		root = other.root;
+		return *this;
+	}
+	PersistentPtrMap& operator=(PersistentPtrMap&& other) noexcept
+	{
+		if (this != &other)
+		{
+			release(root);
+			root = other.root;
+			other.root = nullptr;
+		}
+		return *this;
+	}
+	~PersistentPtrMap() { release(root); }
+
+	// Return nullptr if key is not in the map
+	const V* lookup(K key) const
+	{
+		uint64_t hash = hashOf(key);
+		const Node* node = root;
+		for (unsigned level = 0; node != nullptr; ++level)
+		{
+			uint32_t bit = slotBit(hash, level);
+			if (node->dataMap & bit)
+			{
+				const value_type& entry = node->entries()[indexOf(node->dataMap, bit)];
+				return entry.first == key ? &entry.second : nullptr;
+			}
+			if (!(node->nodeMap & bit))
+				return nullptr;
+			node = node->children()[indexOf(node->nodeMap, bit)];
+		}
+		return nullptr;
+	}
+
+	// Map key to value. Return true if the map changes
+	bool set(K key, const V& value)
+	{
+		return insertWith(key, value, [](const V&, const V& newValue) { return newValue; });
+	}
+
+	// Map key to join(old value, value), or to value if key is not in the map. Return true if the map changes
+	template <typename Join>
+	bool update(K key, const V& value, Join join)
+	{
+		return insertWith(key, value, join);
+	}
+
+	// Add the entries of other, where join(value, other value) combines the values of a key in both maps, and must be commutative. Return true if the map changes
+	template <typename Join>
+	bool merge(const PersistentPtrMap& other, Join join)
+	{
+		if (other.root == nullptr || other.root == root)
+			return false;
+		if (root == nullptr)
+		{
+			*this = other;
+			return true;
+		}
+
+		Node* newRoot = mergeImpl(root, other.root, 0, join);
+		if (newRoot == root)
+		{
+			release(newRoot);
+			return false;
+		}
+		release(root);
+		root = newRoot;
+		return true;
+	}
+
+	size_t size() const { return root == nullptr ? 0 : root->count; }
+	bool empty() const { return root == nullptr; }
+
+	// Maps sharing their root are equal without looking further
+	bool operator==(const PersistentPtrMap& other) const
+	{
+		if (root == nullptr || other.root == nullptr)
+			return root == other.root;
+		return equalImpl(root, other.root);
+	}
+	bool operator!=(const PersistentPtrMap& other) const { return !(*this == other); }
+
+	const_iterator begin() const { return const_iterator(root); }
+	const_iterator end() const { return const_iterator(); }
+};
+
+}
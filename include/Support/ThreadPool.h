@@ -1,8 +1,10 @@
 #ifndef SUPPORT_THREADPOOL_H
 #define SUPPORT_THREADPOOL_H
 
+#include <llvm/Support/ErrorHandling.h>
 #include <llvm/Support/ManagedStatic.h>
 
+#include <cassert>
 #include <condition_variable>
 #include <functional>
 #include <future>
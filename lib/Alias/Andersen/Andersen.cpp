@@ -17,8 +17,20 @@ cl::opt<bool> DumpResultInfo("dump-result",
 cl::opt<bool> DumpConstraintInfo("dump-cons",
                                  cl::desc("Dump constraint info into stderr"),
                                  cl::init(false), cl::Hidden);
-
-Andersen::Andersen(const Module &module) { runOnModule(module); }
+cl::opt<PtsSetImpl> PtsSetKind(
+    "andersen-pts-set", cl::desc("The points-to set implementation of Andersen"),
+    cl::values(clEnumValN(PtsSetImpl::SPARSE_BITVECTOR, "sbv",
+                          "Sparse bit vectors (default)"),
+               clEnumValN(PtsSetImpl::BDD, "bdd",
+                          "Binary decision diagrams shared by all the sets"),
+               clEnumValN(PtsSetImpl::SHARED, "shared",
+                          "Hash-consed sets with memoized unions")),
+    cl::init(PtsSetImpl::SPARSE_BITVECTOR));
+
+Andersen::Andersen(const Module &module, bool incremental)
+    : incremental(incremental), ptsSetImpl(PtsSetKind) {
+  runOnModule(module);
+}
 
 void Andersen::getAllAllocationSites(
     std::vector<const llvm::Value *> &allocSites) const {
@@ -36,21 +48,23 @@ bool Andersen::getPointsToSet(const llvm::Value *v,
   NodeIndex ptrTgt = nodeFactory.getMergeTarget(ptrIndex);
   ptsSet.clear();
 
-  auto ptsItr = ptsGraph.find(ptrTgt);
-  if (ptsItr == ptsGraph.end()) {
-    // Can't find ptrTgt. The reason might be that ptrTgt is an undefined
-    // pointer. Dereferencing it is undefined behavior anyway, so we might just
-    // want to treat it as a nullptr pointer
-    return true;
-  }
-  for (auto v : ptsItr->second) {
-    if (v == nodeFactory.getNullObjectNode())
-      continue;
+  visitPtsGraph([&](const auto &ptsGraph) {
+    const auto *pts = ptsGraph.find(ptrTgt);
+    if (pts == nullptr) {
+      // Can't find ptrTgt. The reason might be that ptrTgt is an undefined
+      // pointer. Dereferencing it is undefined behavior anyway, so we might
+      // just want to treat it as a nullptr pointer
+      return;
+    }
+    for (auto v : *pts) {
+      if (v == nodeFactory.getNullObjectNode())
+        continue;
 
-    const llvm::Value *val = nodeFactory.getValueForNode(v);
-    if (val != nullptr)
-      ptsSet.push_back(val);
-  }
+      const llvm::Value *val = nodeFactory.getValueForNode(v);
+      if (val != nullptr)
+        ptsSet.push_back(val);
+    }
+  });
   return true;
 }
 
@@ -60,7 +74,9 @@ bool Andersen::runOnModule(const Module &M) {
   if (DumpDebugInfo)
     dumpConstraintsPlainVanilla();
 
-  optimizeConstraints();
+  // The nodes merged by HVN and HU cannot be split in incremental mode
+  if (!incremental)
+    optimizeConstraints();
 
   if (DumpConstraintInfo)
     dumpConstraints();
@@ -130,14 +146,15 @@ void Andersen::dumpConstraintsPlainVanilla() const {
 }
 
 void Andersen::dumpPtsGraphPlainVanilla() const {
-  for (unsigned i = 0, e = nodeFactory.getNumNodes(); i < e; ++i) {
-    NodeIndex rep = nodeFactory.getMergeTarget(i);
-    auto ptsItr = ptsGraph.find(rep);
-    if (ptsItr != ptsGraph.end()) {
-      errs() << i << " ";
-      for (auto v : ptsItr->second)
-        errs() << v << " ";
-      errs() << "\n";
+  visitPtsGraph([&](const auto &ptsGraph) {
+    for (unsigned i = 0, e = nodeFactory.getNumNodes(); i < e; ++i) {
+      NodeIndex rep = nodeFactory.getMergeTarget(i);
+      if (const auto *pts = ptsGraph.find(rep)) {
+        errs() << i << " ";
+        for (auto v : *pts)
+          errs() << v << " ";
+        errs() << "\n";
+      }
     }
-  }
+  });
 }
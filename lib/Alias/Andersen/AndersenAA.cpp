@@ -5,29 +5,68 @@
 
 using namespace llvm;
 
-static inline bool isSetContainingOnly(const AndersPtsSet &set, NodeIndex i) {
+template <typename PtsSetType>
+static inline bool isSetContainingOnly(const PtsSetType &set, NodeIndex i) {
   return (set.getSize() == 1) && (*set.begin() == i);
 }
 
-AliasResult AndersenAAResult::andersenAlias(const Value *v1, const Value *v2) {
-  NodeIndex n1 = (anders.nodeFactory)
-                     .getMergeTarget((anders.nodeFactory).getValueNodeFor(v1));
-  NodeIndex n2 = (anders.nodeFactory)
-                     .getMergeTarget((anders.nodeFactory).getValueNodeFor(v2));
+namespace {
+
+// A pointer whose node and points-to set are looked up for alias queries
+template <typename PtsSetType> struct QueryPointer {
+  // The pointer with its casts stripped, or nullptr if it is not a pointer
+  const Value *value = nullptr;
+  NodeIndex node = AndersNodeFactory::InvalidIndex;
+  // The points-to set of node, or nullptr if we know nothing about it
+  const PtsSetType *ptsSet = nullptr;
+};
+
+} // namespace
+
+// We use the const node factory, whose getMergeTarget() does not allocate
+template <typename PtsSetType>
+static QueryPointer<PtsSetType>
+lookupPointer(const Value *v, const AndersNodeFactory &nodeFactory,
+              const AndersPtsGraph<PtsSetType> &ptsGraph) {
+  QueryPointer<PtsSetType> ptr;
+  v = v->stripPointerCasts();
+  if (!v->getType()->isPointerTy())
+    return ptr;
+
+  ptr.value = v;
+  NodeIndex node = nodeFactory.getValueNodeFor(v);
+  if (node == AndersNodeFactory::InvalidIndex)
+    return ptr;
+  ptr.node = nodeFactory.getMergeTarget(node);
+  ptr.ptsSet = ptsGraph.find(ptr.node);
+  return ptr;
+}
 
-  if (n1 == n2)
+template <typename PtsSetType>
+static AliasResult aliasPointers(const QueryPointer<PtsSetType> &p1,
+                                 const QueryPointer<PtsSetType> &p2,
+                                 NodeIndex nullObj) {
+  if (p1.value == nullptr || p2.value == nullptr)
+    return AliasResult::NoAlias;
+
+  if (p1.value == p2.value)
     return AliasResult::MustAlias;
 
-  auto itr1 = (anders.ptsGraph).find(n1), itr2 = (anders.ptsGraph).find(n2);
-  if (itr1 == (anders.ptsGraph).end() || itr2 == (anders.ptsGraph).end())
+  if (p1.node == AndersNodeFactory::InvalidIndex ||
+      p2.node == AndersNodeFactory::InvalidIndex)
+    // We have no idea what at least one of them is
+    return AliasResult::MayAlias;
+
+  if (p1.node == p2.node)
+    return AliasResult::MustAlias;
+
+  if (p1.ptsSet == nullptr || p2.ptsSet == nullptr)
     // We know nothing about at least one of (v1, v2)
     return AliasResult::MayAlias;
 
-  AndersPtsSet &s1 = itr1->second, s2 = itr2->second;
-  bool isNull1 =
-      isSetContainingOnly(s1, (anders.nodeFactory).getNullObjectNode());
-  bool isNull2 =
-      isSetContainingOnly(s2, (anders.nodeFactory).getNullObjectNode());
+  const PtsSetType &s1 = *p1.ptsSet, &s2 = *p2.ptsSet;
+  bool isNull1 = isSetContainingOnly(s1, nullObj);
+  bool isNull2 = isSetContainingOnly(s2, nullObj);
   if (isNull1 || isNull2)
     // If any of them is null, we know that they must not alias each other
     return AliasResult::NoAlias;
@@ -35,13 +74,10 @@ AliasResult AndersenAAResult::andersenAlias(const Value *v1, const Value *v2) {
   if (s1.getSize() == 1 && s2.getSize() == 1 && *s1.begin() == *s2.begin())
     return AliasResult::MustAlias;
 
-  // Compute the intersection of s1 and s2
-  for (auto const &idx : s1) {
-    if (idx == (anders.nodeFactory).getNullObjectNode())
-      continue;
-    if (s2.has(idx))
-      return AliasResult::MayAlias;
-  }
+  // Check whether s1 and s2 share a non-null object, without computing the
+  // intersection
+  if (s1.intersectWith(s2, nullObj))
+    return AliasResult::MayAlias;
 
   return AliasResult::NoAlias;
 }
@@ -51,16 +87,54 @@ AliasResult AndersenAAResult::alias(const MemoryLocation &l1,
   if (l1.Size == 0 || l2.Size == 0)
     return AliasResult::NoAlias;
 
-  const Value *v1 = (l1.Ptr)->stripPointerCasts();
-  const Value *v2 = (l2.Ptr)->stripPointerCasts();
-
-  if (!v1->getType()->isPointerTy() || !v2->getType()->isPointerTy())
-    return AliasResult::NoAlias;
+  return anders.visitPtsGraph([&](const auto &ptsGraph) {
+    const AndersNodeFactory &nodeFactory = anders.nodeFactory;
+    return aliasPointers(lookupPointer(l1.Ptr, nodeFactory, ptsGraph),
+                         lookupPointer(l2.Ptr, nodeFactory, ptsGraph),
+                         nodeFactory.getNullObjectNode());
+  });
+}
 
-  if (v1 == v2)
-    return AliasResult::MustAlias;
+std::vector<AliasResult>
+AndersenAAResult::aliasMatrix(ArrayRef<const Value *> values) {
+  size_t n = values.size();
+  std::vector<AliasResult> result(n * n, AliasResult::MayAlias);
+
+  anders.visitPtsGraph([&](const auto &ptsGraph) {
+    const AndersNodeFactory &nodeFactory = anders.nodeFactory;
+    NodeIndex nullObj = nodeFactory.getNullObjectNode();
+    std::vector<decltype(lookupPointer(values.front(), nodeFactory, ptsGraph))>
+        pointers;
+    pointers.reserve(n);
+    for (const Value *v : values)
+      pointers.push_back(lookupPointer(v, nodeFactory, ptsGraph));
+
+    // The results are symmetric
+    for (size_t i = 0; i < n; ++i) {
+      result[i * n + i] = aliasPointers(pointers[i], pointers[i], nullObj);
+      for (size_t j = i + 1; j < n; ++j)
+        result[i * n + j] = result[j * n + i] =
+            aliasPointers(pointers[i], pointers[j], nullObj);
+    }
+  });
+  return result;
+}
 
-  return andersenAlias(v1, v2);
+std::vector<AliasResult>
+AndersenAAResult::aliasesOf(const Value *v,
+                            ArrayRef<const Value *> candidates) {
+  std::vector<AliasResult> result;
+  result.reserve(candidates.size());
+
+  anders.visitPtsGraph([&](const auto &ptsGraph) {
+    const AndersNodeFactory &nodeFactory = anders.nodeFactory;
+    NodeIndex nullObj = nodeFactory.getNullObjectNode();
+    auto pointer = lookupPointer(v, nodeFactory, ptsGraph);
+    for (const Value *candidate : candidates)
+      result.push_back(aliasPointers(
+          pointer, lookupPointer(candidate, nodeFactory, ptsGraph), nullObj));
+  });
+  return result;
 }
 
 bool AndersenAAResult::pointsToConstantMemory(const MemoryLocation &loc,
@@ -69,24 +143,27 @@ bool AndersenAAResult::pointsToConstantMemory(const MemoryLocation &loc,
   if (node == AndersNodeFactory::InvalidIndex)
     return false;
 
-  auto itr = (anders.ptsGraph).find(node);
-  if (itr == (anders.ptsGraph).end())
-    // Not a pointer?
-    return false;
-
-  const AndersPtsSet &ptsSet = itr->second;
-  for (auto const &idx : ptsSet) {
-    if (const Value *val = (anders.nodeFactory).getValueForNode(idx)) {
-      if (!isa<GlobalValue>(val) || (isa<GlobalVariable>(val) &&
-                                     !cast<GlobalVariable>(val)->isConstant()))
-        return false;
-    } else {
-      if (idx != (anders.nodeFactory).getNullObjectNode())
-        return false;
+  return anders.visitPtsGraph([&](const auto &ptsGraph) {
+    const auto *pts = ptsGraph.find(node);
+    if (pts == nullptr)
+      // Not a pointer?
+      return false;
+
+    const auto &ptsSet = *pts;
+    for (auto const &idx : ptsSet) {
+      if (const Value *val = (anders.nodeFactory).getValueForNode(idx)) {
+        if (!isa<GlobalValue>(val) ||
+            (isa<GlobalVariable>(val) &&
+             !cast<GlobalVariable>(val)->isConstant()))
+          return false;
+      } else {
+        if (idx != (anders.nodeFactory).getNullObjectNode())
+          return false;
+      }
     }
-  }
 
-  return true;
+    return true;
+  });
 }
 
 AndersenAAResult::AndersenAAResult(const Module &m) : anders(m) {}
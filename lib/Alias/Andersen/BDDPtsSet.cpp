@@ -0,0 +1,305 @@
+#include <llvm/Support/ErrorHandling.h>
+#include <llvm/Support/MathExtras.h>
+
+#include <algorithm>
+
+#include "Alias/Andersen/BDDPtsSet.h"
+
+
+using namespace llvm;
+
+static inline DdNode *checkResult(DdNode *n) {
+  if (n == nullptr)
+    report_fatal_error("CUDD fails to build the BDD of a points-to set");
+  return n;
+}
+
+// Get the then- and else-cofactors of f w.r.t. the domain variable at level l.
+// The variables are never reordered, so the level of a variable is its index
+static inline void getCofactors(DdNode *f, unsigned l, DdNode *&t,
+                                DdNode *&e) {
+  DdNode *r = Cudd_Regular(f);
+  if (Cudd_IsConstant(r) || r->index != l) {
+    t = e = f;
+    return;
+  }
+  int c = Cudd_IsComplement(f);
+  t = Cudd_NotCond(Cudd_T(r), c);
+  e = Cudd_NotCond(Cudd_E(r), c);
+}
+
+BDDPtsSetManager::BDDPtsSetManager()
+    : bdd(0), manager(bdd.getManager()), zero(Cudd_ReadLogicZero(manager)),
+      numLiveSets(0) {
+  Cudd_AutodynDisable(manager);
+}
+
+BDDPtsSetManager &BDDPtsSetManager::get() {
+  // Never destroyed, so that a set with static storage duration can still
+  // release its BDD at exit
+  static BDDPtsSetManager *instance = new BDDPtsSetManager();
+  return *instance;
+}
+
+void BDDPtsSetManager::reserve(unsigned numElements) {
+  unsigned numBits = numElements <= 2 ? 1 : Log2_32_Ceil(numElements);
+  if (numBits <= domainVars.size())
+    return;
+  if (numLiveSets != 0)
+    report_fatal_error("Cannot enlarge the domain of BDD points-to sets while "
+                       "some of them are not empty");
+
+  domainVars.clear();
+  for (unsigned i = 0; i < numBits; ++i)
+    domainVars.push_back(checkResult(Cudd_bddIthVar(manager, i)));
+}
+
+size_t BDDPtsSetManager::getMemoryUsage() const {
+  return Cudd_ReadMemoryInUse(manager);
+}
+
+unsigned BDDPtsSetManager::getNumNodes() const {
+  return Cudd_ReadNodeCount(manager);
+}
+
+BDDAndersPtsSet::iterator::iterator(DdNode *r)
+    : manager(BDDPtsSetManager::get().manager),
+      zero(BDDPtsSetManager::get().zero), root(nullptr),
+      numBits(BDDPtsSetManager::get().getNumBits()), value(0) {
+  if (r == zero)
+    return;
+
+  // Hold the root so that the path stays valid even if the set changes
+  root = r;
+  Cudd_Ref(root);
+  path.push_back(root);
+  descend(0);
+}
+
+BDDAndersPtsSet::iterator::iterator(const iterator &other)
+    : manager(other.manager), zero(other.zero), root(other.root),
+      numBits(other.numBits), path(other.path), value(other.value) {
+  if (root != nullptr)
+    Cudd_Ref(root);
+}
+
+BDDAndersPtsSet::iterator &
+BDDAndersPtsSet::iterator::operator=(const iterator &other) {
+  if (other.root != nullptr)
+    Cudd_Ref(other.root);
+  if (root != nullptr)
+    Cudd_RecursiveDeref(manager, root);
+  manager = other.manager;
+  zero = other.zero;
+  root = other.root;
+  numBits = other.numBits;
+  path = other.path;
+  value = other.value;
+  return *this;
+}
+
+BDDAndersPtsSet::iterator::~iterator() {
+  if (root != nullptr)
+    Cudd_RecursiveDeref(manager, root);
+}
+
+void BDDAndersPtsSet::iterator::descend(unsigned l) {
+  for (; l < numBits; ++l) {
+    DdNode *t, *e;
+    getCofactors(path[l], l, t, e);
+    if (e != zero) {
+      path.push_back(e);
+    } else {
+      // A non-zero function has at least one non-zero cofactor
+      value |= 1u << (numBits - 1 - l);
+      path.push_back(t);
+    }
+  }
+}
+
+BDDAndersPtsSet::iterator &BDDAndersPtsSet::iterator::operator++() {
+  assert(!path.empty() && "Incrementing an end iterator!");
+
+  // Find the deepest level where we took the else-branch and the then-branch
+  // is not empty
+  for (unsigned l = numBits; l-- > 0;) {
+    path.pop_back();
+    unsigned bit = 1u << (numBits - 1 - l);
+    if (value & bit) {
+      value &= ~bit;
+      continue;
+    }
+
+    DdNode *t, *e;
+    getCofactors(path[l], l, t, e);
+    if (t != zero) {
+      value |= bit;
+      path.push_back(t);
+      descend(l + 1);
+      return *this;
+    }
+  }
+
+  path.clear();
+  return *this;
+}
+
+BDDAndersPtsSet::BDDAndersPtsSet() : node(BDDPtsSetManager::get().zero) {
+  Cudd_Ref(node);
+}
+
+BDDAndersPtsSet::BDDAndersPtsSet(const BDDAndersPtsSet &other)
+    : node(other.node) {
+  Cudd_Ref(node);
+  BDDPtsSetManager &mgr = BDDPtsSetManager::get();
+  if (node != mgr.zero)
+    ++mgr.numLiveSets;
+}
+
+BDDAndersPtsSet::BDDAndersPtsSet(BDDAndersPtsSet &&other) : node(other.node) {
+  other.node = BDDPtsSetManager::get().zero;
+  Cudd_Ref(other.node);
+}
+
+BDDAndersPtsSet &BDDAndersPtsSet::operator=(const BDDAndersPtsSet &other) {
+  Cudd_Ref(other.node);
+  reset(other.node);
+  return *this;
+}
+
+BDDAndersPtsSet &BDDAndersPtsSet::operator=(BDDAndersPtsSet &&other) {
+  if (this != &other) {
+    BDDPtsSetManager &mgr = BDDPtsSetManager::get();
+    DdNode *old = node;
+    node = other.node;
+    other.node = mgr.zero;
+    Cudd_Ref(other.node);
+    if (old != mgr.zero)
+      --mgr.numLiveSets;
+    Cudd_RecursiveDeref(mgr.manager, old);
+  }
+  return *this;
+}
+
+BDDAndersPtsSet::~BDDAndersPtsSet() {
+  BDDPtsSetManager &mgr = BDDPtsSetManager::get();
+  if (node != mgr.zero)
+    --mgr.numLiveSets;
+  Cudd_RecursiveDeref(mgr.manager, node);
+}
+
+void BDDAndersPtsSet::reset(DdNode *n) {
+  BDDPtsSetManager &mgr = BDDPtsSetManager::get();
+  DdNode *old = node;
+  node = n;
+  if (n != mgr.zero)
+    ++mgr.numLiveSets;
+  if (old != mgr.zero)
+    --mgr.numLiveSets;
+  Cudd_RecursiveDeref(mgr.manager, old);
+}
+
+bool BDDAndersPtsSet::has(unsigned idx) const {
+  BDDPtsSetManager &mgr = BDDPtsSetManager::get();
+  unsigned numBits = mgr.getNumBits();
+  if (numBits < 32 && (idx >> numBits) != 0)
+    return false;
+
+  // Follow the path of idx from the root
+  DdNode *f = node;
+  for (unsigned l = 0; l < numBits && f != mgr.zero; ++l) {
+    DdNode *t, *e;
+    getCofactors(f, l, t, e);
+    f = ((idx >> (numBits - 1 - l)) & 1) ? t : e;
+  }
+  return f != mgr.zero;
+}
+
+bool BDDAndersPtsSet::insert(unsigned idx) {
+  if (has(idx))
+    return false;
+
+  BDDPtsSetManager &mgr = BDDPtsSetManager::get();
+  mgr.reserve(idx + 1);
+  unsigned numBits = mgr.getNumBits();
+  int phase[32];
+  for (unsigned l = 0; l < numBits; ++l)
+    phase[l] = (idx >> (numBits - 1 - l)) & 1;
+
+  DdNode *cube = checkResult(Cudd_bddComputeCube(
+      mgr.manager, mgr.domainVars.data(), phase, numBits));
+  Cudd_Ref(cube);
+  DdNode *result = checkResult(Cudd_bddOr(mgr.manager, node, cube));
+  Cudd_Ref(result);
+  Cudd_RecursiveDeref(mgr.manager, cube);
+  reset(result);
+  return true;
+}
+
+bool BDDAndersPtsSet::contains(const BDDAndersPtsSet &other) const {
+  return Cudd_bddLeq(BDDPtsSetManager::get().manager, other.node, node);
+}
+
+bool BDDAndersPtsSet::intersectWith(const BDDAndersPtsSet &other) const {
+  // The sets are disjoint iff *this implies the complement of other
+  return !Cudd_bddLeq(BDDPtsSetManager::get().manager, node,
+                      Cudd_Not(other.node));
+}
+
+bool BDDAndersPtsSet::intersectWith(const BDDAndersPtsSet &other,
+                                    unsigned ignored) const {
+  if (!intersectWith(other))
+    return false;
+  if (!has(ignored) || !other.has(ignored))
+    return true;
+
+  // Both sets have ignored. Walking the elements in order avoids building the
+  // BDD of the intersection
+  for (auto itr = begin(), ite = end(), otherItr = other.begin(),
+            otherIte = other.end();
+       itr != ite && otherItr != otherIte;) {
+    if (*itr < *otherItr) {
+      ++itr;
+    } else if (*otherItr < *itr) {
+      ++otherItr;
+    } else {
+      if (*itr != ignored)
+        return true;
+      ++itr;
+      ++otherItr;
+    }
+  }
+  return false;
+}
+
+bool BDDAndersPtsSet::unionWith(const BDDAndersPtsSet &other) {
+  BDDPtsSetManager &mgr = BDDPtsSetManager::get();
+  if (other.node == mgr.zero || other.node == node)
+    return false;
+
+  DdNode *result = checkResult(Cudd_bddOr(mgr.manager, node, other.node));
+  Cudd_Ref(result);
+  if (result == node) {
+    Cudd_RecursiveDeref(mgr.manager, result);
+    return false;
+  }
+  reset(result);
+  return true;
+}
+
+void BDDAndersPtsSet::clear() {
+  DdNode *zero = BDDPtsSetManager::get().zero;
+  Cudd_Ref(zero);
+  reset(zero);
+}
+
+unsigned BDDAndersPtsSet::getSize() const {
+  BDDPtsSetManager &mgr = BDDPtsSetManager::get();
+  if (node == mgr.zero)
+    return 0;
+  return (unsigned)Cudd_CountMinterm(mgr.manager, node, mgr.getNumBits());
+}
+
+bool BDDAndersPtsSet::isEmpty() const {
+  return node == BDDPtsSetManager::get().zero;
+}
@@ -13,6 +13,9 @@
 #include <llvm/IR/PatternMatch.h>
 #include <llvm/Support/raw_ostream.h>
 
+#include <algorithm>
+#include <iterator>
+
 
 #include "Alias/Andersen/Andersen.h"
 
@@ -42,6 +45,11 @@ void Andersen::collectConstraints(const Module &M) {
   // global object as pointing to the memory for the global: &G = <G memory>
   collectConstraintsForGlobals(M);
 
+  // In incremental mode, remember which constraints come from which function
+  size_t numCollected = constraints.size();
+  if (incremental)
+    funcConstraints[nullptr].assign(constraints.begin(), constraints.end());
+
   // Here is a notable point before we proceed:
   // For functions with non-local linkage type, theoretically we should not
   // trust anything that get passed to it or get returned by it. However,
@@ -54,28 +62,72 @@ void Andersen::collectConstraints(const Module &M) {
     if (f.isDeclaration() || f.isIntrinsic())
       continue;
 
-    // Scan the function body
-    // A visitor pattern might help modularity, but it needs more boilerplate
-    // codes to set up, and it breaks down the main logic into pieces
-
-    // First, create a value node for each instruction with pointer type. It is
-    // necessary to do the job here rather than on-the-fly because an
-    // instruction may refer to the value node defined before it (e.g. phi
-    // nodes)
-    for (const_inst_iterator itr = inst_begin(f), ite = inst_end(f); itr != ite;
-         ++itr) {
-      auto inst = &*itr.getInstructionIterator();
-      if (inst->getType()->isPointerTy())
-        nodeFactory.createValueNode(inst);
-    }
+    collectConstraintsForFunction(f);
 
-    // Now, collect constraint for each relevant instruction
-    for (const_inst_iterator itr = inst_begin(f), ite = inst_end(f); itr != ite;
-         ++itr) {
-      auto inst = &*itr.getInstructionIterator();
-      collectConstraintsForInstruction(inst);
+    if (incremental) {
+      funcConstraints[&f].assign(constraints.begin() + numCollected,
+                                 constraints.end());
+      numCollected = constraints.size();
     }
   }
+
+  if (incremental) {
+    for (auto const &c : constraints)
+      countConstraint(c, true);
+  }
+}
+
+void Andersen::collectConstraintsForFunction(const Function &f) {
+  // Scan the function body
+  // A visitor pattern might help modularity, but it needs more boilerplate
+  // codes to set up, and it breaks down the main logic into pieces
+
+  // First, create a value node for each instruction with pointer type. It is
+  // necessary to do the job here rather than on-the-fly because an
+  // instruction may refer to the value node defined before it (e.g. phi
+  // nodes). When a function is re-collected, only its new instructions need
+  // new nodes
+  for (const_inst_iterator itr = inst_begin(f), ite = inst_end(f); itr != ite;
+       ++itr) {
+    auto inst = &*itr.getInstructionIterator();
+    if (inst->getType()->isPointerTy() &&
+        nodeFactory.getValueNodeFor(inst) == AndersNodeFactory::InvalidIndex)
+      nodeFactory.createValueNode(inst);
+  }
+
+  // Now, collect constraint for each relevant instruction
+  for (const_inst_iterator itr = inst_begin(f), ite = inst_end(f); itr != ite;
+       ++itr) {
+    auto inst = &*itr.getInstructionIterator();
+    collectConstraintsForInstruction(inst);
+  }
+}
+
+void Andersen::updateFunctions(ArrayRef<const Function *> funcs) {
+  assert(incremental && "Updating functions requires the incremental mode!");
+
+  std::vector<AndersConstraint> added, removed;
+  for (const Function *f : funcs) {
+    constraints.clear();
+    if (!f->isDeclaration() && !f->isIntrinsic())
+      collectConstraintsForFunction(*f);
+
+    // Diff the old and the new constraints of f as multisets
+    std::vector<AndersConstraint> &oldConstraints = funcConstraints[f];
+    std::vector<AndersConstraint> newConstraints = constraints;
+    std::sort(oldConstraints.begin(), oldConstraints.end());
+    std::sort(newConstraints.begin(), newConstraints.end());
+    std::set_difference(oldConstraints.begin(), oldConstraints.end(),
+                        newConstraints.begin(), newConstraints.end(),
+                        std::back_inserter(removed));
+    std::set_difference(newConstraints.begin(), newConstraints.end(),
+                        oldConstraints.begin(), oldConstraints.end(),
+                        std::back_inserter(added));
+    oldConstraints = std::move(newConstraints);
+  }
+  constraints.clear();
+
+  updateConstraints(added, removed);
 }
 
 void Andersen::collectConstraintsForGlobals(const Module &M) {
@@ -165,7 +217,10 @@ void Andersen::collectConstraintsForInstruction(const Instruction *inst) {
     NodeIndex valNode = nodeFactory.getValueNodeFor(inst);
     assert(valNode != AndersNodeFactory::InvalidIndex &&
            "Failed to find alloca value node");
-    NodeIndex objNode = nodeFactory.createObjectNode(inst);
+    // The object already exists if the function is re-collected
+    NodeIndex objNode = nodeFactory.getObjectNodeFor(inst);
+    if (objNode == AndersNodeFactory::InvalidIndex)
+      objNode = nodeFactory.createObjectNode(inst);
     constraints.emplace_back(AndersConstraint::ADDR_OF, valNode, objNode);
     break;
   }
@@ -9,8 +9,10 @@
 #include <queue>
 
 #include "Alias/Andersen/Andersen.h"
+#include "Alias/Andersen/ConstraintGraph.h"
 #include "Alias/Andersen/CycleDetector.h"
 #include "Alias/Andersen/SparseBitVectorGraph.h"
+#include "Support/ThreadPool.h"
 
 
 using namespace llvm;
@@ -26,180 +28,10 @@ namespace {
 // Define CCG (Copy Constraint Graph) type for use in collapseNodes
 using CCG = SparseBitVectorGraph;
 
-// This class represent the constraint graph
-class ConstraintGraphNode {
-private:
-  NodeIndex idx;
-
-  // We use set rather than SmallSet because we need the capability of iteration
-  typedef std::set<NodeIndex> NodeSet;
-  NodeSet copyEdges, loadEdges, storeEdges;
-
-  bool insertCopyEdge(NodeIndex dst) { return copyEdges.insert(dst).second; }
-  bool removeCopyEdge(NodeIndex dst) { return copyEdges.erase(dst); }
-  bool insertLoadEdge(NodeIndex dst) { return loadEdges.insert(dst).second; }
-  bool removeLoadEdge(NodeIndex dst) { return loadEdges.erase(dst); }
-  bool insertStoreEdge(NodeIndex dst) { return storeEdges.insert(dst).second; }
-  bool removeStoreEdge(NodeIndex dst) { return storeEdges.erase(dst); }
-  bool isEmpty() const {
-    return copyEdges.empty() && loadEdges.empty() && storeEdges.empty();
-  }
-
-  void mergeEdges(const ConstraintGraphNode &other) {
-    copyEdges.insert(other.copyEdges.begin(), other.copyEdges.end());
-    loadEdges.insert(other.loadEdges.begin(), other.loadEdges.end());
-    storeEdges.insert(other.storeEdges.begin(), other.storeEdges.end());
-  }
-
-  ConstraintGraphNode(NodeIndex i) : idx(i) {}
-
-public:
-  typedef NodeSet::iterator iterator;
-  typedef NodeSet::const_iterator const_iterator;
-
-  NodeIndex getNodeIndex() const { return idx; }
-
-  bool replaceCopyEdge(NodeIndex oldIdx, NodeIndex newIdx) {
-    return removeCopyEdge(oldIdx) && insertCopyEdge(newIdx);
-  }
-  bool replaceLoadEdge(NodeIndex oldIdx, NodeIndex newIdx) {
-    return removeLoadEdge(oldIdx) && insertLoadEdge(newIdx);
-  }
-  bool replaceStoreEdge(NodeIndex oldIdx, NodeIndex newIdx) {
-    return removeStoreEdge(oldIdx) && insertStoreEdge(newIdx);
-  }
-
-  iterator begin() { return copyEdges.begin(); }
-  iterator end() { return copyEdges.end(); }
-  const_iterator begin() const { return copyEdges.begin(); }
-  const_iterator end() const { return copyEdges.end(); }
-
-  const_iterator load_begin() const { return loadEdges.begin(); }
-  const_iterator load_end() const { return loadEdges.end(); }
-  llvm::iterator_range<const_iterator> loads() const {
-    return llvm::iterator_range<const_iterator>(load_begin(), load_end());
-  }
-
-  const_iterator store_begin() const { return storeEdges.begin(); }
-  const_iterator store_end() const { return storeEdges.end(); }
-  llvm::iterator_range<const_iterator> stores() const {
-    return llvm::iterator_range<const_iterator>(store_begin(), store_end());
-  }
-
-  friend class ConstraintGraph;
-};
-
-class ConstraintGraph {
-private:
-  typedef std::map<NodeIndex, ConstraintGraphNode> NodeMapTy;
-  NodeMapTy graph;
-
-public:
-  typedef NodeMapTy::iterator iterator;
-  typedef NodeMapTy::const_iterator const_iterator;
-
-  ConstraintGraph() {}
-
-  bool insertCopyEdge(NodeIndex src, NodeIndex dst) {
-    auto itr = graph.find(src);
-    if (itr == graph.end()) {
-      ConstraintGraphNode srcNode(src);
-      srcNode.insertCopyEdge(dst);
-      graph.insert(std::make_pair(src, std::move(srcNode)));
-      return true;
-    } else
-      return (itr->second).insertCopyEdge(dst);
-  }
-
-  bool insertLoadEdge(NodeIndex src, NodeIndex dst) {
-    auto itr = graph.find(src);
-    if (itr == graph.end()) {
-      ConstraintGraphNode srcNode(src);
-      srcNode.insertLoadEdge(dst);
-      graph.insert(std::make_pair(src, std::move(srcNode)));
-      return true;
-    } else
-      return (itr->second).insertLoadEdge(dst);
-  }
-
-  bool insertStoreEdge(NodeIndex src, NodeIndex dst) {
-    auto itr = graph.find(src);
-    if (itr == graph.end()) {
-      ConstraintGraphNode srcNode(src);
-      srcNode.insertStoreEdge(dst);
-      graph.insert(std::make_pair(src, std::move(srcNode)));
-      return true;
-    } else
-      return (itr->second).insertStoreEdge(dst);
-  }
-
-  void mergeNodes(NodeIndex dst, NodeIndex src) {
-    auto itr = graph.find(src);
-    if (itr == graph.end())
-      return;
-
-    const ConstraintGraphNode &srcNode = itr->second;
-    itr = graph.find(dst);
-    if (itr == graph.end()) {
-      ConstraintGraphNode dstNode(dst);
-      graph.insert(std::make_pair(dst, srcNode));
-    } else
-      (itr->second).mergeEdges(srcNode);
-  }
-
-  void deleteNode(NodeIndex idx) { graph.erase(idx); }
-
-  ConstraintGraphNode *getNodeWithIndex(NodeIndex idx) {
-    auto itr = graph.find(idx);
-    if (itr == graph.end())
-      return nullptr;
-    else
-      return &(itr->second);
-  }
-
-  ConstraintGraphNode *getOrInsertNode(NodeIndex idx) {
-    auto itr = graph.find(idx);
-    if (itr == graph.end()) {
-      ConstraintGraphNode newNode(idx);
-      itr = graph.insert(std::make_pair(idx, newNode)).first;
-    }
-    return &(itr->second);
-  }
-
-  iterator begin() { return graph.begin(); }
-  iterator end() { return graph.end(); }
-  const_iterator begin() const { return graph.begin(); }
-  const_iterator end() const { return graph.end(); }
-};
-
-} // namespace
-
-// Specialize the AnderGraphTraits for ConstraintGraph
-template <> class AndersGraphTraits<ConstraintGraph> {
-public:
-  typedef ConstraintGraphNode NodeType;
-  typedef MapValueIterator<ConstraintGraph::const_iterator> NodeIterator;
-  typedef ConstraintGraphNode::iterator ChildIterator;
-
-  static inline ChildIterator child_begin(const NodeType *n) {
-    return n->begin();
-  }
-  static inline ChildIterator child_end(const NodeType *n) { return n->end(); }
-
-  static inline NodeIterator node_begin(const ConstraintGraph *g) {
-    return NodeIterator(g->begin());
-  }
-  static inline NodeIterator node_end(const ConstraintGraph *g) {
-    return NodeIterator(g->end());
-  }
-};
-
-namespace {
-
 // Template version of collapseNodes function to support different PtsSet types
 template<typename PtsSetType>
 void collapseNodes(NodeIndex dst, NodeIndex src, AndersNodeFactory &nodeFactory,
-                   std::map<NodeIndex, PtsSetType> &ptsGraph,
+                   AndersPtsGraph<PtsSetType> &ptsGraph,
                    ConstraintGraph &constraintGraph) {
   if (dst == src)
     return;
@@ -215,42 +47,14 @@ void collapseNodes(NodeIndex dst, NodeIndex src, AndersNodeFactory &nodeFactory,
   constraintGraph.deleteNode(src);
 }
 
-// Backward compatibility for the original version
-void collapseNodes(NodeIndex dst, NodeIndex src, AndersNodeFactory &nodeFactory,
-                   std::map<NodeIndex, AndersPtsSet> &ptsGraph,
-                   ConstraintGraph &constraintGraph) {
-  collapseNodes<AndersPtsSet>(dst, src, nodeFactory, ptsGraph, constraintGraph);
-}
-
-// Add overload for DefaultPtsSet
-void collapseNodes(NodeIndex dst, NodeIndex src, AndersNodeFactory &nodeFactory,
-                   std::map<NodeIndex, DefaultPtsSet> &ptsGraph,
-                   ConstraintGraph &constraintGraph) {
-  collapseNodes<DefaultPtsSet>(dst, src, nodeFactory, ptsGraph, constraintGraph);
-}
-
 // Template versions with CCG parameter
 template<typename PtsSetType>
 void collapseNodes(NodeIndex dst, NodeIndex src, AndersNodeFactory &nodeFactory,
-                   std::map<NodeIndex, PtsSetType> &ptsGraph,
+                   AndersPtsGraph<PtsSetType> &ptsGraph,
                    ConstraintGraph &constraintGraph, CCG &copyGraph) {
   collapseNodes<PtsSetType>(dst, src, nodeFactory, ptsGraph, constraintGraph);
 }
 
-// Backward compatibility for the original version with CCG parameter
-void collapseNodes(NodeIndex dst, NodeIndex src, AndersNodeFactory &nodeFactory,
-                   std::map<NodeIndex, AndersPtsSet> &ptsGraph,
-                   ConstraintGraph &constraintGraph, CCG &copyGraph) {
-  collapseNodes<AndersPtsSet>(dst, src, nodeFactory, ptsGraph, constraintGraph);
-}
-
-// Add overload for DefaultPtsSet with CCG parameter
-void collapseNodes(NodeIndex dst, NodeIndex src, AndersNodeFactory &nodeFactory,
-                   std::map<NodeIndex, DefaultPtsSet> &ptsGraph,
-                   ConstraintGraph &constraintGraph, CCG &copyGraph) {
-  collapseNodes<DefaultPtsSet>(dst, src, nodeFactory, ptsGraph, constraintGraph);
-}
-
 // The worklist for our analysis
 class AndersWorkList {
 private:
@@ -275,6 +79,7 @@ public:
     return ret;
   }
   bool isEmpty() const { return list.empty(); }
+  size_t size() const { return list.size(); }
 };
 
 // The technique used here is described in "The Ant and the Grasshopper: Fast
@@ -403,7 +208,7 @@ template<typename PtsSetType>
 void buildConstraintGraph(ConstraintGraph &cGraph,
                           const std::vector<AndersConstraint> &constraints,
                           AndersNodeFactory &nodeFactory,
-                          std::map<NodeIndex, PtsSetType> &ptsGraph) {
+                          AndersPtsGraph<PtsSetType> &ptsGraph) {
   for (auto const &c : constraints) {
     NodeIndex srcTgt = nodeFactory.getMergeTarget(c.getSrc());
     NodeIndex dstTgt = nodeFactory.getMergeTarget(c.getDest());
@@ -431,29 +236,13 @@ void buildConstraintGraph(ConstraintGraph &cGraph,
   }
 }
 
-// Backward compatibility for the original version
-void buildConstraintGraph(ConstraintGraph &cGraph,
-                          const std::vector<AndersConstraint> &constraints,
-                          AndersNodeFactory &nodeFactory,
-                          std::map<NodeIndex, AndersPtsSet> &ptsGraph) {
-  buildConstraintGraph<AndersPtsSet>(cGraph, constraints, nodeFactory, ptsGraph);
-}
-
-// Add overload for DefaultPtsSet
-void buildConstraintGraph(ConstraintGraph &cGraph,
-                          const std::vector<AndersConstraint> &constraints,
-                          AndersNodeFactory &nodeFactory,
-                          std::map<NodeIndex, DefaultPtsSet> &ptsGraph) {
-  buildConstraintGraph<DefaultPtsSet>(cGraph, constraints, nodeFactory, ptsGraph);
-}
-
 // Template version of OnlineCycleDetector class
 template<typename PtsSetType>
 class OnlineCycleDetectorT : public CycleDetector<ConstraintGraph> {
 private:
   AndersNodeFactory &nodeFactory;
   ConstraintGraph &constraintGraph;
-  std::map<NodeIndex, PtsSetType> &ptsGraph;
+  AndersPtsGraph<PtsSetType> &ptsGraph;
   std::queue<std::pair<NodeIndex, NodeIndex>> &cycleCandidates;
 
   NodeType *getRep(NodeIndex idx) override {
@@ -478,7 +267,7 @@ private:
 
 public:
   OnlineCycleDetectorT(AndersNodeFactory &n, ConstraintGraph &co,
-                      std::map<NodeIndex, PtsSetType> &p,
+                      AndersPtsGraph<PtsSetType> &p,
                       std::queue<std::pair<NodeIndex, NodeIndex>> &cc)
       : nodeFactory(n), constraintGraph(co), ptsGraph(p), cycleCandidates(cc) {}
 
@@ -499,66 +288,260 @@ public:
   using OnlineCycleDetectorT<AndersPtsSet>::OnlineCycleDetectorT;
 };
 
-// Add specialized version for DefaultPtsSet
-using DefaultOnlineCycleDetector = OnlineCycleDetectorT<DefaultPtsSet>;
+// The number of shards of a parallel round. It does not depend on the number
+// of workers, so the solver takes the same steps whatever -nworkers is
+static const unsigned NumShards = 64;
+
+// A round with fewer nodes is not worth the synchronization
+static const size_t MinParallelRoundSize = 256;
+
+typedef std::pair<NodeIndex, NodeIndex> NodePair;
+typedef std::vector<std::vector<NodePair>> ShardedPairs;
+
+// Process all the nodes of the current work list at once. This reaches the
+// same fixpoint as processing them one by one, because every node whose
+// points-to set or copy edges change is put into the next work list.
+//
+// A round is split into four phases:
+//   1. HCD, which merges nodes, runs sequentially.
+//   2. For each node, a task resolves its load, store and copy edges. It
+//      collects the copy edges to add and the points-to sets to propagate.
+//      The task only writes the edges of its own node and does not change
+//      the merge targets.
+//   3. A task per shard snapshots the nodes in the shard that are also the
+//      targets of some propagations, so that they can be read while their
+//      points-to sets change.
+//   4. A task per shard adds the new copy edges whose source is in the shard,
+//      and performs the unions into the targets in the shard.
+template <typename PtsSetType>
+void solveRoundInParallel(AndersWorkList &currWorkList,
+                          AndersWorkList &nextWorkList,
+                          AndersNodeFactory &nodeFactory,
+                          ConstraintGraph &constraintGraph,
+                          AndersPtsGraph<PtsSetType> &ptsGraph,
+                          OfflineCycleDetector *offlineInfo,
+                          std::queue<NodePair> &cycleCandidates,
+                          DenseSet<NodePair> &checkedEdges) {
+  // Phase 1: collect the nodes and perform HCD
+  std::vector<NodeIndex> candidates;
+  while (!currWorkList.isEmpty()) {
+    NodeIndex node = nodeFactory.getMergeTarget(currWorkList.dequeue());
+    if (constraintGraph.getNodeWithIndex(node) == nullptr)
+      continue;
+    PtsSetType *ptsSet = ptsGraph.find(node);
+    if (ptsSet == nullptr)
+      continue;
+
+    if (offlineInfo != nullptr) {
+      NodeIndex collapseTarget = offlineInfo->getCollapseTarget(node);
+      if (collapseTarget != AndersNodeFactory::InvalidIndex) {
+        NodeIndex ctRep = nodeFactory.getMergeTarget(collapseTarget);
+        bool mergeSelf = false;
+        for (auto v : *ptsSet) {
+          NodeIndex vRep = nodeFactory.getMergeTarget(v);
+          if (vRep == node) {
+            mergeSelf = true;
+            continue;
+          }
+          collapseNodes(ctRep, vRep, nodeFactory, ptsGraph, constraintGraph);
+        }
 
-} // end of anonymous namespace
+        if (mergeSelf) {
+          collapseNodes(ctRep, node, nodeFactory, ptsGraph, constraintGraph);
+          if (ctRep != node) {
+            nextWorkList.enqueue(ctRep);
+            continue;
+          }
+        }
+      }
+    }
+    candidates.push_back(node);
+  }
+
+  // The merges above may have collapsed some candidates into others
+  std::vector<NodeIndex> nodes;
+  std::vector<std::pair<ConstraintGraphNode *, const PtsSetType *>> nodeInfo;
+  DenseSet<NodeIndex> nodeSet;
+  for (NodeIndex node : candidates) {
+    node = nodeFactory.getMergeTarget(node);
+    if (!nodeSet.insert(node).second)
+      continue;
+    ConstraintGraphNode *cNode = constraintGraph.getNodeWithIndex(node);
+    const PtsSetType *ptsSet = ptsGraph.find(node);
+    if (cNode == nullptr || ptsSet == nullptr)
+      continue;
+    nodes.push_back(node);
+    nodeInfo.emplace_back(cNode, ptsSet);
+  }
+
+  // Phase 2: resolve the edges of each node. Path compression in
+  // getMergeTarget() writes the node factory, so the tasks use the const one.
+  // A propagation is recorded as the position of its source in nodes
+  const AndersNodeFactory &factory = nodeFactory;
+  std::vector<ShardedPairs> newEdges(NumShards, ShardedPairs(NumShards));
+  std::vector<ShardedPairs> propagations(NumShards, ShardedPairs(NumShards));
+  // Wait for the futures rather than the pool, which polls every 10 ms
+  auto *pool = ThreadPool::get();
+  std::vector<std::future<void>> tasks;
+  auto waitForTasks = [&tasks]() {
+    for (auto &task : tasks)
+      task.wait();
+    tasks.clear();
+  };
+  for (unsigned chunk = 0; chunk < NumShards; ++chunk) {
+    tasks.push_back(pool->enqueue([&, chunk]() {
+      ShardedPairs &chunkEdges = newEdges[chunk];
+      ShardedPairs &chunkPropagations = propagations[chunk];
+      DenseMap<NodeIndex, NodeIndex> updateMap;
+      for (size_t i = chunk; i < nodes.size(); i += NumShards) {
+        NodeIndex node = nodes[i];
+        ConstraintGraphNode *cNode = nodeInfo[i].first;
+        const PtsSetType &ptsSet = *nodeInfo[i].second;
+
+        // Redirect the load and store edges to the merge targets first
+        updateMap.clear();
+        for (auto const &dst : cNode->loads()) {
+          NodeIndex tgtNode = factory.getMergeTarget(dst);
+          if (tgtNode != dst)
+            updateMap[dst] = tgtNode;
+        }
+        for (auto const &mapping : updateMap)
+          cNode->replaceLoadEdge(mapping.first, mapping.second);
+        updateMap.clear();
+        for (auto const &dst : cNode->stores()) {
+          NodeIndex tgtNode = factory.getMergeTarget(dst);
+          if (tgtNode != dst)
+            updateMap[dst] = tgtNode;
+        }
+        for (auto const &mapping : updateMap)
+          cNode->replaceStoreEdge(mapping.first, mapping.second);
 
-/// solveConstraints - This stage iteratively processes the constraints list
-/// propagating constraints (adding edges to the Nodes in the points-to graph)
-/// until a fixed point is reached.
-///
-/// We use a variant of the technique called "Lazy Cycle Detection", which is
-/// described in "The Ant and the Grasshopper: Fast and Accurate Pointer
-/// Analysis for Millions of Lines of Code. In Programming Language Design and
-/// Implementation (PLDI), June 2007."
-/// The paper describes performing cycle detection one node at a time, which can
-/// be expensive if there are no cycles, but there are long chains of nodes that
-/// it heuristically believes are cycles (because it will DFS from each node
-/// without state from previous nodes).
-/// Instead, we use the heuristic to build a worklist of nodes to check, then
-/// cycle detect them all at the same time to do this more cheaply.  This
-/// catches cycles slightly later than the original technique did, but does it
-/// make significantly cheaper.
-void Andersen::solveConstraints() {
-  // We'll do offline HCD first
-  OfflineCycleDetector offlineInfo(constraints, nodeFactory);
-  if (EnableHCD)
-    offlineInfo.run();
+        for (auto v : ptsSet) {
+          NodeIndex vRep = factory.getMergeTarget(v);
+          for (auto const &dst : cNode->loads())
+            chunkEdges[vRep % NumShards].emplace_back(vRep, dst);
+          for (auto const &dst : cNode->stores())
+            chunkEdges[dst % NumShards].emplace_back(dst, vRep);
+        }
 
-  // Now build the constraint graph
-  ConstraintGraph constraintGraph;
-  buildConstraintGraph(constraintGraph, constraints, nodeFactory, ptsGraph);
-  // The constraint vector is useless now
-  constraints.clear();
+        updateMap.clear();
+        for (auto const &dst : *cNode) {
+          NodeIndex tgtNode = factory.getMergeTarget(dst);
+          if (node == tgtNode)
+            continue;
+          chunkPropagations[tgtNode % NumShards].emplace_back(i, tgtNode);
+          if (tgtNode != dst)
+            updateMap[dst] = tgtNode;
+        }
+        for (auto const &mapping : updateMap)
+          cNode->replaceCopyEdge(mapping.first, mapping.second);
+      }
+    }));
+  }
+  waitForTasks();
+
+  // Phase 3: snapshot the nodes that are also targets in this round
+  std::vector<PtsSetType> snapshots(nodes.size());
+  std::vector<const PtsSetType *> sources(nodes.size());
+  std::vector<std::vector<size_t>> nodesByShard(NumShards);
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    sources[i] = nodeInfo[i].second;
+    nodesByShard[nodes[i] % NumShards].push_back(i);
+  }
+  for (unsigned shard = 0; shard < NumShards; ++shard) {
+    tasks.push_back(pool->enqueue([&, shard]() {
+      DenseSet<NodeIndex> targets;
+      for (auto const &chunkPropagations : propagations)
+        for (auto const &propagation : chunkPropagations[shard])
+          targets.insert(propagation.second);
+      for (size_t i : nodesByShard[shard]) {
+        if (targets.count(nodes[i])) {
+          snapshots[i] = *nodeInfo[i].second;
+          sources[i] = &snapshots[i];
+        }
+      }
+    }));
+  }
+  waitForTasks();
+
+  // Phase 4: add the copy edges and propagate the points-to sets by shards.
+  // A graph node that does not exist yet is created after the tasks, so the
+  // constraint graph is only read here
+  std::vector<std::vector<NodeIndex>> changed(NumShards);
+  std::vector<std::vector<NodePair>> cycleEdges(NumShards);
+  std::vector<std::vector<NodePair>> deferredEdges(NumShards);
+  for (unsigned shard = 0; shard < NumShards; ++shard) {
+    tasks.push_back(pool->enqueue([&, shard]() {
+      for (auto const &chunkEdges : newEdges) {
+        for (auto const &edge : chunkEdges[shard]) {
+          if (constraintGraph.getNodeWithIndex(edge.first) == nullptr)
+            deferredEdges[shard].push_back(edge);
+          else if (constraintGraph.insertCopyEdge(edge.first, edge.second))
+            changed[shard].push_back(edge.first);
+        }
+      }
+
+      for (auto const &chunkPropagations : propagations) {
+        for (auto const &propagation : chunkPropagations[shard]) {
+          const PtsSetType &srcPtsSet = *sources[propagation.first];
+          auto &tgtPtsSet = ptsGraph[propagation.second];
+          if (tgtPtsSet.unionWith(srcPtsSet))
+            changed[shard].push_back(propagation.second);
+          else if (EnableLCD && srcPtsSet == tgtPtsSet)
+            cycleEdges[shard].push_back(
+                std::make_pair(nodes[propagation.first], propagation.second));
+        }
+      }
+    }));
+  }
+  waitForTasks();
+
+  for (unsigned shard = 0; shard < NumShards; ++shard) {
+    for (auto const &edge : deferredEdges[shard])
+      if (constraintGraph.insertCopyEdge(edge.first, edge.second))
+        nextWorkList.enqueue(edge.first);
+    for (NodeIndex node : changed[shard])
+      nextWorkList.enqueue(node);
+    for (auto const &edgePair : cycleEdges[shard]) {
+      if (checkedEdges.insert(edgePair).second)
+        cycleCandidates.push(edgePair);
+    }
+  }
+}
+// With workers, a large round is solved in parallel. Neither CUDD nor the
+// pool of shared sets is thread-safe, so only the sparse bit vectors are
+// solved in parallel
+bool canSolveInParallel(PtsSetImpl impl) {
+  return !ThreadPool::get()->Workers.empty() &&
+         impl == PtsSetImpl::SPARSE_BITVECTOR;
+}
 
+// Propagate the points-to sets from the nodes in the work list until a fixed
+// point is reached. HCD is performed if offlineInfo is not null
+template <typename PtsSetType>
+void solveWorkList(AndersWorkList &workList, AndersNodeFactory &nodeFactory,
+                   ConstraintGraph &constraintGraph,
+                   AndersPtsGraph<PtsSetType> &ptsGraph,
+                   OfflineCycleDetector *offlineInfo, bool enableLCD,
+                   bool parallel) {
   // We switch between two work lists instead of relying on only one work list
-  AndersWorkList workList1, workList2;
+  AndersWorkList otherWorkList;
   // The "current" and the "next" work list
-  AndersWorkList *currWorkList = &workList1, *nextWorkList = &workList2;
+  AndersWorkList *currWorkList = &workList, *nextWorkList = &otherWorkList;
   // The set of nodes that LCD believes might be on a cycle
   std::queue<std::pair<NodeIndex, NodeIndex>> cycleCandidates;
   // The set of edges that LCD believes not on a cycle
   DenseSet<std::pair<NodeIndex, NodeIndex>> checkedEdges;
 
-  // Scan the node list, add it to work list if the node a representative and
-  // can contribute to the calculation right now.
-  for (auto const &mapping : ptsGraph) {
-    NodeIndex node = mapping.first;
-    if (nodeFactory.getMergeTarget(node) == node &&
-        constraintGraph.getNodeWithIndex(node) != nullptr)
-      currWorkList->enqueue(node);
-  }
-
   while (!currWorkList->isEmpty()) {
     // Iteration begins
 
     // First we've got to check if there is any cycle candidates in the last
     // iteration. If there is, detect and collapse cycle
-    if (EnableLCD && !cycleCandidates.empty()) {
+    if (enableLCD && !cycleCandidates.empty()) {
       // Detect and collapse cycles online
-      DefaultOnlineCycleDetector cycleDetector(nodeFactory, constraintGraph, ptsGraph,
-                                      cycleCandidates);
+      OnlineCycleDetectorT<PtsSetType> cycleDetector(
+          nodeFactory, constraintGraph, ptsGraph, cycleCandidates);
       cycleDetector.run();
       
       // Empty the queue
@@ -567,6 +550,15 @@ void Andersen::solveConstraints() {
       }
     }
 
+    if (parallel && currWorkList->size() >= MinParallelRoundSize) {
+      solveRoundInParallel(*currWorkList, *nextWorkList, nodeFactory,
+                           constraintGraph, ptsGraph,
+                           offlineInfo,
+                           cycleCandidates, checkedEdges);
+      std::swap(currWorkList, nextWorkList);
+      continue;
+    }
+
     while (!currWorkList->isEmpty()) {
       NodeIndex node = currWorkList->dequeue();
       node = nodeFactory.getMergeTarget(node);
@@ -576,16 +568,15 @@ void Andersen::solveConstraints() {
       if (cNode == nullptr)
         continue;
 
-      auto ptsItr = ptsGraph.find(node);
-      if (ptsItr != ptsGraph.end()) {
+      if (const auto *ptsSetPtr = ptsGraph.find(node)) {
         // Check indirect constraints and add copy edge to the constraint graph
         // if necessary
-        const auto &ptsSet = ptsItr->second;
+        const auto &ptsSet = *ptsSetPtr;
 
         // This is where we perform HCD: check if node has a collapse target,
         // and if it does, merge them immediately
-        if (EnableHCD) {
-          NodeIndex collapseTarget = offlineInfo.getCollapseTarget(node);
+        if (offlineInfo != nullptr) {
+          NodeIndex collapseTarget = offlineInfo->getCollapseTarget(node);
           if (collapseTarget != AndersNodeFactory::InvalidIndex) {
             // errs() << "node = " << node << ", collapseTgt = " <<
             // collapseTarget << "\n";
@@ -673,7 +664,7 @@ void Andersen::solveConstraints() {
 
           if (isChanged) {
             nextWorkList->enqueue(tgtNode);
-          } else if (EnableLCD) {
+          } else if (enableLCD) {
             // This is where we do lazy cycle detection.
             // If this is a cycle candidate (equal points-to sets and this
             // particular edge has not been cycle-checked previously), add to
@@ -698,3 +689,292 @@ void Andersen::solveConstraints() {
     std::swap(currWorkList, nextWorkList);
   }
 }
+
+} // end of anonymous namespace
+
+/// solveConstraints - This stage iteratively processes the constraints list
+/// propagating constraints (adding edges to the Nodes in the points-to graph)
+/// until a fixed point is reached.
+///
+/// We use a variant of the technique called "Lazy Cycle Detection", which is
+/// described in "The Ant and the Grasshopper: Fast and Accurate Pointer
+/// Analysis for Millions of Lines of Code. In Programming Language Design and
+/// Implementation (PLDI), June 2007."
+/// The paper describes performing cycle detection one node at a time, which can
+/// be expensive if there are no cycles, but there are long chains of nodes that
+/// it heuristically believes are cycles (because it will DFS from each node
+/// without state from previous nodes).
+/// Instead, we use the heuristic to build a worklist of nodes to check, then
+/// cycle detect them all at the same time to do this more cheaply.  This
+/// catches cycles slightly later than the original technique did, but does it
+/// make significantly cheaper.
+void Andersen::solveConstraints() {
+  // No node is created while solving, so the graphs never grow
+  if (ptsSetImpl == PtsSetImpl::BDD) {
+    // Size the domain of the BDDs before any set is created. The old sets are
+    // released first because the domain cannot grow while they are alive
+    bddPtsGraph.reset(nodeFactory.getNumNodes());
+    BDDPtsSetManager::get().reserve(nodeFactory.getNumNodes());
+    solveConstraints(bddPtsGraph);
+  } else if (ptsSetImpl == PtsSetImpl::SHARED) {
+    sharedPtsGraph.reset(nodeFactory.getNumNodes());
+    solveConstraints(sharedPtsGraph);
+  } else {
+    ptsGraph.reset(nodeFactory.getNumNodes());
+    solveConstraints(ptsGraph);
+  }
+}
+
+template <typename PtsSetType>
+void Andersen::solveConstraints(AndersPtsGraph<PtsSetType> &ptsGraph) {
+  // HCD and LCD merge nodes, which cannot be split in incremental mode
+  bool enableHCD = EnableHCD && !incremental;
+  bool enableLCD = EnableLCD && !incremental;
+
+  // We'll do offline HCD first
+  OfflineCycleDetector offlineInfo(constraints, nodeFactory);
+  if (enableHCD)
+    offlineInfo.run();
+
+  // Now build the constraint graph
+  constraintGraph = ConstraintGraph();
+  buildConstraintGraph(constraintGraph, constraints, nodeFactory, ptsGraph);
+  // The constraint vector is useless now
+  constraints.clear();
+
+  // Scan the node list, add it to work list if the node a representative and
+  // can contribute to the calculation right now.
+  AndersWorkList workList;
+  for (NodeIndex node = 0; node < ptsGraph.size(); ++node) {
+    if (ptsGraph.count(node) && nodeFactory.getMergeTarget(node) == node &&
+        constraintGraph.getNodeWithIndex(node) != nullptr)
+      workList.enqueue(node);
+  }
+
+  solveWorkList(workList, nodeFactory, constraintGraph, ptsGraph,
+                enableHCD ? &offlineInfo : nullptr, enableLCD,
+                canSolveInParallel(ptsSetImpl));
+
+  // The constraint graph is only needed to update the solution later
+  if (!incremental)
+    constraintGraph = ConstraintGraph();
+}
+
+bool Andersen::countConstraint(const AndersConstraint &c, bool add) {
+  if (add)
+    return constraintCounts[c]++ == 0;
+
+  auto itr = constraintCounts.find(c);
+  assert(itr != constraintCounts.end() && "Removing an unknown constraint!");
+  if (--itr->second != 0)
+    return false;
+  constraintCounts.erase(itr);
+  return true;
+}
+
+void Andersen::updateConstraints(const std::vector<AndersConstraint> &added,
+                                 const std::vector<AndersConstraint> &removed) {
+  assert(incremental && "Updating constraints requires the incremental mode!");
+
+  if (ptsSetImpl == PtsSetImpl::BDD) {
+    // The domain of the BDDs cannot grow while some sets are alive, so we
+    // start over if the new nodes do not fit in it
+    unsigned numBits = BDDPtsSetManager::get().getNumBits();
+    if (numBits < 32 && nodeFactory.getNumNodes() > (1u << numBits)) {
+      for (auto const &c : removed)
+        countConstraint(c, false);
+      for (auto const &c : added)
+        countConstraint(c, true);
+      solveFromScratch();
+      return;
+    }
+    updateSolution(bddPtsGraph, added, removed);
+  } else if (ptsSetImpl == PtsSetImpl::SHARED) {
+    updateSolution(sharedPtsGraph, added, removed);
+  } else {
+    updateSolution(ptsGraph, added, removed);
+  }
+}
+
+void Andersen::solveFromScratch() {
+  assert(incremental && "Solving again requires the incremental mode!");
+
+  constraints.clear();
+  for (auto const &mapping : constraintCounts)
+    constraints.push_back(mapping.first);
+  solveConstraints();
+}
+
+/// updateSolution - Update the solution after the constraints change, without
+/// solving the unaffected nodes again.
+///
+/// Adding constraints is monotone: the new edges and addresses are put into
+/// the graph, and the nodes they start from are propagated as usual. Removing
+/// constraints is not, so we over-approximate the region of the nodes whose
+/// points-to sets may shrink: the nodes reachable from the destinations of the
+/// removed constraints through the copy edges, the load edges, and the
+/// objects pointed to by the store pointers in the region. The points-to sets
+/// in the region are reset, the copy edges resolved into the region are
+/// dropped, and the region is solved again from its frontier, i.e. the
+/// addresses taken in the region and the nodes outside the region that copy,
+/// load or store into it. The nodes outside the region do not depend on the
+/// removed constraints, so their points-to sets are kept.
+template <typename PtsSetType>
+void Andersen::updateSolution(AndersPtsGraph<PtsSetType> &ptsGraph,
+                              const std::vector<AndersConstraint> &added,
+                              const std::vector<AndersConstraint> &removed) {
+  // The re-collected functions may have created some nodes
+  unsigned numNodes = nodeFactory.getNumNodes();
+  ptsGraph.grow(numNodes);
+
+  // First, remove the constraints and collect the nodes they directly affect
+  std::vector<NodeIndex> frontier;
+  for (auto const &c : removed) {
+    if (!countConstraint(c, false))
+      continue;
+
+    NodeIndex src = c.getSrc(), dst = c.getDest();
+    switch (c.getType()) {
+    case AndersConstraint::ADDR_OF: {
+      frontier.push_back(dst);
+      break;
+    }
+    case AndersConstraint::LOAD: {
+      constraintGraph.removeLoadEdge(src, dst);
+      frontier.push_back(dst);
+      break;
+    }
+    case AndersConstraint::STORE: {
+      constraintGraph.removeStoreEdge(dst, src);
+      if (const auto *ptsSet = ptsGraph.find(dst))
+        for (auto v : *ptsSet)
+          frontier.push_back(v);
+      break;
+    }
+    case AndersConstraint::COPY: {
+      constraintGraph.removeCopyEdge(src, dst);
+      frontier.push_back(dst);
+      break;
+    }
+    }
+  }
+
+  // Next, find the region affected by the removal
+  std::vector<char> inRegion(numNodes, 0);
+  std::vector<NodeIndex> region;
+  while (!frontier.empty()) {
+    NodeIndex node = frontier.back();
+    frontier.pop_back();
+    if (inRegion[node])
+      continue;
+    inRegion[node] = 1;
+    region.push_back(node);
+
+    ConstraintGraphNode *cNode = constraintGraph.getNodeWithIndex(node);
+    if (cNode == nullptr)
+      continue;
+    for (auto const &dst : *cNode)
+      frontier.push_back(dst);
+    for (auto const &dst : cNode->loads())
+      frontier.push_back(dst);
+    if (cNode->store_begin() != cNode->store_end()) {
+      if (const auto *ptsSet = ptsGraph.find(node))
+        for (auto v : *ptsSet)
+          frontier.push_back(v);
+    }
+  }
+
+  AndersWorkList workList;
+  if (!region.empty()) {
+    for (auto &mapping : constraintGraph) {
+      NodeIndex node = mapping.first;
+      ConstraintGraphNode &cNode = mapping.second;
+
+      // Drop the copy edges into the region that are not constraints. They
+      // are resolved from loads and stores, and are resolved again below
+      bool copiesIntoRegion = false;
+      std::vector<NodeIndex> resolvedEdges;
+      for (auto const &dst : cNode) {
+        if (!inRegion[dst])
+          continue;
+        if (constraintCounts.count(
+                AndersConstraint(AndersConstraint::COPY, dst, node)))
+          copiesIntoRegion = true;
+        else
+          resolvedEdges.push_back(dst);
+      }
+      for (NodeIndex dst : resolvedEdges)
+        constraintGraph.removeCopyEdge(node, dst);
+
+      if (inRegion[node])
+        continue;
+
+      // The nodes outside the region that flow into it are the frontier
+      bool intoRegion = copiesIntoRegion;
+      for (auto const &dst : cNode.loads())
+        intoRegion |= inRegion[dst] != 0;
+      if (!intoRegion && cNode.store_begin() != cNode.store_end()) {
+        if (const auto *ptsSet = ptsGraph.find(node)) {
+          for (auto v : *ptsSet) {
+            if (inRegion[v]) {
+              intoRegion = true;
+              break;
+            }
+          }
+        }
+      }
+      if (intoRegion)
+        workList.enqueue(node);
+    }
+
+    // Reset the region, and take the addresses in it again. The ADDR_OF
+    // constraints to the same node are adjacent in constraintCounts
+    for (NodeIndex node : region)
+      ptsGraph.erase(node);
+    for (NodeIndex node : region) {
+      for (auto itr = constraintCounts.lower_bound(AndersConstraint(
+               AndersConstraint::ADDR_OF, node, AndersNodeFactory::InvalidIndex));
+           itr != constraintCounts.end() &&
+           itr->first.getType() == AndersConstraint::ADDR_OF &&
+           itr->first.getDest() == node;
+           ++itr) {
+        ptsGraph[node].insert(itr->first.getSrc());
+        workList.enqueue(node);
+      }
+    }
+  }
+
+  // Then, add the new constraints
+  for (auto const &c : added) {
+    if (!countConstraint(c, true))
+      continue;
+
+    NodeIndex src = c.getSrc(), dst = c.getDest();
+    switch (c.getType()) {
+    case AndersConstraint::ADDR_OF: {
+      if (ptsGraph[dst].insert(src))
+        workList.enqueue(dst);
+      break;
+    }
+    case AndersConstraint::LOAD: {
+      constraintGraph.insertLoadEdge(src, dst);
+      workList.enqueue(src);
+      break;
+    }
+    case AndersConstraint::STORE: {
+      constraintGraph.insertStoreEdge(dst, src);
+      workList.enqueue(dst);
+      break;
+    }
+    case AndersConstraint::COPY: {
+      constraintGraph.insertCopyEdge(src, dst);
+      workList.enqueue(src);
+      break;
+    }
+    }
+  }
+
+  // Finally, propagate from the frontier
+  solveWorkList(workList, nodeFactory, constraintGraph, ptsGraph, nullptr,
+                false, canSolveInParallel(ptsSetImpl));
+}
@@ -127,8 +127,10 @@ bool Andersen::addConstraintForExternalLibrary(const CallBase *cs,
       (isReallocLike && !isa<ConstantPointerNull>(cs->getArgOperand(0)))) {
     const Instruction *inst = cs;
 
-    // Create the obj node
-    NodeIndex objIndex = nodeFactory.createObjectNode(inst);
+    // Create the obj node, unless the function is re-collected
+    NodeIndex objIndex = nodeFactory.getObjectNodeFor(inst);
+    if (objIndex == AndersNodeFactory::InvalidIndex)
+      objIndex = nodeFactory.createObjectNode(inst);
 
     // Get the pointer node
     NodeIndex ptrIndex = nodeFactory.getValueNodeFor(inst);
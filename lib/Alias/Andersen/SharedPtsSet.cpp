@@ -0,0 +1,335 @@
+#include <llvm/Support/MathExtras.h>
+
+#include <algorithm>
+
+#include "Alias/Andersen/SharedPtsSet.h"
+
+
+using namespace llvm;
+
+typedef SharedPtsSetPool::Block Block;
+
+// The number of dead sets, or cached unions, that triggers a flush of the
+// union cache
+static const size_t MaxDeadSets = 1 << 16;
+static const size_t MaxCachedUnions = 1 << 20;
+
+static size_t hashBlocks(const std::vector<Block> &blocks) {
+  size_t hash = blocks.size();
+  for (auto const &b : blocks) {
+    hash = (hash ^ b.index) * 0x100000001b3ULL;
+    hash = (hash ^ b.bits) * 0x9e3779b97f4a7c15ULL;
+  }
+  return hash;
+}
+
+static unsigned countBits(const std::vector<Block> &blocks) {
+  unsigned size = 0;
+  for (auto const &b : blocks)
+    size += countPopulation(b.bits);
+  return size;
+}
+
+// Return true if every element of sub is in super
+static bool isSubset(const std::vector<Block> &sub,
+                     const std::vector<Block> &super) {
+  auto itr = super.begin(), ite = super.end();
+  for (auto const &b : sub) {
+    while (itr != ite && itr->index < b.index)
+      ++itr;
+    if (itr == ite || itr->index != b.index || (b.bits & ~itr->bits) != 0)
+      return false;
+  }
+  return true;
+}
+
+// Return true if lhs and rhs share an element other than ignored
+static bool intersects(const std::vector<Block> &lhs,
+                       const std::vector<Block> &rhs,
+                       unsigned ignored = ~0u) {
+  unsigned ignoredIndex = ignored / 64;
+  uint64_t ignoredMask = uint64_t(1) << (ignored % 64);
+  auto litr = lhs.begin(), lite = lhs.end();
+  auto ritr = rhs.begin(), rite = rhs.end();
+  while (litr != lite && ritr != rite) {
+    if (litr->index < ritr->index) {
+      ++litr;
+    } else if (ritr->index < litr->index) {
+      ++ritr;
+    } else {
+      uint64_t common = litr->bits & ritr->bits;
+      if (litr->index == ignoredIndex)
+        common &= ~ignoredMask;
+      if (common != 0)
+        return true;
+      ++litr;
+      ++ritr;
+    }
+  }
+  return false;
+}
+
+SharedPtsSetPool::SharedPtsSetPool() {
+  // The empty set, which is never freed
+  entries.emplace_back();
+}
+
+SharedPtsSetPool &SharedPtsSetPool::get() {
+  // Never destroyed, so that a set with static storage duration can still
+  // release its reference at exit
+  static SharedPtsSetPool *instance = new SharedPtsSetPool();
+  return *instance;
+}
+
+size_t SharedPtsSetPool::getMemoryUsage() const {
+  size_t bytes = entries.size() * sizeof(Entry);
+  for (auto const &entry : entries)
+    bytes += entry.blocks.capacity() * sizeof(Block);
+  return bytes;
+}
+
+unsigned SharedPtsSetPool::intern(std::vector<Block> &&blocks) {
+  if (blocks.empty())
+    return 0;
+
+  size_t hash = hashBlocks(blocks);
+  auto range = table.equal_range(hash);
+  for (auto itr = range.first; itr != range.second; ++itr) {
+    Entry &entry = entries[itr->second];
+    if (entry.blocks == blocks) {
+      ++entry.refs;
+      return itr->second;
+    }
+  }
+
+  unsigned id;
+  if (!freeIds.empty()) {
+    id = freeIds.back();
+    freeIds.pop_back();
+  } else {
+    id = entries.size();
+    entries.emplace_back();
+  }
+  Entry &entry = entries[id];
+  entry.size = countBits(blocks);
+  entry.blocks = std::move(blocks);
+  entry.blocks.shrink_to_fit();
+  entry.refs = 1;
+  entry.hash = hash;
+  table.emplace(hash, id);
+  return id;
+}
+
+void SharedPtsSetPool::release(unsigned id) {
+  if (id == 0)
+    return;
+
+  Entry &entry = entries[id];
+  assert(entry.refs > 0 && "Releasing a dead points-to set!");
+  if (--entry.refs != 0)
+    return;
+
+  auto range = table.equal_range(entry.hash);
+  for (auto itr = range.first; itr != range.second; ++itr) {
+    if (itr->second == id) {
+      table.erase(itr);
+      break;
+    }
+  }
+  std::vector<Block>().swap(entry.blocks);
+  entry.size = 0;
+
+  // The union cache may still refer to this id, so it cannot be reused yet
+  deadIds.push_back(id);
+  if (deadIds.size() >= MaxDeadSets)
+    flushUnionCache();
+}
+
+void SharedPtsSetPool::flushUnionCache() {
+  unionCache.clear();
+  freeIds.insert(freeIds.end(), deadIds.begin(), deadIds.end());
+  deadIds.clear();
+}
+
+unsigned SharedPtsSetPool::getUnion(unsigned a, unsigned b) {
+  assert(a != 0 && b != 0 && a != b);
+  ++numUnions;
+
+  auto key = std::make_pair(std::min(a, b), std::max(a, b));
+  auto cacheItr = unionCache.find(key);
+  if (cacheItr != unionCache.end() && entries[cacheItr->second].refs != 0) {
+    ++numUnionCacheHits;
+    retain(cacheItr->second);
+    return cacheItr->second;
+  }
+
+  const Entry &lhs = entries[a], &rhs = entries[b];
+  unsigned result;
+  if (lhs.size >= rhs.size && isSubset(rhs.blocks, lhs.blocks)) {
+    result = a;
+    retain(a);
+  } else if (rhs.size > lhs.size && isSubset(lhs.blocks, rhs.blocks)) {
+    result = b;
+    retain(b);
+  } else {
+    std::vector<Block> blocks;
+    blocks.reserve(lhs.blocks.size() + rhs.blocks.size());
+    auto litr = lhs.blocks.begin(), lite = lhs.blocks.end();
+    auto ritr = rhs.blocks.begin(), rite = rhs.blocks.end();
+    while (litr != lite || ritr != rite) {
+      if (ritr == rite || (litr != lite && litr->index < ritr->index)) {
+        blocks.push_back(*litr++);
+      } else if (litr == lite || ritr->index < litr->index) {
+        blocks.push_back(*ritr++);
+      } else {
+        blocks.push_back({litr->index, litr->bits | ritr->bits});
+        ++litr;
+        ++ritr;
+      }
+    }
+    result = intern(std::move(blocks));
+  }
+
+  if (unionCache.size() >= MaxCachedUnions)
+    flushUnionCache();
+  unionCache[key] = result;
+  return result;
+}
+
+SharedAndersPtsSet::iterator::iterator(unsigned id) : id(id) {
+  const auto &blocks = SharedPtsSetPool::get().getEntry(id).blocks;
+  if (blocks.empty())
+    return;
+
+  SharedPtsSetPool::get().retain(id);
+  block = blocks.data();
+  blockEnd = block + blocks.size();
+  remaining = block->bits;
+  settle();
+}
+
+SharedAndersPtsSet::iterator::iterator(const iterator &other)
+    : id(other.id), block(other.block), blockEnd(other.blockEnd),
+      remaining(other.remaining), value(other.value) {
+  if (block != nullptr)
+    SharedPtsSetPool::get().retain(id);
+}
+
+SharedAndersPtsSet::iterator &
+SharedAndersPtsSet::iterator::operator=(const iterator &other) {
+  SharedPtsSetPool &pool = SharedPtsSetPool::get();
+  if (other.block != nullptr)
+    pool.retain(other.id);
+  if (block != nullptr)
+    pool.release(id);
+  id = other.id;
+  block = other.block;
+  blockEnd = other.blockEnd;
+  remaining = other.remaining;
+  value = other.value;
+  return *this;
+}
+
+SharedAndersPtsSet::iterator::~iterator() {
+  if (block != nullptr)
+    SharedPtsSetPool::get().release(id);
+}
+
+void SharedAndersPtsSet::iterator::settle() {
+  while (remaining == 0) {
+    if (++block == blockEnd) {
+      // Drop the reference now that we are at the end
+      SharedPtsSetPool::get().release(id);
+      block = blockEnd = nullptr;
+      return;
+    }
+    remaining = block->bits;
+  }
+  value = block->index * 64 + countTrailingZeros(remaining);
+}
+
+SharedAndersPtsSet &
+SharedAndersPtsSet::operator=(const SharedAndersPtsSet &other) {
+  SharedPtsSetPool &pool = SharedPtsSetPool::get();
+  pool.retain(other.id);
+  pool.release(id);
+  id = other.id;
+  return *this;
+}
+
+SharedAndersPtsSet &SharedAndersPtsSet::operator=(SharedAndersPtsSet &&other) {
+  if (this != &other) {
+    SharedPtsSetPool::get().release(id);
+    id = other.id;
+    other.id = 0;
+  }
+  return *this;
+}
+
+bool SharedAndersPtsSet::has(unsigned idx) const {
+  const auto &blocks = SharedPtsSetPool::get().getEntry(id).blocks;
+  unsigned index = idx / 64;
+  auto itr = std::lower_bound(
+      blocks.begin(), blocks.end(), index,
+      [](const Block &b, unsigned index) { return b.index < index; });
+  return itr != blocks.end() && itr->index == index &&
+         (itr->bits >> (idx % 64)) & 1;
+}
+
+bool SharedAndersPtsSet::insert(unsigned idx) {
+  if (has(idx))
+    return false;
+
+  // Union with the singleton set, which is memoized as any other union
+  SharedAndersPtsSet singleton;
+  singleton.id = SharedPtsSetPool::get().intern(
+      {{idx / 64, uint64_t(1) << (idx % 64)}});
+  return unionWith(singleton);
+}
+
+bool SharedAndersPtsSet::contains(const SharedAndersPtsSet &other) const {
+  if (id == other.id || other.id == 0)
+    return true;
+  SharedPtsSetPool &pool = SharedPtsSetPool::get();
+  const auto &lhs = pool.getEntry(id), &rhs = pool.getEntry(other.id);
+  return lhs.size >= rhs.size && isSubset(rhs.blocks, lhs.blocks);
+}
+
+bool SharedAndersPtsSet::intersectWith(const SharedAndersPtsSet &other) const {
+  if (id == 0 || other.id == 0)
+    return false;
+  if (id == other.id)
+    return true;
+  SharedPtsSetPool &pool = SharedPtsSetPool::get();
+  return intersects(pool.getEntry(id).blocks, pool.getEntry(other.id).blocks);
+}
+
+bool SharedAndersPtsSet::intersectWith(const SharedAndersPtsSet &other,
+                                       unsigned ignored) const {
+  if (id == 0 || other.id == 0)
+    return false;
+  SharedPtsSetPool &pool = SharedPtsSetPool::get();
+  return intersects(pool.getEntry(id).blocks, pool.getEntry(other.id).blocks,
+                    ignored);
+}
+
+bool SharedAndersPtsSet::unionWith(const SharedAndersPtsSet &other) {
+  if (other.id == id || other.id == 0)
+    return false;
+
+  SharedPtsSetPool &pool = SharedPtsSetPool::get();
+  if (id == 0) {
+    pool.retain(other.id);
+    id = other.id;
+    return true;
+  }
+
+  unsigned result = pool.getUnion(id, other.id);
+  if (result == id) {
+    pool.release(result);
+    return false;
+  }
+  pool.release(id);
+  id = result;
+  return true;
+}
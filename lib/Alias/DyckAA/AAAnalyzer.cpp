@@ -20,6 +20,7 @@
 #include <llvm/IR/InstIterator.h>
 #include "Alias/DyckAA/AAAnalyzer.h"
 #include "Support/RecursiveTimer.h"
+#include "Support/ThreadPool.h"
 
 static cl::opt<unsigned> FunctionTypeCheckLevel("function-type-check-level", cl::init(4), cl::Hidden,
                                                 cl::desc("The level of checking the compatability of function types"
@@ -38,6 +39,12 @@ static cl::opt<bool> PrintUnknownPointerCall("print-unknown-ptr-call", cl::init(
 static cl::opt<unsigned> NumInterIteration("dyckaa-inter-iteration", cl::init(UINT_MAX), cl::Hidden,
                                            cl::desc("The max # iterators for fixed-point inter-proc computation."));
 
+std::string AAAnalyzer::getOptionString() {
+    return "function-type-check-level=" + std::to_string(FunctionTypeCheckLevel) +
+           ";with-function-cast-comb=" + std::to_string(WithFunctionCastComb) +
+           ";dyckaa-inter-iteration=" + std::to_string(NumInterIteration);
+}
+
 AAAnalyzer::AAAnalyzer(Module *M, DyckGraph *DG, DyckCallGraph *CG) {
     Mod = M;
     CFLGraph = DG;
@@ -46,6 +53,14 @@ AAAnalyzer::AAAnalyzer(Module *M, DyckGraph *DG, DyckCallGraph *CG) {
     initFunctionGroups();
 }
 
+AAAnalyzer::AAAnalyzer(AAAnalyzer *Global, Function *F) : LocalFunc(F) {
+    Mod = Global->Mod;
+    DL = Global->DL;
+    DyckCG = Global->DyckCG;
+    LocalGraph.reset(new DyckGraph(Global->CFLGraph));
+    CFLGraph = LocalGraph.get();
+}
+
 AAAnalyzer::~AAAnalyzer() {
     destroyFunctionGroups();
 }
@@ -54,22 +69,86 @@ void AAAnalyzer::intraProcedureAnalysis() {
     RecursiveTimer IntraAA("Running intra-procedural analysis");
     long InstNum = 0;
     long IntrinsicsNum = 0;
+    std::vector<Function *> Functions;
     for (auto &F: *Mod) {
         if (F.isIntrinsic()) {
             // intrinsics are handled as instructions
             IntrinsicsNum++;
             continue;
         }
-        DyckCallGraphNode *DF = DyckCG->getOrInsertFunction(&F);
-        for (auto &I: instructions(F)) {
-            InstNum++;
-            handleInst(&I, DF);
+        InstNum += F.getInstructionCount();
+        Functions.push_back(&F);
+    }
+
+    if (ThreadPool::get()->Workers.empty()) {
+        for (auto *F: Functions) collectFunctionConstraints(F);
+    } else {
+        // functions are collected into their own graphs in parallel,
+        // and then merged into the global graph in the order of functions.
+        std::vector<std::unique_ptr<AAAnalyzer>> Locals(Functions.size());
+        {
+            RecursiveTimer CollectTimer("Collecting constraints in parallel");
+            for (unsigned K = 0; K < Functions.size(); ++K) {
+                if (Functions[K]->empty()) continue;
+                ThreadPool::get()->enqueue([this, K, &Functions, &Locals]() {
+                    auto *Local = new AAAnalyzer(this, Functions[K]);
+                    Local->collectFunctionConstraints(Functions[K]);
+                    Locals[K].reset(Local);
+                });
+            }
+            ThreadPool::get()->wait();
+        }
+
+        RecursiveTimer MergeTimer("Merging local constraint graphs");
+        for (unsigned K = 0; K < Functions.size(); ++K) {
+            DyckCG->getOrInsertFunction(Functions[K]);
+            if (Locals[K]) mergeLocalAnalyzer(Locals[K].get());
+            Locals[K].reset();
         }
     }
     DEBUG_WITH_TYPE("dyckaa-stats", errs() << "\n# Instructions: " << InstNum << "\n");
     DEBUG_WITH_TYPE("dyckaa-stats", errs() << "# Functions: " << Mod->size() - IntrinsicsNum << "\n");
 }
 
+void AAAnalyzer::collectFunctionConstraints(Function *F) {
+    if (!LocalFunc) DyckCG->getOrInsertFunction(F);
+    for (auto &I: instructions(F)) {
+        handleInst(&I, F);
+    }
+}
+
+void AAAnalyzer::mergeLocalAnalyzer(AAAnalyzer *Local) {
+    CFLGraph->merge(Local->CFLGraph, [this](void *V) { return wrapValue((Value *) V); });
+    for (auto &Update: Local->PendingUpdates)
+        updateCallGraph(Update.Kind, Update.Caller, Update.Val, Update.CalledValue, &Update.Args);
+    for (auto &Combination: Local->PendingCombinations)
+        combineFunctionGroups(Combination.first, Combination.second);
+}
+
+void AAAnalyzer::updateCallGraph(CallGraphUpdate::UpdateKind Kind, Function *Caller, Value *Val,
+                                 Value *CalledValue, std::vector<Value *> *Args) {
+    if (LocalFunc) {
+        PendingUpdates.push_back({Kind, Caller, Val, CalledValue, Args ? *Args : std::vector<Value *>()});
+        return;
+    }
+
+    auto *Parent = DyckCG->getOrInsertFunction(Caller);
+    switch (Kind) {
+        case CallGraphUpdate::UK_Ret:
+            Parent->addRet(Val);
+            break;
+        case CallGraphUpdate::UK_VAArg:
+            Parent->addVAArg(Val);
+            break;
+        case CallGraphUpdate::UK_CommonCall:
+            Parent->addCommonCall(new CommonCall((Instruction *) Val, (Function *) CalledValue, Args));
+            break;
+        case CallGraphUpdate::UK_PointerCall:
+            Parent->addPointerCall(new PointerCall((Instruction *) Val, CalledValue, Args));
+            break;
+    }
+}
+
 void AAAnalyzer::interProcedureAnalysis() {
     RecursiveTimer IntraAA("Running inter-procedural analysis");
 
@@ -291,6 +370,10 @@ void AAAnalyzer::destroyFunctionGroups() {
 
 void AAAnalyzer::combineFunctionGroups(FunctionType *FTyX, FunctionType *FTyY) {
     if (!WithFunctionCastComb) return;
+    if (LocalFunc) {
+        PendingCombinations.emplace_back(FTyX, FTyY);
+        return;
+    }
 
     FunctionTypeNode *X = this->initFunctionGroup(FTyX)->Root;
     FunctionTypeNode *Y = this->initFunctionGroup(FTyY)->Root;
@@ -306,10 +389,8 @@ void AAAnalyzer::combineFunctionGroups(FunctionType *FTyX, FunctionType *FTyY) {
 
 DyckGraphNode *AAAnalyzer::addField(DyckGraphNode *Val, long FieldIndex, DyckGraphNode *Field) {
     if (!Field) {
-        auto *ValRepSet = Val->getOutVertices((void *) (CFLGraph->getOrInsertIndexEdgeLabel(FieldIndex)));
-        if (ValRepSet && !ValRepSet->empty()) {
-            Field = *(ValRepSet->begin());
-        } else {
+        Field = Val->getOutVertex((void *) (CFLGraph->getOrInsertIndexEdgeLabel(FieldIndex)));
+        if (!Field) {
             Field = CFLGraph->retrieveDyckVertex(nullptr).first;
             Val->addTarget(Field, (void *) (CFLGraph->getOrInsertIndexEdgeLabel(FieldIndex)));
         }
@@ -328,10 +409,8 @@ DyckGraphNode *AAAnalyzer::addPtrTo(DyckGraphNode *Address, DyckGraphNode *Val)
         Address->addTarget(Val, DLabel);
         return Address;
     } else if (!Val) {
-        std::set<DyckGraphNode *> *DerefSet = Address->getOutVertices(DLabel);
-        if (DerefSet && !DerefSet->empty()) {
-            Val = *(DerefSet->begin());
-        } else {
+        Val = Address->getOutVertex(DLabel);
+        if (!Val) {
             Val = CFLGraph->retrieveDyckVertex(nullptr).first;
             Address->addTarget(Val, DLabel);
         }
@@ -407,6 +486,11 @@ DyckGraphNode *AAAnalyzer::wrapValue(Value *V) {
     }
     DyckGraphNode *VDV = RetPair.first;
 
+    // a function-local analyzer leaves the constants and globals to the global one
+    if (LocalFunc && !isa<Instruction>(V) && !isa<Argument>(V) && !isa<BasicBlock>(V)) {
+        return VDV;
+    }
+
     // constantTy are handled as below.
     if (isa<ConstantExpr>(V)) {
         unsigned Opcode = ((ConstantExpr *) V)->getOpcode();
@@ -671,7 +755,7 @@ std::set<Function *> *AAAnalyzer::getCompatibleFunctions(FunctionType *FTy) {
     return &(FTyNode->Root->CompatibleFuncs);
 }
 
-void AAAnalyzer::handleInst(Instruction *Inst, DyckCallGraphNode *Parent) {
+void AAAnalyzer::handleInst(Instruction *Inst, Function *Parent) {
     int Mask = 0;
 
     switch (Inst->getOpcode()) {
@@ -680,7 +764,7 @@ void AAAnalyzer::handleInst(Instruction *Inst, DyckCallGraphNode *Parent) {
         case Instruction::Ret: {
             ReturnInst *RetInst = ((ReturnInst *) Inst);
             if (RetInst->getNumOperands() > 0 && !RetInst->getOperandUse(0)->getType()->isVoidTy()) {
-                Parent->addRet(RetInst->getOperandUse(0));
+                updateCallGraph(CallGraphUpdate::UK_Ret, Parent, RetInst->getOperandUse(0));
             }
         }
             break;
@@ -869,7 +953,7 @@ void AAAnalyzer::handleInst(Instruction *Inst, DyckCallGraphNode *Parent) {
         }
             break;
         case Instruction::VAArg: {
-            Parent->addVAArg(Inst);
+            updateCallGraph(CallGraphUpdate::UK_VAArg, Parent, Inst);
             DyckGraphNode *VAArg = wrapValue(Inst);
             Value *PtrVAArg = Inst->getOperand(0);
             addPtrTo(wrapValue(PtrVAArg), VAArg);
@@ -923,13 +1007,13 @@ void AAAnalyzer::handleExtractInsertElmtInst(Value *Vec, Value *Elmt) {
 }
 
 void AAAnalyzer::handleInvokeCallInst(Instruction *Ret, Value *CV, std::vector<Value *> *Args,
-                                      DyckCallGraphNode *Parent) {
+                                      Function *Parent) {
     if (isa<Function>(CV)) {
         if (((Function *) CV)->isIntrinsic()) {
             handleInstrinsic((Instruction *) Ret);
         } else {
-            this->handleLibInvokeCallInst(Ret, (Function *) CV, Args, Parent);
-            Parent->addCommonCall(new CommonCall(Ret, (Function *) CV, Args));
+            this->handleLibInvokeCallInst(Ret, (Function *) CV, Args);
+            updateCallGraph(CallGraphUpdate::UK_CommonCall, Parent, Ret, CV, Args);
         }
     } else {
         wrapValue(CV);
@@ -940,11 +1024,10 @@ void AAAnalyzer::handleInvokeCallInst(Instruction *Ret, Value *CV, std::vector<V
             }
 
             if (isa<Function>(CVCopy)) {
-                this->handleLibInvokeCallInst(Ret, (Function *) CVCopy, Args, Parent);
-                Parent->addCommonCall(new CommonCall(Ret, (Function *) CVCopy, Args));
+                this->handleLibInvokeCallInst(Ret, (Function *) CVCopy, Args);
+                updateCallGraph(CallGraphUpdate::UK_CommonCall, Parent, Ret, CVCopy, Args);
             } else {
-                auto *PCall = new PointerCall(Ret, CV, Args);
-                Parent->addPointerCall(PCall);
+                updateCallGraph(CallGraphUpdate::UK_PointerCall, Parent, Ret, CV, Args);
             }
         } else if (isa<GlobalAlias>(CV)) {
             Value *CVCopy = CV;
@@ -953,15 +1036,13 @@ void AAAnalyzer::handleInvokeCallInst(Instruction *Ret, Value *CV, std::vector<V
             }
 
             if (isa<Function>(CVCopy)) {
-                this->handleLibInvokeCallInst(Ret, (Function *) CVCopy, Args, Parent);
-                Parent->addCommonCall(new CommonCall(Ret, (Function *) CVCopy, Args));
+                this->handleLibInvokeCallInst(Ret, (Function *) CVCopy, Args);
+                updateCallGraph(CallGraphUpdate::UK_CommonCall, Parent, Ret, CVCopy, Args);
             } else {
-                auto *PCall = new PointerCall(Ret, CV, Args);
-                Parent->addPointerCall(PCall);
+                updateCallGraph(CallGraphUpdate::UK_PointerCall, Parent, Ret, CV, Args);
             }
         } else {
-            auto *PCall = new PointerCall(Ret, CV, Args);
-            Parent->addPointerCall(PCall);
+            updateCallGraph(CallGraphUpdate::UK_PointerCall, Parent, Ret, CV, Args);
         }
     }
 }
@@ -1091,7 +1172,7 @@ bool AAAnalyzer::handlePointerFunctionCalls(DyckCallGraphNode *Caller, int Count
             if (!Ret) Ret = true;
             PCall->addMayAliasedFunction(MayAliasedFunctioin);
             handleCommonFunctionCall(PCall, Caller, DyckCG->getOrInsertFunction(MayAliasedFunctioin));
-            handleLibInvokeCallInst(PCall->getInstruction(), MayAliasedFunctioin, &(PCall->getArgs()), Caller);
+            handleLibInvokeCallInst(PCall->getInstruction(), MayAliasedFunctioin, &(PCall->getArgs()));
             PFIt++;
         }
 
@@ -1101,8 +1182,7 @@ bool AAAnalyzer::handlePointerFunctionCalls(DyckCallGraphNode *Caller, int Count
     return Ret;
 }
 
-void AAAnalyzer::handleLibInvokeCallInst(Value *Ret, Function *F, const std::vector<Value *> *Args,
-                                         DyckCallGraphNode *Parent) {
+void AAAnalyzer::handleLibInvokeCallInst(Value *Ret, Function *F, const std::vector<Value *> *Args) {
     // args must be the real arguments, not the parameters.
     if (!F->empty() || F->isIntrinsic())
         return;
@@ -1177,7 +1257,7 @@ void AAAnalyzer::handleLibInvokeCallInst(Value *Ret, Function *F, const std::vec
             if (FName == "pthread_create") {
                 std::vector<Value *> XArgs;
                 XArgs.push_back(Args->at(3));
-                handleInvokeCallInst(nullptr, Args->at(2), &XArgs, DyckCG->getOrInsertFunction(F));
+                handleInvokeCallInst(nullptr, Args->at(2), &XArgs, F);
             }
         }
             break;
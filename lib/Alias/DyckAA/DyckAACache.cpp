@@ -0,0 +1,612 @@
+/*
+ *  Canary features a fast unification-based alias analysis for C programs
+ *  Copyright (C) 2021 Qingkai Shi <qingkaishi@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MD5.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/Process.h>
+#include <llvm/Support/raw_ostream.h>
+#include <cstring>
+#include "Alias/DyckAA/AAAnalyzer.h"
+#include "Alias/DyckAA/DyckAACache.h"
+#include "Alias/DyckAA/DyckCallGraph.h"
+#include "Alias/DyckAA/DyckGraph.h"
+#include "Alias/DyckAA/DyckGraphEdgeLabel.h"
+#include "Alias/DyckAA/DyckModRefAnalysis.h"
+
+static cl::opt<std::string> CacheDir("dyckaa-cache-dir", cl::init(""), cl::Hidden,
+                                     cl::desc("The directory where the results of dyckaa are cached."));
+
+/// the magic number and the version of the file format, bump the version if the format changes
+/// @{
+static const char CacheMagic[8] = {'D', 'Y', 'C', 'K', 'A', 'A', 'C', '\0'};
+static const uint32_t CacheVersion = 1;
+/// @}
+
+/// section tags
+enum : uint32_t {
+    ST_Graph = 1, ST_CallGraph = 2, ST_ModRef = 3
+};
+
+static const unsigned NullId = ~0U;
+
+namespace {
+class Writer {
+private:
+    std::string &Out;
+
+public:
+    explicit Writer(std::string &O) : Out(O) {}
+
+    void write32(uint32_t V) { Out.append((const char *) &V, sizeof(V)); }
+
+    void write64(uint64_t V) { Out.append((const char *) &V, sizeof(V)); }
+
+    void writeIds(const std::vector<unsigned> &Ids) {
+        write32(Ids.size());
+        for (auto Id: Ids) write32(Id);
+    }
+};
+
+/// reads a payload, every read is bounds-checked and a failure makes the reader invalid
+class Reader {
+private:
+    const char *Cur;
+    const char *End;
+    bool Valid = true;
+
+public:
+    explicit Reader(StringRef Data) : Cur(Data.begin()), End(Data.end()) {}
+
+    bool valid() const { return Valid; }
+
+    bool atEnd() const { return Cur == End; }
+
+    uint32_t read32() {
+        uint32_t V = 0;
+        if (End - Cur < (long) sizeof(V)) {
+            Valid = false;
+            return 0;
+        }
+        memcpy(&V, Cur, sizeof(V));
+        Cur += sizeof(V);
+        return V;
+    }
+
+    uint64_t read64() {
+        uint64_t V = 0;
+        if (End - Cur < (long) sizeof(V)) {
+            Valid = false;
+            return 0;
+        }
+        memcpy(&V, Cur, sizeof(V));
+        Cur += sizeof(V);
+        return V;
+    }
+
+    /// read a count of items that take at least \p MinSize bytes each
+    uint32_t readCount(unsigned MinSize) {
+        auto N = read32();
+        if ((uint64_t) N * MinSize > (uint64_t) (End - Cur)) {
+            Valid = false;
+            return 0;
+        }
+        return N;
+    }
+
+    void fail() { Valid = false; }
+};
+} // end of anonymous namespace
+
+std::unique_ptr<DyckAACache> DyckAACache::open(Module &M) {
+    if (CacheDir.empty()) return nullptr;
+
+    // the bitcode is hashed rather than the text, which is a few times slower to print
+    SmallVector<char, 0> Bitcode;
+    raw_svector_ostream OS(Bitcode);
+    WriteBitcodeToFile(M, OS);
+    MD5 Hash;
+    Hash.update(StringRef(Bitcode.data(), Bitcode.size()));
+    Hash.update(AAAnalyzer::getOptionString());
+    MD5::MD5Result Result;
+    Hash.final(Result);
+    std::string Key = Result.digest().str().str();
+
+    SmallString<256> Path(CacheDir.getValue());
+    sys::path::append(Path, Key + ".dyckaa");
+    return std::unique_ptr<DyckAACache>(new DyckAACache(M, Path.str().str(), Key));
+}
+
+DyckAACache::DyckAACache(Module &M, std::string P, std::string K) : Path(std::move(P)), Key(std::move(K)) {
+    numberValues(M);
+
+    auto BufOrErr = MemoryBuffer::getFile(Path, /* IsText */ false, /* RequiresNullTerminator */ false);
+    if (!BufOrErr) return;
+
+    // check the header before the buffer is accepted
+    StringRef Data = (*BufOrErr)->getBuffer();
+    size_t HeaderSize = sizeof(CacheMagic) + sizeof(uint32_t) + Key.size() + sizeof(uint32_t);
+    if (Data.size() < HeaderSize) return;
+    if (memcmp(Data.data(), CacheMagic, sizeof(CacheMagic)) != 0) return;
+    Reader R(Data.substr(sizeof(CacheMagic)));
+    if (R.read32() != CacheVersion) return;
+    if (Data.substr(sizeof(CacheMagic) + sizeof(uint32_t), Key.size()) != Key) return;
+    Reader Count(Data.substr(HeaderSize - sizeof(uint32_t)));
+    if (Count.read32() != Values.size()) return;
+    Buffer = std::move(*BufOrErr);
+}
+
+void DyckAACache::numberValues(Module &M) {
+    // globals and the bodies of functions
+    for (auto &G: M.globals()) Values.push_back(&G);
+    for (auto &F: M) Values.push_back(&F);
+    for (auto &A: M.aliases()) Values.push_back(&A);
+    for (auto &I: M.ifuncs()) Values.push_back(&I);
+    for (auto &F: M) {
+        for (auto &A: F.args()) Values.push_back(&A);
+        for (auto &B: F) Values.push_back(&B);
+        for (auto &I: instructions(F)) Values.push_back(&I);
+    }
+
+    // constants and other operands in the order they are used, in a pre-order walk of their operands
+    DenseSet<Value *> Walked;
+    std::vector<Value *> Stack;
+    auto Walk = [this, &Walked, &Stack](Value *Root) {
+        Stack.push_back(Root);
+        while (!Stack.empty()) {
+            auto *V = Stack.back();
+            Stack.pop_back();
+            if (!V || isa<GlobalValue>(V) || !Walked.insert(V).second) continue;
+            Values.push_back(V);
+            if (auto *C = dyn_cast<Constant>(V)) {
+                for (unsigned K = C->getNumOperands(); K > 0; --K) Stack.push_back(C->getOperand(K - 1));
+            }
+        }
+    };
+    for (auto &G: M.globals())
+        if (G.hasInitializer()) Walk(G.getInitializer());
+    for (auto &A: M.aliases()) Walk(A.getAliasee());
+    for (auto &I: M.ifuncs()) Walk(I.getResolver());
+    for (auto &F: M)
+        for (auto &I: instructions(F))
+            for (auto &Op: I.operands())
+                if (!isa<Instruction>(Op) && !isa<Argument>(Op) && !isa<BasicBlock>(Op)) Walk(Op.get());
+}
+
+void DyckAACache::buildValueIds() {
+    if (!ValueIds.empty()) return;
+    ValueIds.reserve(Values.size());
+    for (unsigned K = 0; K < Values.size(); ++K) ValueIds[Values[K]] = K;
+}
+
+unsigned DyckAACache::getValueId(Value *V) const {
+    if (!V) return NullId;
+    auto It = ValueIds.find(V);
+    assert(It != ValueIds.end() && "the value does not belong to the module!");
+    return It->second;
+}
+
+bool DyckAACache::findSection(unsigned Tag, StringRef &Payload) const {
+    if (!Buffer) return false;
+    StringRef Data = Buffer->getBuffer();
+    size_t HeaderSize = sizeof(CacheMagic) + sizeof(uint32_t) + Key.size() + sizeof(uint32_t);
+    Reader R(Data.substr(HeaderSize));
+    size_t Offset = HeaderSize;
+    while (!R.atEnd()) {
+        auto SecTag = R.read32();
+        auto SecSize = R.read64();
+        Offset += sizeof(uint32_t) + sizeof(uint64_t);
+        if (!R.valid() || SecSize > Data.size() - Offset) return false;
+        if (SecTag == Tag) {
+            Payload = Data.substr(Offset, SecSize);
+            return true;
+        }
+        Offset += SecSize;
+        R = Reader(Data.substr(Offset));
+    }
+    return false;
+}
+
+bool DyckAACache::loadAliasResult(DyckGraph *DG, DyckCallGraph *DCG) {
+    StringRef GraphData, CGData;
+    if (!findSection(ST_Graph, GraphData) || !findSection(ST_CallGraph, CGData)) return false;
+
+    auto ReadValue = [this](Reader &R, bool Nullable) -> Value * {
+        auto Id = R.read32();
+        if (Id == NullId && Nullable) return nullptr;
+        if (Id >= Values.size()) {
+            R.fail();
+            return nullptr;
+        }
+        return Values[Id];
+    };
+    auto ReadFunction = [&ReadValue](Reader &R) -> Function * {
+        auto *F = dyn_cast_or_null<Function>(ReadValue(R, false));
+        if (!F) R.fail();
+        return F;
+    };
+    auto ReadValues = [&ReadValue](Reader &R, std::vector<Value *> &Vals, bool Nullable) {
+        auto N = R.readCount(sizeof(uint32_t));
+        for (unsigned K = 0; K < N && R.valid(); ++K) Vals.push_back(ReadValue(R, Nullable));
+    };
+
+    // decode everything first, so that an invalid cache does not leave a half-restored graph
+    struct ClassRecord {
+        bool ContainsNull;
+        std::vector<Value *> Vals;
+        std::vector<std::tuple<uint32_t, int64_t, uint32_t>> Edges; // label type, label value, target
+    };
+    std::vector<ClassRecord> ClassRecords;
+    {
+        Reader R(GraphData);
+        DenseSet<Value *> Seen;
+        ClassRecords.resize(R.readCount(2 * sizeof(uint32_t)));
+        for (auto &Class: ClassRecords) {
+            Class.ContainsNull = R.read32();
+            ReadValues(R, Class.Vals, false);
+            for (auto *V: Class.Vals)
+                if (!Seen.insert(V).second) R.fail();
+            if (!R.valid()) return false;
+        }
+        for (auto &Class: ClassRecords) {
+            auto NumEdges = R.readCount(2 * sizeof(uint32_t) + sizeof(uint64_t));
+            for (unsigned K = 0; K < NumEdges; ++K) {
+                auto Type = R.read32();
+                auto Label = (int64_t) R.read64();
+                auto Target = R.read32();
+                if (Type > DyckGraphEdgeLabel::LT_Index || Target >= ClassRecords.size()) R.fail();
+                Class.Edges.emplace_back(Type, Label, Target);
+            }
+            if (!R.valid()) return false;
+        }
+        if (!R.atEnd()) return false;
+    }
+
+    struct CallRecord {
+        Call::CallKind Kind;
+        int Id;
+        Instruction *Inst;
+        Value *CalledValue;
+        std::vector<Value *> Args;
+        std::vector<Function *> Callees;
+    };
+    struct NodeRecord {
+        Function *Func;
+        std::vector<Value *> Rets;
+        std::vector<Value *> VAArgs;
+        std::vector<CallRecord> Calls;
+        std::vector<std::pair<unsigned, Function *>> Records; // (the index of a call, callee)
+    };
+    std::vector<Function *> ExternalCallees;
+    std::vector<NodeRecord> NodeRecords;
+    {
+        Reader R(CGData);
+        auto NumExternal = R.readCount(sizeof(uint32_t));
+        for (unsigned K = 0; K < NumExternal && R.valid(); ++K) ExternalCallees.push_back(ReadFunction(R));
+        NodeRecords.resize(R.readCount(5 * sizeof(uint32_t)));
+        for (auto &Node: NodeRecords) {
+            Node.Func = ReadFunction(R);
+            ReadValues(R, Node.Rets, false);
+            ReadValues(R, Node.VAArgs, false);
+            Node.Calls.resize(R.readCount(5 * sizeof(uint32_t)));
+            for (auto &C: Node.Calls) {
+                auto Kind = R.read32();
+                if (Kind > Call::CK_Pointer) R.fail();
+                C.Kind = (Call::CallKind) Kind;
+                C.Id = (int) R.read32();
+                if (C.Id <= 0) R.fail();
+                auto *Inst = ReadValue(R, true);
+                C.Inst = dyn_cast_or_null<Instruction>(Inst);
+                if (Inst && !C.Inst) R.fail();
+                C.CalledValue = ReadValue(R, false);
+                if (C.Kind == Call::CK_Common && !isa_and_nonnull<Function>(C.CalledValue)) R.fail();
+                ReadValues(R, C.Args, true);
+                if (C.Kind == Call::CK_Pointer) {
+                    auto NumCallees = R.readCount(sizeof(uint32_t));
+                    for (unsigned K = 0; K < NumCallees && R.valid(); ++K) C.Callees.push_back(ReadFunction(R));
+                }
+                if (!R.valid()) return false;
+            }
+            auto NumRecords = R.readCount(2 * sizeof(uint32_t));
+            for (unsigned K = 0; K < NumRecords && R.valid(); ++K) {
+                auto CallIndex = R.read32();
+                if (CallIndex >= Node.Calls.size()) R.fail();
+                Node.Records.emplace_back(CallIndex, ReadFunction(R));
+            }
+            if (!R.valid()) return false;
+        }
+        if (!R.atEnd()) return false;
+    }
+
+    // restore the dyck graph, classes are added in the order of representatives
+    std::vector<DyckGraphNode *> Classes;
+    Classes.reserve(ClassRecords.size());
+    for (auto &Class: ClassRecords) {
+        auto *Rep = DG->addEquivalentClass(std::vector<void *>(Class.Vals.begin(), Class.Vals.end()));
+        if (Class.ContainsNull) Rep->setContainsNull();
+        Classes.push_back(Rep);
+    }
+    for (unsigned K = 0; K < ClassRecords.size(); ++K) {
+        for (auto &Edge: ClassRecords[K].Edges) {
+            DyckGraphEdgeLabel *Label;
+            switch (std::get<0>(Edge)) {
+                case DyckGraphEdgeLabel::LT_Dereference:
+                    Label = DG->getDereferenceEdgeLabel();
+                    break;
+                case DyckGraphEdgeLabel::LT_Offset:
+                    Label = DG->getOrInsertOffsetEdgeLabel(std::get<1>(Edge));
+                    break;
+                default:
+                    Label = DG->getOrInsertIndexEdgeLabel(std::get<1>(Edge));
+                    break;
+            }
+            Classes[K]->addTarget(Classes[std::get<2>(Edge)], Label);
+        }
+    }
+
+    // restore the call graph, the nodes called by the external node are created first and in order,
+    // so that its call records are rebuilt by DyckCallGraph::getOrInsertFunction itself
+    for (auto *F: ExternalCallees) DCG->getOrInsertFunction(F);
+    for (auto &Node: NodeRecords) {
+        auto *CGNode = DCG->getOrInsertFunction(Node.Func);
+        for (auto *Ret: Node.Rets) CGNode->addRet(Ret);
+        for (auto *VAArg: Node.VAArgs) CGNode->addVAArg(VAArg);
+        std::vector<Call *> Calls;
+        for (auto &C: Node.Calls) {
+            if (C.Kind == Call::CK_Common) {
+                auto *CC = new CommonCall(C.Inst, cast<Function>(C.CalledValue), &C.Args, C.Id);
+                CGNode->addCommonCall(CC);
+                Calls.push_back(CC);
+            } else {
+                auto *PC = new PointerCall(C.Inst, C.CalledValue, &C.Args, C.Id);
+                for (auto *Callee: C.Callees) PC->addMayAliasedFunction(Callee);
+                CGNode->addPointerCall(PC);
+                Calls.push_back(PC);
+            }
+        }
+        for (auto &Record: Node.Records)
+            CGNode->addCalledFunction(Calls[Record.first], DCG->getOrInsertFunction(Record.second));
+    }
+    return true;
+}
+
+void DyckAACache::storeAliasResult(DyckGraph *DG, DyckCallGraph *DCG) {
+    // values created by the analysis itself cannot be identified in another run
+    buildValueIds();
+    auto Known = [this](Value *V) { return !V || ValueIds.count(V); };
+
+    auto &Reps = DG->getVertices();
+    DenseMap<DyckGraphNode *, unsigned> ClassIds;
+    for (unsigned K = 0; K < Reps.size(); ++K) ClassIds[Reps[K]] = K;
+
+    std::string Graph;
+    Writer GW(Graph);
+    GW.write32(Reps.size());
+    for (auto *Rep: Reps) {
+        GW.write32(Rep->containsNull());
+        auto *Vals = Rep->getEquivalentSet();
+        std::vector<unsigned> Ids;
+        Ids.reserve(Vals->size());
+        for (auto *V: *Vals) {
+            if (!Known((Value *) V)) return;
+            Ids.push_back(getValueId((Value *) V));
+        }
+        GW.writeIds(Ids);
+    }
+    for (auto *Rep: Reps) {
+        auto &Edges = Rep->getOutVertices();
+        GW.write32(Edges.size());
+        for (auto &LabelIt: Edges) {
+            auto *Label = (DyckGraphEdgeLabel *) LabelIt.first;
+            if (Label->isLabelTy(DyckGraphEdgeLabel::LT_Dereference)) {
+                GW.write32(DyckGraphEdgeLabel::LT_Dereference);
+                GW.write64(0);
+            } else if (Label->isLabelTy(DyckGraphEdgeLabel::LT_Offset)) {
+                GW.write32(DyckGraphEdgeLabel::LT_Offset);
+                GW.write64(((PointerOffsetEdgeLabel *) Label)->getOffsetBytes());
+            } else {
+                GW.write32(DyckGraphEdgeLabel::LT_Index);
+                GW.write64(((FieldIndexEdgeLabel *) Label)->getFieldIndex());
+            }
+            // the graph is solved, so there is one target for each label
+            GW.write32(ClassIds.lookup(Rep->getOutVertex(LabelIt.first)));
+        }
+    }
+
+    std::string CG;
+    Writer CW(CG);
+    auto *External = DCG->getFunction(nullptr);
+    CW.write32(std::distance(External->child_edge_begin(), External->child_edge_end()));
+    for (auto It = External->child_edge_begin(), E = External->child_edge_end(); It != E; ++It)
+        CW.write32(getValueId(It->second->getLLVMFunction()));
+
+    // nodes are written in the order of functions
+    std::vector<DyckCallGraphNode *> Nodes;
+    for (auto *Node: make_range(DCG->nodes_begin(), DCG->nodes_end()))
+        if (Node->getLLVMFunction()) Nodes.push_back(Node);
+    std::sort(Nodes.begin(), Nodes.end(), [this](DyckCallGraphNode *X, DyckCallGraphNode *Y) {
+        return getValueId(X->getLLVMFunction()) < getValueId(Y->getLLVMFunction());
+    });
+    CW.write32(Nodes.size());
+    for (auto *Node: Nodes) {
+        CW.write32(getValueId(Node->getLLVMFunction()));
+        std::vector<unsigned> Ids;
+        for (auto *Ret: Node->getReturns()) {
+            if (!Known(Ret)) return;
+            Ids.push_back(getValueId(Ret));
+        }
+        CW.writeIds(Ids);
+        Ids.clear();
+        for (auto *VAArg: Node->getVAArgs()) {
+            if (!Known(VAArg)) return;
+            Ids.push_back(getValueId(VAArg));
+        }
+        CW.writeIds(Ids);
+
+        // calls are written in the order of their ids
+        std::vector<Call *> Calls(Node->common_call_begin(), Node->common_call_end());
+        Calls.insert(Calls.end(), Node->pointer_call_begin(), Node->pointer_call_end());
+        std::sort(Calls.begin(), Calls.end(), [](Call *X, Call *Y) { return X->id() < Y->id(); });
+        DenseMap<Call *, unsigned> CallIndices;
+        CW.write32(Calls.size());
+        for (unsigned K = 0; K < Calls.size(); ++K) {
+            auto *C = Calls[K];
+            CallIndices[C] = K;
+            if (!Known(C->getInstruction()) || !Known(C->getCalledValue())) return;
+            CW.write32(C->getKind());
+            CW.write32(C->id());
+            CW.write32(getValueId(C->getInstruction()));
+            CW.write32(getValueId(C->getCalledValue()));
+            Ids.clear();
+            for (auto *Arg: C->getArgs()) {
+                if (!Known(Arg)) return;
+                Ids.push_back(getValueId(Arg));
+            }
+            CW.writeIds(Ids);
+            if (auto *PC = dyn_cast<PointerCall>(C)) {
+                Ids.clear();
+                for (auto *Callee: *PC) Ids.push_back(getValueId(Callee));
+                CW.writeIds(Ids);
+            }
+        }
+        CW.write32(std::distance(Node->child_edge_begin(), Node->child_edge_end()));
+        for (auto It = Node->child_edge_begin(), E = Node->child_edge_end(); It != E; ++It) {
+            assert(It->first && CallIndices.count(It->first));
+            CW.write32(CallIndices.lookup(It->first));
+            CW.write32(getValueId(It->second->getLLVMFunction()));
+        }
+    }
+
+    Sections.clear();
+    Writer SW(Sections);
+    SW.write32(ST_Graph);
+    SW.write64(Graph.size());
+    Sections.append(Graph);
+    SW.write32(ST_CallGraph);
+    SW.write64(CG.size());
+    Sections.append(CG);
+    flush();
+}
+
+bool DyckAACache::loadModRef(DyckGraph *DG, std::map<Function *, ModRef> &Func2MR) {
+    StringRef Data;
+    if (!findSection(ST_ModRef, Data)) return false;
+
+    auto &Reps = DG->getVertices();
+    std::map<Function *, ModRef> Result;
+    Reader R(Data);
+    auto ReadClasses = [&R, &Reps](std::set<DyckGraphNode *> &Classes) {
+        auto N = R.readCount(sizeof(uint32_t));
+        for (unsigned K = 0; K < N; ++K) {
+            auto Id = R.read32();
+            if (Id >= Reps.size()) {
+                R.fail();
+                return;
+            }
+            Classes.insert(Reps[Id]);
+        }
+    };
+    auto NumFunctions = R.readCount(3 * sizeof(uint32_t));
+    for (unsigned K = 0; K < NumFunctions && R.valid(); ++K) {
+        auto Id = R.read32();
+        auto *F = Id < Values.size() ? dyn_cast<Function>(Values[Id]) : nullptr;
+        if (!F) return false;
+        auto &MR = Result[F];
+        ReadClasses(MR.Mods);
+        ReadClasses(MR.Refs);
+    }
+    if (!R.valid() || !R.atEnd()) return false;
+    Func2MR.swap(Result);
+    return true;
+}
+
+void DyckAACache::storeModRef(DyckGraph *DG, const std::map<Function *, ModRef> &Func2MR) {
+    buildValueIds();
+    auto &Reps = DG->getVertices();
+    DenseMap<DyckGraphNode *, unsigned> ClassIds;
+    for (unsigned K = 0; K < Reps.size(); ++K) ClassIds[Reps[K]] = K;
+
+    // the alias result is either just written or loaded from the file
+    if (Sections.empty()) {
+        StringRef Graph, CG;
+        if (!findSection(ST_Graph, Graph) || !findSection(ST_CallGraph, CG)) return;
+        Writer SW(Sections);
+        SW.write32(ST_Graph);
+        SW.write64(Graph.size());
+        Sections.append(Graph.begin(), Graph.end());
+        SW.write32(ST_CallGraph);
+        SW.write64(CG.size());
+        Sections.append(CG.begin(), CG.end());
+    }
+
+    std::string MRData;
+    Writer W(MRData);
+    std::vector<std::pair<unsigned, const ModRef *>> Entries;
+    for (auto &It: Func2MR) Entries.emplace_back(getValueId(It.first), &It.second);
+    std::sort(Entries.begin(), Entries.end());
+    W.write32(Entries.size());
+    for (auto &Entry: Entries) {
+        W.write32(Entry.first);
+        for (auto *Classes: {&Entry.second->Mods, &Entry.second->Refs}) {
+            std::vector<unsigned> Ids;
+            for (auto *N: *Classes) Ids.push_back(ClassIds.lookup(N->getRepresentative()));
+            std::sort(Ids.begin(), Ids.end());
+            W.writeIds(Ids);
+        }
+    }
+
+    Writer SW(Sections);
+    SW.write32(ST_ModRef);
+    SW.write64(MRData.size());
+    Sections.append(MRData);
+    flush();
+}
+
+void DyckAACache::flush() {
+    std::error_code EC = sys::fs::create_directories(CacheDir.getValue());
+    if (EC) {
+        errs() << "Warning: cannot create the dyckaa cache directory " << CacheDir << ": " << EC.message() << "\n";
+        return;
+    }
+
+    // other processes may read the file at the same time, so it is replaced atomically
+    std::string TmpPath = Path + ".tmp" + std::to_string(sys::Process::getProcessId());
+    {
+        raw_fd_ostream OS(TmpPath, EC, sys::fs::OF_None);
+        if (EC) {
+            errs() << "Warning: cannot write the dyckaa cache " << TmpPath << ": " << EC.message() << "\n";
+            return;
+        }
+        std::string Header;
+        Writer HW(Header);
+        Header.append(CacheMagic, sizeof(CacheMagic));
+        HW.write32(CacheVersion);
+        Header.append(Key);
+        HW.write32(Values.size());
+        OS << Header << Sections;
+    }
+    EC = sys::fs::rename(TmpPath, Path);
+    if (EC) {
+        errs() << "Warning: cannot write the dyckaa cache " << Path << ": " << EC.message() << "\n";
+        sys::fs::remove(TmpPath);
+    }
+}
@@ -40,6 +40,7 @@ static cl::opt<bool> DotVFG("dot-vfg", cl::init(false), cl::Hidden,
                            cl::desc("Dump the Value Flow Graph to a DOT file"));
 
 char DyckAliasAnalysis::ID = 0;
+const unsigned DyckAliasAnalysis::UnknownClass;
 static RegisterPass<DyckAliasAnalysis> X("dyckaa", "a unification based alias analysis");
 
 DyckAliasAnalysis::DyckAliasAnalysis() : ModulePass(ID) {
@@ -57,18 +58,81 @@ void DyckAliasAnalysis::getAnalysisUsage(AnalysisUsage &AU) const {
 }
 
 const std::set<Value *> *DyckAliasAnalysis::getAliasSet(Value *Ptr) const {
-    DyckGraphNode *V = DyckPTG->retrieveDyckVertex(Ptr).first;
-    return (const std::set<Value *> *) V->getEquivalentSet();
+    auto Id = getAliasClass(Ptr);
+    if (Id == UnknownClass) return nullptr;
+    return ClassAliasSets[Id];
 }
 
 bool DyckAliasAnalysis::mayAlias(Value *V1, Value *V2) const {
-    return getAliasSet(V1)->count(V2);
+    if (V1 == V2) return true;
+    auto Id = getAliasClass(V1);
+    return Id != UnknownClass && Id == getAliasClass(V2);
 }
 
 bool DyckAliasAnalysis::mayNull(Value *V) const {
-    auto *DyckNode = DyckPTG->findDyckVertex(V);
-    if (!DyckNode) return false;
-    return DyckNode->containsNull();
+    auto Id = getAliasClass(V);
+    if (Id == UnknownClass) return false;
+    return ClassMayNull.test(Id);
+}
+
+unsigned DyckAliasAnalysis::getAliasClass(const Value *V) const {
+    auto It = ClassIds.find(V);
+    if (It == ClassIds.end()) return UnknownClass;
+    return It->second;
+}
+
+unsigned DyckAliasAnalysis::pointsToClass(const Value *V) const {
+    auto Id = getAliasClass(V);
+    if (Id == UnknownClass) return UnknownClass;
+    return ClassPointsTo[Id];
+}
+
+std::vector<BitVector> DyckAliasAnalysis::aliasMatrix(ArrayRef<Value *> Values) const {
+    // group the values by their classes, values that are not analyzed only alias themselves
+    DenseMap<unsigned, BitVector> Groups;
+    std::vector<unsigned> Ids(Values.size());
+    for (unsigned K = 0; K < Values.size(); ++K) {
+        Ids[K] = getAliasClass(Values[K]);
+        if (Ids[K] == UnknownClass) continue;
+        auto &Group = Groups[Ids[K]];
+        if (Group.empty()) Group.resize(Values.size());
+        Group.set(K);
+    }
+
+    std::vector<BitVector> Matrix(Values.size());
+    for (unsigned K = 0; K < Values.size(); ++K) {
+        if (Ids[K] != UnknownClass) {
+            Matrix[K] = Groups[Ids[K]];
+        } else {
+            Matrix[K].resize(Values.size());
+            Matrix[K].set(K);
+        }
+    }
+    return Matrix;
+}
+
+void DyckAliasAnalysis::freeze() {
+    auto &Reps = DyckPTG->getVertices();
+    DenseMap<DyckGraphNode *, unsigned> RepIds;
+    RepIds.reserve(Reps.size());
+    ClassAliasSets.resize(Reps.size());
+    ClassPointsTo.resize(Reps.size(), UnknownClass);
+    ClassMayNull.resize(Reps.size());
+    for (unsigned K = 0; K < Reps.size(); ++K) {
+        auto *Rep = Reps[K];
+        RepIds[Rep] = K;
+        // equivalent sets are materialized here, they are never rebuilt afterwards
+        auto *AliasSet = (const std::set<Value *> *) Rep->getEquivalentSet();
+        ClassAliasSets[K] = AliasSet;
+        for (auto *V: *AliasSet) ClassIds[V] = K;
+        if (Rep->containsNull()) ClassMayNull.set(K);
+    }
+
+    auto *DerefLabel = DyckPTG->getDereferenceEdgeLabel();
+    for (unsigned K = 0; K < Reps.size(); ++K) {
+        if (auto *Target = Reps[K]->getOutVertex(DerefLabel))
+            ClassPointsTo[K] = RepIds.lookup(Target);
+    }
 }
 
 DyckCallGraph *DyckAliasAnalysis::getDyckCallGraph() const {
@@ -82,21 +146,28 @@ DyckGraph *DyckAliasAnalysis::getDyckGraph() const {
 bool DyckAliasAnalysis::runOnModule(Module &M) {
     RecursiveTimer DyckAA("Running DyckAA");
 
-    // alias analysis
-    AAAnalyzer AA(&M, DyckPTG, DyckCG);
-    AA.intraProcedureAnalysis();
-    AA.interProcedureAnalysis();
-
-    // a post-processing procedure
-    for (auto *DyckNode: DyckPTG->getVertices()) {
-        auto *AliasSet = (const std::set<Value *> *) DyckNode->getEquivalentSet();
-        if (!AliasSet) continue;
-        for (auto *V: *AliasSet) {
-            if (!isa<ConstantPointerNull>(V)) continue;
-            DyckNode->setContainsNull();
-            break;
+    Cache = DyckAACache::open(M);
+    if (Cache && Cache->loadAliasResult(DyckPTG, DyckCG)) {
+        outs() << "DyckAA result is loaded from the cache.\n";
+    } else {
+        // alias analysis
+        AAAnalyzer AA(&M, DyckPTG, DyckCG);
+        AA.intraProcedureAnalysis();
+        AA.interProcedureAnalysis();
+
+        // a post-processing procedure
+        for (auto *DyckNode: DyckPTG->getVertices()) {
+            auto *AliasSet = (const std::set<Value *> *) DyckNode->getEquivalentSet();
+            if (!AliasSet) continue;
+            for (auto *V: *AliasSet) {
+                if (!isa<ConstantPointerNull>(V)) continue;
+                DyckNode->setContainsNull();
+                break;
+            }
         }
+        if (Cache) Cache->storeAliasResult(DyckPTG, DyckCG);
     }
+    freeze();
 
     /* call graph */
     if (DotCallGraph) {
@@ -140,7 +211,7 @@ bool DyckAliasAnalysis::runOnModule(Module &M) {
 void DyckAliasAnalysis::printAliasSetInformation() {
     /*if (InterAAEval)*/
     {
-        std::set<DyckGraphNode *> &AllReps = DyckPTG->getVertices();
+        auto &AllReps = DyckPTG->getVertices();
 
         outs() << "Printing distribution.log... ";
         outs().flush();
@@ -202,7 +273,7 @@ void DyckAliasAnalysis::printAliasSetInformation() {
 
         std::map<DyckGraphNode *, int> TheMap;
         int Idx = 0;
-        std::set<DyckGraphNode *> &Reps = DyckPTG->getVertices();
+        auto &Reps = DyckPTG->getVertices();
         auto RepIt = Reps.begin();
         while (RepIt != Reps.end()) {
             Idx++;
@@ -214,12 +285,14 @@ void DyckAliasAnalysis::printAliasSetInformation() {
         RepIt = Reps.begin();
         while (RepIt != Reps.end()) {
             DyckGraphNode *DGN = *RepIt;
-            std::map<void *, std::set<DyckGraphNode *>> &OutVs = DGN->getOutVertices();
+            auto &OutVs = DGN->getOutVertices();
 
             auto OvIt = OutVs.begin();
             while (OvIt != OutVs.end()) {
                 auto *Label = (DyckGraphEdgeLabel *) OvIt->first;
-                std::set<DyckGraphNode *> *oVs = &OvIt->second;
+                std::set<DyckGraphNode *> TheVs;
+                for (auto *OV: OvIt->second) TheVs.insert(OV->getRepresentative());
+                std::set<DyckGraphNode *> *oVs = &TheVs;
 
                 auto OIt = oVs->begin();
                 while (OIt != oVs->end()) {
@@ -260,7 +333,7 @@ void DyckAliasAnalysis::printAliasSetInformation() {
         Log << "===== {.} means pthread escaped alias set =====\n";
 
         int Idx = 0;
-        std::set<DyckGraphNode *> &Reps = DyckPTG->getVertices();
+        auto &Reps = DyckPTG->getVertices();
         auto RepsIt = Reps.begin();
         while (RepsIt != Reps.end()) {
             Idx++;
@@ -20,22 +20,27 @@
 
 static int GlobalCallID = 0;
 
-Call::Call(CallKind K, Instruction *Inst, Value *CalledValue, std::vector<Value *> *Args) : Kind(K) {
+Call::Call(CallKind K, Instruction *Inst, Value *CalledValue, std::vector<Value *> *Args, int Id) : Kind(K) {
     assert(CalledValue != nullptr && "Error when create a call: called value is null!");
     assert(Args != nullptr && "Error when create a call: args is null!");
 
     this->CalledValue = CalledValue;
     this->Inst = Inst;
     this->Args = *Args;
-    this->CallId = ++GlobalCallID;
+    if (Id > 0) {
+        this->CallId = Id;
+        if (Id > GlobalCallID) GlobalCallID = Id;
+    } else {
+        this->CallId = ++GlobalCallID;
+    }
 }
 
-CommonCall::CommonCall(Instruction *Inst, Function *Func, std::vector<Value *> *Args)
-        : Call(CK_Common, Inst, Func, Args) {
+CommonCall::CommonCall(Instruction *Inst, Function *Func, std::vector<Value *> *Args, int Id)
+        : Call(CK_Common, Inst, Func, Args, Id) {
 }
 
-PointerCall::PointerCall(Instruction *Inst, Value *CalledValue, std::vector<Value *> *Args)
-        : Call(CK_Pointer, Inst, CalledValue, Args) {
+PointerCall::PointerCall(Instruction *Inst, Value *CalledValue, std::vector<Value *> *Args, int Id)
+        : Call(CK_Pointer, Inst, CalledValue, Args, Id) {
 }
 
 DyckCallGraphNode::DyckCallGraphNode(Function *F) : Func(F) {
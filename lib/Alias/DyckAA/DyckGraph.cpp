@@ -21,14 +21,18 @@
 #include <stack>
 #include "Alias/DyckAA/DyckGraphEdgeLabel.h"
 #include "Alias/DyckAA/DyckGraph.h"
+#include "Alias/DyckAA/DyckWorkList.h"
 
 DyckGraph::DyckGraph() {
     DerefEdgeLabel = new DereferenceEdgeLabel;
 }
 
-DyckGraph::~DyckGraph() {
-    for (auto &V: Vertices) delete V;
+DyckGraph::DyckGraph(DyckGraph *Owner) : LabelOwner(Owner) {
+    DerefEdgeLabel = Owner->getDereferenceEdgeLabel();
+}
 
+DyckGraph::~DyckGraph() {
+    if (LabelOwner) return;
     delete DerefEdgeLabel;
     auto OIt = OffsetEdgeLabelMap.begin();
     while (OIt != OffsetEdgeLabelMap.end()) {
@@ -43,6 +47,13 @@ DyckGraph::~DyckGraph() {
 }
 
 DyckGraphEdgeLabel *DyckGraph::getOrInsertOffsetEdgeLabel(long Offset) {
+    if (LabelOwner) {
+        auto &Ret = OffsetEdgeLabelMap[Offset];
+        if (!Ret) Ret = LabelOwner->getOrInsertOffsetEdgeLabel(Offset);
+        return Ret;
+    }
+
+    std::lock_guard<std::mutex> Lock(LabelMutex);
     if (OffsetEdgeLabelMap.count(Offset)) {
         return OffsetEdgeLabelMap[Offset];
     } else {
@@ -53,6 +64,13 @@ DyckGraphEdgeLabel *DyckGraph::getOrInsertOffsetEdgeLabel(long Offset) {
 }
 
 DyckGraphEdgeLabel *DyckGraph::getOrInsertIndexEdgeLabel(long Offset) {
+    if (LabelOwner) {
+        auto &Ret = IndexEdgeLabelMap[Offset];
+        if (!Ret) Ret = LabelOwner->getOrInsertIndexEdgeLabel(Offset);
+        return Ret;
+    }
+
+    std::lock_guard<std::mutex> Lock(LabelMutex);
     if (IndexEdgeLabelMap.count(Offset)) {
         return IndexEdgeLabelMap[Offset];
     } else {
@@ -62,258 +80,173 @@ DyckGraphEdgeLabel *DyckGraph::getOrInsertIndexEdgeLabel(long Offset) {
     }
 }
 
-void DyckGraph::printAsDot(const char *FileName) const {
+void DyckGraph::printAsDot(const char *FileName) {
     FILE *FileDesc = fopen(FileName, "w+");
     fprintf(FileDesc, "digraph ptg {\n");
 
-    auto VIt = Vertices.begin();
-    while (VIt != Vertices.end()) {
-        if ((*VIt)->getName() != nullptr)
-            fprintf(FileDesc, "\ta%d[label=\"%s\"];\n", (*VIt)->getIndex(), (*VIt)->getName());
+    for (auto *Rep: getVertices()) {
+        if (Rep->getName() != nullptr)
+            fprintf(FileDesc, "\ta%d[label=\"%s\"];\n", Rep->getIndex(), Rep->getName());
         else
-            fprintf(FileDesc, "\ta%d;\n", (*VIt)->getIndex());
-
-        std::map<void *, std::set<DyckGraphNode *>> &Outs = (*VIt)->getOutVertices();
-        auto OIt = Outs.begin();
-        while (OIt != Outs.end()) {
-            long Label = (long) (OIt->first);
-            std::set<DyckGraphNode *> *Tars = &OIt->second;
-            auto TarIt = Tars->begin();
-            while (TarIt != Tars->end()) {
-                fprintf(FileDesc, "\ta%d->a%d [label=\"%ld\"];\n", (*VIt)->getIndex(), (*TarIt)->getIndex(), Label);
-                TarIt++;
-            }
-            OIt++;
+            fprintf(FileDesc, "\ta%d;\n", Rep->getIndex());
+
+        for (auto &OIt: Rep->getOutVertices()) {
+            long Label = (long) (OIt.first);
+            std::set<DyckGraphNode *> Tars;
+            for (auto *Tar: OIt.second) Tars.insert(Tar->getRepresentative());
+            for (auto *Tar: Tars)
+                fprintf(FileDesc, "\ta%d->a%d [label=\"%ld\"];\n", Rep->getIndex(), Tar->getIndex(), Label);
         }
-        ++VIt;
     }
 
     fprintf(FileDesc, "}\n");
     fclose(FileDesc);
 }
 
-void DyckGraph::removeFromWorkList(std::multimap<DyckGraphNode *, void *> &List, DyckGraphNode *Node, void *Label) {
-    typedef std::multimap<DyckGraphNode *, void *>::iterator CIT;
-    typedef std::pair<CIT, CIT> Range;
-    Range NodeRange = List.equal_range(Node);
-    auto Next = NodeRange.first;
-    while (Next != NodeRange.second) {
-        if ((Next)->second == Label) {
-            List.erase(Next);
-            return;
-        }
-        Next++;
+DyckGraphNode *DyckGraph::unify(DyckGraphNode *RepX, DyckGraphNode *RepY, DyckWorkList *WorkList) {
+    assert(RepX->isRepresentative() && RepY->isRepresentative());
+    if (RepX == RepY) return RepX;
+
+    // union by rank, x becomes the new representative
+    if (RepX->Rank < RepY->Rank) std::swap(RepX, RepY);
+    if (RepX->Rank == RepY->Rank) RepX->Rank++;
+    RepY->Parent = RepX;
+    NumReps--;
+    RepsValid = false;
+
+    // splice the member chains
+    RepX->LastMember->NextMember = RepY;
+    RepX->LastMember = RepY->LastMember;
+    RepX->ContainsNull |= RepY->ContainsNull;
+    RepX->EquivClassValid = false;
+    RepY->EquivClass.reset();
+
+    // labels pending on y are now pending on x
+    if (WorkList && WorkList->contains(RepY->getIndex())) {
+        for (auto &YIt: RepY->OutNodes)
+            if (WorkList->remove(RepY->getIndex(), YIt.first)) WorkList->push(RepX->getIndex(), YIt.first);
     }
-}
 
-bool DyckGraph::containsInWorkList(std::multimap<DyckGraphNode *, void *> &List, DyckGraphNode *v, void *l) {
-    typedef std::multimap<DyckGraphNode *, void *>::iterator CIT;
-    typedef std::pair<CIT, CIT> Range;
-    Range NodeRange = List.equal_range(v);
-    auto Next = NodeRange.first;
-    while (Next != NodeRange.second) {
-        if ((Next)->second == l) {
-            return true;
-        }
-        Next++;
+    // move y's out edges to x, the smaller edge table is merged into the larger one
+    if (RepX->OutNodes.size() < RepY->OutNodes.size()) RepX->OutNodes.swap(RepY->OutNodes);
+    for (auto &YIt: RepY->OutNodes) {
+        auto &XList = RepX->getOrInsertOutList(YIt.first);
+        if (XList.empty()) XList.swap(YIt.second);
+        else XList.insert(XList.end(), YIt.second.begin(), YIt.second.end());
+        if (WorkList && XList.size() > 1) WorkList->push(RepX->getIndex(), YIt.first);
     }
-    return false;
+    DyckGraphNode::LabelEdgesTy().swap(RepY->OutNodes);
+    return RepX;
 }
 
 DyckGraphNode *DyckGraph::combine(DyckGraphNode *NodeX, DyckGraphNode *NodeY) {
-    assert(Vertices.count(NodeX));
-    assert(Vertices.count(NodeY));
-    if (NodeX == NodeY) return NodeX;
-
-    if (NodeX->degree() < NodeY->degree()) {
-        DyckGraphNode *Temp = NodeX;
-        NodeX = NodeY;
-        NodeY = Temp;
-    }
-
-    std::set<void *> &YOutLabels = NodeY->getOutLabels();
-    auto YOIt = YOutLabels.begin();
-    while (YOIt != YOutLabels.end()) {
-        if (NodeY->containsTarget(NodeY, *YOIt)) {
-            if (!NodeX->containsTarget(NodeX, *YOIt)) {
-                NodeX->addTarget(NodeX, *YOIt);
-            }
-            NodeY->removeTarget(NodeY, *YOIt);
+    return unify(NodeX->getRepresentative(), NodeY->getRepresentative(), nullptr);
+}
 
-        }
-        YOIt++;
+bool DyckGraph::qirunAlgorithm() {
+    DyckWorkList WorkList(Nodes.size());
+    for (auto &Node: Nodes) {
+        if (!Node.isRepresentative()) continue;
+        for (auto &LabelIt: Node.OutNodes)
+            if (LabelIt.second.size() > 1) WorkList.push(Node.getIndex(), LabelIt.first);
     }
 
-    YOIt = YOutLabels.begin();
-    while (YOIt != YOutLabels.end()) {
-        std::set<DyckGraphNode *> *Ws = &NodeY->getOutVertices()[*YOIt];
-        auto W = Ws->begin();
-        while (W != Ws->end()) {
-            if (!NodeX->containsTarget(*W, *YOIt)) {
-                NodeX->addTarget(*W, *YOIt);
-            }
-            // cannot use removeTarget function, which will affect iterator
-            // y remove target *w
-            DyckGraphNode *WTemp = *W;
-            Ws->erase(W++);
-            // *w remove src y
-            ((WTemp)->getInVertices())[*YOIt].erase(NodeY);
+    bool Ret = WorkList.empty();
+    while (!WorkList.empty()) {
+        auto Item = WorkList.pop();
+        auto *Z = &Nodes[Item.first];
+        auto *Label = Item.second;
+
+        // pending labels of a vertex are dropped when it is unified into another
+        assert(Z->isRepresentative());
+        auto *List = Z->getOutList(Label);
+        if (!List || List->size() < 2) continue;
+
+        // all targets of z with the same label are unified into one
+        DyckGraphNode::EdgeListTy Targets;
+        Targets.swap(*List);
+        DyckGraphNode *X = Targets.front()->getRepresentative();
+        for (unsigned K = 1; K < Targets.size(); ++K) {
+            DyckGraphNode *Y = Targets[K]->getRepresentative();
+            if (X != Y) X = unify(X, Y, &WorkList);
         }
-        YOIt++;
-    }
 
-    std::set<void *> &YInLabels = NodeY->getInLabels();
-    auto YIIt = YInLabels.begin();
-    while (YIIt != YInLabels.end()) {
-        std::set<DyckGraphNode *> *Ws = &NodeY->getInVertices()[*YIIt];
-        auto W = Ws->begin();
-        while (W != Ws->end()) {
-            if (!(*W)->containsTarget(NodeX, *YIIt)) {
-                (*W)->addTarget(NodeX, *YIIt);
-            }
-
-            // cannot use removeTarget function, which will affect iterator
-            DyckGraphNode *WTemp = *W;
-            Ws->erase(W++);
-            ((WTemp)->getOutVertices())[*YIIt].erase(NodeY);
-        }
+        // z itself may have been unified if it is its own target
+        auto *ZRep = Z->getRepresentative();
+        auto &ZList = ZRep->getOrInsertOutList(Label);
+        ZList.push_back(X);
+        if (ZList.size() > 1) WorkList.push(ZRep->getIndex(), Label);
+    }
+    flatten();
+    return Ret;
+}
 
-        YIIt++;
+void DyckGraph::merge(DyckGraph *Local, const std::function<DyckGraphNode *(void *)> &Wrap) {
+    assert(Local->LabelOwner == this && "the local graph must borrow the labels of this graph!");
+
+    // map each equivalent class of the local graph to a vertex of this graph,
+    // classes with values are mapped first so that they do not need new anonymous vertices
+    std::vector<DyckGraphNode *> Mapped(Local->Nodes.size(), nullptr);
+    for (auto &Node: Local->Nodes) {
+        if (!Node.Value) continue;
+        auto *&Class = Mapped[Node.getRepresentative()->getIndex()];
+        auto *Wrapped = Wrap(Node.Value);
+        Class = Class ? combine(Class, Wrapped) : Wrapped;
     }
-    auto Vals = NodeY->getEquivalentSet();
-    for (auto &Val: *Vals) {
-        ValVertexMap[Val] = NodeX;
+    for (auto &Node: Local->Nodes) {
+        if (!Node.isRepresentative()) continue;
+        auto *&Class = Mapped[Node.getIndex()];
+        if (!Class) Class = retrieveDyckVertex(nullptr).first;
+        if (Node.ContainsNull) Class->setContainsNull();
     }
-    NodeY->mvEquivalentSetTo(NodeX);
-    Vertices.erase(NodeY);
-    delete NodeY;
-    return NodeX;
-}
 
-bool DyckGraph::qirunAlgorithm() {
-    bool Ret = true;
-    std::multimap<DyckGraphNode *, void *> Worklist;
-    auto VIt = Vertices.begin();
-    while (VIt != Vertices.end()) {
-        std::set<void *> &OutLabels = (*VIt)->getOutLabels();
-        auto LabelIt = OutLabels.begin();
-        while (LabelIt != OutLabels.end()) {
-            if ((*VIt)->outNumVertices(*LabelIt) > 1) {
-                Worklist.insert(std::pair<DyckGraphNode *, void *>(*VIt, *LabelIt));
-            }
-            LabelIt++;
-        }
-        VIt++;
+    for (auto &Node: Local->Nodes) {
+        if (!Node.isRepresentative()) continue;
+        auto *Src = Mapped[Node.getIndex()];
+        for (auto &LabelIt: Node.OutNodes)
+            for (auto *Tar: LabelIt.second)
+                Src->addTarget(Mapped[Tar->getRepresentative()->getIndex()], LabelIt.first);
     }
+}
 
-    if (!Worklist.empty()) Ret = false;
-
-    while (!Worklist.empty()) {
-        //outs()<<"HERE0\n"; outs().flush();
-        auto ZIt = Worklist.begin();
-        //outs()<<"HERE0.1\n"; outs().flush();
-        std::set<DyckGraphNode *> *Nodes = &ZIt->first->getOutVertices()[ZIt->second];
-        auto NodeIt = Nodes->begin();
-        DyckGraphNode *X = *(NodeIt);
-        NodeIt++;
-        //outs()<<"HERE0.2\n"; outs().flush();
-        DyckGraphNode *Y = *(NodeIt);
-        if (X->degree() < Y->degree()) {
-            DyckGraphNode *Temp = X;
-            X = Y;
-            Y = Temp;
-        }
-        //outs()<<"HERE0.3\n"; outs().flush();
-        assert(X != Y);
-        Vertices.erase(Y);
-        auto Vals = Y->getEquivalentSet();
-        for (auto &Val: *Vals) {
-            ValVertexMap[Val] = X;
-        }
-        //outs()<<"HERE0.4\n"; outs().flush();
-        Y->mvEquivalentSetTo(X/*->getRepresentative()*/);
-        //outs()<<"HERE1\n"; outs().flush();
-        std::set<void *> &YOutLabels = Y->getOutLabels();
-        auto YOIt = YOutLabels.begin();
-        while (YOIt != YOutLabels.end()) {
-            if (Y->containsTarget(Y, *YOIt)) {
-                if (!X->containsTarget(X, *YOIt)) {
-                    X->addTarget(X, *YOIt);
-                    if (X->outNumVertices(*YOIt) > 1 && !containsInWorkList(Worklist, X, *YOIt)) {
-                        Worklist.insert(std::pair<DyckGraphNode *, void *>(X, *YOIt));
-                    }
-                }
-                Y->removeTarget(Y, *YOIt);
-                if (Y->outNumVertices(*YOIt) < 2) {
-                    removeFromWorkList(Worklist, Y, *YOIt);
-                }
-            }
-            YOIt++;
-        }
-        //outs()<<"HERE2\n"; outs().flush();
-        YOIt = YOutLabels.begin();
-        while (YOIt != YOutLabels.end()) {
-            std::set<DyckGraphNode *> *Ws = &Y->getOutVertices()[*YOIt];
-            auto W = Ws->begin();
-            while (W != Ws->end()) {
-                if (!X->containsTarget(*W, *YOIt)) {
-                    X->addTarget(*W, *YOIt);
-                    if (X->outNumVertices(*YOIt) > 1 && !containsInWorkList(Worklist, X, *YOIt)) {
-                        Worklist.insert(std::pair<DyckGraphNode *, void *>(X, *YOIt));
-                    }
-                }
-                // cannot use removeTarget function, which will affect iterator
-                // y remove target *w
-                DyckGraphNode *WTemp = *W;
-                Ws->erase(W++);
-                // *w remove src y
-                ((WTemp)->getInVertices())[*YOIt].erase(Y);
-                if (Y->outNumVertices(*YOIt) < 2) {
-                    removeFromWorkList(Worklist, Y, *YOIt);
-                }
-            }
-            YOIt++;
-        }
-        //outs()<<"HERE3\n"; outs().flush();
-        std::set<void *> &YInLabels = Y->getInLabels();
-        auto YIIt = YInLabels.begin();
-        while (YIIt != YInLabels.end()) {
-            std::set<DyckGraphNode *> *Ws = &Y->getInVertices()[*YIIt];
-            auto W = Ws->begin();
-            while (W != Ws->end()) {
-                if (!(*W)->containsTarget(X, *YIIt)) {
-                    (*W)->addTarget(X, *YIIt);
-                }
-
-                // cannot use removeTarget function, which will affect iterator
-                DyckGraphNode *WTemp = *W;
-                Ws->erase(W++);
-                ((WTemp)->getOutVertices())[*YIIt].erase(Y);
-                if ((WTemp)->outNumVertices(*YIIt) < 2) {
-                    removeFromWorkList(Worklist, WTemp, *YIIt);
-                }
-            }
-
-            YIIt++;
-        }
-        delete Y;
+DyckGraphNode *DyckGraph::addEquivalentClass(const std::vector<void *> &Vals) {
+    if (Vals.empty()) return retrieveDyckVertex(nullptr).first;
+
+    // members point to the representative directly, i.e., the class is already flattened
+    auto *Rep = retrieveDyckVertex(Vals[0]).first;
+    for (unsigned K = 1; K < Vals.size(); ++K) {
+        assert(!ValVertexMap.count(Vals[K]) && "the value is already in the graph!");
+        Nodes.emplace_back(DyckGraphNode::ArenaTag(), (int) Nodes.size(), Vals[K], nullptr);
+        auto *Member = &Nodes.back();
+        ValVertexMap.emplace(Vals[K], Member);
+        Member->Parent = Rep;
+        Rep->LastMember->NextMember = Member;
+        Rep->LastMember = Member;
     }
-    return Ret;
+    if (Vals.size() > 1) Rep->Rank = 1;
+    return Rep;
+}
+
+void DyckGraph::flatten() {
+    for (auto &Node: Nodes) Node.Parent = Node.getRepresentative();
 }
 
 std::pair<DyckGraphNode *, bool> DyckGraph::retrieveDyckVertex(void *Val, const char *Name) {
     if (Val == nullptr) {
-        auto *Node = new DyckGraphNode(nullptr);
-        Vertices.insert(Node);
-        return std::make_pair(Node, false);
+        Nodes.emplace_back(DyckGraphNode::ArenaTag(), (int) Nodes.size(), nullptr, nullptr);
+        NumReps++;
+        RepsValid = false;
+        return std::make_pair(&Nodes.back(), false);
     }
 
     auto It = ValVertexMap.find(Val);
     if (It != ValVertexMap.end()) {
-        return std::make_pair(It->second, true);
+        return std::make_pair(It->second->getRepresentative(), true);
     } else {
-        auto *Node = new DyckGraphNode(Val, Name);
-        Vertices.insert(Node);
+        Nodes.emplace_back(DyckGraphNode::ArenaTag(), (int) Nodes.size(), Val, Name);
+        NumReps++;
+        RepsValid = false;
+        auto *Node = &Nodes.back();
         ValVertexMap.insert(std::pair<void *, DyckGraphNode *>(Val, Node));
         return std::make_pair(Node, false);
     }
@@ -322,55 +255,53 @@ std::pair<DyckGraphNode *, bool> DyckGraph::retrieveDyckVertex(void *Val, const
 DyckGraphNode *DyckGraph::findDyckVertex(void *Val) {
     auto It = ValVertexMap.find(Val);
     if (It != ValVertexMap.end()) {
-        return It->second;
+        return It->second->getRepresentative();
     }
     return nullptr;
 }
 
 unsigned int DyckGraph::numVertices() {
-    return Vertices.size();
+    return NumReps;
 }
 
 unsigned int DyckGraph::numEquivalentClasses() {
-    return Vertices.size();
+    return NumReps;
 }
 
-std::set<DyckGraphNode *> &DyckGraph::getVertices() {
-    return Vertices;
+const std::vector<DyckGraphNode *> &DyckGraph::getVertices() {
+    if (!RepsValid) {
+        Reps.clear();
+        Reps.reserve(NumReps);
+        for (auto &Node: Nodes)
+            if (Node.isRepresentative()) Reps.push_back(&Node);
+        RepsValid = true;
+    }
+    return Reps;
 }
 
 void DyckGraph::validation(const char *File, int Line) {
     printf("Start validation... ");
-    std::set<DyckGraphNode *> &Reps = this->getVertices();
-    auto RepsIt = Reps.begin();
-    while (RepsIt != Reps.end()) {
-        DyckGraphNode *Rep = *RepsIt;
+    for (auto *Rep: getVertices()) {
         auto RepVal = Rep->getEquivalentSet();
         for (auto Val: *RepVal)
-            assert(ValVertexMap[Val] == Rep);
-        RepsIt++;
+            assert(ValVertexMap[Val]->getRepresentative() == Rep);
     }
     printf("Done!\n\n");
 }
 
 void DyckGraph::getReachableVertices(const std::set<DyckGraphNode *> &Sources, std::set<DyckGraphNode *> &Reachable) {
     std::stack<DyckGraphNode *> WorkStack;
-    for (auto *N: Sources) if (N) WorkStack.push(N);
-    std::set<DyckGraphNode *> Visited;
+    for (auto *N: Sources) if (N) WorkStack.push(N->getRepresentative());
     while (!WorkStack.empty()) {
         DyckGraphNode *Top = WorkStack.top();
         WorkStack.pop();
-        if (Visited.count(Top)) continue;
-        Visited.insert(Top);
+        if (!Reachable.insert(Top).second) continue;
 
         std::set<DyckGraphNode *> Tars;
-        Top->getOutVertices(&Tars);
-        auto TIt = Tars.begin();
-        while (TIt != Tars.end()) {
-            DyckGraphNode *DGN = (*TIt);
-            if (Visited.find(DGN) == Visited.end())
+        Top->getOutVertices(Tars);
+        for (auto *DGN: Tars) {
+            if (!Reachable.count(DGN))
                 WorkStack.push(DGN);
-            TIt++;
         }
     }
 }
@@ -380,4 +311,4 @@ void DyckGraph::getReachableVertices(DyckGraphNode *Source, std::set<DyckGraphNo
     std::set<DyckGraphNode *> Srcs;
     Srcs.insert(Source);
     getReachableVertices(Srcs, Reachable);
-}
\ No newline at end of file
+}
@@ -16,14 +16,15 @@
  *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include "Alias/DyckAA/DyckGraphNode.h"
 
-int DyckGraphNode::GlobalNodeIndex = 0;
-
-DyckGraphNode::DyckGraphNode(void *V, const char *Name) {
+DyckGraphNode::DyckGraphNode(ArenaTag, int Index, void *V, const char *Name) {
+    NodeIndex = Index;
     NodeName = Name;
-    NodeIndex = GlobalNodeIndex++;
-    if (V) EquivClass.insert(V);
+    Value = V;
+    Parent = this;
+    LastMember = this;
 }
 
 DyckGraphNode::~DyckGraphNode() = default;
@@ -32,123 +33,75 @@ const char *DyckGraphNode::getName() {
     return NodeName;
 }
 
-unsigned int DyckGraphNode::outNumVertices(void *Label) {
-    auto It = OutNodes.find(Label);
-    if (It != OutNodes.end()) {
-        return It->second.size();
-    }
-    return 0;
-}
-
-unsigned int DyckGraphNode::inNumVertices(void *Label) {
-    auto It = InNodes.find(Label);
-    if (It != InNodes.end()) {
-        return It->second.size();
-    }
-    return 0;
+int DyckGraphNode::getIndex() const {
+    return NodeIndex;
 }
 
-unsigned int DyckGraphNode::degree() {
-    unsigned int Ret = 0;
-
-    auto IIt = InNodes.begin();
-    while (IIt != InNodes.end()) {
-        Ret = Ret + IIt->second.size();
-        IIt++;
-    }
-
-    auto OIt = OutNodes.begin();
-    while (OIt != OutNodes.end()) {
-        Ret = Ret + OIt->second.size();
-        OIt++;
+DyckGraphNode *DyckGraphNode::getRepresentative() {
+    // path halving, a node is written only if its path is longer than one,
+    // so that concurrent lookups on a fully compressed forest never write
+    DyckGraphNode *Node = this;
+    while (Node->Parent != Node) {
+        DyckGraphNode *GrandParent = Node->Parent->Parent;
+        if (Node->Parent != GrandParent) Node->Parent = GrandParent;
+        Node = GrandParent;
     }
-
-    return Ret;
-}
-
-std::set<void *> *DyckGraphNode::getEquivalentSet() {
-    return &this->EquivClass;
-}
-
-void DyckGraphNode::mvEquivalentSetTo(DyckGraphNode *RootRep) {
-    if (RootRep == this) return;
-
-    std::set<void *> *RootEC = RootRep->getEquivalentSet();
-    std::set<void *> *ThisEC = this->getEquivalentSet();
-    RootEC->insert(ThisEC->begin(), ThisEC->end());
-}
-
-std::set<void *> &DyckGraphNode::getOutLabels() {
-    return OutLables;
+    return Node;
 }
 
-std::map<void *, std::set<DyckGraphNode *>> &DyckGraphNode::getOutVertices() {
-    return OutNodes;
+unsigned int DyckGraphNode::outNumVertices(void *Label) {
+    auto *List = getRepresentative()->getOutList(Label);
+    return List ? List->size() : 0;
 }
 
-std::set<void *> &DyckGraphNode::getInLabels() {
-    return InLables;
+DyckGraphNode *DyckGraphNode::getOutVertex(void *Label) {
+    auto *List = getRepresentative()->getOutList(Label);
+    if (!List || List->empty()) return nullptr;
+    return List->front()->getRepresentative();
 }
 
-std::map<void *, std::set<DyckGraphNode *>> &DyckGraphNode::getInVertices() {
-    return InNodes;
+const DyckGraphNode::LabelEdgesTy &DyckGraphNode::getOutVertices() {
+    return getRepresentative()->OutNodes;
 }
 
-int DyckGraphNode::getIndex() const {
-    return NodeIndex;
+void DyckGraphNode::getOutVertices(std::set<DyckGraphNode *> &Targets) {
+    for (auto &LabelIt: getRepresentative()->OutNodes)
+        for (auto *Tar: LabelIt.second)
+            Targets.insert(Tar->getRepresentative());
 }
 
 void DyckGraphNode::addTarget(DyckGraphNode *Node, void *Label) {
-    OutLables.insert(Label);
-    OutNodes[Label].insert(Node);
-    Node->addSource(this, Label);
-}
-
-void DyckGraphNode::removeTarget(DyckGraphNode *Node, void *Label) {
-    auto It = OutNodes.find(Label);
-    if (It != OutNodes.end())
-        It->second.erase(Node);
-    Node->removeSource(this, Label);
-}
-
-bool DyckGraphNode::containsTarget(DyckGraphNode *Tar, void *Label) {
-    auto It = OutNodes.find(Label);
-    if (It != OutNodes.end()) return It->second.count(Tar);
-    return false;
+    auto &List = getRepresentative()->getOrInsertOutList(Label);
+    // cheap de-duplication, the others are removed when the graph is unified
+    if (!List.empty() && List.back()->getRepresentative() == Node->getRepresentative()) return;
+    List.push_back(Node);
 }
 
-std::set<DyckGraphNode *> *DyckGraphNode::getInVertices(void *Label) {
-    auto It = InNodes.find(Label);
-    if (It != InNodes.end()) return &It->second;
-    return nullptr;
+std::set<void *> *DyckGraphNode::getEquivalentSet() {
+    auto *Rep = getRepresentative();
+    if (!Rep->EquivClass) Rep->EquivClass.reset(new std::set<void *>);
+    if (!Rep->EquivClassValid) {
+        for (auto *Member = Rep; Member; Member = Member->NextMember)
+            if (Member->Value) Rep->EquivClass->insert(Member->Value);
+        Rep->EquivClassValid = true;
+    }
+    return Rep->EquivClass.get();
 }
 
-std::set<DyckGraphNode *> *DyckGraphNode::getOutVertices(void *Label) {
-    auto It = OutNodes.find(Label);
-    if (It != OutNodes.end()) return &It->second;
-    return nullptr;
-}
+// the followings are private functions
 
-DyckGraphNode *DyckGraphNode::getInVertex(void *Label) {
-    auto *Set = getInVertices(Label);
-    if (Set && Set->size() == 1) return *Set->begin();
-    return nullptr;
+static bool labelLess(const std::pair<void *, DyckGraphNode::EdgeListTy> &Entry, void *Label) {
+    return Entry.first < Label;
 }
 
-DyckGraphNode *DyckGraphNode::getOutVertex(void *Label) {
-    auto *Set = getOutVertices(Label);
-    if (Set && Set->size() == 1) return *Set->begin();
+DyckGraphNode::EdgeListTy *DyckGraphNode::getOutList(void *Label) {
+    auto It = std::lower_bound(OutNodes.begin(), OutNodes.end(), Label, labelLess);
+    if (It != OutNodes.end() && It->first == Label) return &It->second;
     return nullptr;
 }
 
-// the followings are private functions
-
-void DyckGraphNode::addSource(DyckGraphNode *Node, void *Label) {
-    InLables.insert(Label);
-    InNodes[Label].insert(Node);
-}
-
-void DyckGraphNode::removeSource(DyckGraphNode *Node, void *Label) {
-    auto It = InNodes.find(Label);
-    if (It != InNodes.end()) It->second.erase(Node);
+DyckGraphNode::EdgeListTy &DyckGraphNode::getOrInsertOutList(void *Label) {
+    auto It = std::lower_bound(OutNodes.begin(), OutNodes.end(), Label, labelLess);
+    if (It != OutNodes.end() && It->first == Label) return It->second;
+    return OutNodes.emplace(It, Label, EdgeListTy())->second;
 }
@@ -37,9 +37,13 @@ void DyckModRefAnalysis::getAnalysisUsage(AnalysisUsage &AU) const {
 bool DyckModRefAnalysis::runOnModule(Module &M) {
     RecursiveTimer DyckMRA("Running DyckMRA");
     auto *DyckAA = &getAnalysis<DyckAliasAnalysis>();
+    auto *Cache = DyckAA->getCache();
+    if (Cache && Cache->loadModRef(DyckAA->getDyckGraph(), Func2MR)) return false;
+
     MRAnalyzer MR(&M, DyckAA->getDyckGraph(), DyckAA->getDyckCallGraph());
     MR.intraProcedureAnalysis();
     MR.interProcedureAnalysis();
     MR.swap(Func2MR); // get the result
+    if (Cache) Cache->storeModRef(DyckAA->getDyckGraph(), Func2MR);
     return false;
 }
@@ -18,6 +18,7 @@
 
 #include <llvm/IR/InstIterator.h>
 #include <llvm/IR/Instructions.h>
+#include <algorithm>
 #include "Alias/DyckAA/DyckAliasAnalysis.h"
 #include "Alias/DyckAA/DyckGraph.h"
 #include "Alias/DyckAA/DyckGraphNode.h"
@@ -36,42 +37,114 @@ DyckVFG::DyckVFG(DyckAliasAnalysis *DAA, DyckModRefAnalysis *DMRA, Module *M) {
         buildLocalVFG(F);
     }
 
+    // the edges found in parallel are added in the order of functions
+    std::map<Function *, std::vector<std::pair<DyckVFGNode *, DyckVFGNode *>>> LocalEdgeMap;
     for (auto &F: *M) {
         if (F.empty()) continue;
-        ThreadPool::get()->enqueue([this, DAA, &F, &LocalCFGMap](){
+        auto &LocalEdges = LocalEdgeMap[&F];
+        ThreadPool::get()->enqueue([this, DAA, &F, &LocalCFGMap, &LocalEdges](){
             auto LocalCFG = std::make_shared<CFG>(&F);
             LocalCFGMap.at(&F) = LocalCFG;
-            buildLocalVFG(DAA, LocalCFG.get(), &F);
+            buildLocalVFG(DAA, LocalCFG.get(), &F, LocalEdges);
         });
     }
     ThreadPool::get()->wait();
+    for (auto &F: *M) {
+        if (F.empty()) continue;
+        for (auto &Edge: LocalEdgeMap.at(&F)) Edge.first->addTarget(Edge.second);
+    }
 
-    // connect local VFGs
+    // connect local VFGs, partitioned by callers; each task only queries the CFG of its own caller
     auto *DyckCG = DAA->getDyckCallGraph();
+    std::map<Function *, std::vector<CallEdge>> CallEdgeMap;
     for (auto &F: *M) {
         if (F.empty()) continue;
-        auto *CtrlFlow = LocalCFGMap.at(&F).get();
         auto *CGNode = DyckCG->getFunction(&F);
         if (!CGNode) continue;
-        for (auto &I: instructions(F)) {
-            auto *CI = dyn_cast<CallInst>(&I);
-            if (!CI) continue;
-            auto *TheCall = CGNode->getCall(CI);
-            if (auto *CC = dyn_cast_or_null<CommonCall>(TheCall)) {
-                auto *Callee = dyn_cast<Function>(CC->getCalledFunction());
-                assert(Callee);
-                if (Callee->empty()) continue;
-                connect(DMRA, TheCall, Callee, CtrlFlow);
-            } else if (auto *PC = dyn_cast_or_null<PointerCall>(TheCall)) {
-                for (Function *Callee: *PC) {
+        auto *CtrlFlow = LocalCFGMap.at(&F).get();
+        auto &CallEdges = CallEdgeMap[&F];
+        ThreadPool::get()->enqueue([this, DMRA, &F, CGNode, CtrlFlow, &CallEdges]() {
+            for (auto &I: instructions(F)) {
+                auto *CI = dyn_cast<CallInst>(&I);
+                if (!CI) continue;
+                auto *TheCall = CGNode->getCall(CI);
+                if (auto *CC = dyn_cast_or_null<CommonCall>(TheCall)) {
+                    auto *Callee = dyn_cast<Function>(CC->getCalledFunction());
+                    assert(Callee);
                     if (Callee->empty()) continue;
-                    connect(DMRA, TheCall, Callee, CtrlFlow);
+                    connect(DMRA, TheCall, Callee, CtrlFlow, CallEdges);
+                } else if (auto *PC = dyn_cast_or_null<PointerCall>(TheCall)) {
+                    for (Function *Callee: *PC) {
+                        if (Callee->empty()) continue;
+                        connect(DMRA, TheCall, Callee, CtrlFlow, CallEdges);
+                    }
                 }
             }
+        });
+    }
+    ThreadPool::get()->wait();
+
+    // edges are added in the order of callers, so nodes are created in the same order whatever the number of workers
+    for (auto &F: *M) {
+        auto It = CallEdgeMap.find(&F);
+        if (It == CallEdgeMap.end()) continue;
+        for (auto &Edge: It->second) {
+            auto *FromNode = Edge.FromNode ? Edge.FromNode : getOrCreateVFGNode(Edge.From);
+            if (!Edge.To) continue;
+            auto *ToNode = Edge.ToNode ? Edge.ToNode : getOrCreateVFGNode(Edge.To);
+            FromNode->addTarget(ToNode, Edge.Label);
+        }
+    }
+
+    finalize();
+}
+
+void DyckVFG::finalize() {
+    // out edges, sorted by the indices of targets and de-duplicated
+    TargetOffsets.assign(Nodes.size() + 1, 0);
+    SourceOffsets.assign(Nodes.size() + 1, 0);
+    size_t NumEdges = 0;
+    for (auto *N: Nodes) {
+        auto &Pending = N->PendingTargets;
+        std::sort(Pending.begin(), Pending.end(), [](const DyckVFGNode::EdgeTy &X, const DyckVFGNode::EdgeTy &Y) {
+            return X.first->Index < Y.first->Index || (X.first->Index == Y.first->Index && X.second < Y.second);
+        });
+        Pending.erase(std::unique(Pending.begin(), Pending.end()), Pending.end());
+        NumEdges += Pending.size();
+    }
+    TargetEdges.clear();
+    TargetEdges.reserve(NumEdges);
+    for (auto *N: Nodes) {
+        TargetOffsets[N->Index] = TargetEdges.size();
+        for (auto &Edge: N->PendingTargets) {
+            TargetEdges.push_back(Edge);
+            SourceOffsets[Edge.first->Index + 1]++;
         }
+        std::vector<DyckVFGNode::EdgeTy>().swap(N->PendingTargets);
+    }
+    TargetOffsets[Nodes.size()] = TargetEdges.size();
+
+    // in edges, a counting sort of the out edges by their targets
+    for (unsigned K = 0; K < Nodes.size(); ++K) SourceOffsets[K + 1] += SourceOffsets[K];
+    SourceEdges.resize(NumEdges);
+    std::vector<unsigned> Fill(SourceOffsets.begin(), SourceOffsets.end() - 1);
+    for (auto *N: Nodes)
+        for (unsigned E = TargetOffsets[N->Index]; E < TargetOffsets[N->Index + 1]; ++E)
+            SourceEdges[Fill[TargetEdges[E].first->Index]++] = std::make_pair(N, TargetEdges[E].second);
+
+    for (auto *N: Nodes) {
+        N->TargetBegin = TargetEdges.data() + TargetOffsets[N->Index];
+        N->TargetEnd = TargetEdges.data() + TargetOffsets[N->Index + 1];
+        N->SourceBegin = SourceEdges.data() + SourceOffsets[N->Index];
+        N->SourceEnd = SourceEdges.data() + SourceOffsets[N->Index + 1];
     }
 }
 
+size_t DyckVFG::getEdgeMemoryUsage() const {
+    return (TargetOffsets.capacity() + SourceOffsets.capacity()) * sizeof(unsigned) +
+           (TargetEdges.capacity() + SourceEdges.capacity()) * sizeof(DyckVFGNode::EdgeTy);
+}
+
 void DyckVFG::buildLocalVFG(Function &F) {
     // direct value flow through cast, gep-0-0, select, phi
     for (auto &I: instructions(F)) {
@@ -114,7 +187,8 @@ void DyckVFG::buildLocalVFG(Function &F) {
     }
 }
 
-void DyckVFG::buildLocalVFG(DyckAliasAnalysis *DAA, CFG *CtrlFlow, Function *F) const {
+void DyckVFG::buildLocalVFG(DyckAliasAnalysis *DAA, CFG *CtrlFlow, Function *F,
+                            std::vector<std::pair<DyckVFGNode *, DyckVFGNode *>> &Edges) const {
     // indirect value flow through load/store
     auto *DG = DAA->getDyckGraph();
     std::map<DyckGraphNode *, std::vector<LoadInst *>> LoadMap; // ptr -> load
@@ -145,7 +219,7 @@ void DyckVFG::buildLocalVFG(DyckAliasAnalysis *DAA, CFG *CtrlFlow, Function *F)
                 if (CtrlFlow->reachable(Store, Load)) {
                     auto *StNode = getVFGNode(Store->getValueOperand());
                     assert(StNode);
-                    StNode->addTarget(LdNode);
+                    Edges.emplace_back(StNode, LdNode);
                 }
             }
         }
@@ -165,8 +239,9 @@ DyckVFGNode *DyckVFG::getVFGNode(Value *V) const {
 DyckVFGNode *DyckVFG::getOrCreateVFGNode(Value *V) {
     auto It = ValueNodeMap.find(V);
     if (It == ValueNodeMap.end()) {
-        auto *Ret = new DyckVFGNode(V);
+        auto *Ret = new DyckVFGNode(V, Nodes.size());
         ValueNodeMap[V] = Ret;
+        Nodes.push_back(Ret);
         return Ret;
     }
     return It->second;
@@ -192,25 +267,27 @@ static void collectValues(std::set<DyckGraphNode *>::iterator Begin, std::set<Dy
     }
 }
 
-void DyckVFG::connect(DyckModRefAnalysis *DMRA, Call *C, Function *Callee, CFG *Ctrl) {
+void DyckVFG::connect(DyckModRefAnalysis *DMRA, Call *C, Function *Callee, CFG *Ctrl,
+                      std::vector<CallEdge> &Edges) const {
+    // nodes that do not exist yet are left null and created when the edges are merged
+    auto AddEdge = [this, &Edges](Value *From, Value *To, int Label) {
+        Edges.push_back({From, To, getVFGNode(From), To ? getVFGNode(To) : nullptr, Label});
+    };
+
     // connect direct inputs
     for (unsigned K = 0; K < C->numArgs(); ++K) {
         if (K >= Callee->arg_size()) continue; // ignore var args
-        auto *Actual = C->getArg(K);
-        auto *ActualNode = getOrCreateVFGNode(Actual);
-        auto *Formal = Callee->getArg(K);
-        auto *FormalNode = getOrCreateVFGNode(Formal);
-        ActualNode->addTarget(FormalNode, C->id());
+        AddEdge(C->getArg(K), Callee->getArg(K), C->id());
     }
     // connect direct outputs
     if (!C->getInstruction()->getType()->isVoidTy()) {
-        auto *ActualRet = getOrCreateVFGNode(C->getInstruction());
+        auto *ActualRet = C->getInstruction();
+        AddEdge(ActualRet, nullptr, 0);
         for (auto &Inst: instructions(Callee)) {
             auto *RetInst = dyn_cast<ReturnInst>(&Inst);
             if (!RetInst) continue;
             if (RetInst->getNumOperands() != 1) continue;
-            auto *FormalRet = getOrCreateVFGNode(Inst.getOperand(0));
-            FormalRet->addTarget(ActualRet, -C->id());
+            AddEdge(Inst.getOperand(0), ActualRet, -C->id());
         }
     }
 
@@ -224,7 +301,7 @@ void DyckVFG::connect(DyckModRefAnalysis *DMRA, Call *C, Function *Callee, CFG *
     collectValues(DMRA->ref_begin(Callee), DMRA->ref_end(Callee), RefCallerValues, RefCalleeValues, C, Callee, Ctrl);
     for (auto *CallerVal: RefCallerValues)
         for (auto *CalleeVal: RefCalleeValues)
-            getOrCreateVFGNode(CallerVal)->addTarget(getOrCreateVFGNode(CalleeVal), C->id());
+            AddEdge(CallerVal, CalleeVal, C->id());
 
     // connect indirect outputs
     //  1. get mods, get mod values (in caller and callee)
@@ -233,7 +310,7 @@ void DyckVFG::connect(DyckModRefAnalysis *DMRA, Call *C, Function *Callee, CFG *
     collectValues(DMRA->mod_begin(Callee), DMRA->mod_end(Callee), ModCallerValues, ModCalleeValues, C, Callee, Ctrl);
     for (auto *CalleeVal: ModCalleeValues)
         for (auto *CallerVal: ModCallerValues)
-            getOrCreateVFGNode(CalleeVal)->addTarget(getOrCreateVFGNode(CallerVal), -C->id());
+            AddEdge(CalleeVal, CallerVal, -C->id());
 }
 
 Function *DyckVFGNode::getFunction() const {
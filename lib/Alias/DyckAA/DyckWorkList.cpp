@@ -0,0 +1,74 @@
+/*
+ *  Canary features a fast unification-based alias analysis for C programs
+ *  Copyright (C) 2021 Qingkai Shi <qingkaishi@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include "Alias/DyckAA/DyckWorkList.h"
+
+bool DyckWorkList::push(unsigned Vertex, void *Label) {
+    grow(Vertex);
+    ItemTy Item(Vertex, Label);
+    if (Membership.test(Vertex) && Positions.count(Item)) return false;
+
+    Positions[Item] = Items.size();
+    Items.push_back(Item);
+    if (Slots[Vertex]++ == 0) Membership.set(Vertex);
+    return true;
+}
+
+bool DyckWorkList::contains(unsigned Vertex, void *Label) const {
+    if (!contains(Vertex)) return false;
+    return Positions.count(ItemTy(Vertex, Label));
+}
+
+bool DyckWorkList::remove(unsigned Vertex, void *Label) {
+    if (!contains(Vertex)) return false;
+    auto It = Positions.find(ItemTy(Vertex, Label));
+    if (It == Positions.end()) return false;
+
+    // move the last pair to the hole
+    unsigned Pos = It->second;
+    Positions.erase(It);
+    if (Pos != Items.size() - 1) {
+        Items[Pos] = Items.back();
+        Positions[Items[Pos]] = Pos;
+    }
+    Items.pop_back();
+    release(Vertex);
+    return true;
+}
+
+DyckWorkList::ItemTy DyckWorkList::pop() {
+    assert(!Items.empty() && "Trying to pop an empty worklist!");
+    ItemTy Item = Items.back();
+    Items.pop_back();
+    Positions.erase(Item);
+    release(Item.first);
+    return Item;
+}
+
+void DyckWorkList::grow(unsigned Vertex) {
+    if (Vertex < Slots.size()) return;
+    unsigned NewSize = Slots.size() * 2 > Vertex + 1 ? Slots.size() * 2 : Vertex + 1;
+    Slots.resize(NewSize, 0);
+    Membership.resize(NewSize);
+}
+
+void DyckWorkList::release(unsigned Vertex) {
+    assert(Slots[Vertex] > 0);
+    if (--Slots[Vertex] == 0) Membership.reset(Vertex);
+}
@@ -16,10 +16,14 @@
  *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/IR/InstIterator.h>
 #include <llvm/IR/Instruction.h>
 #include <llvm/IR/Instructions.h>
+#include <algorithm>
+#include <future>
 #include "Alias/DyckAA/MRAnalyzer.h"
+#include "Support/ThreadPool.h"
 
 MRAnalyzer::MRAnalyzer(Module *M, DyckGraph *DG, DyckCallGraph *DCG) : M(M), DG(DG), DCG(DCG) {
 }
@@ -27,36 +31,58 @@ MRAnalyzer::MRAnalyzer(Module *M, DyckGraph *DG, DyckCallGraph *DCG) : M(M), DG(
 MRAnalyzer::~MRAnalyzer() = default;
 
 void MRAnalyzer::intraProcedureAnalysis() {
+    // the graph is not changed any more, the maps are initialized here and
+    // then filled in parallel, each task only writes its own entry.
+    for (auto It = DCG->nodes_begin(), E = DCG->nodes_end(); It != E; ++It) {
+        auto *F = (*It)->getLLVMFunction();
+        if (!F) continue; // there is one and only one fake node that does not include a function
+        Func2MR[F];
+        std::vector<DyckGraphNode *> ParNodes;
+        for (unsigned K = 0; K < F->arg_size(); ++K) {
+            auto *DGNode = DG->findDyckVertex(F->getArg(K));
+            if (DGNode) ParNodes.push_back(DGNode);
+        }
+        std::sort(ParNodes.begin(), ParNodes.end());
+        ParNodes.erase(std::unique(ParNodes.begin(), ParNodes.end()), ParNodes.end());
+        FuncParReachableNodes[F] = &ParReachableNodes[ParNodes];
+    }
 
-}
+    // compute a set of dyck nodes reachable from parameters and todo returns
+    std::vector<std::future<void>> Futures;
+    for (auto &It: ParReachableNodes) {
+        if (It.first.empty()) continue;
+        Futures.push_back(ThreadPool::get()->enqueue([this, &It]() {
+            std::set<DyckGraphNode *> ParNodes(It.first.begin(), It.first.end());
+            DG->getReachableVertices(ParNodes, It.second);
+            for (auto *ParNode: It.first) It.second.erase(ParNode); // let us exclude explicit parameters
+        }));
+    }
+    for (auto &Future: Futures) Future.wait();
 
-void MRAnalyzer::interProcedureAnalysis() {
-    // fixme let's impl a simple version where we do not use scc and bottom-up inter-proc analysis
-    for (auto It = DCG->nodes_begin(), E = DCG->nodes_end(); It != E; ++It)
-        runOnFunction(*It);
+    Futures.clear();
+    for (auto &It: Func2MR)
+        Futures.push_back(ThreadPool::get()->enqueue([this, &It]() { runOnFunction(It.first); }));
+    for (auto &Future: Futures) Future.wait();
 }
 
-void MRAnalyzer::runOnFunction(DyckCallGraphNode *CGNode) {
-    auto *F = CGNode->getLLVMFunction();
-    if (!F) return; // there is one and only one fake node that does not include a function
-
-    auto &MR = Func2MR[F];
-    std::set<DyckGraphNode *> &Refs = MR.Mods;
-    std::set<DyckGraphNode *> &Mods = MR.Refs;
+void MRAnalyzer::interProcedureAnalysis() {
+    std::vector<std::vector<std::vector<DyckCallGraphNode *>>> Levels;
+    getSCCLevels(Levels);
 
-    // compute a set of dyck nodes reachable from parameters and todo returns
-    std::set<DyckGraphNode *> ParReachableNodes;
-    std::set<DyckGraphNode *> RetReachableNodes;
-    for (unsigned K = 0; K < F->arg_size(); ++K) {
-        auto *DGNode = DG->findDyckVertex(F->getArg(K));
-        if (!DGNode) continue;
-        DG->getReachableVertices(DGNode, ParReachableNodes);
-    }
-    for (unsigned K = 0; K < F->arg_size(); ++K) {
-        auto *DGNode = DG->findDyckVertex(F->getArg(K));
-        if (!DGNode) continue;
-        ParReachableNodes.erase(DGNode); // let us exclude explicit parameters
+    // an SCC only reads the summaries of SCCs in lower levels
+    for (auto &Level: Levels) {
+        std::vector<std::future<void>> Futures;
+        for (auto &SCC: Level)
+            Futures.push_back(ThreadPool::get()->enqueue([this, &SCC]() { runOnSCC(SCC); }));
+        for (auto &Future: Futures) Future.wait();
     }
+}
+
+void MRAnalyzer::runOnFunction(Function *F) {
+    auto &MR = Func2MR.at(F);
+    auto &ParReachable = *FuncParReachableNodes.at(F);
+    std::set<DyckGraphNode *> &Refs = MR.Refs;
+    std::set<DyckGraphNode *> &Mods = MR.Mods;
 
     // for each instruction,
     // if it refs a node that is reachable from parameters add it to refs
@@ -67,7 +93,7 @@ void MRAnalyzer::runOnFunction(DyckCallGraphNode *CGNode) {
             auto *RefNode = DG->findDyckVertex(Ref);
             if (!RefNode) continue;
             // check if reachable from parameters
-            if (ParReachableNodes.count(RefNode)) Refs.insert(RefNode);
+            if (ParReachable.count(RefNode)) Refs.insert(RefNode);
         }
         if (F->onlyReadsMemory()) continue; // a read only function
         if (auto *SI = dyn_cast<StoreInst>(&I)) {
@@ -75,10 +101,91 @@ void MRAnalyzer::runOnFunction(DyckCallGraphNode *CGNode) {
             auto *PtrNode = DG->findDyckVertex(Ptr);
             if (!PtrNode) continue;
             auto *ModNode = PtrNode->getOutVertex(DG->getDereferenceEdgeLabel());
-            // check if reachable from parameters and returns
-            if (ParReachableNodes.count(ModNode) || RetReachableNodes.count(ModNode)) Mods.insert(ModNode);
+            // check if reachable from parameters, todo returns
+            if (ParReachable.count(ModNode)) Mods.insert(ModNode);
         } else {
             // todo other instructions that may revise a memory
         }
     }
 }
+
+void MRAnalyzer::runOnSCC(const std::vector<DyckCallGraphNode *> &SCC) {
+    // the callees and the caller share the dyck nodes of parameters and arguments, so
+    // composing a callee's summary is to keep the nodes that are also visible in the caller
+    bool Changed = true;
+    while (Changed) {
+        Changed = false;
+        for (auto *CGNode: SCC) {
+            auto *F = CGNode->getLLVMFunction();
+            auto &MR = Func2MR.at(F);
+            auto &ParReachable = *FuncParReachableNodes.at(F);
+            for (auto It = CGNode->child_begin(), E = CGNode->child_end(); It != E; ++It) {
+                auto *Callee = (*It)->getLLVMFunction();
+                if (!Callee || Callee == F) continue;
+                auto &CalleeMR = Func2MR.at(Callee);
+                for (auto *Node: CalleeMR.Mods)
+                    if (ParReachable.count(Node) && MR.Mods.insert(Node).second) Changed = true;
+                for (auto *Node: CalleeMR.Refs)
+                    if (ParReachable.count(Node) && MR.Refs.insert(Node).second) Changed = true;
+            }
+        }
+        // the summaries of a single function are complete after one round
+        if (SCC.size() == 1) break;
+    }
+}
+
+void MRAnalyzer::getSCCLevels(std::vector<std::vector<std::vector<DyckCallGraphNode *>>> &Levels) {
+    // an iterative version of tarjan's algorithm, which finds SCCs in a reverse topological order,
+    // so that the levels of the callees of an SCC are known when the SCC is found
+    DenseMap<DyckCallGraphNode *, unsigned> Index, LowLink, SCCLevel;
+    std::vector<DyckCallGraphNode *> Stack;
+    std::vector<std::pair<DyckCallGraphNode *, CallRecordVecTy::iterator>> VisitStack;
+    unsigned NextIndex = 0;
+
+    auto Visit = [&](DyckCallGraphNode *N) {
+        Index[N] = LowLink[N] = NextIndex++;
+        Stack.push_back(N);
+        VisitStack.emplace_back(N, N->child_edge_begin());
+    };
+
+    for (auto It = DCG->nodes_begin(), E = DCG->nodes_end(); It != E; ++It) {
+        if (!(*It)->getLLVMFunction() || Index.count(*It)) continue;
+        Visit(*It);
+        while (!VisitStack.empty()) {
+            auto *N = VisitStack.back().first;
+            auto &ChildIt = VisitStack.back().second;
+            if (ChildIt != N->child_edge_end()) {
+                auto *Child = (ChildIt++)->second;
+                if (!Child->getLLVMFunction()) continue;
+                auto CIt = Index.find(Child);
+                if (CIt == Index.end()) Visit(Child);
+                else if (!SCCLevel.count(Child)) LowLink[N] = std::min(LowLink[N], CIt->second);
+                continue;
+            }
+
+            VisitStack.pop_back();
+            if (!VisitStack.empty()) {
+                auto *Parent = VisitStack.back().first;
+                LowLink[Parent] = std::min(LowLink[Parent], LowLink[N]);
+            }
+            if (LowLink[N] != Index[N]) continue;
+
+            std::vector<DyckCallGraphNode *> SCC;
+            do {
+                SCC.push_back(Stack.back());
+                Stack.pop_back();
+            } while (SCC.back() != N);
+
+            unsigned Level = 0;
+            for (auto *Member: SCC) {
+                for (auto CIt = Member->child_begin(), CE = Member->child_end(); CIt != CE; ++CIt) {
+                    auto LIt = SCCLevel.find(*CIt);
+                    if (LIt != SCCLevel.end()) Level = std::max(Level, LIt->second + 1);
+                }
+            }
+            for (auto *Member: SCC) SCCLevel[Member] = Level;
+            if (Levels.size() <= Level) Levels.resize(Level + 1);
+            Levels[Level].push_back(std::move(SCC));
+        }
+    }
+}
@@ -13,6 +13,7 @@ namespace context
 
 void AdaptiveContext::trackCallSite(const ProgramPoint& pLoc)
 {
+	std::unique_lock<std::shared_timed_mutex> lock(trackedMutex);
 	trackedCallsites.insert(pLoc);
 }
 
@@ -23,7 +24,12 @@ const Context* AdaptiveContext::pushContext(const Context* ctx, const llvm::Inst
 
 const Context* AdaptiveContext::pushContext(const ProgramPoint& pp)
 {
-	if (trackedCallsites.count(pp))
+	bool tracked;
+	{
+		std::shared_lock<std::shared_timed_mutex> lock(trackedMutex);
+		tracked = trackedCallsites.count(pp) != 0;
+	}
+	if (tracked)
 		return Context::pushContext(pp);
 	else
 		return pp.getContext();
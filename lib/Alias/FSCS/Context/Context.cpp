@@ -13,9 +13,7 @@ const Context* Context::pushContext(const ProgramPoint& pp)
 
 const Context* Context::pushContext(const Context* ctx, const Instruction* inst)
 {
-	auto newCtx = Context(inst, ctx);
-	auto itr = ctxSet.insert(newCtx).first;
-	return &(*itr);
+	return ctxSet.intern(Context(inst, ctx));
 }
 
 const Context* Context::popContext(const Context* ctx)
@@ -26,8 +24,7 @@ const Context* Context::popContext(const Context* ctx)
 
 const Context* Context::getGlobalContext()
 {
-	auto itr = ctxSet.insert(Context()).first;
-	return &(*itr);
+	return ctxSet.intern(Context());
 }
 
 std::vector<const Context*> Context::getAllContexts()
@@ -35,10 +32,14 @@ std::vector<const Context*> Context::getAllContexts()
 	std::vector<const Context*> ret;
 	ret.reserve(ctxSet.size());
 
-	for (auto const& ctx: ctxSet)
-		ret.push_back(&ctx);
+	ctxSet.forEach([&ret](const Context& ctx) { ret.push_back(&ctx); });
 
 	return ret;
 }
 
+void Context::releaseAll()
+{
+	ctxSet.clear();
+}
+
 }
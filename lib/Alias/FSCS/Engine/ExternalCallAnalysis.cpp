@@ -351,17 +351,6 @@ void TransferFunction::evalExternalCopy(const context::Context* ctx, const CallC
 	auto const& src = copyEffect.getSource();
 	auto const& dest = copyEffect.getDest();
 
-	// Add debug output
-	static size_t copyCount = 0;
-	bool showDebug = copyCount < 20;
-	copyCount++;
-	
-	if (showDebug) {
-		llvm::errs() << "DEBUG: [ExternalCopy:" << copyCount << "] Processing copy with context depth=" 
-		             << ctx->size() << ", src type=" << static_cast<int>(src.getType())
-					 << ", dest type=" << static_cast<int>(dest.getType()) << "\n";
-	}
-
 	// Special case for memcpy: the source is not a single ptr/mem
 	if (src.getType() == CopySource::SourceType::ReachableMemory)
 	{
@@ -370,84 +359,34 @@ void TransferFunction::evalExternalCopy(const context::Context* ctx, const CallC
 		auto& store = evalResult.getNewStore(*localState);
 		auto storeChanged = evalMemcpy(ctx, callNode, store, dest.getPosition(), src.getPosition());
 
-		if (storeChanged) {
-			// Use the current context for the program point
+		if (storeChanged)
 			addMemLevelSuccessors(ProgramPoint(ctx, &callNode), store, evalResult);
-			
-			if (showDebug) {
-				llvm::errs() << "DEBUG: [ExternalCopy:" << copyCount << "] Added mem-level successors for memcpy with context depth=" 
-				             << ctx->size() << "\n";
-			}
-		} else if (showDebug) {
-			llvm::errs() << "DEBUG: [ExternalCopy:" << copyCount << "] No store changes for memcpy\n";
-		}
 	}
 	else
 	{
 		auto srcSet = evalExternalCopySource(ctx, callNode, src);
-		if (!srcSet.empty()) {
+		if (!srcSet.empty())
 			evalExternalCopyDest(ctx, callNode, evalResult, dest, srcSet);
-			
-			if (showDebug) {
-				llvm::errs() << "DEBUG: [ExternalCopy:" << copyCount << "] Processed copy operation with non-empty source set, context depth=" 
-				             << ctx->size() << "\n";
-			}
-		} else if (showDebug) {
-			llvm::errs() << "DEBUG: [ExternalCopy:" << copyCount << "] Empty source set for copy operation\n";
-		}
 	}
 }
 
 void TransferFunction::evalExternalCallByEffect(const context::Context* ctx, const CallCFGNode& callNode, const PointerEffect& effect, EvalResult& evalResult)
 {
-	// Add debug output
-	static size_t effectCount = 0;
-	bool showDebug = effectCount < 20;
-	effectCount++;
-	
-	if (showDebug) {
-		llvm::errs() << "DEBUG: [ExternalEffect:" << effectCount << "] Processing effect type=" 
-		             << static_cast<int>(effect.getType()) 
-					 << " with context depth=" << ctx->size() << "\n";
-	}
-	
 	switch (effect.getType())
 	{
 		case PointerEffectType::Alloc:
 		{
-			if (evalExternalAlloc(ctx, callNode, effect.getAsAllocEffect())) {
-				// Use the current context for the program point
+			if (evalExternalAlloc(ctx, callNode, effect.getAsAllocEffect()))
 				addTopLevelSuccessors(ProgramPoint(ctx, &callNode), evalResult);
-				
-				if (showDebug) {
-					llvm::errs() << "DEBUG: [ExternalEffect:" << effectCount << "] Added top-level successors with context depth=" 
-								 << ctx->size() << "\n";
-				}
-			}
-			// Preserve context for memory-level successors
 			addMemLevelSuccessors(ProgramPoint(ctx, &callNode), *localState, evalResult);
-			
-			if (showDebug) {
-				llvm::errs() << "DEBUG: [ExternalEffect:" << effectCount << "] Added mem-level successors with context depth=" 
-				             << ctx->size() << "\n";
-			}
 			break;
 		}
 		case PointerEffectType::Copy:
 		{
 			evalExternalCopy(ctx, callNode, evalResult, effect.getAsCopyEffect());
-			
-			if (showDebug) {
-				llvm::errs() << "DEBUG: [ExternalEffect:" << effectCount << "] Processed copy effect with context depth=" 
-				             << ctx->size() << "\n";
-			}
 			break;
 		}
 		case PointerEffectType::Exit:
-			if (showDebug) {
-				llvm::errs() << "DEBUG: [ExternalEffect:" << effectCount << "] Processed exit effect with context depth=" 
-				             << ctx->size() << "\n";
-			}
 			break;
 	}
 }
@@ -457,19 +396,7 @@ void TransferFunction::evalExternalCall(const context::Context* ctx, const CallC
 	// Use fc.getContext() directly instead of creating a new context
 	// This ensures consistent context handling between internal and external calls
 	auto newCtx = fc.getContext();
-	
-	// Add debug output to track context usage
-	static size_t externalCallCount = 0;
-	bool showDebug = externalCallCount < 20;
-	externalCallCount++;
-	
-	if (showDebug) {
-		llvm::errs() << "DEBUG: [ExternalCall:" << externalCallCount << "] Function " 
-		             << fc.getFunction()->getName() 
-					 << ", ctx depth=" << ctx->size() 
-					 << ", new ctx depth=" << newCtx->size() << "\n";
-	}
-	
+
 	auto summary = globalState.getExternalPointerTable().lookup(fc.getFunction()->getName());
 	if (summary == nullptr)
 	{
@@ -479,38 +406,14 @@ void TransferFunction::evalExternalCall(const context::Context* ctx, const CallC
 		// Treat unmodeled functions as no-ops by default instead of crashing
 		// But preserve the context when adding successors
 		addMemLevelSuccessors(ProgramPoint(newCtx, &callNode), *localState, evalResult);
-		
-		if (showDebug) {
-			llvm::errs() << "DEBUG: [ExternalCall:" << externalCallCount << "] Added successors with context depth=" 
-			             << newCtx->size() << "\n";
-		}
 		return;
 	}
 
 	// If the external func is a noop, we still need to propagate
 	if (summary->empty())
-	{
 		addMemLevelSuccessors(ProgramPoint(newCtx, &callNode), *localState, evalResult);
-		
-		if (showDebug) {
-			llvm::errs() << "DEBUG: [ExternalCall:" << externalCallCount << "] Empty summary, added successors with context depth=" 
-			             << newCtx->size() << "\n";
-		}
-	}
 	else
 	{
-		if (showDebug) {
-			// Since PointerEffectSummary doesn't have a size() method, count effects manually
-			size_t effectCount = 0;
-			for (auto const& effect: *summary) {
-				effectCount++;
-			}
-			
-			llvm::errs() << "DEBUG: [ExternalCall:" << externalCallCount << "] Found " 
-			             << effectCount << " effects to process with context depth=" 
-						 << newCtx->size() << "\n";
-		}
-		
 		for (auto const& effect: *summary)
 			evalExternalCallByEffect(newCtx, callNode, effect, evalResult);
 	}
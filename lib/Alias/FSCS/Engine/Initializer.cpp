@@ -35,11 +35,6 @@ ForwardWorkList Initializer::runOnInitState(Store&& initStore)
 	assert(entryCFG != nullptr);
 	auto entryNode = entryCFG->getEntryNode();
 
-	// Log entry context info
-	llvm::errs() << "DEBUG: Initializing analysis with entry function " 
-	             << entryCFG->getFunction().getName() 
-				 << ", k=" << context::KLimitContext::getLimit() << "\n";
-
 	// Set up argv
 	auto& entryFunc = entryCFG->getFunction();
 	if (entryFunc.arg_size() > 1)
@@ -66,9 +61,6 @@ ForwardWorkList Initializer::runOnInitState(Store&& initStore)
 	auto pp = ProgramPoint(entryCtx, entryNode);
 	memo.update(pp, std::move(initStore));
 	workList.enqueue(pp);
-	
-	llvm::errs() << "DEBUG: Initial program point created with context depth " 
-	             << entryCtx->size() << ", node type EntryNode\n";
 
 	return workList;
 }
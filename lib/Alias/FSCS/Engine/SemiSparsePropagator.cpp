@@ -3,12 +3,10 @@
 #include "Alias/FSCS/Engine/SemiSparsePropagator.h"
 #include "Alias/FSCS/Engine/WorkList.h"
 #include "Alias/FSCS/Program/CFG/CFG.h"
+#include "Alias/FSCS/Support/Instrumentation.h"
 #include "Alias/FSCS/Support/Memo.h"
 #include "Alias/FSCS/Context/Context.h"
-
 #include "Alias/FSCS/IO/Printer.h"
-#include <llvm/Support/raw_ostream.h>
-using namespace llvm;
 
 namespace tpa
 {
@@ -44,16 +42,6 @@ bool isTopLevelNode(const CFGNode* node)
  */
 bool SemiSparsePropagator::enqueueIfMemoChange(const ProgramPoint& pp, const Store& store)
 {
-	// Debug contexts during propagation
-	static size_t propagationCount = 0;
-	bool showDebug = propagationCount < 50;
-	propagationCount++;
-	
-	if (showDebug && propagationCount % 10 == 0) {
-		errs() << "DEBUG: [Propagation:" << propagationCount << "] Context depth=" 
-		       << pp.getContext()->size() << "\n";
-	}
-
 	if (memo.update(pp, store))
 	{
 		workList.enqueue(pp);
@@ -76,17 +64,7 @@ void SemiSparsePropagator::propagateTopLevel(const EvalSuccessor& evalSucc)
 {
 	// Top-level successors: no store merging, just enqueue
 	auto pp = evalSucc.getProgramPoint();
-	
-	// Critical: Ensure context is properly propagated
-	static size_t topLevelPropCount = 0;
-	bool showDebug = topLevelPropCount < 20;
-	topLevelPropCount++;
-	
-	if (showDebug) {
-		errs() << "DEBUG: [TopLevelProp:" << topLevelPropCount << "] Enqueueing program point with context depth="
-		       << pp.getContext()->size() << "\n";
-	}
-	
+	TPA_RECORD_EVENT(TopLevelPropagation, 1);
 	workList.enqueue(pp);
 }
 
@@ -105,25 +83,12 @@ void SemiSparsePropagator::propagateMemLevel(const EvalSuccessor& evalSucc)
 	// Mem-level successors: store merging, enqueue if memo changed
 	auto pp = evalSucc.getProgramPoint();
 	auto node = pp.getCFGNode();
-	
-	// Critical: Debug context propagation in memory-level operations
-	static size_t memLevelPropCount = 0;
-	bool showDebug = memLevelPropCount < 20;
-	memLevelPropCount++;
-	
-	if (showDebug) {
-		errs() << "DEBUG: [MemLevelProp:" << memLevelPropCount << "] Processing program point with context depth="
-		       << pp.getContext()->size() << "\n";
-	}
-	
+
 	assert(!isTopLevelNode(node));
 	assert(evalSucc.getStore() != nullptr);
 	bool enqueued = enqueueIfMemoChange(pp, *evalSucc.getStore());
-
-	if (showDebug && enqueued) {
-		errs() << "DEBUG: [MemLevelProp:" << memLevelPropCount << "] Enqueued program point with context depth="
-		       << pp.getContext()->size() << "\n";
-	}
+	TPA_RECORD_EVENT(MemLevelPropagation, enqueued ? 1 : 0);
+	(void)enqueued;
 }
 
 /**
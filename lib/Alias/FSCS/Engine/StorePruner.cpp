@@ -5,6 +5,7 @@
 #include "Alias/FSCS/MemoryModel/PointerManager.h"
 #include "Alias/FSCS/Program/CFG/CFGNode.h"
 #include "Alias/FSCS/IO/Printer.h"
+#include "Alias/FSCS/Support/Instrumentation.h"
 
 #include <llvm/Support/raw_ostream.h>
 
@@ -126,15 +127,9 @@ void StorePruner::findAllReachableObjects(const Store& store, ObjectSet& reachab
  */
 Store StorePruner::filterStore(const Store& store, const ObjectSet& reachableSet)
 {
-	Store ret;
-	for (auto const& mapping: store)
-	{
-		if (reachableSet.count(mapping.first))
-			ret.strongUpdate(mapping.first, mapping.second);
-		else
-			ret.strongUpdate(mapping.first, mapping.second);
-	}
-	return ret;
+	// Unreachable objects are currently kept as well, so the result is the store itself. Copying it rather than re-inserting every mapping lets the callee's store share its structure with the caller's
+	(void)reachableSet;
+	return store;
 }
 
 /**
@@ -161,6 +156,7 @@ Store StorePruner::pruneStore(const Store& store, const ProgramPoint& pp)
 	
 	auto reachableSet = getRootSet(store, pp);
 	findAllReachableObjects(store, reachableSet);
+	TPA_RECORD_EVENT(StorePruning, reachableSet.size());
 	return filterStore(store, reachableSet);
 }
 
@@ -164,17 +164,6 @@ void TransferFunction::evalInternalCall(const context::Context* ctx, const CallC
 
 	// Get the context from the function context instead of creating a new one
 	auto newCtx = fc.getContext();
-	
-	// Debug output for context creation
-	static size_t callCount = 0;
-	if (callCount < 20) {
-		llvm::errs() << "DEBUG: [" << callCount << "] evalInternalCall for " 
-		             << fc.getFunction()->getName() 
-					 << " ctx size=" << ctx->size() 
-					 << " newCtx size=" << newCtx->size() 
-					 << "\n";
-		callCount++;
-	}
 
 	// Use the caller's context (ctx) when collecting arguments, not the callee's context (newCtx)
 	// Arguments exist in the caller's context, not the callee's context
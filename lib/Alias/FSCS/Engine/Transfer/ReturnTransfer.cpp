@@ -78,7 +78,8 @@ void TransferFunction::evalReturnNode(const ProgramPoint& pp, EvalResult& evalRe
 	//if (prunedStore != nullptr)
 	//	evalResult.getStore().mergeWith(*prunedStore);
 
-	for (auto retSite: globalState.getCallGraph().getCallers(FunctionContext(ctx, &retNode.getFunction())))
+	// A snapshot, since call edges may be added concurrently
+	for (auto retSite: globalState.getCallGraph().getCallersSnapshot(FunctionContext(ctx, &retNode.getFunction())))
 		evalReturn(ctx, retNode, retSite, evalResult);
 }
 
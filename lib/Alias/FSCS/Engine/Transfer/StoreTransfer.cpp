@@ -25,23 +25,6 @@ void TransferFunction::weakUpdateStore(PtsSet dstSet, PtsSet srcSet, Store& stor
 
 void TransferFunction::evalStore(const Pointer* dst, const Pointer* src, const ProgramPoint& pp, EvalResult& evalResult)
 {
-	// Debug - verify pointer contexts match the program point
-	static size_t storeOpCount = 0;
-	bool showDebug = storeOpCount < 20;
-	storeOpCount++;
-	
-	if (showDebug) {
-		auto ctx = pp.getContext();
-		llvm::errs() << "DEBUG: [Store:" << storeOpCount << "] pp ctx depth=" << ctx->size()
-		             << ", dst ptr ctx depth=" << dst->getContext()->size()
-					 << ", src ptr ctx depth=" << src->getContext()->size();
-					 
-		if (ctx != dst->getContext() || ctx != src->getContext()) {
-			llvm::errs() << " (CONTEXT MISMATCH!)";
-		}
-		llvm::errs() << "\n";
-	}
-
 	auto& env = globalState.getEnv();
 
 	auto srcSet = env.lookup(src);
@@ -74,20 +57,8 @@ void TransferFunction::evalStoreNode(const ProgramPoint& pp, EvalResult& evalRes
 	auto srcPtr = ptrManager.getPointer(ctx, storeNode.getSrc());
 	auto dstPtr = ptrManager.getPointer(ctx, storeNode.getDest());
 
-	// Debug - track when pointers are missing
-	static size_t storeNodeCount = 0;
-	bool showDebug = storeNodeCount < 20;
-	storeNodeCount++;
-	
-	if (srcPtr == nullptr || dstPtr == nullptr) {
-		if (showDebug) {
-			llvm::errs() << "DEBUG: [StoreNode:" << storeNodeCount << "] Missing pointer: "
-			             << "src=" << (srcPtr ? "valid" : "null") 
-						 << ", dst=" << (dstPtr ? "valid" : "null")
-						 << ", ctx depth=" << ctx->size() << "\n";
-		}
+	if (srcPtr == nullptr || dstPtr == nullptr)
 		return;
-	}
 
 	evalStore(dstPtr, srcPtr, pp, evalResult);
 }
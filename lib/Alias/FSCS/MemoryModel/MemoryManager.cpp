@@ -47,6 +47,7 @@ const MemoryObject* MemoryManager::getMemoryObject(const MemoryBlock* memBlock,
 	assert(memBlock != nullptr);
 
 	auto obj = MemoryObject(memBlock, offset, summary);
+	std::lock_guard<std::mutex> lock(mutex);
 	auto itr = objSet.insert(obj).first;
 	assert(itr->isSummaryObject() == summary);
 	return &*itr;
@@ -64,6 +65,7 @@ const MemoryObject* MemoryManager::getMemoryObject(const MemoryBlock* memBlock,
  */
 const MemoryBlock* MemoryManager::allocateMemoryBlock(AllocSite allocSite, const TypeLayout* type)
 {
+	std::lock_guard<std::mutex> lock(mutex);
 	auto itr = allocMap.find(allocSite);
 	if (itr == allocMap.end())
 		itr = allocMap.insert(itr, std::make_pair(allocSite, MemoryBlock(allocSite, type)));
@@ -278,6 +280,7 @@ std::vector<const MemoryObject*> MemoryManager::getReachableMemoryObjects(const
 	}
 	else
 	{
+		std::lock_guard<std::mutex> lock(mutex);
 		auto itr = objSet.find(*obj);
 		assert(itr != objSet.end());
 
@@ -99,6 +99,7 @@ const Pointer* PointerManager::setUniversalPointer(const llvm::UndefValue* v)
 {
 	assert(uPtr == nullptr);
 	assert(v->getType() == llvm::Type::getInt8PtrTy(v->getContext()));
+	std::lock_guard<std::mutex> lock(mutex);
 	uPtr = buildPointer(Context::getGlobalContext(), v);
 	return uPtr;
 }
@@ -130,6 +131,7 @@ const Pointer* PointerManager::setNullPointer(const llvm::ConstantPointerNull* v
 {
 	assert(nPtr == nullptr);
 	assert(v->getType() == llvm::Type::getInt8PtrTy(v->getContext()));
+	std::lock_guard<std::mutex> lock(mutex);
 	nPtr = buildPointer(Context::getGlobalContext(), v);
 	return nPtr;
 }
@@ -164,6 +166,7 @@ const Pointer* PointerManager::getPointer(const Context* ctx, const llvm::Value*
 {
 	assert(ctx != nullptr && val != nullptr);
 
+	std::lock_guard<std::mutex> lock(mutex);
 	val = canonicalizeValue(val);
 	
 	if (llvm::isa<llvm::ConstantPointerNull>(val))
@@ -200,6 +203,7 @@ const Pointer* PointerManager::getOrCreatePointer(const Context* ctx, const llvm
 {
 	assert(ctx != nullptr && val != nullptr);
 
+	std::lock_guard<std::mutex> lock(mutex);
 	val = canonicalizeValue(val);
 
 	if (llvm::isa<llvm::ConstantPointerNull>(val))
@@ -230,6 +234,7 @@ PointerManager::PointerVector PointerManager::getPointersWithValue(const llvm::V
 {
 	PointerVector vec;
 
+	std::lock_guard<std::mutex> lock(mutex);
 	val = canonicalizeValue(val);
 
 	if (llvm::isa<llvm::ConstantPointerNull>(val))
@@ -257,6 +262,7 @@ PointerManager::PointerVector PointerManager::getPointersWithValue(const llvm::V
 std::vector<const Pointer*> PointerManager::getAllPointers() const
 {
     std::vector<const Pointer*> result;
+    std::lock_guard<std::mutex> lock(mutex);
     result.reserve(ptrSet.size());
     
     for (const auto& ptr : ptrSet) {
@@ -7,6 +7,7 @@
 #include "Alias/FSCS/Precision/TrackerGlobalState.h"
 #include "Alias/FSCS/Precision/ValueDependenceTracker.h"
 #include "Alias/FSCS/Program/SemiSparseProgram.h"
+#include "Alias/FSCS/Support/Instrumentation.h"
 
 #include <llvm/IR/Argument.h>
 #include <llvm/IR/BasicBlock.h>
@@ -276,6 +277,7 @@ ProgramPointSet PrecisionLossTracker::trackImprecision(const PointerList& ptrs)
 	TrackerGlobalState trackerState(globalState.getPointerManager(), globalState.getMemoryManager(), globalState.getSemiSparseProgram(), globalState.getEnv(), globalState.getCallGraph() ,globalState.getExternalPointerTable(), ppSet);
 	ImprecisionTracker(trackerState).runOnWorkList(workList);
 
+	TPA_RECORD_EVENT(PrecisionLoss, ppSet.size());
 	return ppSet;
 }
 
@@ -14,9 +14,10 @@
 namespace context
 {
 
-std::unordered_set<Context> Context::ctxSet;
+util::ConcurrentInternTable<Context> Context::ctxSet;
 // KLimitContext::defaultLimit is now initialized in KLimitContext.cpp
 std::unordered_set<ProgramPoint> AdaptiveContext::trackedCallsites;
+std::shared_timed_mutex AdaptiveContext::trackedMutex;
 unsigned SelectiveKCFA::defaultLimit = 0u;
 std::unordered_map<const llvm::Instruction*, unsigned> SelectiveKCFA::callSiteKLimits;
 std::unordered_map<const llvm::Instruction*, unsigned> SelectiveKCFA::allocSiteKLimits;
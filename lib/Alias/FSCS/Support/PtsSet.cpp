@@ -5,21 +5,14 @@ namespace tpa
 {
 
 PtsSet::PtsSetSet PtsSet::existingSet;
-const PtsSet::SetType* PtsSet::emptySet = &*(existingSet.insert(PtsSet::SetType()).first);
+const PtsSet::SetType* PtsSet::emptySet = existingSet.intern(PtsSet::SetType());
 
 const PtsSet::SetType* PtsSet::uniquifySet(SetType&& set)
 {
 	if (set.count(MemoryManager::getUniversalObject()))
 		set = { MemoryManager::getUniversalObject() };
 
-	auto itr = existingSet.find(set);
-	if (itr == existingSet.end())
-	{
-		set.shrink_to_fit();
-		itr = existingSet.insert(itr, std::move(set));
-	}
-
-	return &*itr;
+	return existingSet.intern(std::move(set), [](SetType& newSet) { newSet.shrink_to_fit(); });
 }
 
 PtsSet PtsSet::insert(const MemoryObject* obj)
@@ -79,4 +72,10 @@ PtsSet PtsSet::mergeAll(const std::vector<PtsSet>& sets)
 	return uniquifySet(SetType(std::move(flatSet)));
 }
 
+void PtsSet::releaseAll()
+{
+	existingSet.clear();
+	emptySet = existingSet.intern(SetType());
+}
+
 }
\ No newline at end of file
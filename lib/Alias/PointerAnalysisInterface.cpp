@@ -13,6 +13,30 @@ static cl::opt<std::string> DefaultAnalysisType(
     "default-ptr-analysis", cl::desc("Default pointer analysis to use"),
     cl::value_desc("analysis type"), cl::init("andersen"));
 
+//===----------------------------------------------------------------------===//
+// Default Batched Queries
+//===----------------------------------------------------------------------===//
+
+std::vector<AliasResult>
+PointerAnalysisResult::aliasMatrix(ArrayRef<const Value *> Values) {
+  size_t N = Values.size();
+  std::vector<AliasResult> Result(N * N, AliasResult::MayAlias);
+  for (size_t I = 0; I < N; ++I)
+    for (size_t J = 0; J < N; ++J)
+      Result[I * N + J] = alias(Values[I], Values[J]);
+  return Result;
+}
+
+std::vector<AliasResult>
+PointerAnalysisResult::aliasesOf(const Value *V,
+                                 ArrayRef<const Value *> Candidates) {
+  std::vector<AliasResult> Result;
+  Result.reserve(Candidates.size());
+  for (const Value *Candidate : Candidates)
+    Result.push_back(alias(V, Candidate));
+  return Result;
+}
+
 //===----------------------------------------------------------------------===//
 // Andersen Pointer Analysis Implementation
 //===----------------------------------------------------------------------===//
@@ -31,6 +55,15 @@ public:
     return Result->alias(LocA, LocB);
   }
 
+  std::vector<AliasResult> aliasMatrix(ArrayRef<const Value *> Values) {
+    return Result->aliasMatrix(Values);
+  }
+
+  std::vector<AliasResult> aliasesOf(const Value *V,
+                                     ArrayRef<const Value *> Candidates) {
+    return Result->aliasesOf(V, Candidates);
+  }
+
   bool pointsToConstantMemory(const MemoryLocation &Loc, bool OrLocal) {
     return Result->pointsToConstantMemory(Loc, OrLocal);
   }
@@ -59,6 +92,17 @@ AliasResult AndersenPointerAnalysisResult::alias(const MemoryLocation &LocA,
   return Impl->alias(LocA, LocB);
 }
 
+std::vector<AliasResult>
+AndersenPointerAnalysisResult::aliasMatrix(ArrayRef<const Value *> Values) {
+  return Impl->aliasMatrix(Values);
+}
+
+std::vector<AliasResult>
+AndersenPointerAnalysisResult::aliasesOf(const Value *V,
+                                         ArrayRef<const Value *> Candidates) {
+  return Impl->aliasesOf(V, Candidates);
+}
+
 std::vector<const Value*> AndersenPointerAnalysisResult::getPointsToSet(
     const Value *Ptr) {
   return Impl->getPointsToSet(Ptr);
@@ -7,10 +7,15 @@
 
 using namespace seadsa;
 
-static llvm::cl::opt<bool> NoAllocSiteOpt(
+namespace seadsa {
+bool NoAllocSiteOpt;
+}
+
+static llvm::cl::opt<bool, true> XNoAllocSiteOpt(
     "sea-dsa-no-single-as-opt",
     llvm::cl::desc("Disable node splitting optimization in cloner"),
-    llvm::cl::init(false), llvm::cl::Hidden);
+    llvm::cl::location(seadsa::NoAllocSiteOpt), llvm::cl::init(false),
+    llvm::cl::Hidden);
 
 /// Return true if the instruction allocates memory on the stack
 static bool isStackAllocation(const llvm::Value *v) {
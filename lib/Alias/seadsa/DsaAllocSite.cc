@@ -8,10 +8,15 @@
 
 #include <algorithm>
 
-static llvm::cl::opt<std::string> TrackAllocSite(
+namespace seadsa {
+std::string TrackAllocSite;
+}
+
+static llvm::cl::opt<std::string, true> XTrackAllocSite(
     "sea-dsa-track-alloc-site",
     llvm::cl::desc("DSA: Track allocation site <function_name,value_name>"),
-    llvm::cl::init(""), llvm::cl::Hidden);
+    llvm::cl::location(seadsa::TrackAllocSite), llvm::cl::init(""),
+    llvm::cl::Hidden);
 
 namespace seadsa {
 
@@ -1,5 +1,6 @@
 #include <llvm/ADT/SCCIterator.h>
 #include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/SmallPtrSet.h>
 #include <llvm/Analysis/CallGraph.h>
 #include <llvm/Analysis/TargetLibraryInfo.h>
 #include <llvm/IR/DataLayout.h>
@@ -20,9 +21,17 @@
 #include "Alias/seadsa/DsaLibFuncInfo.hh"
 #include "Alias/seadsa/Graph.hh"
 #include "Alias/seadsa/Local.hh"
+#include "Alias/seadsa/SummaryCache.hh"
 #include "Alias/seadsa/config.h"
 #include "Alias/seadsa/support/Debug.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <thread>
+
 using namespace llvm;
 
 namespace seadsa {
@@ -35,6 +44,12 @@ static llvm::cl::opt<bool, true> XNoBUFlowSensitiveOpt(
     llvm::cl::location(seadsa::NoBUFlowSensitiveOpt), llvm::cl::init(false),
     llvm::cl::Hidden);
 
+static llvm::cl::opt<unsigned> BUThreads(
+    "sea-dsa-bu-threads",
+    llvm::cl::desc("Number of threads resolving the calls of independent "
+                   "SCCs in bottom up (default 1)"),
+    llvm::cl::init(1), llvm::cl::Hidden);
+
 namespace seadsa {
 
 static const Value *findUniqueReturnValue(const Function &F) {
@@ -132,83 +147,273 @@ void BottomUpAnalysis::cloneAndResolveArguments(
   callerG.compress();
 }
 
-bool BottomUpAnalysis::runOnModule(Module &M, GraphMap &graphs) {
+BottomUpAnalysis::GraphRef BottomUpAnalysis::getSCCGraph(const SCC &scc,
+                                                         GraphMap &graphs) {
+  GraphRef fGraph = nullptr;
+  for (CallGraphNode *cgn : scc) {
+    Function *fn = cgn->getFunction();
+    if (!fn) continue;
+    if (fn->isDeclaration() && !m_dsaLibFuncInfo.hasSpecFunc(*fn)) continue;
+
+    if (!fGraph) {
+      assert(graphs.find(fn) != graphs.end());
+      fGraph = graphs[fn];
+      assert(fGraph);
+    }
+    graphs[fn] = fGraph;
+  }
+  return fGraph;
+}
 
-  LOG("dsa-bu", errs() << "Started bottom-up analysis ... \n");
+void BottomUpAnalysis::runLocalOnSCC(const SCC &scc, Graph &fGraph,
+                                     LocalAnalysis &la) {
+  for (CallGraphNode *cgn : scc) {
+    Function *fn = cgn->getFunction();
+    if (!fn) continue;
+    if (fn->isDeclaration() && !m_dsaLibFuncInfo.hasSpecFunc(*fn)) continue;
 
-  LocalAnalysis la(m_dl, m_tliWrapper, m_allocInfo);
+    if (m_dsaLibFuncInfo.hasSpecFunc(*fn)) {
+      Function &spec_fn = *m_dsaLibFuncInfo.getSpecFunc(*fn);
+      la.runOnFunction(spec_fn, fGraph);
 
-  for (auto it = scc_begin(&m_cg); !it.isAtEnd(); ++it) {
-    auto &scc = *it;
-
-    // -- compute a local graph shared between all functions in the scc
-    GraphRef fGraph = nullptr;
-    for (CallGraphNode *cgn : scc) {
-      Function *fn = cgn->getFunction();
-      if (!fn) continue;
-      if (fn->isDeclaration() && !m_dsaLibFuncInfo.hasSpecFunc(*fn)) continue;
-
-      if (!fGraph) {
-        assert(graphs.find(fn) != graphs.end());
-        fGraph = graphs[fn];
-        assert(fGraph);
-      }
-      if (m_dsaLibFuncInfo.hasSpecFunc(*fn)) {
-        Function &spec_fn = *m_dsaLibFuncInfo.getSpecFunc(*fn);
-        la.runOnFunction(spec_fn, *fGraph);
+    } else {
+      la.runOnFunction(*fn, fGraph);
+    }
+  }
+}
 
-      } else {
-        la.runOnFunction(*fn, *fGraph);
+// The graph of an scc is computed from its functions and the graphs of
+// its callees, so its key hashes the functions and the keys of the
+// callees. The graphs of spec functions come from another module and
+// are not cached.
+//
+// A callee called through a cast is not an edge of the call graph, so
+// its scc may come after the caller's. Its graph is then still empty
+// when it is cloned, and it adds nothing to the key of the caller.
+SummaryCache::Key BottomUpAnalysis::getSummaryKey(const SCC &scc,
+                                                  SummaryCache &cache,
+                                                  SummaryKeys &keys) {
+  SmallPtrSet<const Function *, 8> inSCC;
+  bool hasSpec = false;
+  for (CallGraphNode *cgn : scc) {
+    Function *fn = cgn->getFunction();
+    if (!fn) continue;
+    hasSpec |= m_dsaLibFuncInfo.hasSpecFunc(*fn);
+    inSCC.insert(fn);
+  }
+
+  // -- the callee keys are sorted, so the calls are visited in any
+  // -- order, once per callee
+  auto computeKey = [&]() -> SummaryCache::Key {
+    if (hasSpec) return {};
+    std::vector<const Function *> fns;
+    std::vector<SummaryCache::Key> calleeKeys;
+    SmallPtrSet<const Function *, 16> seen(inSCC.begin(), inSCC.end());
+    for (CallGraphNode *cgn : call_graph_utils::SortedCGNs(scc)) {
+      fns.push_back(cgn->getFunction());
+      for (auto &callRecord : *cgn) {
+        const Function *callee =
+            DsaCallSite(*cast<CallBase>(*callRecord.first)).getCallee();
+        if (!callee || !seen.insert(callee).second) continue;
+        bool calleeHasSpec = m_dsaLibFuncInfo.hasSpecFunc(*callee);
+        const Function &target =
+            calleeHasSpec ? *m_dsaLibFuncInfo.getSpecFunc(*callee) : *callee;
+        if (target.isDeclaration() || target.empty()) continue;
+        if (calleeHasSpec) return {};
+
+        auto it = keys.find(callee);
+        if (it == keys.end()) continue;
+        if (it->second.empty()) return {};
+        calleeKeys.push_back(it->second);
       }
+    }
+    std::sort(calleeKeys.begin(), calleeKeys.end());
+    calleeKeys.erase(std::unique(calleeKeys.begin(), calleeKeys.end()),
+                     calleeKeys.end());
+    return cache.getBottomUpKey(fns, calleeKeys,
+                                m_flowSensitiveOpt && !NoBUFlowSensitiveOpt);
+  };
+
+  // -- an empty key is recorded too, so that the callers of the scc
+  // -- tell it from an scc not visited yet
+  SummaryCache::Key key = computeKey();
+  for (const Function *fn : inSCC)
+    keys[fn] = key;
+  return key;
+}
 
-      graphs[fn] = fGraph;
+void BottomUpAnalysis::resolveCallsOnSCC(const SCC &scc, Graph *fGraph,
+                                         GraphMap &graphs) {
+  std::vector<CallGraphNode *> cgns = call_graph_utils::SortedCGNs(scc);
+  for (CallGraphNode *cgn : cgns) {
+    Function *fn = cgn->getFunction();
+    if (!fn) continue;
+
+    // -- resolve all function calls in the SCC
+    auto callRecords = call_graph_utils::SortedCallSites(cgn, m_dsaLibFuncInfo);
+    for (auto *callRecord : callRecords) {
+      DsaCallSite dsaCS(*dyn_cast<llvm::CallBase>(callRecord));
+      const Function *callee = dsaCS.getCallee();
+      if (!callee) continue;
+      if (callee->isDeclaration() && !m_dsaLibFuncInfo.hasSpecFunc(*callee))
+        continue;
+
+      assert(graphs.count(dsaCS.getCaller()) > 0);
+      assert(graphs.count(dsaCS.getCallee()) > 0);
+
+      Graph &callerG = *(graphs.find(dsaCS.getCaller())->second);
+      Graph &calleeG = *(graphs.find(dsaCS.getCallee())->second);
+
+      static std::atomic<int> cnt(0);
+      int id = ++cnt;
+      LOG("dsa-bu", llvm::errs() << "BU #" << id << ": "
+                                 << dsaCS.getCaller()->getName() << " <- "
+                                 << dsaCS.getCallee()->getName() << "\n");
+      LOG("dsa-bu", llvm::errs()
+                        << "\tCallee size: " << calleeG.numNodes()
+                        << ", caller size:\t" << callerG.numNodes() << "\n");
+      LOG("dsa-bu", llvm::errs()
+                        << "\tCallee collapsed: " << calleeG.numCollapsed()
+                        << ", caller collapsed:\t" << callerG.numCollapsed()
+                        << "\n");
+
+      cloneAndResolveArguments(dsaCS, calleeG, callerG, m_dsaLibFuncInfo,
+                               m_flowSensitiveOpt && !NoBUFlowSensitiveOpt);
+
+      LOG("dsa-bu", llvm::errs()
+                        << "\tCaller size after clone: " << callerG.numNodes()
+                        << ", collapsed: " << callerG.numCollapsed() << "\n");
     }
+  }
 
-    std::vector<CallGraphNode *> cgns = call_graph_utils::SortedCGNs(scc);
-    for (CallGraphNode *cgn : cgns) {
-      Function *fn = cgn->getFunction();
-      if (!fn) continue;
+  if (fGraph) fGraph->compress();
+}
 
-      // -- resolve all function calls in the SCC
-      auto callRecords =
-          call_graph_utils::SortedCallSites(cgn, m_dsaLibFuncInfo);
-      for (auto *callRecord : callRecords) {
+// Resolve the calls of an scc once the sccs of all its callees are
+// done. The sccs ready to be processed form the frontier of the DAG
+// of sccs; each thread takes one from it, and processing it may add
+// its callers to it.
+//
+// A graph is only written by the thread processing its scc, which
+// ends with compress(). After that it is only read, to be cloned into
+// the graphs of its callers, so the callers need no lock on it: the
+// scheduler lock orders the end of an scc before the start of its
+// callers, and reading a compressed graph does not update it (all
+// the forwarding of its cells is resolved). Apart from the graphs,
+// cloning only shares the node ids and the type sets, which are
+// thread-safe.
+//
+// The graph of an scc only depends on the final graphs of its
+// callees, so the graphs are the same as when the sccs are processed
+// one at a time, up to the ids of the nodes.
+void BottomUpAnalysis::resolveCallsInParallel(
+    const std::vector<SCC> &sccs, const std::vector<GraphRef> &sccGraphs,
+    const std::vector<SummaryCache::Key> &sccKeys, SummaryCache *cache,
+    GraphMap &graphs, unsigned numThreads) {
+  DenseMap<const Function *, unsigned> sccOf;
+  for (unsigned i = 0, e = sccs.size(); i < e; ++i)
+    for (CallGraphNode *cgn : sccs[i])
+      if (const Function *fn = cgn->getFunction()) sccOf[fn] = i;
+
+  // -- the callers of each scc, and the number of callees left
+  std::vector<std::vector<unsigned>> callers(sccs.size());
+  std::vector<unsigned> numPending(sccs.size(), 0);
+  for (unsigned i = 0, e = sccs.size(); i < e; ++i) {
+    std::set<unsigned> callees;
+    for (CallGraphNode *cgn : call_graph_utils::SortedCGNs(sccs[i])) {
+      for (auto *callRecord :
+           call_graph_utils::SortedCallSites(cgn, m_dsaLibFuncInfo)) {
         DsaCallSite dsaCS(*dyn_cast<llvm::CallBase>(callRecord));
-        const Function *callee = dsaCS.getCallee();
-        if (!callee) continue;
-        if (callee->isDeclaration() && !m_dsaLibFuncInfo.hasSpecFunc(*callee))
-          continue;
-
-        assert(graphs.count(dsaCS.getCaller()) > 0);
-        assert(graphs.count(dsaCS.getCallee()) > 0);
-
-        Graph &callerG = *(graphs.find(dsaCS.getCaller())->second);
-        Graph &calleeG = *(graphs.find(dsaCS.getCallee())->second);
-
-        static int cnt = 0;
-        ++cnt;
-        LOG("dsa-bu", llvm::errs() << "BU #" << cnt << ": "
-                                   << dsaCS.getCaller()->getName() << " <- "
-                                   << dsaCS.getCallee()->getName() << "\n");
-        LOG("dsa-bu", llvm::errs()
-                          << "\tCallee size: " << calleeG.numNodes()
-                          << ", caller size:\t" << callerG.numNodes() << "\n");
-        LOG("dsa-bu", llvm::errs()
-                          << "\tCallee collapsed: " << calleeG.numCollapsed()
-                          << ", caller collapsed:\t" << callerG.numCollapsed()
-                          << "\n");
-
-        cloneAndResolveArguments(dsaCS, calleeG, callerG, m_dsaLibFuncInfo,
-                                 m_flowSensitiveOpt && !NoBUFlowSensitiveOpt);
-
-        LOG("dsa-bu", llvm::errs()
-                          << "\tCaller size after clone: " << callerG.numNodes()
-                          << ", collapsed: " << callerG.numCollapsed() << "\n");
+        auto it = sccOf.find(dsaCS.getCallee());
+        if (it != sccOf.end() && it->second != i) callees.insert(it->second);
       }
     }
+    for (unsigned callee : callees) callers[callee].push_back(i);
+    numPending[i] = callees.size();
+  }
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<unsigned> frontier;
+  unsigned numLeft = sccs.size();
+  for (unsigned i = 0, e = sccs.size(); i < e; ++i)
+    if (numPending[i] == 0) frontier.push_back(i);
+
+  auto worker = [&]() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      cv.wait(lock, [&] { return !frontier.empty() || numLeft == 0; });
+      if (frontier.empty()) return;
+
+      unsigned i = frontier.front();
+      frontier.pop_front();
+      lock.unlock();
+      resolveCallsOnSCC(sccs[i], sccGraphs[i].get(), graphs);
+      if (cache && sccGraphs[i]) cache->store(sccKeys[i], *sccGraphs[i]);
+      lock.lock();
+
+      --numLeft;
+      for (unsigned caller : callers[i])
+        if (--numPending[caller] == 0) frontier.push_back(caller);
+      cv.notify_all();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned i = 1; i < numThreads; ++i)
+    threads.emplace_back(worker);
+  worker();
+  for (auto &t : threads)
+    t.join();
+}
+
+bool BottomUpAnalysis::runOnModule(Module &M, GraphMap &graphs) {
 
-    if (fGraph) fGraph->compress();
+  LOG("dsa-bu", errs() << "Started bottom-up analysis ... \n");
+
+  LocalAnalysis la(m_dl, m_tliWrapper, m_allocInfo);
+
+  // -- the graphs of the sccs found in the summary cache are loaded
+  // -- instead of computed
+  std::unique_ptr<SummaryCache> cache;
+  if (SummaryCache::isEnabled())
+    cache.reset(new SummaryCache(M, m_allocInfo, "bu"));
+  SummaryKeys keys;
+
+  // -- the local analysis uses caches of LLVM that are not
+  // -- thread-safe, so only resolve the calls in parallel
+  std::vector<SCC> sccs;
+  std::vector<GraphRef> sccGraphs;
+  std::vector<SummaryCache::Key> sccKeys;
+  for (auto it = scc_begin(&m_cg); !it.isAtEnd(); ++it) {
+    GraphRef fGraph = getSCCGraph(*it, graphs);
+    SummaryCache::Key key;
+    if (cache && fGraph) {
+      key = getSummaryKey(*it, *cache, keys);
+      if (!key.empty() && cache->load(key, *fGraph)) continue;
+    }
+
+    if (fGraph) runLocalOnSCC(*it, *fGraph, la);
+    if (BUThreads <= 1) {
+      resolveCallsOnSCC(*it, fGraph.get(), graphs);
+      if (cache && fGraph) cache->store(key, *fGraph);
+    } else {
+      sccs.push_back(*it);
+      sccGraphs.push_back(fGraph);
+      sccKeys.push_back(key);
+    }
   }
+  if (BUThreads > 1)
+    resolveCallsInParallel(sccs, sccGraphs, sccKeys, cache.get(), graphs,
+                           BUThreads);
+
+  if (cache && !cache->save())
+    errs() << "WARNING: cannot write the summary cache\n";
+  if (cache)
+    LOG("dsa-summary-cache",
+        errs() << "Summary cache: " << cache->numHits() << " hits, "
+               << cache->numMisses() << " misses, " << cache->numStores()
+               << " stored\n");
 
   if (m_dsaLibFuncInfo.genSpecs()) {
     for (auto &KVP : graphs) {
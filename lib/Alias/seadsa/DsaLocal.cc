@@ -44,14 +44,20 @@
 
 using namespace llvm;
 
-static llvm::cl::opt<bool> TrustArgumentTypes(
+namespace seadsa {
+bool TrustArgumentTypes;
+bool AssumeExternalFunctonsAllocators;
+} // namespace seadsa
+
+static llvm::cl::opt<bool, true> XTrustArgumentTypes(
     "sea-dsa-trust-args",
     llvm::cl::desc("Trust function argument types in SeaDsa Local analysis"),
-    llvm::cl::init(true));
-static llvm::cl::opt<bool> AssumeExternalFunctonsAllocators(
+    llvm::cl::location(seadsa::TrustArgumentTypes), llvm::cl::init(true));
+static llvm::cl::opt<bool, true> XAssumeExternalFunctonsAllocators(
     "sea-dsa-assume-external-functions-allocators",
     llvm::cl::desc(
         "Treat all external functions as potential memory allocators"),
+    llvm::cl::location(seadsa::AssumeExternalFunctonsAllocators),
     llvm::cl::init(false));
 
 /*****************************************************************************/
@@ -1922,9 +1928,13 @@ bool Local::runOnModule(Module &M) {
   m_dl = &M.getDataLayout();
   m_allocInfo = &getAnalysis<AllocWrapInfo>();
   m_allocInfo->initialize(M, this);
+  if (SummaryCache::isEnabled())
+    m_cache.reset(new SummaryCache(M, *m_allocInfo, "local"));
 
   for (Function &F : M)
     runOnFunction(F);
+  if (m_cache && !m_cache->save())
+    errs() << "WARNING: cannot write the summary cache\n";
   return false;
 }
 
@@ -1936,7 +1946,12 @@ bool Local::runOnFunction(Function &F) {
   auto &tli = getAnalysis<TargetLibraryInfoWrapperPass>();
   LocalAnalysis la(*m_dl, tli, *m_allocInfo);
   GraphRef g = std::make_shared<Graph>(*m_dl, m_setFactory);
-  la.runOnFunction(F, *g);
+  SummaryCache::Key key;
+  if (m_cache) key = m_cache->getLocalKey(F);
+  if (!m_cache || !m_cache->load(key, *g)) {
+    la.runOnFunction(F, *g);
+    if (m_cache) m_cache->store(key, *g);
+  }
   m_graphs.insert({&F, g});
   return false;
 }
@@ -0,0 +1,1170 @@
+#include "Alias/seadsa/SummaryCache.hh"
+
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/AsmParser/SlotMapping.h"
+#include "llvm/IR/Attributes.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/InlineAsm.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Metadata.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Operator.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/LEB128.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "Alias/seadsa/AllocWrapInfo.hh"
+#include "Alias/seadsa/CallSite.hh"
+#include "Alias/seadsa/Graph.hh"
+
+#include <cstring>
+#include <limits>
+
+using namespace llvm;
+
+static llvm::cl::opt<std::string> SummaryCacheDir(
+    "sea-dsa-summary-cache",
+    llvm::cl::desc("Directory where SeaDsa stores the graphs of functions to "
+                   "reuse them across runs"),
+    llvm::cl::init(""), llvm::cl::value_desc("dir"));
+
+namespace seadsa {
+extern bool EnableOmnipotentChar;
+extern bool NoAllocSiteOpt;
+extern std::string TrackAllocSite;
+extern bool TrustArgumentTypes;
+extern bool AssumeExternalFunctonsAllocators;
+} // namespace seadsa
+
+namespace {
+
+// -- bump when the graphs or their encoding change
+const char *CacheVersion = "sea-dsa-summary-cache-3";
+
+// -- unsigned integers are LEB128-encoded and strings are prefixed
+// -- with their size
+void writeInt(std::string &out, uint64_t v) {
+  if (v < 0x80) {
+    out.push_back(static_cast<char>(v));
+    return;
+  }
+  uint8_t buf[16];
+  out.append(reinterpret_cast<const char *>(buf), encodeULEB128(v, buf));
+}
+
+void writeString(std::string &out, StringRef s) {
+  writeInt(out, s.size());
+  out.append(s.begin(), s.end());
+}
+
+// -- MD5 of the parts of the IR from which a graph is computed. Local
+// -- values are numbered by position, so their names are not hashed.
+class StructuralHasher {
+public:
+  using TypeHashes = DenseMap<const Type *, std::string>;
+  using GlobalHashes = DenseMap<const GlobalValue *, std::string>;
+
+private:
+  // -- hashed at once by digest, which is cheaper than many updates.
+  // -- Integers are LEB128-encoded, which keeps the bytes few.
+  std::string m_bytes;
+  DenseMap<const Type *, unsigned> m_types;
+  DenseMap<const Constant *, unsigned> m_constants;
+  DenseMap<const Value *, unsigned> m_locals;
+  // -- hashes of struct and function types and of globals, shared with
+  // -- the hashers of the other functions of the module
+  TypeHashes *m_typeHashes;
+  GlobalHashes *m_globalHashes;
+
+  // -- add the hash of v from memo, computed by a hasher without memo,
+  // -- which ends the recursion of structs
+  template <typename Map, typename T>
+  void addMemoized(Map &memo, T *v, void (StructuralHasher::*addBody)(T *)) {
+    auto it = memo.find(v);
+    if (it == memo.end()) {
+      StructuralHasher h;
+      (h.*addBody)(v);
+      it = memo.insert({v, h.digest()}).first;
+    }
+    add(it->second);
+  }
+
+public:
+  StructuralHasher(TypeHashes *typeHashes = nullptr,
+                   GlobalHashes *globalHashes = nullptr)
+      : m_typeHashes(typeHashes), m_globalHashes(globalHashes) {}
+
+  void add(uint64_t v) { writeInt(m_bytes, v); }
+
+  void add(StringRef s) { writeString(m_bytes, s); }
+
+  void add(const AttributeList &attrs) {
+    add(attrs.getNumAttrSets());
+    for (unsigned idx : attrs.indexes()) {
+      AttributeSet set = attrs.getAttributes(idx);
+      add(set.getNumAttributes());
+      for (const Attribute &attr : set) {
+        if (attr.isStringAttribute()) {
+          add(attr.getKindAsString());
+          add(attr.getValueAsString());
+          continue;
+        }
+        add(attr.getKindAsEnum());
+        if (attr.isIntAttribute()) add(attr.getValueAsInt());
+        if (attr.isTypeAttribute()) {
+          add(attr.getValueAsType() != nullptr);
+          if (attr.getValueAsType()) addType(attr.getValueAsType());
+        }
+      }
+    }
+  }
+
+  void add(const APInt &v) {
+    add(v.getBitWidth());
+    for (unsigned i = 0, e = v.getNumWords(); i < e; ++i)
+      add(v.getRawData()[i]);
+  }
+
+  // -- types and constants are hashed once, and then by their number,
+  // -- which also ends the recursion of identified structs
+  void addType(Type *t) {
+    auto res = m_types.insert({t, m_types.size()});
+    add(res.first->second);
+    if (!res.second) return;
+    if (m_typeHashes && (t->isStructTy() || t->isFunctionTy()))
+      addMemoized(*m_typeHashes, t, &StructuralHasher::addTypeBody);
+    else
+      addTypeBody(t);
+  }
+
+  void addTypeBody(Type *t) {
+    add(t->getTypeID());
+    switch (t->getTypeID()) {
+    case Type::IntegerTyID:
+      add(cast<IntegerType>(t)->getBitWidth());
+      break;
+    case Type::PointerTyID: {
+      auto *pt = cast<PointerType>(t);
+      add(pt->getAddressSpace());
+      add(pt->isOpaque());
+      if (!pt->isOpaque()) addType(pt->getPointerElementType());
+      break;
+    }
+    case Type::StructTyID: {
+      auto *st = cast<StructType>(t);
+      add(st->hasName() ? st->getName() : "");
+      add(st->isPacked());
+      add(st->isOpaque());
+      if (st->isOpaque()) break;
+      add(st->getNumElements());
+      for (Type *elem : st->elements())
+        addType(elem);
+      break;
+    }
+    case Type::ArrayTyID:
+      add(t->getArrayNumElements());
+      addType(t->getArrayElementType());
+      break;
+    case Type::FixedVectorTyID:
+    case Type::ScalableVectorTyID:
+      add(cast<VectorType>(t)->getElementCount().getKnownMinValue());
+      addType(cast<VectorType>(t)->getElementType());
+      break;
+    case Type::FunctionTyID: {
+      auto *ft = cast<FunctionType>(t);
+      add(ft->isVarArg());
+      add(ft->getNumParams());
+      addType(ft->getReturnType());
+      for (Type *param : ft->params())
+        addType(param);
+      break;
+    }
+    default:
+      // -- the other types are identified by their id
+      break;
+    }
+  }
+
+  void addConstant(const Constant *c) {
+    auto res = m_constants.insert({c, m_constants.size()});
+    add(res.first->second);
+    if (!res.second) return;
+    add(c->getValueID());
+    if (auto *gv = dyn_cast<GlobalValue>(c)) {
+      if (m_globalHashes)
+        addMemoized(*m_globalHashes, gv, &StructuralHasher::addGlobal);
+      else
+        addGlobal(gv);
+      return;
+    }
+    addType(c->getType());
+    if (auto *ci = dyn_cast<ConstantInt>(c)) {
+      add(ci->getValue());
+      return;
+    }
+    if (auto *cf = dyn_cast<ConstantFP>(c)) {
+      add(cf->getValueAPF().bitcastToAPInt());
+      return;
+    }
+    if (auto *cds = dyn_cast<ConstantDataSequential>(c)) {
+      add(cds->getRawDataValues());
+      return;
+    }
+    if (auto *ce = dyn_cast<ConstantExpr>(c)) {
+      add(ce->getOpcode());
+      if (ce->isCompare()) add(ce->getPredicate());
+      if (ce->hasIndices())
+        for (unsigned idx : ce->getIndices())
+          add(idx);
+      if (auto *gep = dyn_cast<GEPOperator>(ce)) {
+        addType(gep->getSourceElementType());
+        add(gep->isInBounds());
+      }
+    }
+    add(c->getNumOperands());
+    for (const Value *op : c->operand_values()) {
+      if (auto *opc = dyn_cast<Constant>(op))
+        addConstant(opc);
+      else
+        add(op->getValueID());
+    }
+  }
+
+  void addGlobal(const GlobalValue *gv) {
+    add(gv->getValueID());
+    addType(gv->getType());
+    // -- the initializers of globals are hashed with main, see
+    // -- addFunction
+    add(gv->getName());
+    addType(gv->getValueType());
+    add(gv->getLinkage());
+    if (auto *var = dyn_cast<GlobalVariable>(gv)) {
+      add(var->isConstant());
+      // -- except for a function the global is initialized to: loads
+      // -- through a cast of the global create an alloc site for it in
+      // -- any function, see visitLoadInst in DsaLocal
+      const Constant *init =
+          var->hasInitializer() ? var->getInitializer() : nullptr;
+      if (init && isa<Function>(init->stripPointerCasts())) {
+        add(init->getValueID());
+        add(init->stripPointerCasts()->getName());
+      }
+    }
+    // -- a call to a declaration is an external call, whose graph
+    // -- depends on the attributes of the callee
+    if (auto *fn = dyn_cast<Function>(gv)) {
+      add(fn->isDeclaration());
+      add(fn->getAttributes());
+    }
+  }
+
+  void addOperand(const Value *v) {
+    auto local = m_locals.find(v);
+    if (local != m_locals.end()) {
+      add('L');
+      add(local->second);
+    } else if (auto *c = dyn_cast<Constant>(v)) {
+      add('C');
+      addConstant(c);
+    } else if (auto *arg = dyn_cast<Argument>(v)) {
+      add('A');
+      add(arg->getArgNo());
+    } else if (auto *ia = dyn_cast<InlineAsm>(v)) {
+      add('I');
+      add(ia->getAsmString());
+      add(ia->getConstraintString());
+      addType(ia->getFunctionType());
+    } else {
+      // -- metadata is not hashed
+      add(v->getValueID());
+    }
+  }
+
+  void addInstruction(const Instruction &I) {
+    add(I.getOpcode());
+    addType(I.getType());
+    add(I.getNumOperands());
+    for (const Value *op : I.operand_values())
+      addOperand(op);
+
+    if (auto *AI = dyn_cast<AllocaInst>(&I)) {
+      addType(AI->getAllocatedType());
+    } else if (auto *GEP = dyn_cast<GetElementPtrInst>(&I)) {
+      addType(GEP->getSourceElementType());
+      add(GEP->isInBounds());
+    } else if (auto *CI = dyn_cast<CmpInst>(&I)) {
+      add(CI->getPredicate());
+    } else if (auto *CB = dyn_cast<CallBase>(&I)) {
+      addType(CB->getFunctionType());
+      add(CB->getAttributes());
+      add(CB->getCallingConv());
+    } else if (auto *PHI = dyn_cast<PHINode>(&I)) {
+      for (const BasicBlock *bb : PHI->blocks())
+        addOperand(bb);
+    } else if (auto *EVI = dyn_cast<ExtractValueInst>(&I)) {
+      for (unsigned idx : EVI->indices())
+        add(idx);
+    } else if (auto *IVI = dyn_cast<InsertValueInst>(&I)) {
+      for (unsigned idx : IVI->indices())
+        add(idx);
+    } else if (auto *SVI = dyn_cast<ShuffleVectorInst>(&I)) {
+      for (int idx : SVI->getShuffleMask())
+        add(idx);
+    } else if (auto *RMW = dyn_cast<AtomicRMWInst>(&I)) {
+      add(RMW->getOperation());
+    }
+  }
+
+  void addFunction(const Function &F) {
+    add(F.getName());
+    addType(F.getFunctionType());
+    add(F.getAttributes());
+    add(F.getCallingConv());
+
+    m_locals.clear();
+    for (const BasicBlock &bb : F) {
+      m_locals.insert({&bb, m_locals.size()});
+      for (const Instruction &I : bb)
+        m_locals.insert({&I, m_locals.size()});
+    }
+    for (const BasicBlock &bb : F) {
+      add(bb.size());
+      for (const Instruction &I : bb)
+        addInstruction(I);
+    }
+
+    // -- the local analysis of main initializes the globals
+    if (F.getName() == "main") {
+      for (const GlobalVariable &gv : F.getParent()->globals()) {
+        addConstant(&gv);
+        add(gv.hasInitializer());
+        if (gv.hasInitializer()) addConstant(gv.getInitializer());
+      }
+    }
+  }
+
+  std::string digest() {
+    MD5 md5;
+    md5.update(m_bytes);
+    MD5::MD5Result res;
+    md5.final(res);
+    return res.digest().str().str();
+  }
+};
+
+// -- true if t refers to an identified struct without a name, which
+// -- cannot be printed and parsed back
+bool hasUnnamedStruct(Type *t, SmallPtrSetImpl<Type *> &seen) {
+  if (!seen.insert(t).second) return false;
+  if (auto *st = dyn_cast<StructType>(t))
+    if (!st->isLiteral() && !st->hasName()) return true;
+  for (Type *sub : t->subtypes())
+    if (hasUnnamedStruct(sub, seen)) return true;
+  return false;
+}
+
+bool hasUnnamedStruct(Type *t) {
+  SmallPtrSet<Type *, 8> seen;
+  return hasUnnamedStruct(t, seen);
+}
+
+bool isPrintable(const Constant *c) {
+  if (hasUnnamedStruct(c->getType())) return false;
+  if (auto *gv = dyn_cast<GlobalValue>(c)) return gv->hasName();
+  if (auto *gep = dyn_cast<GEPOperator>(c))
+    if (hasUnnamedStruct(gep->getSourceElementType())) return false;
+  for (const Value *op : c->operand_values()) {
+    auto *opc = dyn_cast<Constant>(op);
+    if (!opc || !isPrintable(opc)) return false;
+  }
+  return true;
+}
+
+// -- a graph being read, checked before the graph is built from it
+struct CellData {
+  int64_t node;
+  unsigned offset;
+};
+
+struct LinkData {
+  seadsa::Field field;
+  CellData cell;
+};
+
+struct NodeData {
+  uint32_t flags;
+  unsigned size;
+  bool onceUnique;
+  const Value *unique;
+  std::vector<std::pair<unsigned, std::vector<Type *>>> types;
+  std::vector<LinkData> links;
+  std::vector<const Value *> allocSites;
+};
+
+enum class ValueKind { Argument, Instruction, Global, Constant };
+enum class FieldKind { Unknown, Omni, Type };
+
+} // namespace
+
+namespace seadsa {
+
+/// Writes a graph after a header of tables of the globals, types and
+/// values it refers to. These are numbered when first met, so that
+/// each is decoded once however often the graph refers to it.
+class SummaryCache::Encoder {
+  SummaryCache &m_cache;
+  DenseMap<const GlobalValue *, unsigned> m_globalIds;
+  DenseMap<Type *, unsigned> m_typeIds;
+  DenseMap<const Value *, unsigned> m_valueIds;
+  std::string m_globals, m_types, m_values, m_body;
+  bool m_ok = true;
+
+  unsigned getGlobalId(const GlobalValue &gv) {
+    if (!gv.hasName()) m_ok = false;
+    auto res = m_globalIds.insert({&gv, m_globalIds.size()});
+    if (res.second) writeString(m_globals, gv.getName());
+    return res.first->second;
+  }
+
+  unsigned getValueId(const Value &v) {
+    auto res = m_valueIds.insert({&v, m_valueIds.size()});
+    if (!res.second) return res.first->second;
+
+    // -- arguments and instructions by their position in their
+    // -- function, globals by name and other constants as text
+    if (auto *arg = dyn_cast<Argument>(&v)) {
+      writeInt(m_values, unsigned(ValueKind::Argument));
+      writeInt(m_values, getGlobalId(*arg->getParent()));
+      writeInt(m_values, arg->getArgNo());
+    } else if (auto *I = dyn_cast<Instruction>(&v)) {
+      unsigned idx = 0;
+      if (!m_cache.getInstructionIndex(*I, idx)) m_ok = false;
+      writeInt(m_values, unsigned(ValueKind::Instruction));
+      writeInt(m_values, getGlobalId(*I->getFunction()));
+      writeInt(m_values, idx);
+    } else if (auto *gv = dyn_cast<GlobalValue>(&v)) {
+      writeInt(m_values, unsigned(ValueKind::Global));
+      writeInt(m_values, getGlobalId(*gv));
+    } else if (auto *c = dyn_cast<Constant>(&v)) {
+      if (!isPrintable(c)) m_ok = false;
+      std::string s;
+      raw_string_ostream os(s);
+      c->printAsOperand(os, /*PrintType=*/true);
+      writeInt(m_values, unsigned(ValueKind::Constant));
+      writeString(m_values, os.str());
+    } else {
+      m_ok = false;
+    }
+    return res.first->second;
+  }
+
+public:
+  explicit Encoder(SummaryCache &cache) : m_cache(cache) {}
+
+  bool ok() const { return m_ok; }
+  void fail() { m_ok = false; }
+
+  void addInt(uint64_t v) { writeInt(m_body, v); }
+
+  /// 0 stands for no value
+  void addValue(const Value *v) { addInt(v ? getValueId(*v) + 1 : 0); }
+
+  void addType(Type *t) {
+    auto res = m_typeIds.insert({t, m_typeIds.size()});
+    if (res.second) writeType(t);
+    addInt(res.first->second);
+  }
+
+  /// Named structs by name, the other types by their parts
+  void writeType(Type *t) {
+    writeInt(m_types, t->getTypeID());
+    switch (t->getTypeID()) {
+    case Type::IntegerTyID:
+      writeInt(m_types, cast<IntegerType>(t)->getBitWidth());
+      break;
+    case Type::PointerTyID: {
+      auto *pt = cast<PointerType>(t);
+      writeInt(m_types, pt->getAddressSpace());
+      writeInt(m_types, pt->isOpaque());
+      if (!pt->isOpaque()) writeType(pt->getPointerElementType());
+      break;
+    }
+    case Type::StructTyID: {
+      auto *st = cast<StructType>(t);
+      writeInt(m_types, !st->isLiteral());
+      if (!st->isLiteral()) {
+        if (!st->hasName()) m_ok = false;
+        writeString(m_types, st->getName());
+        break;
+      }
+      writeInt(m_types, st->isPacked());
+      writeInt(m_types, st->getNumElements());
+      for (Type *elem : st->elements())
+        writeType(elem);
+      break;
+    }
+    case Type::ArrayTyID:
+      writeInt(m_types, t->getArrayNumElements());
+      writeType(t->getArrayElementType());
+      break;
+    case Type::FixedVectorTyID:
+    case Type::ScalableVectorTyID:
+      writeInt(m_types,
+               cast<VectorType>(t)->getElementCount().getKnownMinValue());
+      writeType(cast<VectorType>(t)->getElementType());
+      break;
+    case Type::FunctionTyID: {
+      auto *ft = cast<FunctionType>(t);
+      writeInt(m_types, ft->isVarArg());
+      writeInt(m_types, ft->getNumParams());
+      writeType(ft->getReturnType());
+      for (Type *param : ft->params())
+        writeType(param);
+      break;
+    }
+    default:
+      // -- the other types are identified by their id
+      break;
+    }
+  }
+
+  /// The tables, then the graph
+  std::string finish() const {
+    std::string out;
+    writeInt(out, m_globalIds.size());
+    out += m_globals;
+    writeInt(out, m_typeIds.size());
+    out += m_types;
+    writeInt(out, m_valueIds.size());
+    out += m_values;
+    out += m_body;
+    return out;
+  }
+};
+
+/// Reads what Encoder writes, checking it on the way: any error
+/// sets a flag and makes the following reads return 0 or null
+class SummaryCache::Decoder {
+  SummaryCache &m_cache;
+  const uint8_t *m_pos;
+  const uint8_t *m_end;
+  bool m_ok = true;
+  std::vector<const GlobalValue *> m_globals;
+  std::vector<Type *> m_types;
+  std::vector<const Value *> m_values;
+
+  Type *readTypeData(unsigned depth) {
+    // -- types are nested much less deeply, unless the input is bad
+    if (depth > 64) m_ok = false;
+    LLVMContext &ctx = m_cache.m_module.getContext();
+    auto id = Type::TypeID(readInt(Type::ScalableVectorTyID));
+    if (!m_ok) return nullptr;
+    Type *t = nullptr;
+    switch (id) {
+    case Type::IntegerTyID: {
+      unsigned bits = readInt(IntegerType::MAX_INT_BITS);
+      if (bits >= IntegerType::MIN_INT_BITS) t = IntegerType::get(ctx, bits);
+      break;
+    }
+    case Type::PointerTyID: {
+      unsigned addrSpace = readInt(std::numeric_limits<unsigned>::max());
+      if (readInt(1)) {
+        t = PointerType::get(ctx, addrSpace);
+        break;
+      }
+      Type *elem = readTypeData(depth + 1);
+      if (elem && PointerType::isValidElementType(elem))
+        t = PointerType::get(elem, addrSpace);
+      break;
+    }
+    case Type::StructTyID: {
+      if (readInt(1)) {
+        t = StructType::getTypeByName(ctx, readString());
+        break;
+      }
+      bool packed = readInt(1);
+      std::vector<Type *> elems(readCount());
+      for (Type *&elem : elems)
+        if (!(elem = readTypeData(depth + 1)) ||
+            !StructType::isValidElementType(elem))
+          return fail();
+      t = StructType::get(ctx, elems, packed);
+      break;
+    }
+    case Type::ArrayTyID: {
+      uint64_t size = readInt();
+      Type *elem = readTypeData(depth + 1);
+      if (elem && ArrayType::isValidElementType(elem))
+        t = ArrayType::get(elem, size);
+      break;
+    }
+    case Type::FixedVectorTyID:
+    case Type::ScalableVectorTyID: {
+      unsigned size = readInt(std::numeric_limits<unsigned>::max());
+      Type *elem = readTypeData(depth + 1);
+      if (size && elem && VectorType::isValidElementType(elem))
+        t = VectorType::get(
+            elem, ElementCount::get(size, id == Type::ScalableVectorTyID));
+      break;
+    }
+    case Type::FunctionTyID: {
+      bool varArg = readInt(1);
+      std::vector<Type *> params(readCount());
+      Type *ret = readTypeData(depth + 1);
+      if (!ret || !FunctionType::isValidReturnType(ret)) return fail();
+      for (Type *&param : params)
+        if (!(param = readTypeData(depth + 1)) ||
+            !FunctionType::isValidArgumentType(param))
+          return fail();
+      t = FunctionType::get(ret, params, varArg);
+      break;
+    }
+    default:
+      t = Type::getPrimitiveType(ctx, id);
+      break;
+    }
+    if (!t || !m_ok) return fail();
+    return t;
+  }
+
+  Type *fail() {
+    m_ok = false;
+    return nullptr;
+  }
+
+  // -- the parser needs a null-terminated text, such as the key of a
+  // -- StringMap entry
+  Constant *parseConstant(StringRef text) {
+    auto &entry = *m_cache.m_constants.try_emplace(text, nullptr).first;
+    if (!entry.second) {
+      SMDiagnostic err;
+      entry.second = parseConstantValue(entry.getKey(), err, m_cache.m_module,
+                                        &m_cache.getSlots());
+    }
+    return entry.second;
+  }
+
+  const Value *readTableValue() {
+    auto kind = ValueKind(readInt());
+    if (kind == ValueKind::Constant) return parseConstant(readString());
+
+    uint64_t id = readInt();
+    const GlobalValue *gv = id < m_globals.size() ? m_globals[id] : nullptr;
+    if (kind == ValueKind::Global) return gv;
+    auto *fn = dyn_cast_or_null<Function>(gv);
+    uint64_t idx = readInt();
+    if (!fn) return nullptr;
+    if (kind == ValueKind::Argument)
+      return idx < fn->arg_size() ? fn->getArg(idx) : nullptr;
+    if (kind == ValueKind::Instruction)
+      return m_cache.getInstruction(*fn, idx);
+    return nullptr;
+  }
+
+public:
+  Decoder(SummaryCache &cache, StringRef in)
+      : m_cache(cache), m_pos(reinterpret_cast<const uint8_t *>(in.begin())),
+        m_end(reinterpret_cast<const uint8_t *>(in.end())) {}
+
+  bool ok() const { return m_ok; }
+  bool atEnd() const { return m_pos == m_end; }
+
+  uint64_t readInt() {
+    if (!m_ok) return 0;
+    unsigned size;
+    const char *error = nullptr;
+    uint64_t v = decodeULEB128(m_pos, &size, m_end, &error);
+    if (error) {
+      m_ok = false;
+      return 0;
+    }
+    m_pos += size;
+    return v;
+  }
+
+  /// An integer no greater than max
+  uint64_t readInt(uint64_t max) {
+    uint64_t v = readInt();
+    if (v > max) m_ok = false;
+    return m_ok ? v : 0;
+  }
+
+  /// The number of the items that follow, each at least a byte long
+  uint64_t readCount() { return readInt(m_end - m_pos); }
+
+  StringRef readString() {
+    uint64_t size = readCount();
+    if (!m_ok) return "";
+    StringRef s(reinterpret_cast<const char *>(m_pos), size);
+    m_pos += size;
+    return s;
+  }
+
+  bool readTables() {
+    m_globals.resize(readCount());
+    for (auto &gv : m_globals)
+      if (!(gv = m_cache.m_module.getNamedValue(readString()))) return false;
+    m_types.resize(readCount());
+    for (auto &t : m_types)
+      if (!(t = readTypeData(0))) return false;
+    m_values.resize(readCount());
+    for (auto &v : m_values)
+      if (!(v = readTableValue())) return false;
+    return m_ok;
+  }
+
+  Type *readType() {
+    uint64_t id = readInt();
+    if (id < m_types.size()) return m_types[id];
+    m_ok = false;
+    return nullptr;
+  }
+
+  /// Return null for no value
+  const Value *readValue() {
+    uint64_t id = readInt(m_values.size());
+    return id ? m_values[id - 1] : nullptr;
+  }
+
+  /// A cell is a node number plus one, 0 for no node, and a raw offset
+  CellData readCell(size_t numNodes) {
+    CellData c;
+    c.node = int64_t(readInt(numNodes)) - 1;
+    c.offset = readInt(std::numeric_limits<unsigned>::max());
+    return c;
+  }
+};
+
+bool SummaryCache::isEnabled() { return !SummaryCacheDir.empty(); }
+
+SummaryCache::SummaryCache(Module &M, const AllocWrapInfo &allocInfo,
+                           StringRef client)
+    : m_module(M) {
+  StructuralHasher h;
+  h.add(CacheVersion);
+  h.add(M.getTargetTriple());
+  h.add(M.getDataLayoutStr());
+  h.add(g_IsTypeAware);
+  h.add(EnableOmnipotentChar);
+  h.add(NoAllocSiteOpt);
+  h.add(TrackAllocSite);
+  h.add(TrustArgumentTypes);
+  h.add(AssumeExternalFunctonsAllocators);
+  const auto &wrappers = allocInfo.getAllocWrapperNames(M);
+  h.add(wrappers.size());
+  for (StringRef name : wrappers)
+    h.add(name);
+  m_config = h.digest();
+
+  StructuralHasher fileHash;
+  fileHash.add(m_config);
+  fileHash.add(client);
+  fileHash.add(M.getModuleIdentifier());
+  SmallString<128> path(SummaryCacheDir);
+  sys::path::append(path, client + "-" + fileHash.digest() + ".dsa");
+  m_file = std::string(path.str());
+
+  // -- the file is a version followed by pairs of a key and a graph
+  auto buf = MemoryBuffer::getFile(m_file);
+  if (!buf) return;
+  m_buffer = std::move(*buf);
+  Decoder dec(*this, m_buffer->getBuffer());
+  if (dec.readString() != CacheVersion) return;
+  for (uint64_t i = 0, e = dec.readCount(); i < e; ++i) {
+    StringRef key = dec.readString();
+    StringRef graph = dec.readString();
+    if (!dec.ok()) break;
+    m_found[key] = graph;
+  }
+}
+
+SummaryCache::~SummaryCache() = default;
+
+const std::string &SummaryCache::getFunctionHash(const Function &F) {
+  auto it = m_fnHashes.find(&F);
+  if (it != m_fnHashes.end()) return it->second;
+
+  StructuralHasher h(&m_typeHashes, &m_globalHashes);
+  h.addFunction(F);
+  return m_fnHashes[&F] = h.digest();
+}
+
+SummaryCache::Key SummaryCache::getLocalKey(const Function &F) {
+  StructuralHasher h;
+  h.add(m_config);
+  h.add("local");
+  h.add(getFunctionHash(F));
+  return h.digest();
+}
+
+SummaryCache::Key
+SummaryCache::getBottomUpKey(ArrayRef<const Function *> fns,
+                             ArrayRef<Key> calleeKeys, bool flowSensitiveOpt) {
+  StructuralHasher h;
+  h.add(m_config);
+  h.add("bu");
+  h.add(flowSensitiveOpt);
+  h.add(fns.size());
+  for (const Function *fn : fns)
+    h.add(getFunctionHash(*fn));
+  h.add(calleeKeys.size());
+  for (const Key &key : calleeKeys)
+    h.add(key);
+  return h.digest();
+}
+
+// -- without the named types of the module, the parser would create
+// -- new ones for the types and the constants of a graph. Collecting
+// -- them walks the module, so it is done on the first parse.
+SlotMapping &SummaryCache::getSlots() {
+  if (!m_slots) {
+    m_slots.reset(new SlotMapping());
+    for (StructType *st : m_module.getIdentifiedStructTypes())
+      if (st->hasName()) m_slots->NamedTypes[st->getName()] = st;
+  }
+  return *m_slots;
+}
+
+const Instruction *SummaryCache::getInstruction(const Function &F,
+                                                size_t idx) {
+  std::lock_guard<std::mutex> lock(m_instsMutex);
+  auto res = m_insts.insert({&F, {}});
+  auto &insts = res.first->second;
+  if (res.second)
+    for (const Instruction &I : instructions(F))
+      insts.push_back(&I);
+  return idx < insts.size() ? insts[idx] : nullptr;
+}
+
+bool SummaryCache::getInstructionIndex(const Instruction &I, unsigned &out) {
+  std::lock_guard<std::mutex> lock(m_instsMutex);
+  auto it = m_instIndex.find(&I);
+  if (it == m_instIndex.end()) {
+    unsigned idx = 0;
+    for (const Instruction &J : instructions(*I.getFunction()))
+      m_instIndex[&J] = idx++;
+    it = m_instIndex.find(&I);
+  }
+  if (it == m_instIndex.end()) return false;
+  out = it->second;
+  return true;
+}
+
+bool SummaryCache::write(const Graph &g, std::string &out) {
+  static_assert(sizeof(Node::NodeType) == sizeof(uint32_t),
+                "node flags are stored as an integer");
+
+  if (g.isFlat()) return false;
+
+  DenseMap<const Node *, unsigned> nodeIds;
+  for (const Node &n : g) {
+    if (n.isForwarding()) return false;
+    nodeIds.insert({&n, nodeIds.size()});
+  }
+
+  Encoder enc(*this);
+  auto cell = [&](const Cell &c) {
+    auto it = c.isNull() ? nodeIds.end() : nodeIds.find(c.getNode());
+    if (!c.isNull() && it == nodeIds.end()) enc.fail();
+    enc.addInt(it == nodeIds.end() ? 0 : it->second + 1);
+    enc.addInt(c.isNull() ? 0 : c.getRawOffset());
+  };
+
+  enc.addInt(nodeIds.size());
+  for (const Node &n : g) {
+    Node::NodeType nodeType = n.getNodeType();
+    uint32_t flags;
+    std::memcpy(&flags, &nodeType, sizeof(flags));
+    enc.addInt(flags);
+    enc.addInt(n.size());
+    enc.addInt(n.hasOnceUniqueScalar());
+    enc.addValue(n.getUniqueScalar());
+
+    std::vector<unsigned> offsets;
+    for (auto &kv : n.types())
+      offsets.push_back(kv.first);
+    std::sort(offsets.begin(), offsets.end());
+    enc.addInt(offsets.size());
+    for (unsigned off : offsets) {
+      std::vector<Type *> set;
+      for (Type *t : n.types().find(off)->second)
+        set.push_back(t);
+      enc.addInt(off);
+      enc.addInt(set.size());
+      for (Type *t : set)
+        enc.addType(t);
+    }
+
+    enc.addInt(n.links().size());
+    for (auto &kv : n.links()) {
+      const FieldType &ft = kv.first.getType();
+      if (ft.isNotImplemented()) return false;
+      enc.addInt(kv.first.getOffset());
+      if (ft.getLLVMType()) {
+        enc.addInt(unsigned(FieldKind::Type));
+        enc.addType(ft.getLLVMType());
+      } else {
+        enc.addInt(
+            unsigned(ft.isOmniType() ? FieldKind::Omni : FieldKind::Unknown));
+      }
+      cell(*kv.second);
+    }
+
+    enc.addInt(n.getAllocSites().size());
+    for (const Value *v : n.getAllocSites())
+      enc.addValue(v);
+  }
+
+  enc.addInt(g.m_values.size());
+  for (auto &kv : g.m_values) {
+    enc.addValue(kv.first);
+    cell(*kv.second);
+  }
+  enc.addInt(g.m_formals.size());
+  for (auto &kv : g.m_formals) {
+    enc.addValue(kv.first);
+    cell(*kv.second);
+  }
+  enc.addInt(g.m_returns.size());
+  for (auto &kv : g.m_returns) {
+    enc.addValue(kv.first);
+    cell(*kv.second);
+  }
+
+  enc.addInt(std::distance(g.alloc_sites().begin(), g.alloc_sites().end()));
+  for (const DsaAllocSite &as : g.alloc_sites()) {
+    enc.addValue(&as.getValue());
+    enc.addInt(as.getCallPaths().size());
+    for (auto &path : as.getCallPaths()) {
+      enc.addInt(path.size());
+      for (auto &step : path) {
+        enc.addInt(step.first);
+        enc.addValue(step.second);
+      }
+    }
+  }
+
+  enc.addInt(std::distance(g.callsites().begin(), g.callsites().end()));
+  for (const DsaCallSite &cs : g.callsites()) {
+    if (!cs.hasCell()) return false;
+    enc.addValue(cs.getInstruction());
+    cell(cs.getCell());
+    enc.addInt(cs.isCloned());
+  }
+  if (!enc.ok()) return false;
+
+  out = enc.finish();
+  return true;
+}
+
+bool SummaryCache::read(StringRef in, Graph &g) {
+  Decoder dec(*this, in);
+  if (g.isFlat() || !dec.readTables()) return false;
+  size_t numNodes = dec.readCount();
+
+  // -- read everything first, so that g is left empty on errors
+  std::vector<NodeData> nodes(numNodes);
+  for (NodeData &n : nodes) {
+    n.flags = dec.readInt(std::numeric_limits<uint32_t>::max());
+    n.size = dec.readInt(std::numeric_limits<unsigned>::max());
+    n.onceUnique = dec.readInt(1);
+    n.unique = dec.readValue();
+
+    n.types.resize(dec.readCount());
+    for (auto &entry : n.types) {
+      entry.first = dec.readInt(std::numeric_limits<unsigned>::max());
+      entry.second.resize(dec.readCount());
+      for (Type *&t : entry.second)
+        t = dec.readType();
+    }
+
+    n.links.resize(dec.readCount(), {Field(0, FieldType::mkUnknown()), {}});
+    for (LinkData &link : n.links) {
+      unsigned off = dec.readInt(std::numeric_limits<unsigned>::max());
+      FieldType ft = FieldType::mkUnknown();
+      switch (FieldKind(dec.readInt(unsigned(FieldKind::Type)))) {
+      case FieldKind::Unknown:
+        break;
+      case FieldKind::Omni:
+        ft = FieldType::mkOmniType();
+        break;
+      case FieldKind::Type: {
+        Type *ty = dec.readType();
+        if (!ty) return false;
+        ft = FieldType(ty);
+        // -- FieldType keeps the first primitive type of ty, which is
+        // -- ty itself if it was stored from a FieldType
+        if (ft.getLLVMType() != ty) return false;
+        break;
+      }
+      }
+      link.field = Field(off, ft);
+      link.cell = dec.readCell(numNodes);
+    }
+
+    n.allocSites.resize(dec.readCount());
+    for (const Value *&site : n.allocSites)
+      if (!(site = dec.readValue())) return false;
+    if (!dec.ok()) return false;
+  }
+
+  std::vector<std::pair<const Value *, CellData>> scalars(dec.readCount());
+  for (auto &kv : scalars) {
+    if (!(kv.first = dec.readValue())) return false;
+    kv.second = dec.readCell(numNodes);
+  }
+
+  std::vector<std::pair<const Argument *, CellData>> formals(dec.readCount());
+  for (auto &kv : formals) {
+    if (!(kv.first = dyn_cast_or_null<Argument>(dec.readValue())))
+      return false;
+    kv.second = dec.readCell(numNodes);
+  }
+
+  std::vector<std::pair<const Function *, CellData>> returns(dec.readCount());
+  for (auto &kv : returns) {
+    if (!(kv.first = dyn_cast_or_null<Function>(dec.readValue())))
+      return false;
+    kv.second = dec.readCell(numNodes);
+  }
+
+  std::vector<std::pair<const Value *, DsaAllocSite::CallPaths>> allocSites(
+      dec.readCount());
+  for (auto &kv : allocSites) {
+    if (!(kv.first = dec.readValue())) return false;
+    kv.second.resize(dec.readCount());
+    for (auto &path : kv.second) {
+      path.resize(dec.readCount());
+      for (auto &step : path) {
+        step.first =
+            DsaAllocSite::StepKind(dec.readInt(DsaAllocSite::TopDown));
+        const Value *fn = dec.readValue();
+        if (fn && !isa<Function>(fn)) return false;
+        step.second = cast_or_null<Function>(fn);
+      }
+    }
+  }
+
+  std::vector<std::tuple<const Instruction *, CellData, bool>> callSites(
+      dec.readCount());
+  for (auto &cs : callSites) {
+    if (!(std::get<0>(cs) = dyn_cast_or_null<Instruction>(dec.readValue())))
+      return false;
+    std::get<1>(cs) = dec.readCell(numNodes);
+    std::get<2>(cs) = dec.readInt(1);
+  }
+  if (!dec.ok() || !dec.atEnd()) return false;
+
+  // -- build the graph
+  std::vector<Node *> ns;
+  ns.reserve(numNodes);
+  for (size_t i = 0; i < numNodes; ++i)
+    ns.push_back(&g.mkNode());
+  auto cell = [&](const CellData &c) {
+    return c.node < 0 ? Cell() : Cell(ns[c.node], c.offset);
+  };
+
+  for (size_t i = 0; i < numNodes; ++i) {
+    NodeData &data = nodes[i];
+    Node &n = *ns[i];
+    std::memcpy(&n.m_nodeType, &data.flags, sizeof(data.flags));
+    n.m_size = data.size;
+    n.m_unique_scalar = data.unique;
+    n.m_has_once_unique_scalar = data.onceUnique;
+    n.types().reserve(data.types.size());
+    for (auto &kv : data.types) {
+      Graph::Set set = g.emptySet();
+      for (Type *t : kv.second)
+        set = g.mkSet(set, t);
+      n.types()[kv.first] = set;
+    }
+    n.links().reserve(data.links.size());
+    for (auto &link : data.links)
+      n.links()[link.field].reset(new Cell(cell(link.cell)));
+    n.insertAllocSites(data.allocSites.begin(), data.allocSites.end());
+  }
+
+  g.m_values.reserve(scalars.size());
+  for (auto &kv : scalars)
+    g.m_values[kv.first].reset(new Cell(cell(kv.second)));
+  for (auto &kv : formals)
+    g.m_formals[kv.first].reset(new Cell(cell(kv.second)));
+  for (auto &kv : returns)
+    g.m_returns[kv.first].reset(new Cell(cell(kv.second)));
+  for (auto &kv : allocSites)
+    g.mkAllocSite(*kv.first)->m_callPaths = std::move(kv.second);
+  for (auto &cs : callSites)
+    g.mkCallSite(*std::get<0>(cs), cell(std::get<1>(cs)))
+        ->markCloned(std::get<2>(cs));
+  return true;
+}
+
+bool SummaryCache::load(const Key &key, Graph &g) {
+  assert(g.numNodes() == 0);
+  auto it = m_found.find(key);
+  if (it == m_found.end() || !read(it->second, g)) {
+    ++m_misses;
+    return false;
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_keptMutex);
+    m_kept[key] = it->second.str();
+  }
+  ++m_hits;
+  return true;
+}
+
+bool SummaryCache::store(const Key &key, const Graph &g) {
+  std::string data;
+  if (key.empty() || !write(g, data)) return false;
+  std::lock_guard<std::mutex> lock(m_keptMutex);
+  m_kept[key] = std::move(data);
+  ++m_stores;
+  return true;
+}
+
+bool SummaryCache::save() {
+  std::lock_guard<std::mutex> lock(m_keptMutex);
+  // -- the file is left as it is if every graph was loaded from it
+  if (m_stores == 0 && m_kept.size() == m_found.size()) return true;
+
+  std::string data;
+  writeString(data, CacheVersion);
+  writeInt(data, m_kept.size());
+  for (auto &kv : m_kept) {
+    writeString(data, kv.getKey());
+    writeString(data, kv.getValue());
+  }
+
+  // -- write to a temporary file that is renamed, so that concurrent
+  // -- runs sharing the cache never read a partial file
+  if (sys::fs::create_directories(SummaryCacheDir)) return false;
+  SmallString<128> tmp;
+  int fd;
+  if (sys::fs::createUniqueFile(m_file + ".tmp-%%%%%%", fd, tmp))
+    return false;
+  {
+    raw_fd_ostream os(fd, /*shouldClose=*/true);
+    os << data;
+    os.close();
+    if (os.has_error()) {
+      os.clear_error();
+      sys::fs::remove(tmp);
+      return false;
+    }
+  }
+  if (sys::fs::rename(tmp, m_file)) {
+    sys::fs::remove(tmp);
+    return false;
+  }
+  return true;
+}
+
+} // namespace seadsa
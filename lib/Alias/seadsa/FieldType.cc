@@ -9,14 +9,16 @@
 
 namespace seadsa {
 
-static llvm::cl::opt<bool> EnableOmnipotentChar(
+bool EnableOmnipotentChar;
+
+static llvm::cl::opt<bool, true> XEnableOmnipotentChar(
     "sea-dsa-omnipotent-char",
     llvm::cl::desc("Enable SeaDsa omnipotent char (default is true)"),
     // NOTE: Setting this to false results in unsound results
     // because LLVM insists on storing pointers as i8*
     // even when they have different types in the source
     // language
-    llvm::cl::init(true));
+    llvm::cl::location(EnableOmnipotentChar), llvm::cl::init(true));
 
 namespace seadsa {
 bool g_IsTypeAware;
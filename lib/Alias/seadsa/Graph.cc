@@ -91,7 +91,8 @@ Node::Node(Graph &g)
 }
 
 Node::Node(Graph &g, const Node &n, bool cpLinks, bool cpAllocSites)
-    : m_graph(&g), m_unique_scalar(n.m_unique_scalar), m_size(n.m_size) {
+    : m_graph(&g), m_unique_scalar(n.m_unique_scalar),
+      m_has_once_unique_scalar(n.m_has_once_unique_scalar), m_size(n.m_size) {
   assert(!n.isForwarding());
 
   // -- fresh id
@@ -267,10 +268,10 @@ void Node::collapseOffsets(int tag) {
       if (m_unique_scalar) errs()
           << "KILL due to offset-collapse: " << *m_unique_scalar << "\n";);
 
-  static int cnt = 0;
-  ++cnt;
+  static std::atomic<int> cnt(0);
+  int id = ++cnt;
   LOG("dsa-collapse",
-      errs() << "Offset-Collapse #" << cnt << " tag " << tag << "\n");
+      errs() << "Offset-Collapse #" << id << " tag " << tag << "\n");
   // if (cnt == 53) {
   //   errs() << "\n~~~~NOW~~~~\n";
   // }
@@ -1493,5 +1494,5 @@ Node &FlatGraph::mkNode() {
 }
 
 // Initialization of static data
-uint64_t Node::m_id_factory = 0;
+std::atomic<uint64_t> Node::m_id_factory(0);
 } // namespace seadsa
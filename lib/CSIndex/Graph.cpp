@@ -22,6 +22,10 @@ Graph::Graph(istream &in) {
     readGraph(in);
 }
 
+Graph::Graph(const GraphFile &gf) {
+    readGraph(gf);
+}
+
 Graph::~Graph() = default;
 
 void Graph::printGraph() {
@@ -106,6 +110,38 @@ void Graph::readGraph(istream &in) {
     }
 }
 
+// the same graph readGraph(istream &) builds from the text of the file, without parsing
+void Graph::readGraph(const GraphFile &gf) {
+    int n = gf.num_vertices();
+    n_vertices = n;
+    n_edges = 0;
+    vl = VertexList(n);
+    graph = GRA(n, In_OutList());
+
+    const uint64_t *offsets = gf.offsets();
+    const int32_t *targets = gf.targets();
+    const int32_t *labels = gf.labels();
+    const int32_t *func_ids = gf.func_ids();
+    vector<int> in_degree(n, 0);
+    for (size_t e = 0; e < gf.num_edges(); e++)
+        in_degree[targets[e]]++;
+    for (int i = 0; i < n; i++) {
+        vl[i].id = i;
+        if (func_ids)
+            vl[i].func_id = func_ids[i];
+        graph[i].inList.reserve(in_degree[i]);
+        graph[i].outList.reserve(offsets[i + 1] - offsets[i]);
+    }
+
+    for (int sid = 0; sid < n; sid++) {
+        for (uint64_t e = offsets[sid]; e < offsets[sid + 1]; e++) {
+            if (labels && labels[e])
+                addEdge(sid, targets[e], labels[e]);
+            else
+                addEdge(sid, targets[e]);
+        }
+    }
+}
 
 void Graph::writeGraph(ostream &out) {
     cout << "Graph size = " << graph.size() << endl;
@@ -0,0 +1,181 @@
+#include "CSIndex/GraphFile.h"
+#include "CSIndex/Graph.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// the magic number and the version of the format, bump the version if the format changes
+/// @{
+static const char GraphFileMagic[8] = {'C', 'S', 'R', 'G', 'R', 'A', 'P', 'H'};
+static const uint32_t GraphFileVersion = 1;
+/// @}
+
+static_assert(sizeof(GraphFileHeader) == 80, "the header layout is part of the format");
+
+// the arrays are used in place, which needs the byte order of the format
+static bool host_is_little_endian() {
+    const uint16_t one = 1;
+    return *(const uint8_t *) &one == 1;
+}
+
+static uint32_t header_checksum(const GraphFileHeader &h) {
+    uint32_t hash = 2166136261u;
+    auto *bytes = (const uint8_t *) &h;
+    for (size_t i = 0; i < offsetof(GraphFileHeader, checksum); ++i) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static uint64_t align8(uint64_t pos) {
+    return (pos + 7) & ~(uint64_t) 7;
+}
+
+GraphFile::~GraphFile() {
+    close();
+}
+
+void GraphFile::close() {
+    if (base)
+        munmap((void *) base, size);
+    base = nullptr;
+    size = 0;
+    header = nullptr;
+}
+
+bool GraphFile::fail(const std::string &msg) {
+    close();
+    err = msg;
+    return false;
+}
+
+bool GraphFile::isGraphFile(const std::string &path) {
+    char magic[sizeof(GraphFileMagic)];
+    ifstream in(path, ios::binary);
+    return in.read(magic, sizeof(magic)) && memcmp(magic, GraphFileMagic, sizeof(magic)) == 0;
+}
+
+bool GraphFile::open(const std::string &path) {
+    close();
+    if (!host_is_little_endian())
+        return fail("binary graphs are not supported on big-endian hosts");
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return fail("cannot open " + path + ": " + strerror(errno));
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(GraphFileHeader)) {
+        ::close(fd);
+        return fail(path + " is too small to be a graph file");
+    }
+    void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+        return fail("cannot map " + path + ": " + strerror(errno));
+    base = (const char *) addr;
+    size = st.st_size;
+    header = (const GraphFileHeader *) base;
+
+    // the header, then the bounds of every section
+    const GraphFileHeader &h = *header;
+    if (memcmp(h.magic, GraphFileMagic, sizeof(GraphFileMagic)) != 0)
+        return fail(path + " is not a binary graph file");
+    if (h.version != GraphFileVersion)
+        return fail(path + " has format version " + to_string(h.version) + ", expected " +
+                    to_string(GraphFileVersion));
+    if (h.checksum != header_checksum(h))
+        return fail(path + " has a corrupted header");
+    if (h.file_size != size)
+        return fail(path + " is truncated");
+    if (h.num_vertices > (uint64_t) MAX_VAL || h.num_edges > size)
+        return fail(path + " has a corrupted header");
+
+    auto in_file = [&](uint64_t pos, uint64_t bytes) {
+        return pos % 8 == 0 && pos >= sizeof(GraphFileHeader) && pos <= size && bytes <= size - pos;
+    };
+    uint64_t n = h.num_vertices, m = h.num_edges;
+    if (!in_file(h.offsets_pos, (n + 1) * sizeof(uint64_t)) || !in_file(h.targets_pos, m * sizeof(int32_t)) ||
+        ((h.flags & GF_LABELS) && !in_file(h.labels_pos, m * sizeof(int32_t))) ||
+        ((h.flags & GF_FUNC_IDS) && !in_file(h.func_ids_pos, n * sizeof(int32_t))))
+        return fail(path + " has a section out of the file");
+
+    // clients index the arrays without checks, so the edges are validated once here
+    const uint64_t *offs = offsets();
+    if (offs[0] != 0 || offs[n] != m)
+        return fail(path + " has corrupted edge offsets");
+    for (uint64_t v = 0; v < n; ++v) {
+        if (offs[v] > offs[v + 1])
+            return fail(path + " has corrupted edge offsets");
+    }
+    const int32_t *trgs = targets();
+    for (uint64_t e = 0; e < m; ++e) {
+        if (trgs[e] < 0 || (uint64_t) trgs[e] >= n)
+            return fail(path + " has an edge to a vertex out of the graph");
+    }
+    err.clear();
+    return true;
+}
+
+bool GraphFile::write(Graph &g, const std::string &path, std::string &error) {
+    if (!host_is_little_endian()) {
+        error = "binary graphs are not supported on big-endian hosts";
+        return false;
+    }
+
+    uint64_t n = g.num_vertices();
+    vector<uint64_t> offs(n + 1, 0);
+    vector<int32_t> trgs, labels, func_ids(n);
+    bool has_labels = false;
+    for (uint64_t v = 0; v < n; ++v) {
+        for (int t : g.out_edges(v)) {
+            int label = g.label(v, t);
+            has_labels |= label != 0;
+            trgs.push_back(t);
+            labels.push_back(label);
+        }
+        offs[v + 1] = trgs.size();
+        func_ids[v] = g[v].func_id;
+    }
+    uint64_t m = trgs.size();
+
+    GraphFileHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, GraphFileMagic, sizeof(GraphFileMagic));
+    h.version = GraphFileVersion;
+    h.flags = GF_FUNC_IDS | (has_labels ? GF_LABELS : 0);
+    h.num_vertices = n;
+    h.num_edges = m;
+    h.offsets_pos = sizeof(GraphFileHeader);
+    h.targets_pos = align8(h.offsets_pos + (n + 1) * sizeof(uint64_t));
+    uint64_t end = h.targets_pos + m * sizeof(int32_t);
+    if (has_labels) {
+        h.labels_pos = align8(end);
+        end = h.labels_pos + m * sizeof(int32_t);
+    }
+    h.func_ids_pos = align8(end);
+    h.file_size = h.func_ids_pos + n * sizeof(int32_t);
+    h.checksum = header_checksum(h);
+
+    ofstream out(path, ios::binary | ios::trunc);
+    auto put = [&out](uint64_t pos, const void *data, uint64_t bytes) {
+        static const char zeros[8] = {0};
+        out.write(zeros, pos - (uint64_t) out.tellp());
+        out.write((const char *) data, bytes);
+    };
+    put(0, &h, sizeof(h));
+    put(h.offsets_pos, offs.data(), offs.size() * sizeof(uint64_t));
+    put(h.targets_pos, trgs.data(), m * sizeof(int32_t));
+    if (has_labels)
+        put(h.labels_pos, labels.data(), m * sizeof(int32_t));
+    put(h.func_ids_pos, func_ids.data(), n * sizeof(int32_t));
+    out.close();
+    if (!out) {
+        error = "cannot write " + path;
+        return false;
+    }
+    return true;
+}
@@ -9,7 +9,8 @@
  * Key features:
  * - Analysis of branch instructions and their targets
  * - Construction of post-dominator trees for control flow analysis
- * - Function-level control dependency analysis
+ * - Function-level control dependency analysis, which the PDG runs on
+ *   several functions in parallel
  * - Integration with the overall PDG framework
  * - Support for different types of control dependencies
  *
@@ -25,12 +26,16 @@ char pdg::ControlDependencyGraph::ID = 0;
 using namespace llvm;
 bool pdg::ControlDependencyGraph::runOnFunction(Function &F)
 {
-  _PDT = &getAnalysis<PostDominatorTreeWrapperPass>().getPostDomTree();
-  addControlDepFromEntryNodeToInsts(F);
-  addControlDepFromDominatedBlockToDominator(F);
+  addControlDependencies(F, getAnalysis<PostDominatorTreeWrapperPass>().getPostDomTree());
   return false;
 }
 
+void pdg::ControlDependencyGraph::addControlDependencies(Function &F, PostDominatorTree &PDT)
+{
+  addControlDepFromEntryNodeToInsts(F);
+  addControlDepFromDominatedBlockToDominator(F, PDT);
+}
+
 void pdg::ControlDependencyGraph::addControlDepFromNodeToBB(Node &n, BasicBlock &BB, EdgeType edge_type)
 {
   ProgramGraph &g = ProgramGraph::getInstance();
@@ -47,7 +52,7 @@ void pdg::ControlDependencyGraph::addControlDepFromNodeToBB(Node &n, BasicBlock
 void pdg::ControlDependencyGraph::addControlDepFromEntryNodeToInsts(Function &F)
 {
   ProgramGraph &g = ProgramGraph::getInstance();
-  FunctionWrapper* func_w = g.getFuncWrapperMap()[&F];
+  FunctionWrapper* func_w = g.getFuncWrapper(F);
   if (!func_w)
     return;
   for (auto &BB : F)
@@ -56,7 +61,7 @@ void pdg::ControlDependencyGraph::addControlDepFromEntryNodeToInsts(Function &F)
   }
 }
 
-void pdg::ControlDependencyGraph::addControlDepFromDominatedBlockToDominator(Function &F)
+void pdg::ControlDependencyGraph::addControlDepFromDominatedBlockToDominator(Function &F, PostDominatorTree &PDT)
 {
   ProgramGraph &g = ProgramGraph::getInstance();
   for (auto &BB : F)
@@ -64,7 +69,7 @@ void pdg::ControlDependencyGraph::addControlDepFromDominatedBlockToDominator(Fun
     for (auto succ_iter = succ_begin(&BB); succ_iter != succ_end(&BB); succ_iter++)
     {
       BasicBlock *succ_bb = *succ_iter;
-      if (&BB == &*succ_bb || !_PDT->dominates(&*succ_bb, &BB))
+      if (&BB == &*succ_bb || !PDT.dominates(&*succ_bb, &BB))
       {
         // get terminator and connect with the dependent block
         Instruction *terminator = BB.getTerminator();
@@ -78,11 +83,11 @@ void pdg::ControlDependencyGraph::addControlDepFromDominatedBlockToDominator(Fun
           Node *branch_node = g.getNode(*bi);
           if (branch_node == nullptr)
             break;
-          BasicBlock *nearestCommonDominator = _PDT->findNearestCommonDominator(&BB, succ_bb);
+          BasicBlock *nearestCommonDominator = PDT.findNearestCommonDominator(&BB, succ_bb);
           if (nearestCommonDominator == &BB)
             addControlDepFromNodeToBB(*branch_node, *succ_bb, EdgeType::CONTROLDEP_BR);
 
-          for (auto *cur = _PDT->getNode(&*succ_bb); cur != _PDT->getNode(nearestCommonDominator); cur = cur->getIDom())
+          for (auto *cur = PDT.getNode(&*succ_bb); cur != PDT.getNode(nearestCommonDominator); cur = cur->getIDom())
           {
             addControlDepFromNodeToBB(*branch_node, *cur->getBlock(), EdgeType::CONTROLDEP_BR);
           }
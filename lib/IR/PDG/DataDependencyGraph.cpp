@@ -9,9 +9,13 @@
  * Key features:
  * - Analysis of def-use chains in LLVM IR
  * - Support for different types of data dependencies (direct, memory, etc.)
- * - Function-level data dependency analysis
+ * - Function-level data dependency analysis, with the def-use and alias
+ *   edges of different functions added in parallel
  * - Integration with the overall PDG framework
  * - Support for memory-based dependencies through load/store analysis
+ * - Alias edges built from the loads and stores of each address, so their
+ *   cost scales with the number of edges rather than with the square of
+ *   the function size
  *
  * The data dependency analysis is a fundamental component of the PDG system,
  * complementing control dependency analysis to provide a complete view of
@@ -19,6 +23,7 @@
  */
 
 #include "IR/PDG/DataDependencyGraph.h"
+#include "llvm/ADT/MapVector.h"
 
 char pdg::DataDependencyGraph::ID = 0;
 
@@ -34,38 +39,86 @@ bool pdg::DataDependencyGraph::runOnModule(Module &M)
     g.bindDITypeToNodes(M);
   }
   
+  // the memory dependences come from the pass manager, which is not
+  // thread-safe, so only the RAW edges are added one function at a time
+  std::vector<Function *> funcs;
   for (auto &F : M)
   {
     if (F.isDeclaration() || F.empty())
       continue;
+    funcs.push_back(&F);
     _mem_dep_res = &getAnalysis<MemoryDependenceWrapperPass>(F).getMemDep();
-    // setup alias query interface for each function
     for (auto inst_iter = inst_begin(F); inst_iter != inst_end(F); inst_iter++)
-    {
-      addDefUseEdges(*inst_iter);
       addRAWEdges(*inst_iter);
-      addAliasEdges(*inst_iter);
-    }
   }
+
+  // the other edges connect the nodes of a function to each other, so
+  // functions are handled in parallel
+  pdgutils::runInParallel(funcs.size(), [&](unsigned i) {
+    Function &F = *funcs[i];
+    for (auto inst_iter = inst_begin(F); inst_iter != inst_end(F); inst_iter++)
+      addDefUseEdges(*inst_iter);
+    addAliasEdges(F);
+  });
   return false;
 }
 
-void pdg::DataDependencyGraph::addAliasEdges(Instruction &inst)
+// Add an alias edge from each instruction to the instructions that
+// queryAliasUnderApproximate finds aliasing with it in the function.
+// These are a bitcast and its operand, and a load of a pointer and the
+// other loads of the same address or the pointers stored to it. The
+// loads and stores of pointers are bucketed by address, so only the
+// pairs in a bucket are visited, instead of all pairs of instructions.
+void pdg::DataDependencyGraph::addAliasEdges(Function &F)
 {
   ProgramGraph &g = ProgramGraph::getInstance();
-  Function* func = inst.getFunction();
-  for (auto inst_iter = inst_begin(func); inst_iter != inst_end(func); inst_iter++)
+  auto addEdge = [&g](Instruction &src_inst, Instruction &dst_inst) {
+    if (&src_inst == &dst_inst || !dst_inst.getType()->isPointerTy())
+      return;
+    Node *src = g.getNode(src_inst);
+    Node *dst = g.getNode(dst_inst);
+    if (src == nullptr || dst == nullptr)
+      return;
+    src->addNeighbor(*dst, EdgeType::DATA_ALIAS);
+  };
+
+  struct AddressBucket
   {
-    if (&inst == &*inst_iter)
-      continue;
-    auto alias_result = queryAliasUnderApproximate(inst, *inst_iter);
-    if (alias_result != AliasResult::NoAlias)
+    std::vector<LoadInst *> loads;
+    std::vector<Instruction *> stored_values;
+  };
+  MapVector<Value *, AddressBucket> buckets;
+  for (auto inst_iter = inst_begin(F); inst_iter != inst_end(F); inst_iter++)
+  {
+    Instruction &inst = *inst_iter;
+    if (BitCastInst *bci = dyn_cast<BitCastInst>(&inst))
+    {
+      if (bci->getType()->isPointerTy())
+        if (Instruction *src = dyn_cast<Instruction>(bci->getOperand(0)))
+          addEdge(*bci, *src);
+    }
+    else if (LoadInst *li = dyn_cast<LoadInst>(&inst))
+    {
+      // only loads of pointers take part in alias edges
+      if (li->getType()->isPointerTy())
+        buckets[li->getPointerOperand()].loads.push_back(li);
+    }
+    else if (StoreInst *si = dyn_cast<StoreInst>(&inst))
+    {
+      if (Instruction *val = dyn_cast<Instruction>(si->getValueOperand()))
+        buckets[si->getPointerOperand()].stored_values.push_back(val);
+    }
+  }
+
+  for (auto &kv : buckets)
+  {
+    AddressBucket &bucket = kv.second;
+    for (LoadInst *li : bucket.loads)
     {
-      Node* src = g.getNode(inst);
-      Node* dst = g.getNode(*inst_iter);
-      if (src == nullptr || dst == nullptr)
-        continue;
-      src->addNeighbor(*dst, EdgeType::DATA_ALIAS);
+      for (LoadInst *other : bucket.loads)
+        addEdge(*li, *other);
+      for (Instruction *val : bucket.stored_values)
+        addEdge(*li, *val);
     }
   }
 }
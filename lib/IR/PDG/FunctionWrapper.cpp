@@ -62,6 +62,7 @@ void pdg::FunctionWrapper::buildFormalTreeForArgs()
     AllocaInst* arg_alloca_inst = getArgAllocaInst(*arg);
     if (di_local_var == nullptr || arg_alloca_inst == nullptr)
     {
+      std::lock_guard<std::mutex> lock(pdgutils::getErrsMutex());
       errs() << "empty di local var: " << _func->getName().str() << (di_local_var == nullptr) << " - " << (arg_alloca_inst == nullptr) << "\n";
       continue;
     }
@@ -12,6 +12,8 @@
  * - Node and edge creation and management
  * - Supporting field-sensitive analysis through tree structures
  * - Class hierarchy and function call relationship modeling
+ * - Building the nodes of each function in parallel, as fragments that are
+ *   merged into the graph in module order
  *
  * The graph implementation allows for extensive queries about program dependencies,
  * supporting both control and data dependency analyses in an integrated structure.
@@ -35,9 +37,11 @@ bool pdg::GenericGraph::hasNode(Value &v)
 
 pdg::Node *pdg::GenericGraph::getNode(Value &v)
 {
-  if (!hasNode(v))
+  // find does not modify the map, so nodes can be looked up in parallel
+  auto iter = _val_node_map.find(&v);
+  if (iter == _val_node_map.end())
     return nullptr;
-  return _val_node_map[&v];
+  return iter->second;
 }
 
 // pretty print nodes and edges in PDG
@@ -81,7 +85,8 @@ void pdg::GenericGraph::dumpGraph()
 // DFS search
 bool pdg::GenericGraph::canReach(pdg::Node &src, pdg::Node &dst)
 {
-  // TODO: prune by call graph rechability, improve traverse efficiency
+  // walks the mutable graph; clients issuing many queries should take a
+  // PDGSnapshot, which prunes by function-level reachability and can be indexed
   if (canReach(src, dst, {}))
     return true;
   return false;
@@ -136,51 +141,22 @@ void pdg::ProgramGraph::build(Module &M)
     addNode(*n);
   }
 
+  // the nodes of each function are built in parallel, as fragments that
+  // only read the module
+  std::vector<Function *> funcs;
   for (auto &F : M)
   {
     if (F.isDeclaration() || F.empty())
       continue;
-    std::string func_name = F.getName().str();
-    // bool isTargetFunc = false;
-    // for (auto name : targetFuncNames)
-    // {
-    //   if (func_name.find(name) != std::string::npos)
-    //   {
-    //     isTargetFunc = true;
-    //     break;
-    //   }
-    // }
-
-    // if (!isTargetFunc)
-    //   continue;
-
-    // create nodes for inst in functions
-    FunctionWrapper *func_w = new FunctionWrapper(&F);
-    for (auto inst_iter = inst_begin(F); inst_iter != inst_end(F); inst_iter++)
-    {
-      GraphNodeType node_type = GraphNodeType::INST_OTHER;
-      if (isAnnotationCallInst(*inst_iter))
-        node_type = GraphNodeType::ANNO_VAR;
-      if (isa<ReturnInst>(&*inst_iter))
-        node_type = GraphNodeType::INST_RET;
-      if (isa<CallInst>(&*inst_iter))
-        node_type = GraphNodeType::INST_FUNCALL;
-      if (isa<BranchInst>(&*inst_iter))
-        node_type = GraphNodeType::INST_BR;
-      // if (auto invokeInst = dyn_cast<InvokeInst>(&*inst_iter)) 
-      //   errs() << invokeInst->getCalledFunction()->getName() << "\n";
-      Node *n = new Node(*inst_iter, node_type);
-      _val_node_map.insert(std::pair<Value *, Node *>(&*inst_iter, n));
-      func_w->addInst(*inst_iter);
-      addNode(*n);
-    }
-    func_w->buildFormalTreeForArgs();
-    func_w->buildFormalTreesForRetVal();
-    addFormalTreeNodesToGraph(*func_w);
-    addNode(*func_w->getEntryNode());
-    _func_wrapper_map.insert(std::make_pair(&F, func_w));
-    _val_node_map.insert(std::pair<Value*, Node*>(&F, func_w->getEntryNode()));
+    funcs.push_back(&F);
   }
+  pdgutils::cacheStructLayouts(M);
+  std::vector<FunctionFragment> fragments(funcs.size());
+  pdgutils::runInParallel(funcs.size(), [&](unsigned i) {
+    fragments[i] = buildFunctionFragment(*funcs[i]);
+  });
+  for (auto &fragment : fragments)
+    mergeFunctionFragment(fragment);
 
   buildGlobalAnnotationNodes(M);
 
@@ -217,68 +193,75 @@ void pdg::ProgramGraph::build(Module &M)
   _is_build = true;
 }
 
+pdg::FunctionFragment pdg::ProgramGraph::buildFunctionFragment(Function &F)
+{
+  FunctionFragment fragment;
+  // create nodes for inst in functions
+  FunctionWrapper *func_w = new FunctionWrapper(&F);
+  for (auto inst_iter = inst_begin(F); inst_iter != inst_end(F); inst_iter++)
+  {
+    GraphNodeType node_type = GraphNodeType::INST_OTHER;
+    if (isAnnotationCallInst(*inst_iter))
+      node_type = GraphNodeType::ANNO_VAR;
+    if (isa<ReturnInst>(&*inst_iter))
+      node_type = GraphNodeType::INST_RET;
+    if (isa<CallInst>(&*inst_iter))
+      node_type = GraphNodeType::INST_FUNCALL;
+    if (isa<BranchInst>(&*inst_iter))
+      node_type = GraphNodeType::INST_BR;
+    Node *n = new Node(*inst_iter, node_type);
+    fragment.inst_nodes.push_back(std::make_pair(&*inst_iter, n));
+    func_w->addInst(*inst_iter);
+  }
+  func_w->buildFormalTreeForArgs();
+  func_w->buildFormalTreesForRetVal();
+  fragment.func_w = func_w;
+  return fragment;
+}
+
+void pdg::ProgramGraph::mergeFunctionFragment(FunctionFragment &fragment)
+{
+  for (auto &val_node : fragment.inst_nodes)
+  {
+    _val_node_map.insert(val_node);
+    addNode(*val_node.second);
+  }
+  FunctionWrapper *func_w = fragment.func_w;
+  addFormalTreeNodesToGraph(*func_w);
+  addNode(*func_w->getEntryNode());
+  _func_wrapper_map.insert(std::make_pair(func_w->getFunc(), func_w));
+  _val_node_map.insert(std::pair<Value*, Node*>(func_w->getFunc(), func_w->getEntryNode()));
+}
+
+pdg::FunctionWrapper *pdg::ProgramGraph::getFuncWrapper(Function &F)
+{
+  auto iter = _func_wrapper_map.find(&F);
+  if (iter == _func_wrapper_map.end())
+    return nullptr;
+  return iter->second;
+}
+
 void pdg::ProgramGraph::bindDITypeToNodes(Module &M)
 {
+  // the ditypes of address variables come first, as they create the class
+  // nodes shared by all functions. The ditypes of the instructions of a
+  // function only depend on the nodes of that function, and are computed
+  // in parallel.
+  std::vector<Function *> funcs;
   for (auto &F : M)
   {
     if (F.isDeclaration())
       continue;
-    FunctionWrapper *fw = _func_wrapper_map[&F];
+    FunctionWrapper *fw = getFuncWrapper(F);
     if (!fw)
       continue;
-    auto dbg_declare_insts = fw->getDbgDeclareInsts();
-    // bind ditype to the top-level pointer (alloca)
-    for (auto dbg_declare_inst : dbg_declare_insts)
-    {
-      // For LLVM 14.0.0, we need to handle Metadata conversion correctly
-      Metadata *MD = dbg_declare_inst->getRawLocation();
-      if (!MD) continue;
-      
-      Value *addr = nullptr;
-      if (auto *VMD = dyn_cast<ValueAsMetadata>(MD)) {
-        addr = VMD->getValue();
-      } else {
-        continue;
-      }
-      
-      Node *addr_node = getNode(*addr);
-      if (!addr_node)
-        continue;
-      auto DLV = dbg_declare_inst->getVariable(); // di local variable instance
-      assert(DLV != nullptr && "cannot find DILocalVariable Node for computing DIType");
-      DIType *var_di_type = DLV->getType();
-      std::string var_name = DLV->getName().str();
-      assert(var_di_type != nullptr && "cannot bind nullptr ditype to node!");
-      addr_node->setDIType(*var_di_type);
-      _node_di_type_map.insert(std::make_pair(addr_node, var_di_type));
-      // if dbg contains class information, create a separate class node
-      if (dbgutils::isClassPointerType(*var_di_type))
-      {
-        auto class_name = dbgutils::getSourceLevelTypeName(*var_di_type);
-        if (_class_name_set.find(class_name) != _class_name_set.end())
-        {
-          // if the variable name is this, the current function is a class method
-          if (var_name == "this" && fw->getClassName().empty())
-            fw->setClassName(class_name);
-          continue;
-        }
-        _class_name_set.insert(class_name);
-        Node* class_node = new Node(GraphNodeType::CLASS);
-        class_node->setDIType(*var_di_type);
-        addNode(*class_node);
-        _class_node_map.insert(std::make_pair(class_name, class_node));
-      }
-    }
-
-    for (auto inst_iter = inst_begin(F); inst_iter != inst_end(F); inst_iter++)
-    {
-      Instruction &i = *inst_iter;
-      Node* n = getNode(i);
-      assert(n != nullptr && "cannot compute node di type for null node!\n");
-      DIType* node_di_type = computeNodeDIType(*n);
-      n->setDIType(*node_di_type);
-    }
+    bindDITypeToAddrVars(*fw);
+    funcs.push_back(&F);
   }
+  pdgutils::cacheStructLayouts(M);
+  pdgutils::runInParallel(funcs.size(), [&](unsigned i) {
+    bindDITypeToInsts(*funcs[i]);
+  });
 
   for (auto &global_var : M.getGlobalList())
   {
@@ -291,6 +274,65 @@ void pdg::ProgramGraph::bindDITypeToNodes(Module &M)
   }
 }
 
+void pdg::ProgramGraph::bindDITypeToAddrVars(FunctionWrapper &fw)
+{
+  auto dbg_declare_insts = fw.getDbgDeclareInsts();
+  // bind ditype to the top-level pointer (alloca)
+  for (auto dbg_declare_inst : dbg_declare_insts)
+  {
+    // For LLVM 14.0.0, we need to handle Metadata conversion correctly
+    Metadata *MD = dbg_declare_inst->getRawLocation();
+    if (!MD) continue;
+    
+    Value *addr = nullptr;
+    if (auto *VMD = dyn_cast<ValueAsMetadata>(MD)) {
+      addr = VMD->getValue();
+    } else {
+      continue;
+    }
+    
+    Node *addr_node = getNode(*addr);
+    if (!addr_node)
+      continue;
+    auto DLV = dbg_declare_inst->getVariable(); // di local variable instance
+    assert(DLV != nullptr && "cannot find DILocalVariable Node for computing DIType");
+    DIType *var_di_type = DLV->getType();
+    std::string var_name = DLV->getName().str();
+    assert(var_di_type != nullptr && "cannot bind nullptr ditype to node!");
+    addr_node->setDIType(*var_di_type);
+    _node_di_type_map.insert(std::make_pair(addr_node, var_di_type));
+    // if dbg contains class information, create a separate class node
+    if (dbgutils::isClassPointerType(*var_di_type))
+    {
+      auto class_name = dbgutils::getSourceLevelTypeName(*var_di_type);
+      if (_class_name_set.find(class_name) != _class_name_set.end())
+      {
+        // if the variable name is this, the current function is a class method
+        if (var_name == "this" && fw.getClassName().empty())
+          fw.setClassName(class_name);
+        continue;
+      }
+      _class_name_set.insert(class_name);
+      Node* class_node = new Node(GraphNodeType::CLASS);
+      class_node->setDIType(*var_di_type);
+      addNode(*class_node);
+      _class_node_map.insert(std::make_pair(class_name, class_node));
+    }
+  }
+}
+
+void pdg::ProgramGraph::bindDITypeToInsts(Function &F)
+{
+  for (auto inst_iter = inst_begin(F); inst_iter != inst_end(F); inst_iter++)
+  {
+    Instruction &i = *inst_iter;
+    Node* n = getNode(i);
+    assert(n != nullptr && "cannot compute node di type for null node!\n");
+    DIType* node_di_type = computeNodeDIType(*n);
+    n->setDIType(*node_di_type);
+  }
+}
+
 DIType *pdg::ProgramGraph::computeNodeDIType(Node &n)
 {
   // local variable 
@@ -10,7 +10,8 @@
  * - Construction of the call graph from LLVM Module
  * - Support for both direct and indirect function calls
  * - Integration with the overall PDG system
- * - Call site detection and management
+ * - Call site detection and management, with the indirect call candidates
+ *   of different functions searched in parallel
  * - Support for call reachability analysis
  *
  * The call graph helps optimize PDG construction by providing information about
@@ -24,6 +25,7 @@ using namespace llvm;
 
 void pdg::PDGCallGraph::build(Module &M)
 {
+  std::vector<Function *> funcs;
   for (auto &F : M)
   {
     if (F.isDeclaration() || F.empty())
@@ -31,39 +33,42 @@ void pdg::PDGCallGraph::build(Module &M)
     Node* n = new Node(F, GraphNodeType::FUNC);
     _val_node_map.insert(std::make_pair(&F, n));
     addNode(*n);
+    funcs.push_back(&F);
   }
 
-  // connect nodes
-  for (auto &F : M)
-  {
-    if (F.isDeclaration() || F.empty())
-      continue;
-    auto caller_node = getNode(F);
-    for (auto inst_i = inst_begin(F); inst_i != inst_end(F); inst_i++)
+  // the call targets of each function are found in parallel, as the indirect
+  // call candidates are searched in the whole module, and connected in module
+  // order
+  std::vector<std::vector<std::pair<Function *, EdgeType>>> call_targets(funcs.size());
+  pdgutils::runInParallel(funcs.size(), [&](unsigned i) {
+    for (auto inst_i = inst_begin(funcs[i]); inst_i != inst_end(funcs[i]); inst_i++)
     {
       if (CallInst *ci = dyn_cast<CallInst>(&*inst_i))
       {
         auto called_func = pdgutils::getCalledFunc(*ci);
         // direct calls
         if (called_func != nullptr)
-        {
-          auto callee_node = getNode(*called_func);
-          if (callee_node != nullptr)
-            caller_node->addNeighbor(*callee_node, EdgeType::CONTROLDEP_CALLINV);
-        }
+          call_targets[i].push_back(std::make_pair(called_func, EdgeType::CONTROLDEP_CALLINV));
         else
         {
           // indirect calls
-          auto ind_call_candidates = getIndirectCallCandidates(*ci, M);
-          for (auto ind_call_can : ind_call_candidates)
-          {
-            Node* callee_node = getNode(*ind_call_can);
-            if (callee_node != nullptr)
-              caller_node->addNeighbor(*callee_node, EdgeType::IND_CALL);
-          }
+          for (auto ind_call_can : getIndirectCallCandidates(*ci, M))
+            call_targets[i].push_back(std::make_pair(ind_call_can, EdgeType::IND_CALL));
         }
       }
     }
+  });
+
+  // connect nodes
+  for (unsigned i = 0; i < funcs.size(); i++)
+  {
+    auto caller_node = getNode(*funcs[i]);
+    for (auto &call_target : call_targets[i])
+    {
+      Node *callee_node = getNode(*call_target.first);
+      if (callee_node != nullptr)
+        caller_node->addNeighbor(*callee_node, call_target.second);
+    }
   }
   
   _is_build = true;
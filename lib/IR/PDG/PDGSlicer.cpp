@@ -0,0 +1,340 @@
+/**
+ * @file PDGSlicer.cpp
+ * @brief Implementation of program slicing over a snapshot of the PDG
+ *
+ * This file implements backward, forward and thin slices and chops on a PDGSnapshot,
+ * and the construction of a sliced copy of the module.
+ *
+ * Key features:
+ * - Call site matching: every parameter, call and return edge is tagged with the call
+ *   site it belongs to, through the call wrappers of the program graph, and the walks
+ *   keep a bounded call string so that a path leaves a callee where it entered it
+ * - Thin slices following the producer data edges only, skipping control dependences,
+ *   base pointers of loads and stores, and field edges of parameter trees
+ * - Chops as the intersection of a forward and a backward slice
+ * - Several criteria sliced in parallel over the same read-only snapshot
+ * - A sliced module, which keeps the terminators so that it stays valid IR
+ */
+
+#include "IR/PDG/PDGSlicer.h"
+#include "IR/PDG/PDGUtils.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+
+#include <algorithm>
+#include <map>
+#include <unordered_set>
+
+using namespace llvm;
+
+namespace
+{
+  const unsigned NoSite = ~0u;
+
+  // annotation and class edges describe the program, they carry no dependence
+  const pdg::PDGSnapshot::EdgeKindMask SliceEdgeKinds =
+      pdg::PDGSnapshot::AllEdgeKinds & ~pdg::PDGSnapshot::kindBit(pdg::EdgeType::ANNO_VAR) &
+      ~pdg::PDGSnapshot::kindBit(pdg::EdgeType::ANNO_GLOBAL) & ~pdg::PDGSnapshot::kindBit(pdg::EdgeType::ANNO_OTHER) &
+      ~pdg::PDGSnapshot::kindBit(pdg::EdgeType::CLS_MTH);
+
+  const pdg::PDGSnapshot::EdgeKindMask InterprocEdgeKinds =
+      pdg::PDGSnapshot::kindBit(pdg::EdgeType::PARAMETER_IN) | pdg::PDGSnapshot::kindBit(pdg::EdgeType::PARAMETER_OUT) |
+      pdg::PDGSnapshot::kindBit(pdg::EdgeType::CONTROLDEP_CALLINV) |
+      pdg::PDGSnapshot::kindBit(pdg::EdgeType::CONTROLDEP_CALLRET) | pdg::PDGSnapshot::kindBit(pdg::EdgeType::DATA_RET);
+
+  const pdg::PDGSnapshot::EdgeKindMask ThinEdgeKinds =
+      pdg::PDGSnapshot::kindBit(pdg::EdgeType::DATA_DEF_USE) | pdg::PDGSnapshot::kindBit(pdg::EdgeType::DATA_RAW) |
+      pdg::PDGSnapshot::kindBit(pdg::EdgeType::DATA_RET) | pdg::PDGSnapshot::kindBit(pdg::EdgeType::PARAMETER_IN) |
+      pdg::PDGSnapshot::kindBit(pdg::EdgeType::PARAMETER_OUT);
+
+  // call strings of at most depth call sites, interned; context 0 is the empty one
+  class CallStringTable
+  {
+  public:
+    explicit CallStringTable(unsigned depth) : _depth(depth) { intern({}); }
+
+    unsigned push(unsigned ctx, unsigned site)
+    {
+      uint64_t key = ((uint64_t)ctx << 32) | site;
+      auto iter = _push_memo.find(key);
+      if (iter != _push_memo.end())
+        return iter->second;
+      std::vector<unsigned> call_string = _call_strings[ctx];
+      call_string.push_back(site);
+      if (call_string.size() > _depth)
+        call_string.erase(call_string.begin());
+      unsigned res = intern(call_string);
+      _push_memo.insert(std::make_pair(key, res));
+      return res;
+    }
+
+    unsigned top(unsigned ctx) const { return _call_strings[ctx].back(); }
+    unsigned pop(unsigned ctx) const { return _pop[ctx]; }
+
+  private:
+    unsigned intern(const std::vector<unsigned> &call_string)
+    {
+      auto res = _ids.insert(std::make_pair(call_string, (unsigned)_call_strings.size()));
+      if (!res.second)
+        return res.first->second;
+      _call_strings.push_back(call_string);
+      _pop.push_back(0);
+      if (!call_string.empty())
+      {
+        unsigned id = res.first->second;
+        unsigned popped = intern(std::vector<unsigned>(call_string.begin(), call_string.end() - 1));
+        _pop[id] = popped;
+      }
+      return res.first->second;
+    }
+
+    unsigned _depth;
+    std::vector<std::vector<unsigned>> _call_strings;
+    std::vector<unsigned> _pop;
+    std::map<std::vector<unsigned>, unsigned> _ids;
+    std::unordered_map<uint64_t, unsigned> _push_memo;
+  };
+} // namespace
+
+pdg::PDGSlicer::PDGSlicer(ProgramGraph &g, PDGSnapshot &snapshot, unsigned context_depth)
+    : _snapshot(snapshot), _context_depth(context_depth)
+{
+  unsigned num_nodes = snapshot.numNodes();
+  _call_site.assign(num_nodes, PDGSnapshot::InvalidID);
+  _caller.assign(num_nodes, nullptr);
+  // the call node and the actual trees of a call site are on the caller side of it
+  for (auto &kv : g.getCallWrapperMap())
+  {
+    CallWrapper *cw = kv.second;
+    if (cw == nullptr)
+      continue;
+    Node *call_node = g.getNode(*kv.first);
+    if (call_node == nullptr)
+      continue;
+    NodeID site = snapshot.getID(*call_node);
+    if (site == PDGSnapshot::InvalidID)
+      continue;
+    Function *caller = kv.first->getFunction();
+    auto label = [&](Node &n) {
+      NodeID id = snapshot.getID(n);
+      if (id == PDGSnapshot::InvalidID)
+        return;
+      _call_site[id] = site;
+      _caller[id] = caller;
+    };
+    label(*call_node);
+    std::vector<Tree *> actual_trees;
+    for (auto arg : cw->getArgList())
+    {
+      actual_trees.push_back(cw->getArgActualInTree(*arg));
+      actual_trees.push_back(cw->getArgActualOutTree(*arg));
+    }
+    actual_trees.push_back(cw->getRetActualInTree());
+    actual_trees.push_back(cw->getRetActualOutTree());
+    for (auto tree : actual_trees)
+    {
+      if (tree == nullptr)
+        continue;
+      std::vector<TreeNode *> tree_nodes{tree->getRootNode()};
+      while (!tree_nodes.empty())
+      {
+        TreeNode *tree_node = tree_nodes.back();
+        tree_nodes.pop_back();
+        label(*tree_node);
+        for (auto child : tree_node->getChildNodes())
+          tree_nodes.push_back(child);
+      }
+    }
+  }
+
+  unsigned num_edges = snapshot.numEdges();
+  _out_site.resize(num_edges);
+  _out_into_callee.resize(num_edges);
+  _out_thin.resize(num_edges);
+  _in_site.resize(num_edges);
+  _in_into_callee.resize(num_edges);
+  _in_thin.resize(num_edges);
+  for (NodeID n = 0; n < num_nodes; n++)
+  {
+    for (unsigned e = snapshot.outBegin(n); e != snapshot.outEnd(n); e++)
+      classifyEdge(n, snapshot.outDst(e), snapshot.outKind(e), _out_site[e], _out_into_callee[e], _out_thin[e]);
+    for (unsigned e = snapshot.inBegin(n); e != snapshot.inEnd(n); e++)
+      classifyEdge(snapshot.inSrc(e), n, snapshot.inKind(e), _in_site[e], _in_into_callee[e], _in_thin[e]);
+  }
+}
+
+void pdg::PDGSlicer::classifyEdge(NodeID src, NodeID dst, EdgeType kind, unsigned &site, char &into_callee, char &thin) const
+{
+  site = NoSite;
+  into_callee = 0;
+  Node *src_node = _snapshot.getNode(src);
+  Node *dst_node = _snapshot.getNode(dst);
+
+  thin = (ThinEdgeKinds & PDGSnapshot::kindBit(kind)) != 0 && src_node->getNodeType() != GraphNodeType::FUNC_ENTRY;
+  if (thin && kind == EdgeType::DATA_DEF_USE)
+  {
+    // the address of a load or store does not produce the value it accesses
+    Value *src_val = src_node->getValue();
+    Value *dst_val = dst_node->getValue();
+    if (auto li = dyn_cast_or_null<LoadInst>(dst_val))
+      thin = src_val != li->getPointerOperand();
+    else if (auto si = dyn_cast_or_null<StoreInst>(dst_val))
+      thin = src_val != si->getPointerOperand() || src_val == si->getValueOperand();
+  }
+
+  // an interprocedural edge joins the caller side of a call site with a node
+  // of another function
+  if ((InterprocEdgeKinds & PDGSnapshot::kindBit(kind)) == 0)
+    return;
+  bool src_is_site = _call_site[src] != PDGSnapshot::InvalidID;
+  bool dst_is_site = _call_site[dst] != PDGSnapshot::InvalidID;
+  if (src_is_site == dst_is_site)
+    return;
+  NodeID site_node = src_is_site ? src : dst;
+  Function *other_func = src_is_site ? dst_node->getFunc() : src_node->getFunc();
+  if (other_func == nullptr || other_func == _caller[site_node])
+    return;
+  site = _call_site[site_node];
+  into_callee = src_is_site;
+}
+
+pdg::PDGSlicer::Slice pdg::PDGSlicer::walk(const std::vector<Node *> &starts, bool backward, bool thin) const
+{
+  unsigned num_nodes = _snapshot.numNodes();
+  CallStringTable call_strings(_context_depth);
+  std::vector<char> in_slice(num_nodes, 0);
+  // a node reached with the empty call string is reached with every other one
+  std::vector<char> visited_empty(num_nodes, 0);
+  std::unordered_set<uint64_t> visited;
+  std::vector<std::pair<NodeID, unsigned>> worklist;
+
+  auto visit = [&](NodeID n, unsigned ctx) {
+    if (visited_empty[n])
+      return;
+    if (ctx == 0)
+      visited_empty[n] = 1;
+    else if (!visited.insert(((uint64_t)n << 32) | ctx).second)
+      return;
+    in_slice[n] = 1;
+    worklist.push_back(std::make_pair(n, ctx));
+  };
+  for (auto start : starts)
+  {
+    NodeID id = _snapshot.getID(*start);
+    if (id != PDGSnapshot::InvalidID)
+      visit(id, 0);
+  }
+
+  while (!worklist.empty())
+  {
+    NodeID n = worklist.back().first;
+    unsigned ctx = worklist.back().second;
+    worklist.pop_back();
+    unsigned begin = backward ? _snapshot.inBegin(n) : _snapshot.outBegin(n);
+    unsigned end = backward ? _snapshot.inEnd(n) : _snapshot.outEnd(n);
+    for (unsigned e = begin; e != end; e++)
+    {
+      EdgeType kind = backward ? _snapshot.inKind(e) : _snapshot.outKind(e);
+      if ((SliceEdgeKinds & PDGSnapshot::kindBit(kind)) == 0)
+        continue;
+      if (thin && !(backward ? _in_thin[e] : _out_thin[e]))
+        continue;
+      NodeID next = backward ? _snapshot.inSrc(e) : _snapshot.outDst(e);
+      unsigned site = backward ? _in_site[e] : _out_site[e];
+      if (site == NoSite)
+      {
+        visit(next, ctx);
+        continue;
+      }
+      // walking an edge against its direction swaps entering and leaving the callee
+      bool enters_callee = backward ? !_in_into_callee[e] : _out_into_callee[e];
+      if (enters_callee)
+        visit(next, call_strings.push(ctx, site));
+      else if (ctx == 0)
+        visit(next, 0);
+      else if (call_strings.top(ctx) == site)
+        visit(next, call_strings.pop(ctx));
+    }
+  }
+
+  Slice res;
+  for (NodeID n = 0; n < num_nodes; n++)
+  {
+    if (in_slice[n])
+      res.push_back(n);
+  }
+  return res;
+}
+
+pdg::PDGSlicer::Slice pdg::PDGSlicer::slice(const std::vector<Node *> &criteria, SliceKind kind) const
+{
+  switch (kind)
+  {
+  case SliceKind::BACKWARD:
+    return walk(criteria, true, false);
+  case SliceKind::FORWARD:
+    return walk(criteria, false, false);
+  case SliceKind::THIN:
+    return walk(criteria, true, true);
+  }
+  return Slice();
+}
+
+pdg::PDGSlicer::Slice pdg::PDGSlicer::chop(const std::vector<Node *> &sources, const std::vector<Node *> &sinks) const
+{
+  Slice forward = walk(sources, false, false);
+  Slice backward = walk(sinks, true, false);
+  Slice res;
+  std::set_intersection(forward.begin(), forward.end(), backward.begin(), backward.end(), std::back_inserter(res));
+  return res;
+}
+
+std::vector<pdg::PDGSlicer::Slice> pdg::PDGSlicer::sliceEach(const std::vector<std::vector<Node *>> &criteria, SliceKind kind) const
+{
+  std::vector<Slice> slices(criteria.size());
+  pdgutils::runInParallel(criteria.size(), [&](unsigned i) { slices[i] = slice(criteria[i], kind); });
+  return slices;
+}
+
+std::set<Instruction *> pdg::PDGSlicer::getInstructions(const Slice &slice) const
+{
+  std::set<Instruction *> insts;
+  for (auto n : slice)
+  {
+    if (auto inst = dyn_cast_or_null<Instruction>(_snapshot.getNode(n)->getValue()))
+      insts.insert(inst);
+  }
+  return insts;
+}
+
+std::unique_ptr<Module> pdg::PDGSlicer::buildSlicedModule(Module &M, const std::set<Instruction *> &insts)
+{
+  ValueToValueMapTy vmap;
+  std::unique_ptr<Module> sliced_module = CloneModule(M, vmap);
+  std::unordered_set<Instruction *> kept;
+  for (auto inst : insts)
+  {
+    auto iter = vmap.find(inst);
+    if (iter != vmap.end())
+      kept.insert(cast<Instruction>(iter->second));
+  }
+
+  std::vector<Instruction *> removed;
+  for (auto &F : *sliced_module)
+  {
+    for (auto &BB : F)
+    {
+      for (auto &I : BB)
+      {
+        // terminators and exception pads keep the function well formed
+        if (kept.count(&I) || I.isTerminator() || I.isEHPad() || I.getType()->isTokenTy())
+          continue;
+        removed.push_back(&I);
+      }
+    }
+  }
+  for (auto inst : removed)
+    inst->replaceAllUsesWith(UndefValue::get(inst->getType()));
+  for (auto inst : removed)
+    inst->eraseFromParent();
+  return sliced_module;
+}
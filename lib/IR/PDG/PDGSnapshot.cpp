@@ -0,0 +1,340 @@
+/**
+ * @file PDGSnapshot.cpp
+ * @brief Implementation of the immutable CSR snapshot of the PDG and its reachability queries
+ *
+ * A PDGSnapshot is taken once the PDG is built. It copies the nodes and edges of the
+ * graph into flat arrays, so that clients issuing many reachability queries do not pay
+ * for the std::set based adjacency of the mutable graph.
+ *
+ * Key features:
+ * - Dense node ids and CSR out- and in-edge arrays with a typed edge kind per edge
+ * - Reachability restricted to a mask of edge kinds, in place of a set of excluded types
+ * - Pruning by function-level reachability: the search skips the nodes of functions that
+ *   cannot reach the function of the sink
+ * - An optional Grail index (CSIndex) over the SCC-condensed graph, answering the queries
+ *   of one edge mask without a graph walk
+ */
+
+#include "IR/PDG/PDGSnapshot.h"
+#include "CSIndex/Grail.h"
+#include "CSIndex/Graph.h"
+#include "CSIndex/GraphUtil.h"
+
+#include <algorithm>
+#include <queue>
+
+using namespace llvm;
+
+static_assert(static_cast<unsigned>(pdg::EdgeType::TYPE_OTHEREDGE) < 32, "edge kinds must fit in an EdgeKindMask");
+
+constexpr pdg::PDGSnapshot::NodeID pdg::PDGSnapshot::InvalidID;
+constexpr pdg::PDGSnapshot::EdgeKindMask pdg::PDGSnapshot::AllEdgeKinds;
+
+pdg::PDGSnapshot::EdgeKindMask pdg::PDGSnapshot::excludeKinds(const std::set<EdgeType> &exclude_edge_types)
+{
+  EdgeKindMask mask = AllEdgeKinds;
+  for (auto edge_type : exclude_edge_types)
+    mask &= ~kindBit(edge_type);
+  return mask;
+}
+
+pdg::PDGSnapshot::PDGSnapshot(GenericGraph &g)
+{
+  auto add_node = [this](Node *n) {
+    auto res = _node_ids.insert(std::make_pair(n, (NodeID)_nodes.size()));
+    if (res.second)
+      _nodes.push_back(n);
+    return res.first->second;
+  };
+  for (auto node : g)
+    add_node(node);
+  // some edges reach nodes that were never added to the node set of the graph
+  std::vector<std::pair<NodeID, std::pair<NodeID, uint8_t>>> edges;
+  for (unsigned i = 0; i < _nodes.size(); i++)
+  {
+    for (auto out_edge : _nodes[i]->getOutEdgeSet())
+    {
+      NodeID dst = add_node(out_edge->getDstNode());
+      edges.push_back(std::make_pair(i, std::make_pair(dst, (uint8_t)out_edge->getEdgeType())));
+    }
+  }
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+  unsigned num_nodes = _nodes.size();
+  _out_offsets.assign(num_nodes + 1, 0);
+  _in_offsets.assign(num_nodes + 1, 0);
+  for (auto &e : edges)
+  {
+    _out_offsets[e.first + 1]++;
+    _in_offsets[e.second.first + 1]++;
+  }
+  for (unsigned i = 0; i < num_nodes; i++)
+  {
+    _out_offsets[i + 1] += _out_offsets[i];
+    _in_offsets[i + 1] += _in_offsets[i];
+  }
+  _out_dst.resize(edges.size());
+  _out_kind.resize(edges.size());
+  _in_src.resize(edges.size());
+  _in_kind.resize(edges.size());
+  std::vector<unsigned> in_fill(_in_offsets.begin(), _in_offsets.end() - 1);
+  for (unsigned k = 0; k < edges.size(); k++)
+  {
+    auto &e = edges[k];
+    _out_dst[k] = e.second.first;
+    _out_kind[k] = e.second.second;
+    unsigned slot = in_fill[e.second.first]++;
+    _in_src[slot] = e.first;
+    _in_kind[slot] = e.second.second;
+  }
+
+  // function units, in the order the nodes were numbered
+  std::unordered_map<Function *, unsigned> func_units;
+  _unit_funcs.push_back(nullptr);
+  _node_unit.resize(num_nodes);
+  for (unsigned i = 0; i < num_nodes; i++)
+  {
+    Function *f = _nodes[i]->getFunc();
+    if (f == nullptr)
+    {
+      _node_unit[i] = 0;
+      continue;
+    }
+    auto res = func_units.insert(std::make_pair(f, (unsigned)_unit_funcs.size()));
+    if (res.second)
+      _unit_funcs.push_back(f);
+    _node_unit[i] = res.first->second;
+  }
+  // cross-unit edges, with the kinds seen between each pair of units
+  std::vector<std::pair<unsigned, unsigned>> unit_edges;
+  std::vector<EdgeKindMask> unit_edge_kinds;
+  {
+    std::map<std::pair<unsigned, unsigned>, EdgeKindMask> unit_edge_map;
+    for (unsigned i = 0; i < num_nodes; i++)
+    {
+      for (unsigned e = outBegin(i); e != outEnd(i); e++)
+      {
+        unsigned src_unit = _node_unit[i];
+        unsigned dst_unit = _node_unit[_out_dst[e]];
+        if (src_unit != dst_unit)
+          unit_edge_map[std::make_pair(dst_unit, src_unit)] |= kindBit(outKind(e));
+      }
+    }
+    for (auto &kv : unit_edge_map)
+    {
+      unit_edges.push_back(kv.first);
+      unit_edge_kinds.push_back(kv.second);
+    }
+  }
+  // unit_edges is sorted by destination unit, which gives the in-edge CSR
+  _unit_in_offsets.assign(_unit_funcs.size() + 1, 0);
+  for (auto &ue : unit_edges)
+    _unit_in_offsets[ue.first + 1]++;
+  for (unsigned u = 0; u < _unit_funcs.size(); u++)
+    _unit_in_offsets[u + 1] += _unit_in_offsets[u];
+  for (auto &ue : unit_edges)
+    _unit_in_src.push_back(ue.second);
+  _unit_in_kinds = std::move(unit_edge_kinds);
+
+  _visit_epoch.assign(num_nodes, 0);
+}
+
+pdg::PDGSnapshot::~PDGSnapshot()
+{
+  releaseReachIndex();
+}
+
+void pdg::PDGSnapshot::releaseReachIndex()
+{
+  if (!_grail)
+    return;
+  // Grail leaves its labels in the vertices of the graph and never frees them
+  for (int i = 0; i < _dag->num_vertices(); i++)
+  {
+    delete (*_dag)[i].pre;
+    delete (*_dag)[i].post;
+    delete (*_dag)[i].middle;
+  }
+  delete[] _grail->visited;
+  _grail.reset();
+  _dag.reset();
+}
+
+pdg::PDGSnapshot::NodeID pdg::PDGSnapshot::getID(Node &n) const
+{
+  auto iter = _node_ids.find(&n);
+  if (iter == _node_ids.end())
+    return InvalidID;
+  return iter->second;
+}
+
+bool pdg::PDGSnapshot::canReach(Node &src, Node &dst, EdgeKindMask mask)
+{
+  NodeID src_id = getID(src);
+  NodeID dst_id = getID(dst);
+  if (src_id == InvalidID || dst_id == InvalidID)
+    return &src == &dst;
+  return canReach(src_id, dst_id, mask);
+}
+
+bool pdg::PDGSnapshot::canReach(NodeID src, NodeID dst, EdgeKindMask mask)
+{
+  if (src == dst)
+    return true;
+  if (_grail && mask == _index_mask)
+    return _grail->reach(_scc_of_node[src], _scc_of_node[dst]);
+  return searchReach(src, dst, mask);
+}
+
+// mark the units that can reach dst_unit in the function-level graph
+void pdg::PDGSnapshot::computeUnitsReaching(unsigned dst_unit, EdgeKindMask mask)
+{
+  if (dst_unit == _pruned_dst_unit && mask == _pruned_mask)
+    return;
+  _unit_reaches_dst.assign(_unit_funcs.size(), 0);
+  std::queue<unsigned> unit_queue;
+  _unit_reaches_dst[dst_unit] = 1;
+  unit_queue.push(dst_unit);
+  while (!unit_queue.empty())
+  {
+    unsigned unit = unit_queue.front();
+    unit_queue.pop();
+    for (unsigned e = _unit_in_offsets[unit]; e != _unit_in_offsets[unit + 1]; e++)
+    {
+      unsigned src_unit = _unit_in_src[e];
+      if ((_unit_in_kinds[e] & mask) == 0 || _unit_reaches_dst[src_unit])
+        continue;
+      _unit_reaches_dst[src_unit] = 1;
+      unit_queue.push(src_unit);
+    }
+  }
+  _pruned_dst_unit = dst_unit;
+  _pruned_mask = mask;
+}
+
+bool pdg::PDGSnapshot::searchReach(NodeID src, NodeID dst, EdgeKindMask mask)
+{
+  computeUnitsReaching(_node_unit[dst], mask);
+  if (!_unit_reaches_dst[_node_unit[src]])
+    return false;
+  if (++_epoch == 0)
+  {
+    // the epoch wrapped around, stale stamps could be taken as visited
+    std::fill(_visit_epoch.begin(), _visit_epoch.end(), 0);
+    _epoch = 1;
+  }
+  _stack.clear();
+  _stack.push_back(src);
+  _visit_epoch[src] = _epoch;
+  while (!_stack.empty())
+  {
+    NodeID current = _stack.back();
+    _stack.pop_back();
+    for (unsigned e = outBegin(current); e != outEnd(current); e++)
+    {
+      if ((kindBit(outKind(e)) & mask) == 0)
+        continue;
+      NodeID next = _out_dst[e];
+      if (next == dst)
+        return true;
+      if (_visit_epoch[next] == _epoch || !_unit_reaches_dst[_node_unit[next]])
+        continue;
+      _visit_epoch[next] = _epoch;
+      _stack.push_back(next);
+    }
+  }
+  return false;
+}
+
+void pdg::PDGSnapshot::buildReachIndex(EdgeKindMask mask, int grail_dim)
+{
+  releaseReachIndex();
+  unsigned num_nodes = _nodes.size();
+  if (num_nodes == 0)
+    return;
+  // iterative Tarjan over the edges in mask
+  const int unvisited = -1;
+  std::vector<int> index(num_nodes, unvisited), low_link(num_nodes, 0);
+  std::vector<char> on_stack(num_nodes, 0);
+  std::vector<NodeID> scc_stack;
+  std::vector<std::pair<NodeID, unsigned>> call_stack;
+  _scc_of_node.assign(num_nodes, -1);
+  int next_index = 0;
+  int num_sccs = 0;
+  for (NodeID root = 0; root < num_nodes; root++)
+  {
+    if (index[root] != unvisited)
+      continue;
+    call_stack.push_back(std::make_pair(root, outBegin(root)));
+    index[root] = low_link[root] = next_index++;
+    scc_stack.push_back(root);
+    on_stack[root] = 1;
+    while (!call_stack.empty())
+    {
+      NodeID v = call_stack.back().first;
+      unsigned &e = call_stack.back().second;
+      if (e != outEnd(v))
+      {
+        unsigned cur_e = e++;
+        if ((kindBit(outKind(cur_e)) & mask) == 0)
+          continue;
+        NodeID w = _out_dst[cur_e];
+        if (index[w] == unvisited)
+        {
+          index[w] = low_link[w] = next_index++;
+          scc_stack.push_back(w);
+          on_stack[w] = 1;
+          call_stack.push_back(std::make_pair(w, outBegin(w)));
+        }
+        else if (on_stack[w])
+          low_link[v] = std::min(low_link[v], index[w]);
+        continue;
+      }
+      if (low_link[v] == index[v])
+      {
+        NodeID w;
+        do
+        {
+          w = scc_stack.back();
+          scc_stack.pop_back();
+          on_stack[w] = 0;
+          _scc_of_node[w] = num_sccs;
+        } while (w != v);
+        num_sccs++;
+      }
+      call_stack.pop_back();
+      if (!call_stack.empty())
+      {
+        NodeID parent = call_stack.back().first;
+        low_link[parent] = std::min(low_link[parent], low_link[v]);
+      }
+    }
+  }
+
+  std::vector<std::pair<int, int>> dag_edges;
+  for (NodeID v = 0; v < num_nodes; v++)
+  {
+    for (unsigned e = outBegin(v); e != outEnd(v); e++)
+    {
+      if ((kindBit(outKind(e)) & mask) == 0)
+        continue;
+      int src_scc = _scc_of_node[v];
+      int dst_scc = _scc_of_node[_out_dst[e]];
+      if (src_scc != dst_scc)
+        dag_edges.push_back(std::make_pair(src_scc, dst_scc));
+    }
+  }
+  std::sort(dag_edges.begin(), dag_edges.end());
+  dag_edges.erase(std::unique(dag_edges.begin(), dag_edges.end()), dag_edges.end());
+
+  std::unique_ptr<Graph> dag(new Graph());
+  for (int i = 0; i < num_sccs; i++)
+    dag->addVertex(i);
+  for (auto &de : dag_edges)
+    dag->addEdge(de.first, de.second);
+  GraphUtil::topo_leveler(*dag);
+  _grail.reset(new Grail(*dag, grail_dim, 1, false, 100));
+  _dag = std::move(dag);
+  _index_mask = mask;
+}
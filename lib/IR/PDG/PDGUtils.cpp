@@ -13,15 +13,23 @@
  * - Debug information extraction and processing
  * - Type analysis and handling for field-sensitive operations
  * - Call site and function analysis helpers
+ * - Running the per-function parts of the PDG construction in parallel
  *
  * These utilities simplify the implementation of the core PDG functionality
  * by providing common operations used across multiple components.
  */
 
 #include "IR/PDG/PDGUtils.h"
+#include "IR/PDG/PDGCommandLineOptions.h"
+#include <atomic>
+#include <thread>
 
 using namespace llvm;
 
+unsigned pdg::NUMTHREADS;
+
+cl::opt<unsigned, true> PDGTHREADS("pdg-threads", cl::desc("Number of threads building the per-function parts of the PDG (experimental, speed-up not yet measured on a multi-core host)"), cl::value_desc("number of threads"), cl::location(pdg::NUMTHREADS), cl::init(1));
+
 StructType *pdg::pdgutils::getStructTypeFromGEP(GetElementPtrInst &gep)
 {
   Value *baseAddr = gep.getPointerOperand();
@@ -44,6 +52,7 @@ uint64_t pdg::pdgutils::getGEPOffsetInBits(Module& M, StructType &struct_type, G
   auto const struct_layout = data_layout.getStructLayout(&struct_type);
   if (gep_offset >= struct_type.getNumElements())
   {
+    std::lock_guard<std::mutex> lock(getErrsMutex());
     errs() << "dubious gep access outof bound: " << gep << " in func " << gep.getFunction()->getName() << "\n";
     return INT_MIN;
   }
@@ -409,4 +418,50 @@ std::string& pdg::pdgutils::rtrim(std::string& s, const char* t)
 {
     s.erase(s.find_last_not_of(t) + 1);
     return s;
-}
\ No newline at end of file
+}
+void pdg::pdgutils::runInParallel(unsigned num_tasks, const std::function<void(unsigned)> &task)
+{
+  unsigned num_threads = std::min(std::max(pdg::NUMTHREADS, 1u), num_tasks);
+  // the default: no pool, the tasks run in order on the calling thread
+  if (num_threads <= 1)
+  {
+    for (unsigned i = 0; i < num_tasks; i++)
+      task(i);
+    return;
+  }
+  // each idle thread takes the next task, since functions vary widely in size
+  std::atomic<unsigned> next_task(0);
+  auto worker = [&]() {
+    for (unsigned i = next_task++; i < num_tasks; i = next_task++)
+      task(i);
+  };
+  std::vector<std::thread> threads;
+  for (unsigned i = 1; i < num_threads; i++)
+    threads.emplace_back(worker);
+  worker();
+  for (auto &t : threads)
+    t.join();
+}
+
+void pdg::pdgutils::cacheStructLayouts(Module &M)
+{
+  auto const &data_layout = M.getDataLayout();
+  for (auto &F : M)
+  {
+    for (auto inst_iter = inst_begin(F); inst_iter != inst_end(F); inst_iter++)
+    {
+      GetElementPtrInst *gep = dyn_cast<GetElementPtrInst>(&*inst_iter);
+      if (gep == nullptr)
+        continue;
+      StructType *struct_type = getStructTypeFromGEP(*gep);
+      if (struct_type != nullptr && struct_type->isSized())
+        data_layout.getStructLayout(struct_type);
+    }
+  }
+}
+
+std::mutex &pdg::pdgutils::getErrsMutex()
+{
+  static std::mutex errs_mutex;
+  return errs_mutex;
+}
@@ -14,6 +14,13 @@
  * 4. Connecting inter-procedural dependencies across function calls
  * 5. Connecting class nodes with their methods
  *
+ * The nodes and intra-procedural edges of each function are built in
+ * parallel (-pdg-threads), as they only touch the nodes of that function.
+ * Everything that connects several functions is done afterwards, in module
+ * order, so the graph does not depend on the number of threads.
+ * The speed-up from more threads has not been measured on a multi-core
+ * host; only the single-core overhead of the thread pool has.
+ *
  * A key feature is the handling of function parameters through "tree" structures
  * that enable field-sensitive parameter analysis.
  */
@@ -32,7 +39,6 @@ cl::opt<bool, true> DEBUG("pdg-debug", cl::desc("print debug messages"), cl::val
 void pdg::ProgramDependencyGraph::getAnalysisUsage(AnalysisUsage &AU) const
 {
   AU.addRequired<DataDependencyGraph>();
-  AU.addRequired<ControlDependencyGraph>();
   AU.setPreservesAll();
 }
 
@@ -54,15 +60,28 @@ bool pdg::ProgramDependencyGraph::runOnModule(Module &M)
 
   unsigned func_size = 0;
   connectGlobalWithUses();
+  std::vector<Function *> funcs;
   for (auto &F : M)
   {
     if (F.isDeclaration())
       continue;
     if (!_PDG->hasFuncWrapper(F))
       continue;
-    connectIntraprocDependencies(F);
-    connectInterprocDependencies(F);
-    connectClassNodeWithClassMethods(F);
+    funcs.push_back(&F);
+  }
+  std::vector<char> has_ret_trees_to_connect(funcs.size());
+  pdgutils::runInParallel(funcs.size(), [&](unsigned i) {
+    has_ret_trees_to_connect[i] = connectLocalIntraprocDependencies(*funcs[i]);
+  });
+  for (unsigned i = 0; i < funcs.size(); i++)
+  {
+    if (has_ret_trees_to_connect[i])
+      connectRetTreesWithAddrVars(*funcs[i]);
+  }
+  for (auto F : funcs)
+  {
+    connectInterprocDependencies(*F);
+    connectClassNodeWithClassMethods(*F);
     func_size++;
   }
   errs() << "func size: " << func_size << "\n";
@@ -160,7 +179,7 @@ void pdg::ProgramDependencyGraph::connectCallerAndCallee(CallWrapper &cw, Functi
   auto actual_arg_list = cw.getArgList();
   auto formal_arg_list = fw.getArgList();
   assert(actual_arg_list.size() == formal_arg_list.size() && "cannot connect tree edges due to inequal arg num! (connectCallerandCallee)");
-  if (cw.getCalledFunc())
+  if (DEBUG && cw.getCalledFunc())
     errs() << "connecting interproc call: " << cw.getCalledFunc()->getName() << " - " << cw.getCallInst()->getFunction()->getName() << "\n";
   int num_arg = cw.getArgList().size();
   for (int i = 0; i < num_arg; i++)
@@ -170,7 +189,8 @@ void pdg::ProgramDependencyGraph::connectCallerAndCallee(CallWrapper &cw, Functi
     // step 2: connect actual in -> formal in
     auto actual_in_tree = cw.getArgActualInTree(*actual_arg);
     auto formal_in_tree = fw.getArgFormalInTree(*formal_arg);
-    errs() << "tree size compare: " << actual_in_tree->size() << " - " << formal_in_tree->size() << "\n";
+    if (DEBUG)
+      errs() << "tree size compare: " << actual_in_tree->size() << " - " << formal_in_tree->size() << "\n";
     _PDG->addTreeNodesToGraph(*actual_in_tree);
     connectInTrees(actual_in_tree, formal_in_tree, EdgeType::PARAMETER_IN);
     // step 3: connect actual out -> formal out
@@ -216,19 +236,30 @@ void pdg::ProgramDependencyGraph::connectCallerAndCallee(CallWrapper &cw, Functi
 
 // ===== connect dependencies =====
 void pdg::ProgramDependencyGraph::connectIntraprocDependencies(Function &F)
+{
+  if (connectLocalIntraprocDependencies(F))
+    connectRetTreesWithAddrVars(F);
+}
+
+// Connect the control dependencies and the formal trees of the arguments of
+// F, which only touch the nodes of F. Return true if the return trees of F
+// remain to be connected: their address variables are the returned values,
+// which may be globals or constants used in other functions.
+bool pdg::ProgramDependencyGraph::connectLocalIntraprocDependencies(Function &F)
 {
   // add control dependency edges
-  getAnalysis<ControlDependencyGraph>(F); // add control dependencies for nodes in F
+  PostDominatorTree PDT(F);
+  ControlDependencyGraph::addControlDependencies(F, PDT);
   // connect formal tree with address variables
   FunctionWrapper* func_w = getFuncWrapper(F);
   if (!func_w)
-    return;
+    return false;
   Node* entry_node = func_w->getEntryNode();
   for (auto arg : func_w->getArgList())
   {
     Tree* formal_in_tree = func_w->getArgFormalInTree(*arg);
     if (!formal_in_tree)
-      return;
+      return false;
 
     Tree* formal_out_tree = func_w->getArgFormalOutTree(*arg);
     entry_node->addNeighbor(*formal_in_tree->getRootNode(), EdgeType::PARAMETER_IN);
@@ -236,12 +267,16 @@ void pdg::ProgramDependencyGraph::connectIntraprocDependencies(Function &F)
     connectFormalInTreeWithAddrVars(*formal_in_tree);
     connectFormalOutTreeWithAddrVars(*formal_out_tree);
   }
+  return !func_w->hasNullRetVal();
+}
 
-  if (!func_w->hasNullRetVal())
-  {
-    connectFormalInTreeWithAddrVars(*func_w->getRetFormalInTree());
-    connectFormalOutTreeWithAddrVars(*func_w->getRetFormalOutTree());
-  }
+void pdg::ProgramDependencyGraph::connectRetTreesWithAddrVars(Function &F)
+{
+  FunctionWrapper* func_w = getFuncWrapper(F);
+  if (!func_w || func_w->hasNullRetVal())
+    return;
+  connectFormalInTreeWithAddrVars(*func_w->getRetFormalInTree());
+  connectFormalOutTreeWithAddrVars(*func_w->getRetFormalOutTree());
 }
 
 void pdg::ProgramDependencyGraph::connectInterprocDependencies(Function &F)
@@ -269,7 +304,21 @@ void pdg::ProgramDependencyGraph::connectInterprocDependencies(Function &F)
       // this return both direct call and indirect call targets
       auto called_func_nodes = caller_func_node->getOutNeighbors();
       assert(called_func_nodes.size() > 0 && "find call site with 0 call targets, cannot connect. Aborting\n");
-      if (auto called_func = dyn_cast<Function>((*called_func_nodes.begin())->getValue()))
+      // build the actual trees from the direct callee, or from the indirect
+      // candidate with the smallest name. The out neighbors are ordered by node
+      // address, so taking the first one made the trees depend on allocation order.
+      Function *called_func = call_inst->getCalledFunction();
+      if (!called_func || !_PDG->getFuncWrapper(*called_func))
+      {
+        called_func = nullptr;
+        for (auto f_node : called_func_nodes)
+        {
+          auto candidate = dyn_cast_or_null<Function>(f_node->getValue());
+          if (candidate && _PDG->getFuncWrapper(*candidate) && (!called_func || candidate->getName() < called_func->getName()))
+            called_func = candidate;
+        }
+      }
+      if (called_func)
       {
         auto called_func_w = getFuncWrapper(*called_func);
         if (!call_w->hasParamTrees())
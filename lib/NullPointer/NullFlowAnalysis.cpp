@@ -88,9 +88,11 @@ bool NullFlowAnalysis::runOnModule(Module &M) {
         for (auto &T: *Top) if (!Visited.count(T.first)) DFSStack.push_back(T.first);
     }
 
-    // get initial non null nodes
-    set_intersection(Visited.begin(), Visited.end(), VFG->node_begin(), VFG->node_end(),
-                     inserter(NonNullNodes, NonNullNodes.begin()));
+    // get initial non null nodes, i.e., the nodes no null value flows to.
+    // node_begin() walks an unordered map, so the nodes are filtered one by one
+    // rather than merged as a sorted range
+    for (auto It = VFG->node_begin(), E = VFG->node_end(); It != E; ++It)
+        if (!Visited.count(*It)) NonNullNodes.insert(*It);
     return false;
 }
 
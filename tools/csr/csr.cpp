@@ -14,6 +14,7 @@
 #include "CSIndex/CSProgressBar.h"
 #include "CSIndex/Grail.h"
 #include "CSIndex/Graph.h"
+#include "CSIndex/GraphFile.h"
 #include "CSIndex/GraphUtil.h"
 #include "CSIndex/PathtreeQuery.h"
 #include "CSIndex/PathTree.h"
@@ -42,6 +43,7 @@ static void usage() {
     cout << "\nUsage:\n"
             "	csr [-h] [-t] [-m pathtree_or_grail] [-n num_query] [-q query_file] [-g query_file] graph_file\n"
             "Description:\n"
+            "	graph_file is a text graph or a binary graph made by csr-convert.\n"
             "	-h\tPrint the help message.\n"
             "	-n\t# reachable queries and # unreachable queries to be generated, 100 for each by default.\n"
             "	-g\tSave the randomly generated queries into file.\n"
@@ -104,6 +106,25 @@ static void parse_arg(int argc, char *argv[]) {
         indexing = "grail";
 }
 
+// reads either format, a binary graph is mapped instead of parsed
+static void read_graph(Graph &g, const string &file) {
+    if (GraphFile::isGraphFile(file)) {
+        GraphFile gf;
+        if (!gf.open(file)) {
+            cerr << gf.error() << endl;
+            exit(1);
+        }
+        g.readGraph(gf);
+        return;
+    }
+    ifstream in(file);
+    if (!in) {
+        cerr << "Cannot open " << file << endl;
+        exit(1);
+    }
+    g.readGraph(in);
+}
+
 template<typename Src, typename Target>
 static double test_query(AbstractQuery *aq, vector<std::pair<int, int>> &queries, bool r, Src src, Target trg) {
     signal(SIGALRM, alarm_handler);
@@ -249,17 +270,20 @@ static double pt_index_size(Graph &bbgg, PathTree &pt, Query &pt_query) {
 int main(int argc, char *argv[]) {
     parse_arg(argc, argv);
 
-    ifstream graphfile(graph_file);
-    Graph vfg(graphfile);
-    graphfile.close();
+    auto start = std::chrono::high_resolution_clock::now();
+    Graph vfg;
+    read_graph(vfg, graph_file);
+    auto end = std::chrono::high_resolution_clock::now();
+    chrono::duration<double, std::milli> diff = end - start;
+    cout << "Reading Graph Duration: " << diff.count() << " ms" << endl;
     auto orig_vfg_size = vfg.num_vertices();
     auto orig_vfg_edges = vfg.num_edges();
     vfg.check(); // check the correctness
 
-    auto start = std::chrono::high_resolution_clock::now();
+    start = std::chrono::high_resolution_clock::now();
     vfg.build_summary_edges();
-    auto end = std::chrono::high_resolution_clock::now();
-    chrono::duration<double, std::milli> diff = end - start;
+    end = std::chrono::high_resolution_clock::now();
+    diff = end - start;
     double summary_edge_time = diff.count();
     double summary_edge_size = ((double) vfg.summary_edge_size() * sizeof(int) * 2 / 1024 / 1024);
     vfg.to_indexing_graph();
@@ -393,9 +417,8 @@ int main(int argc, char *argv[]) {
     double tc_time = 0;
     double tc_size = 0;
     if (reps_tab_alg || transitive_closure) {
-        ifstream orig_gf(graph_file);
-        Graph orig_vfg(orig_gf);
-        orig_gf.close();
+        Graph orig_vfg;
+        read_graph(orig_vfg, graph_file);
         orig_vfg.build_summary_edges();
         orig_vfg.add_summary_edges();
 
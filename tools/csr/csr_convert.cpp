@@ -0,0 +1,58 @@
+//
+// Converts a graph_for_greach text graph into the binary format of GraphFile.
+//
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include "CSIndex/Graph.h"
+#include "CSIndex/GraphFile.h"
+
+static void usage() {
+    cout << "\nUsage:\n"
+            "	csr-convert [-h] text_graph_file binary_graph_file\n"
+            "Description:\n"
+            "	-h\tPrint the help message.\n"
+            "	The binary graph keeps the edge labels and the function ids of the text graph,\n"
+            "	and is read by csr without parsing.\n"
+         << endl;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 3 || strcmp("-h", argv[1]) == 0) {
+        usage();
+        return argc == 3 ? 0 : 1;
+    }
+    string text_file = argv[1];
+    string binary_file = argv[2];
+    if (GraphFile::isGraphFile(text_file)) {
+        cerr << text_file << " is already a binary graph" << endl;
+        return 1;
+    }
+
+    ifstream in(text_file);
+    if (!in) {
+        cerr << "Cannot open " << text_file << endl;
+        return 1;
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    Graph g(in);
+    in.close();
+    auto end = std::chrono::high_resolution_clock::now();
+    chrono::duration<double, std::milli> read_time = end - start;
+
+    start = std::chrono::high_resolution_clock::now();
+    string error;
+    if (!GraphFile::write(g, binary_file, error)) {
+        cerr << error << endl;
+        return 1;
+    }
+    end = std::chrono::high_resolution_clock::now();
+    chrono::duration<double, std::milli> write_time = end - start;
+
+    cout << "# Vertices: " << g.num_vertices() << " # Edges: " << g.num_edges() << endl;
+    cout << "Text graph read in " << (int) read_time.count() << " ms, binary graph written in "
+         << (int) write_time.count() << " ms." << endl;
+    return 0;
+}
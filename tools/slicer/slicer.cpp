@@ -0,0 +1,198 @@
+#include "IR/PDG/PDGCommandLineOptions.h"
+#include "IR/PDG/PDGSlicer.h"
+#include "IR/PDG/ProgramDependencyGraph.h"
+
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/IRReader/IRReader.h>
+#include <llvm/InitializePasses.h>
+#include <llvm/PassRegistry.h>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/SourceMgr.h>
+#include <llvm/Support/ToolOutputFile.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <algorithm>
+#include <chrono>
+
+using namespace llvm;
+using namespace pdg;
+
+static cl::opt<std::string> InputFilename(cl::Positional, cl::desc("<input bitcode file>"), cl::Required,
+                                          cl::value_desc("filename"));
+
+static cl::opt<std::string> OutputFilename("o", cl::desc("Write the sliced module to this file"),
+                                           cl::value_desc("filename"));
+
+static cl::list<std::string> Criteria("slice-criteria", cl::CommaSeparated,
+                                      cl::desc("Functions whose call sites are the slicing criteria (sinks of a chop), "
+                                               "or func#N for the N-th instruction of func"));
+
+static cl::list<std::string> ChopSources("chop-sources", cl::CommaSeparated,
+                                         cl::desc("Functions whose call sites are the sources of a chop"));
+
+static cl::opt<SliceKind> Kind("slice-kind", cl::desc("Kind of slice"), cl::init(SliceKind::BACKWARD),
+                               cl::values(clEnumValN(SliceKind::BACKWARD, "backward", "Backward slice"),
+                                          clEnumValN(SliceKind::FORWARD, "forward", "Forward slice"),
+                                          clEnumValN(SliceKind::THIN, "thin", "Thin backward slice")));
+
+static cl::opt<bool> Chop("chop", cl::desc("Chop from -chop-sources to -slice-criteria"), cl::init(false));
+
+static cl::opt<bool> SliceSeparately("slice-separately",
+                                     cl::desc("Take one slice per criterion, in parallel over -pdg-threads"),
+                                     cl::init(false));
+
+static cl::opt<unsigned> ContextDepth("context-depth", cl::desc("Call sites kept in the call strings, 0 for none"),
+                                      cl::init(3));
+
+static cl::opt<bool> PrintSlice("print-slice", cl::desc("Print the instructions of the slice"), cl::init(false));
+
+template <typename Fn> static double timeMs(Fn &&F) {
+  auto Start = std::chrono::high_resolution_clock::now();
+  F();
+  auto End = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double, std::milli>(End - Start).count();
+}
+
+// the criteria of each name: the call sites of a function, or one instruction
+static std::vector<std::vector<Node *>> collectCriteria(Module &M, ProgramGraph &PDG,
+                                                        const std::vector<std::string> &Names) {
+  std::vector<std::vector<Node *>> Res;
+  for (auto &Name : Names) {
+    std::vector<Node *> Nodes;
+    auto Hash = Name.find('#');
+    if (Hash != std::string::npos) {
+      unsigned Index;
+      if (StringRef(Name).substr(Hash + 1).getAsInteger(10, Index)) {
+        errs() << "Bad criterion " << Name << ", expected <function>#<instruction index>\n";
+        Res.push_back(std::move(Nodes));
+        continue;
+      }
+      Function *F = M.getFunction(Name.substr(0, Hash));
+      if (F) {
+        unsigned K = 0;
+        for (auto &I : instructions(*F)) {
+          if (K++ != Index)
+            continue;
+          if (Node *N = PDG.getNode(I))
+            Nodes.push_back(N);
+        }
+      }
+    } else {
+      for (auto &F : M) {
+        for (auto &I : instructions(F)) {
+          auto *CI = dyn_cast<CallBase>(&I);
+          if (!CI || !CI->getCalledFunction() || CI->getCalledFunction()->getName() != Name)
+            continue;
+          if (Node *N = PDG.getNode(I))
+            Nodes.push_back(N);
+        }
+      }
+    }
+    if (Nodes.empty())
+      errs() << "No PDG node for criterion " << Name << "\n";
+    Res.push_back(std::move(Nodes));
+  }
+  return Res;
+}
+
+int main(int argc, char **argv) {
+  cl::ParseCommandLineOptions(argc, argv, "Slices a module over its program dependence graph\n");
+  if (Criteria.empty()) {
+    errs() << "Nothing to slice, give -slice-criteria\n";
+    return 1;
+  }
+
+  LLVMContext Context;
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M;
+  double LoadMs = timeMs([&] { M = parseIRFile(InputFilename, Err, Context); });
+  if (!M) {
+    Err.print(argv[0], errs());
+    return 1;
+  }
+
+  initializeCore(*PassRegistry::getPassRegistry());
+  initializeAnalysis(*PassRegistry::getPassRegistry());
+  legacy::PassManager PM;
+  PM.add(new ProgramDependencyGraph());
+  double PDGMs = timeMs([&] { PM.run(*M); });
+  ProgramGraph &PDG = ProgramGraph::getInstance();
+
+  std::unique_ptr<PDGSnapshot> Snapshot;
+  std::unique_ptr<PDGSlicer> Slicer;
+  double SnapshotMs = timeMs([&] {
+    Snapshot.reset(new PDGSnapshot(PDG));
+    Slicer.reset(new PDGSlicer(PDG, *Snapshot, ContextDepth));
+  });
+
+  std::vector<std::string> CriteriaNames(Criteria.begin(), Criteria.end());
+  auto CriteriaNodes = collectCriteria(*M, PDG, CriteriaNames);
+  std::vector<PDGSlicer::Slice> Slices;
+  double SliceMs = timeMs([&] {
+    if (Chop) {
+      std::vector<std::string> SourceNames(ChopSources.begin(), ChopSources.end());
+      std::vector<Node *> Sources, Sinks;
+      for (auto &Nodes : collectCriteria(*M, PDG, SourceNames))
+        Sources.insert(Sources.end(), Nodes.begin(), Nodes.end());
+      for (auto &Nodes : CriteriaNodes)
+        Sinks.insert(Sinks.end(), Nodes.begin(), Nodes.end());
+      Slices.push_back(Slicer->chop(Sources, Sinks));
+    } else if (SliceSeparately) {
+      Slices = Slicer->sliceEach(CriteriaNodes, Kind);
+    } else {
+      std::vector<Node *> All;
+      for (auto &Nodes : CriteriaNodes)
+        All.insert(All.end(), Nodes.begin(), Nodes.end());
+      Slices.push_back(Slicer->slice(All, Kind));
+    }
+  });
+
+  std::set<Instruction *> SliceInsts;
+  size_t MaxNodes = 0, TotalNodes = 0;
+  for (auto &S : Slices) {
+    auto Insts = Slicer->getInstructions(S);
+    SliceInsts.insert(Insts.begin(), Insts.end());
+    MaxNodes = std::max(MaxNodes, S.size());
+    TotalNodes += S.size();
+  }
+
+  outs() << "PDG: " << Snapshot->numNodes() << " nodes, " << Snapshot->numEdges() << " edges\n";
+  outs() << "Slices: " << Slices.size() << ", largest " << MaxNodes << " nodes, average "
+         << (Slices.empty() ? 0 : TotalNodes / Slices.size()) << " nodes, " << SliceInsts.size()
+         << " instructions in the union\n";
+  outs() << "Time (ms): load " << (long long)LoadMs << ", PDG " << (long long)PDGMs << ", snapshot "
+         << (long long)SnapshotMs << ", slicing " << (long long)SliceMs << " on " << std::max(NUMTHREADS, 1u)
+         << " threads\n";
+
+  if (PrintSlice) {
+    for (auto &F : *M)
+      for (auto &I : instructions(F))
+        if (SliceInsts.count(&I))
+          outs() << F.getName() << ":" << I << "\n";
+  }
+
+  if (!OutputFilename.empty()) {
+    std::unique_ptr<Module> Sliced;
+    double SlicedModuleMs = timeMs([&] { Sliced = PDGSlicer::buildSlicedModule(*M, SliceInsts); });
+    if (verifyModule(*Sliced, &errs())) {
+      errs() << "The sliced module is broken\n";
+      return 1;
+    }
+    std::error_code EC;
+    ToolOutputFile Out(OutputFilename, EC, sys::fs::OF_None);
+    if (EC) {
+      errs() << EC.message() << "\n";
+      return 1;
+    }
+    WriteBitcodeToFile(*Sliced, Out.os());
+    Out.keep();
+    outs() << "Sliced module written in " << (long long)SlicedModuleMs << " ms\n";
+  }
+  return 0;
+}